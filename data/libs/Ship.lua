@@ -416,6 +416,19 @@ Ship.GetHyperspaceRange = function (self)
 	return engine:GetRange(self)
 end
 
+-- ship:GetHyperspaceRoute(destination, metric) -- plan a route from the current system to 'destination' in jumps the ship can make now
+-- metric is optional, see Constants.RouteMetric
+Ship.GetHyperspaceRoute = function (self, destination, metric)
+	if not Game.system then
+		return nil
+	end
+	local range = self:GetHyperspaceRange()
+	if range <= 0 then
+		return nil
+	end
+	return Game.system.path:GetHyperspaceRoute(destination, range, metric)
+end
+
 compat.slots.new2old = {}
 for k,v in pairs(compat.slots.old2new) do
 	compat.slots.new2old[v] = k
@@ -11,11 +11,29 @@ uniform sampler2D texture1; //specular
 uniform sampler2D texture2; //glow
 uniform sampler2D texture3; //ambient
 uniform sampler2D texture4; //pattern
-uniform sampler2D texture5; //color
 uniform sampler2D texture6; //normal
 in vec2 texCoord0;
 #endif
 
+#ifdef MAP_COLOR
+uniform vec4 patternColors[3]; //primary, secondary, trim
+uniform int smoothPatternColors;
+
+// the pattern's red channel picks a colour: 0-0.25 is white (untinted), then
+// primary, secondary and trim. this matches the 16 texel wide lookup texture
+// that used to be generated for each model instance
+vec4 patternColor(in float index)
+{
+	vec4 colors[4] = vec4[4](vec4(1.0), patternColors[0], patternColors[1], patternColors[2]);
+	if (smoothPatternColors == 0)
+		return colors[int(clamp(index * 16.0, 0.0, 15.0)) / 4];
+
+	float t = clamp(index * 16.0 - 0.5, 0.0, 15.0);
+	float t0 = floor(t);
+	return mix(colors[int(t0) / 4], colors[int(min(t0 + 1.0, 15.0)) / 4], t - t0);
+}
+#endif
+
 #ifdef VERTEXCOLOR
 in vec4 vertexColor;
 #endif
@@ -70,7 +88,7 @@ void main(void)
 //patterns - simple lookup
 #ifdef MAP_COLOR
 	vec4 pat = texture(texture4, texCoord0);
-	vec4 mapColor = texture(texture5, vec2(pat.r, 0.0));
+	vec4 mapColor = patternColor(pat.r);
 	vec4 tint = mix(vec4(1.0),mapColor,pat.a);
 	color *= tint;
 #endif
@@ -15,8 +15,12 @@
 #include "graphics/VertexArray.h"
 #include "graphics/Material.h"
 #include "graphics/TextureBuilder.h"
+#include "graphics/Stats.h"
 
 #include <SDL_stdinc.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 using namespace Graphics;
 
@@ -26,6 +30,9 @@ static const float OBJECT_HIDDEN_PIXEL_THRESHOLD = 2.0f;
 // if a terrain object would render smaller than this many pixels, draw a billboard instead
 static const float BILLBOARD_PIXEL_THRESHOLD = 8.0f;
 
+// bodies culled at a time. below two batches it's not worth waking the workers
+static const Uint32 CULL_BATCH_SIZE = 256;
+
 CameraContext::CameraContext(float width, float height, float fovAng, float zNear, float zFar) :
 	m_width(width),
 	m_height(height),
@@ -80,9 +87,145 @@ void CameraContext::ApplyDrawTransforms(Graphics::Renderer *r)
 }
 
 
+struct Camera::CullPass {
+	enum Result {
+		OFFSCREEN,
+		HIDDEN,      // too small to see
+		BILLBOARD,   // terrain body too small to draw properly
+		VISIBLE
+	};
+
+	// in, one entry per body
+	std::vector<Body*> body;
+	std::vector<vector3d> pos;          // interpolated, relative to the body's frame
+	std::vector<double> radius;
+	std::vector<Uint32> transform;      // index into transforms
+	std::vector<Uint8> terrain;
+
+	std::vector<matrix4x4d> transforms; // body frame to camera frame
+	const Graphics::Frustum *frustum;
+	double pixelScale;                  // pixel width is pixelScale * radius / distance
+
+	// out
+	std::vector<vector3d> viewCoords;
+	std::vector<double> camDist;
+	std::vector<Uint8> result;
+
+	Uint32 count;
+	Uint32 numBatches;
+	std::atomic<Uint32> nextBatch;
+	std::atomic<Uint32> doneBatches;
+	std::mutex doneLock;
+	std::condition_variable doneCond;
+
+	// cull batches until there are none left to claim. safe to call from any
+	// number of threads at once
+	void Run();
+	void RunBatch(Uint32 batch);
+	// sleep until batches claimed by other threads are finished too
+	void WaitDone();
+};
+
+void Camera::CullPass::Run()
+{
+	for (;;) {
+		const Uint32 batch = nextBatch.fetch_add(1);
+		if (batch >= numBatches)
+			return;
+		RunBatch(batch);
+		if (doneBatches.fetch_add(1, std::memory_order_acq_rel) + 1 == numBatches) {
+			std::lock_guard<std::mutex> lock(doneLock);
+			doneCond.notify_all();
+		}
+	}
+}
+
+void Camera::CullPass::WaitDone()
+{
+	std::unique_lock<std::mutex> lock(doneLock);
+	doneCond.wait(lock, [this]() { return doneBatches.load(std::memory_order_acquire) >= numBatches; });
+}
+
+void Camera::CullPass::RunBatch(Uint32 batch)
+{
+	const Uint32 end = std::min(count, (batch + 1) * CULL_BATCH_SIZE);
+	for (Uint32 i = batch * CULL_BATCH_SIZE; i < end; i++) {
+		const vector3d vc = transforms[transform[i]] * pos[i];
+		viewCoords[i] = vc;
+
+		// cull off-screen objects
+		if (!frustum->TestPointInfinite(vc, radius[i])) {
+			result[i] = OFFSCREEN;
+			continue;
+		}
+
+		const double dist = vc.Length();
+		camDist[i] = dist;
+
+		// approximate pixel width (disc diameter) of body on screen. terrain
+		// objects are visible from distance but might not have any
+		// discernable features
+		const float pixSize = pixelScale * radius[i] / dist;
+		if (terrain[i])
+			result[i] = pixSize < BILLBOARD_PIXEL_THRESHOLD ? BILLBOARD : VISIBLE;
+		else
+			result[i] = pixSize < OBJECT_HIDDEN_PIXEL_THRESHOLD ? HIDDEN : VISIBLE;
+	}
+}
+
+// helps the main thread through the batches. holds on to the pass, so if it
+// doesn't get to run until the frame is over it finds nothing left to do
+class Camera::CullJob : public Job {
+public:
+	CullJob(const std::shared_ptr<CullPass> &pass) : m_pass(pass) {}
+
+	virtual void OnRun() override { m_pass->Run(); }
+	virtual void OnFinish() override {}
+
+private:
+	std::shared_ptr<CullPass> m_pass;
+};
+
+static inline Uint32 DrawOrderKey(double camDist, Uint32 bodyFlags)
+{
+	// positive floats sort the same as their bits. furthest first, so
+	// invert them
+	const float dist = float(camDist);
+	Uint32 bits;
+	memcpy(&bits, &dist, sizeof(bits));
+	const Uint32 key = 0x7fffffff - (bits & 0x7fffffff);
+	return (bodyFlags & Body::FLAG_DRAW_LAST) ? (key | 0x80000000) : key;
+}
+
+// stable LSD radix sort on the key, a byte at a time. passes where every key
+// has the same byte are skipped
+template <typename T>
+static void RadixSort(std::vector<T> &items, std::vector<T> &scratch)
+{
+	scratch.resize(items.size());
+	for (int shift = 0; shift < 32; shift += 8) {
+		Uint32 counts[256] = {};
+		for (const T &item : items)
+			counts[(item.key >> shift) & 0xff]++;
+		if (counts[(items[0].key >> shift) & 0xff] == items.size())
+			continue;
+
+		Uint32 offset = 0;
+		for (Uint32 &c : counts) {
+			const Uint32 n = c;
+			c = offset;
+			offset += n;
+		}
+		for (const T &item : items)
+			scratch[counts[(item.key >> shift) & 0xff]++] = item;
+		items.swap(scratch);
+	}
+}
+
 Camera::Camera(RefCountedPtr<CameraContext> context, Graphics::Renderer *renderer) :
 	m_context(context),
-	m_renderer(renderer)
+	m_renderer(renderer),
+	m_cullJobs(Pi::GetAsyncJobQueue())
 {
 	Graphics::MaterialDescriptor desc;
 	desc.textures = 1;
@@ -117,68 +260,126 @@ static void position_system_lights(Frame *camFrame, Frame *frame, std::vector<Ca
 
 void Camera::Update()
 {
+	PROFILE_SCOPED()
+
 	Frame *camFrame = m_context->GetCamFrame();
 
-	// evaluate each body and determine if/where/how to draw it
-	m_sortedBodies.clear();
-	for (Body* b : Pi::game->GetSpace()->GetBodies()) {
-		BodyAttrs attrs;
-		attrs.body = b;
-		attrs.billboard = false; // false by default
+	// a pass still held by last frame's jobs can't be touched. it gets
+	// dropped when they're deleted
+	if (!m_cullPass || m_cullPass.use_count() > 1)
+		m_cullPass.reset(new CullPass);
+	CullPass &pass = *m_cullPass;
+
+	pass.body.clear();
+	pass.pos.clear();
+	pass.radius.clear();
+	pass.transform.clear();
+	pass.terrain.clear();
+	pass.transforms.clear();
+	m_frameIndex.clear();
+
+	// gather everything the cull needs from the bodies
+	for (Body *b : Pi::game->GetSpace()->GetBodies()) {
+		auto inserted = m_frameIndex.insert(std::make_pair(b->GetFrame(), Uint32(pass.transforms.size())));
+		if (inserted.second) {
+			pass.transforms.push_back(matrix4x4d());
+			Frame::GetFrameTransform(b->GetFrame(), camFrame, pass.transforms.back());
+		}
+		pass.transform.push_back(inserted.first->second);
+		pass.body.push_back(b);
+		pass.pos.push_back(b->GetInterpPosition());
+		pass.radius.push_back(b->GetClipRadius());
+		pass.terrain.push_back(b->IsType(Object::TERRAINBODY));
+	}
 
-		// determine position and transform for draw
-		Frame::GetFrameTransform(b->GetFrame(), camFrame, attrs.viewTransform);
-		attrs.viewCoords = attrs.viewTransform * b->GetInterpPosition();
+	pass.count = pass.body.size();
+	pass.numBatches = (pass.count + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE;
+	pass.frustum = &m_context->GetFrustum();
+	pass.pixelScale = Graphics::GetScreenHeight() * 2.0 / Graphics::GetFovFactor();
+	pass.viewCoords.resize(pass.count);
+	pass.camDist.resize(pass.count);
+	pass.result.resize(pass.count);
+	pass.nextBatch = 0;
+	pass.doneBatches = 0;
+
+	// the main thread works through the batches too, so busy workers only
+	// cost as much as the batches they've already claimed
+	if (pass.numBatches > 1 && m_cullJobs.IsEmpty()) {
+		const Uint32 numJobs = std::min(pass.numBatches - 1, Uint32(std::max(SDL_GetCPUCount() - 1, 1)));
+		for (Uint32 i = 0; i < numJobs; i++)
+			m_cullJobs.Order(new CullJob(m_cullPass));
+	}
+	pass.Run();
+	pass.WaitDone();
 
-		// cull off-screen objects
-		double rad = b->GetClipRadius();
-		if (!m_context->GetFrustum().TestPointInfinite(attrs.viewCoords, rad))
+	// evaluate each visible body and determine where/how to draw it
+	m_bodyAttrs.clear();
+	m_sortedBodies.clear();
+	Uint32 numOffscreen = 0, numHidden = 0;
+	for (Uint32 i = 0; i < pass.count; i++) {
+		if (pass.result[i] == CullPass::OFFSCREEN) {
+			numOffscreen++;
+			continue;
+		}
+		if (pass.result[i] == CullPass::HIDDEN) {
+			numHidden++;
 			continue;
+		}
 
-		attrs.camDist = attrs.viewCoords.Length();
-		attrs.bodyFlags = b->GetFlags();
+		Body *b = pass.body[i];
 
-		// approximate pixel width (disc diameter) of body on screen
-		const float pixSize = Graphics::GetScreenHeight() * 2.0 * rad / (attrs.camDist * Graphics::GetFovFactor());
-
-		// terrain objects are visible from distance but might not have any discernable features
-		if (b->IsType(Object::TERRAINBODY)) {
-			if (pixSize < BILLBOARD_PIXEL_THRESHOLD) {
-				attrs.billboard = true;
-				vector3d pos;
-				// limit the minimum billboard size for planets so they're always a little visible
-				const double size = std::max(0.5, rad * 2.0 * m_context->GetFrustum().TranslatePoint(attrs.viewCoords, pos));
-				attrs.billboardPos = vector3f(pos);
-				attrs.billboardSize = float(size);
-				if (b->IsType(Object::STAR)) {
-					attrs.billboardColor = StarSystem::starRealColors[b->GetSystemBody()->GetType()];
-				}
-				else if (b->IsType(Object::PLANET)) {
-					// XXX this should incorporate some lighting effect
-					// (ie, colour of the illuminating star(s))
-					attrs.billboardColor = b->GetSystemBody()->GetAlbedo();
-				}
-				else {
-					attrs.billboardColor = Color::WHITE;
-				}
+		BodyAttrs attrs;
+		attrs.body = b;
+		attrs.viewCoords = pass.viewCoords[i];
+		attrs.viewTransform = pass.transforms[pass.transform[i]];
+		attrs.camDist = pass.camDist[i];
+		attrs.bodyFlags = b->GetFlags();
+		attrs.billboard = false; // false by default
 
-				// this should always be the main star in the system - except for the star itself!
-				if( !m_lightSources.empty() && !b->IsType(Object::STAR) ) {
-					const Graphics::Light& light = m_lightSources[0].GetLight();
-					attrs.billboardColor *= light.GetDiffuse(); // colour the billboard a little with the Starlight
-				}
+		if (pass.result[i] == CullPass::BILLBOARD) {
+			attrs.billboard = true;
+			vector3d pos;
+			// limit the minimum billboard size for planets so they're always a little visible
+			const double size = std::max(0.5, pass.radius[i] * 2.0 * m_context->GetFrustum().TranslatePoint(attrs.viewCoords, pos));
+			attrs.billboardPos = vector3f(pos);
+			attrs.billboardSize = float(size);
+			if (b->IsType(Object::STAR)) {
+				attrs.billboardColor = StarSystem::starRealColors[b->GetSystemBody()->GetType()];
+			}
+			else if (b->IsType(Object::PLANET)) {
+				// XXX this should incorporate some lighting effect
+				// (ie, colour of the illuminating star(s))
+				attrs.billboardColor = b->GetSystemBody()->GetAlbedo();
+			}
+			else {
+				attrs.billboardColor = Color::WHITE;
+			}
 
-				attrs.billboardColor.a = 255; // no alpha, these things are hard enough to see as it is
+			// this should always be the main star in the system - except for the star itself!
+			if( !m_lightSources.empty() && !b->IsType(Object::STAR) ) {
+				const Graphics::Light& light = m_lightSources[0].GetLight();
+				attrs.billboardColor *= light.GetDiffuse(); // colour the billboard a little with the Starlight
 			}
-		} else if (pixSize < OBJECT_HIDDEN_PIXEL_THRESHOLD) {
-			continue;
+
+			attrs.billboardColor.a = 255; // no alpha, these things are hard enough to see as it is
 		}
 
-		m_sortedBodies.push_back(attrs);
+		SortKey key;
+		key.key = DrawOrderKey(attrs.camDist, attrs.bodyFlags);
+		key.index = m_bodyAttrs.size();
+		m_sortedBodies.push_back(key);
+		m_bodyAttrs.push_back(attrs);
 	}
 
 	// depth sort
-	m_sortedBodies.sort();
+	if (!m_sortedBodies.empty())
+		RadixSort(m_sortedBodies, m_sortScratch);
+
+	Graphics::Stats &stats = m_renderer->GetStats();
+	stats.AddToStatCount(Graphics::Stats::STAT_CULL_TESTED, pass.count);
+	stats.AddToStatCount(Graphics::Stats::STAT_CULL_OFFSCREEN, numOffscreen);
+	stats.AddToStatCount(Graphics::Stats::STAT_CULL_HIDDEN, numHidden);
+	stats.AddToStatCount(Graphics::Stats::STAT_CULL_VISIBLE, m_bodyAttrs.size());
 }
 
 void Camera::Draw(const Body *excludeBody, ShipCockpit* cockpit)
@@ -203,6 +404,8 @@ void Camera::Draw(const Body *excludeBody, ShipCockpit* cockpit)
 		m_lightSources.push_back(LightSource(0, Graphics::Light(Graphics::Light::LIGHT_DIRECTIONAL, vector3f(0.f), Color::WHITE, Color::WHITE)));
 	}
 
+	UpdateOccluders();
+
 	//fade space background based on atmosphere thickness and light angle
 	float bgIntensity = 1.f;
 	if (camFrame->GetParent() && camFrame->GetParent()->IsRotFrame()) {
@@ -245,8 +448,8 @@ void Camera::Draw(const Body *excludeBody, ShipCockpit* cockpit)
 		m_renderer->SetLights(rendererLights.size(), &rendererLights[0]);
 	}
 
-	for (std::list<BodyAttrs>::iterator i = m_sortedBodies.begin(); i != m_sortedBodies.end(); ++i) {
-		BodyAttrs *attrs = &(*i);
+	for (const SortKey &key : m_sortedBodies) {
+		BodyAttrs *attrs = &m_bodyAttrs[key.index];
 
 		// explicitly exclude a single body if specified (eg player)
 		if (attrs->body == excludeBody)
@@ -275,30 +478,60 @@ void Camera::Draw(const Body *excludeBody, ShipCockpit* cockpit)
 		cockpit->RenderCockpit(m_renderer, this, camFrame);
 }
 
+void Camera::UpdateOccluders()
+{
+	PROFILE_SCOPED()
+
+	const Frame *root = Pi::game->GetSpace()->GetRootFrame();
+
+	m_occluders.clear();
+	for (const Body *b : Pi::game->GetSpace()->GetBodies()) {
+		if (!(b->IsType(Object::PLANET) || b->IsType(Object::STAR)))
+			continue;
+		Occluder o;
+		o.body = b;
+		o.pos = b->GetPositionRelTo(root);
+		o.radius = b->GetSystemBody()->GetRadius();
+		m_occluders.push_back(o);
+	}
+
+	m_lightPositions.clear();
+	for (const LightSource &light : m_lightSources)
+		m_lightPositions.push_back(light.GetBody() ? light.GetBody()->GetPositionRelTo(root) : vector3d(0.0));
+}
+
 void Camera::CalcShadows(const int lightNum, const Body *b, std::vector<Shadow> &shadowsOut) const {
 	// Set up data for eclipses. All bodies are assumed to be spheres.
 	const Body *lightBody = m_lightSources[lightNum].GetBody();
 	if (!lightBody)
 		return;
 
+	const Frame *root = Pi::game->GetSpace()->GetRootFrame();
+	const vector3d bPos = b->GetPositionRelTo(root);
+
 	const double lightRadius = lightBody->GetPhysRadius();
-	const vector3d bLightPos = lightBody->GetPositionRelTo(b);
-	const vector3d lightDir = bLightPos.Normalized();
+	const vector3d bLightPos = m_lightPositions[lightNum] - bPos;
+	const double lightDist = bLightPos.Length();
+	const vector3d lightDir = bLightPos / lightDist;
 
 	double bRadius;
 	if (b->IsType(Object::TERRAINBODY)) bRadius = b->GetSystemBody()->GetRadius();
 	else bRadius = b->GetPhysRadius();
 
+	// the occluders are gathered relative to the root frame, but shadow
+	// centres are used in the orientation of b's frame (TerrainBody::Render
+	// takes them from there to the camera), which for planets rotates
+	const matrix3x3d rootToBodyFrame = b->GetFrame()->GetOrientRelTo(root).Transpose();
+
 	// Look for eclipsing third bodies:
-	for (const Body *b2 : Pi::game->GetSpace()->GetBodies()) {
-		if ( b2 == b || b2 == lightBody || !(b2->IsType(Object::PLANET) || b2->IsType(Object::STAR)))
+	for (const Occluder &o : m_occluders) {
+		if (o.body == b || o.body == lightBody)
 			continue;
 
-		double b2Radius = b2->GetSystemBody()->GetRadius();
-		vector3d b2pos = b2->GetPositionRelTo(b);
+		const vector3d b2pos = o.pos - bPos;
 		const double perpDist = lightDir.Dot(b2pos);
 
-		if ( perpDist <= 0 || perpDist > bLightPos.Length())
+		if ( perpDist <= 0 || perpDist > lightDist)
 			// b2 isn't between b and lightBody; no eclipse
 			continue;
 
@@ -311,8 +544,8 @@ void Camera::CalcShadows(const int lightNum, const Body *b, std::vector<Shadow>
 		// normalised projected position p, the picture is of a disc of radius lrad being occulted by a
 		// disc of radius srad centred at projectedCentre-p. To determine the light intensity at p, we
 		// then just need to estimate the proportion of the light disc being occulted.
-		const double srad = b2Radius / bRadius;
-		const double lrad = (lightRadius/bLightPos.Length())*perpDist / bRadius;
+		const double srad = o.radius / bRadius;
+		const double lrad = (lightRadius/lightDist)*perpDist / bRadius;
 		if (srad / lrad < 0.01) {
 			// any eclipse would have negligible effect - ignore
 			continue;
@@ -320,7 +553,7 @@ void Camera::CalcShadows(const int lightNum, const Body *b, std::vector<Shadow>
 		const vector3d projectedCentre = ( b2pos - perpDist*lightDir ) / bRadius;
 		if (projectedCentre.Length() < 1 + srad + lrad) {
 			// some part of b is (partially) eclipsed
-			Camera::Shadow shadow = { projectedCentre, static_cast<float>(srad), static_cast<float>(lrad) };
+			Camera::Shadow shadow = { rootToBodyFrame * projectedCentre, static_cast<float>(srad), static_cast<float>(lrad) };
 			shadowsOut.push_back(shadow);
 		}
 	}
@@ -11,6 +11,9 @@
 #include "matrix4x4.h"
 #include "Background.h"
 #include "Body.h"
+#include "JobQueue.h"
+#include <memory>
+#include <unordered_map>
 
 class Frame;
 class ShipCockpit;
@@ -111,7 +114,7 @@ private:
 
 	std::unique_ptr<Graphics::Material> m_billboardMaterial;
 
-	// temp attrs for sorting and drawing
+	// temp attrs for drawing
 	struct BodyAttrs {
 		Body *body;
 
@@ -130,28 +133,40 @@ private:
 		vector3f billboardPos;
 		float billboardSize;
 		Color billboardColor;
+	};
 
-		// for sorting. "should a be drawn before b?"
-		friend bool operator<(const BodyAttrs &a, const BodyAttrs &b) {
-			// both drawing last; distance order
-			if (a.bodyFlags & Body::FLAG_DRAW_LAST && b.bodyFlags & Body::FLAG_DRAW_LAST)
-				return a.camDist > b.camDist;
+	// draw order. bodies drawing last go after everything else, and within
+	// each group the furthest is drawn first
+	struct SortKey {
+		Uint32 key;
+		Uint32 index;   // into m_bodyAttrs
+	};
 
-			// a drawing last; draw b first
-			if (a.bodyFlags & Body::FLAG_DRAW_LAST)
-				return false;
+	// the culling inputs and results for a frame, shared with the worker jobs
+	struct CullPass;
+	class CullJob;
 
-			// b drawing last; draw a first
-			if (b.bodyFlags & Body::FLAG_DRAW_LAST)
-				return true;
+	std::shared_ptr<CullPass> m_cullPass;
+	JobSet m_cullJobs;
 
-			// both in normal draw; distance order
-			return a.camDist > b.camDist;
-		}
-	};
+	// frame transforms are worked out once per frame, not once per body
+	std::unordered_map<const Frame*, Uint32> m_frameIndex;
 
-	std::list<BodyAttrs> m_sortedBodies;
+	std::vector<BodyAttrs> m_bodyAttrs;
+	std::vector<SortKey> m_sortedBodies;
+	std::vector<SortKey> m_sortScratch;
 	std::vector<LightSource> m_lightSources;
+
+	// planets and stars, the only things that can eclipse a light. gathered
+	// once per frame in Draw, with positions relative to the root frame
+	struct Occluder {
+		const Body *body;
+		vector3d pos;
+		double radius;
+	};
+	void UpdateOccluders();
+	std::vector<Occluder> m_occluders;
+	std::vector<vector3d> m_lightPositions; // root relative, one for each light source
 };
 
 #endif
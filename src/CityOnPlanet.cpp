@@ -174,6 +174,7 @@ void CityOnPlanet::LookupBuildingListModels(citybuildinglist_t *list)
 	{
 		std::set<std::string> filenames; // set so we get unique names
 		EnumerateNewBuildings(filenames);
+		Pi::modelCache->Preload(std::vector<std::string>(filenames.begin(), filenames.end()));
 		for(auto it = filenames.begin(), itEnd = filenames.end(); it != itEnd; ++it)
 		{
 			// find/load the model
@@ -220,6 +220,15 @@ void DynamicBody::TimeStepUpdate(const float timeStep)
 	ModelBody::TimeStepUpdate(timeStep);
 }
 
+void DynamicBody::CoastTimeStep(const float timeStep)
+{
+	m_oldPos = GetPosition();
+	m_oldAngDisplacement = vector3d(0.0);
+	m_lastForce = vector3d(0.0);
+	m_lastTorque = vector3d(0.0);
+	SetPosition(GetPosition() + m_vel * double(timeStep));
+}
+
 void DynamicBody::UpdateInterpTransform(double alpha)
 {
 	m_interpPos = alpha*GetPosition() + (1.0-alpha)*m_oldPos;
@@ -4,6 +4,7 @@
 #include "FileSourceZip.h"
 #include "utils.h"
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 
@@ -13,8 +14,11 @@ extern "C" {
 
 namespace FileSystem {
 
-FileSourceZip::FileSourceZip(FileSourceFS &fs, const std::string &zipPath) : FileSource(zipPath), m_archive(0)
+FileSourceZip::FileSourceZip(FileSourceFS &fs, const std::string &zipPath) : FileSource(zipPath), m_archive(0), m_fs(fs), m_prefetchedBytes(0)
 {
+	m_readerLock = SDL_CreateMutex();
+	m_prefetchLock = SDL_CreateMutex();
+
 	mz_zip_archive *zip = static_cast<mz_zip_archive*>(std::calloc(1, sizeof(mz_zip_archive)));
 	FILE *file = fs.OpenReadStream(zipPath);
 	if (!mz_zip_reader_init_file_stream(zip, file, 0)) {
@@ -41,13 +45,171 @@ FileSourceZip::FileSourceZip(FileSourceFS &fs, const std::string &zipPath) : Fil
 	}
 
 	m_archive = static_cast<void*>(zip);
+	m_readers.push_back(m_archive);
 }
 
 FileSourceZip::~FileSourceZip()
 {
+	// cancels anything still queued
+	m_prefetchJobs.clear();
+	m_prefetched.clear();
+
+	for (void *reader : m_readers) {
+		mz_zip_archive *zip = static_cast<mz_zip_archive*>(reader);
+		mz_zip_reader_end(zip);
+		std::free(zip);
+	}
+
+	SDL_DestroyMutex(m_prefetchLock);
+	SDL_DestroyMutex(m_readerLock);
+}
+
+void *FileSourceZip::AcquireReader()
+{
+	SDL_LockMutex(m_readerLock);
+	if (!m_readers.empty()) {
+		void *reader = m_readers.back();
+		m_readers.pop_back();
+		SDL_UnlockMutex(m_readerLock);
+		return reader;
+	}
+	SDL_UnlockMutex(m_readerLock);
+
+	// every reader is busy, so open another. this reads the central
+	// directory again, but that's cheap next to decompressing
+	mz_zip_archive *zip = static_cast<mz_zip_archive*>(std::calloc(1, sizeof(mz_zip_archive)));
+	FILE *file = m_fs.OpenReadStream(GetRoot());
+	if (!mz_zip_reader_init_file_stream(zip, file, 0)) {
+		Output("FileSourceZip: unable to reopen '%s'\n", GetRoot().c_str());
+		std::free(zip);
+		return 0;
+	}
+	return static_cast<void*>(zip);
+}
+
+void FileSourceZip::ReleaseReader(void *reader)
+{
+	SDL_LockMutex(m_readerLock);
+	m_readers.push_back(reader);
+	SDL_UnlockMutex(m_readerLock);
+}
+
+RefCountedPtr<FileData> FileSourceZip::Extract(const FileStat &st)
+{
+	mz_zip_archive *zip = static_cast<mz_zip_archive*>(AcquireReader());
+	if (!zip)
+		return RefCountedPtr<FileData>();
+
+	char *data = static_cast<char*>(std::malloc(st.size));
+	const bool ok = mz_zip_reader_extract_to_mem(zip, st.index, data, st.size, 0);
+	ReleaseReader(zip);
+
+	if (!ok) {
+		Output("FileSourceZip::ReadFile: couldn't extract '%s'\n", st.info.GetPath().c_str());
+		std::free(data);
+		return RefCountedPtr<FileData>();
+	}
+
+	return RefCountedPtr<FileData>(new FileDataMalloc(st.info, st.size, data));
+}
+
+class FileSourceZip::PrefetchJob : public Job {
+public:
+	PrefetchJob(FileSourceZip *zip) : m_zip(zip), m_cancelled(false) {}
+
+	void AddFile(const FileStat &st) { m_files.push_back(st); }
+	size_t GetNumFiles() const { return m_files.size(); }
+
+	virtual void OnRun() {
+		for (const FileStat &st : m_files) {
+			if (m_cancelled)
+				return;
+
+			// full up. files read since may have made room for later ones
+			SDL_LockMutex(m_zip->m_prefetchLock);
+			const bool full = m_zip->m_prefetchedBytes + st.size > PREFETCH_BUDGET;
+			SDL_UnlockMutex(m_zip->m_prefetchLock);
+			if (full)
+				continue;
+
+			RefCountedPtr<FileData> data = m_zip->Extract(st);
+			if (!data)
+				continue;
+			SDL_LockMutex(m_zip->m_prefetchLock);
+			if (m_zip->m_prefetched.insert(std::make_pair(st.index, data)).second)
+				m_zip->m_prefetchedBytes += st.size;
+			SDL_UnlockMutex(m_zip->m_prefetchLock);
+		}
+	}
+	virtual void OnFinish() {}
+	virtual void OnCancel() { m_cancelled = true; }
+
+private:
+	FileSourceZip *m_zip;
+	std::vector<FileStat> m_files;
+	std::atomic<bool> m_cancelled;
+};
+
+void FileSourceZip::Prefetch(const std::vector<std::string> &paths, JobQueue *jobs)
+{
+	assert(jobs);
 	if (!m_archive) return;
-	mz_zip_archive *zip = static_cast<mz_zip_archive*>(m_archive);
-	mz_zip_reader_end(zip);
+
+	// forget handles for jobs that have already finished
+	m_prefetchJobs.erase(
+		std::remove_if(m_prefetchJobs.begin(), m_prefetchJobs.end(), [](const Job::Handle &h) { return !h.HasJob(); }),
+		m_prefetchJobs.end());
+
+	// batch small files together so the per-job overhead doesn't dominate,
+	// but keep batches small enough that the work spreads over all threads
+	static const Uint64 BATCH_BYTES = 1024 * 1024;
+	static const size_t BATCH_FILES = 16;
+
+	// don't queue more than could be held
+	Uint64 queuedBytes = 0;
+
+	PrefetchJob *job = nullptr;
+	Uint64 batchBytes = 0;
+	for (const std::string &path : paths) {
+		const FileStat *st = FindFile(path);
+		if (!st || !st->info.IsFile())
+			continue;
+		if (queuedBytes + st->size > PREFETCH_BUDGET)
+			continue;
+		queuedBytes += st->size;
+
+		if (!job)
+			job = new PrefetchJob(this);
+		job->AddFile(*st);
+		batchBytes += st->size;
+
+		if (batchBytes >= BATCH_BYTES || job->GetNumFiles() >= BATCH_FILES) {
+			m_prefetchJobs.push_back(jobs->Queue(job));
+			job = nullptr;
+			batchBytes = 0;
+		}
+	}
+	if (job)
+		m_prefetchJobs.push_back(jobs->Queue(job));
+}
+
+void FileSourceZip::ClearPrefetched()
+{
+	// cancels anything still queued
+	m_prefetchJobs.clear();
+
+	SDL_LockMutex(m_prefetchLock);
+	m_prefetched.clear();
+	m_prefetchedBytes = 0;
+	SDL_UnlockMutex(m_prefetchLock);
+}
+
+size_t FileSourceZip::GetNumPrefetched()
+{
+	SDL_LockMutex(m_prefetchLock);
+	const size_t n = m_prefetched.size();
+	SDL_UnlockMutex(m_prefetchLock);
+	return n;
 }
 
 static void SplitPath(const std::string &path, std::vector<std::string> &output)
@@ -95,6 +257,9 @@ bool FileSourceZip::FindDirectoryAndFile(const std::string &path, const Director
 
 FileInfo FileSourceZip::Lookup(const std::string &path)
 {
+	if (NormalisePath(path).empty())
+		return MakeFileInfo(std::string(), m_archive ? FileInfo::FT_DIR : FileInfo::FT_NON_EXISTENT);
+
 	const Directory *dir;
 	std::string filename;
 	if (!FindDirectoryAndFile(path, dir, filename))
@@ -107,39 +272,55 @@ FileInfo FileSourceZip::Lookup(const std::string &path)
 	return (*i).second.info;
 }
 
-RefCountedPtr<FileData> FileSourceZip::ReadFile(const std::string &path)
+const FileSourceZip::FileStat *FileSourceZip::FindFile(const std::string &path)
 {
-	if (!m_archive) return RefCountedPtr<FileData>();
-	mz_zip_archive *zip = static_cast<mz_zip_archive*>(m_archive);
-
 	const Directory *dir;
 	std::string filename;
 	if (!FindDirectoryAndFile(path, dir, filename))
-		return RefCountedPtr<FileData>();
+		return nullptr;
 
 	std::map<std::string,FileStat>::const_iterator i = dir->files.find(filename);
 	if (i == dir->files.end())
-		return RefCountedPtr<FileData>();
+		return nullptr;
 
-	const FileStat &st = (*i).second;
+	return &(*i).second;
+}
 
-	char *data = static_cast<char*>(std::malloc(st.size));
-	if (!mz_zip_reader_extract_to_mem(zip, st.index, data, st.size, 0)) {
-		Output("FileSourceZip::ReadFile: couldn't extract '%s'\n", path.c_str());
+RefCountedPtr<FileData> FileSourceZip::ReadFile(const std::string &path)
+{
+	if (!m_archive) return RefCountedPtr<FileData>();
+
+	const FileStat *st = FindFile(path);
+	if (!st || !st->info.IsFile())
 		return RefCountedPtr<FileData>();
+
+	{
+		RefCountedPtr<FileData> data;
+		SDL_LockMutex(m_prefetchLock);
+		std::map<Uint32,RefCountedPtr<FileData> >::iterator i = m_prefetched.find(st->index);
+		if (i != m_prefetched.end()) {
+			data = (*i).second;
+			m_prefetched.erase(i);
+			m_prefetchedBytes -= st->size;
+		}
+		SDL_UnlockMutex(m_prefetchLock);
+		if (data)
+			return data;
 	}
 
-	return RefCountedPtr<FileData>(new FileDataMalloc(st.info, st.size, data));
+	return Extract(*st);
 }
 
 bool FileSourceZip::ReadDirectory(const std::string &path, std::vector<FileInfo> &output)
 {
-	const Directory *dir;
-	std::string filename;
-	if (!FindDirectoryAndFile(path, dir, filename))
-		return false;
+	const Directory *dir = &m_root;
+
+	// an empty path is the archive root
+	if (!NormalisePath(path).empty()) {
+		std::string filename;
+		if (!FindDirectoryAndFile(path, dir, filename))
+			return false;
 
-	{
 		std::map<std::string,Directory>::const_iterator i = dir->subdirs.find(filename);
 		if (i == dir->subdirs.end())
 			return false;
@@ -5,9 +5,11 @@
 #define _FILESOURCEZIP_H
 
 #include "FileSystem.h"
+#include "JobQueue.h"
 #include <SDL_stdinc.h>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace FileSystem {
 
@@ -22,7 +24,23 @@ public:
 	virtual RefCountedPtr<FileData> ReadFile(const std::string &path);
 	virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output);
 
+	// ReadFile may be called from any thread; each concurrent reader gets its
+	// own handle on the archive.
+	// Prefetch decompresses the given files on the job queue ahead of time.
+	// a prefetched file is handed out (and forgotten) by the next ReadFile for
+	// it; files not ready by then are simply extracted by the caller. no more
+	// than PREFETCH_BUDGET bytes are held at once, past that files are left
+	// for the caller too. ClearPrefetched cancels what's still queued and
+	// drops whatever nobody asked for
+	void Prefetch(const std::vector<std::string> &paths, JobQueue *jobs);
+	void ClearPrefetched();
+	size_t GetNumPrefetched();
+
+	static const Uint64 PREFETCH_BUDGET = 64 * 1024 * 1024;
+
 private:
+	class PrefetchJob;
+
 	void *m_archive;
 
 	struct FileStat {
@@ -39,8 +57,24 @@ private:
 
 	Directory m_root;
 
+	// pool of idle readers, including m_archive. readers are opened on
+	// demand when every existing one is busy
+	FileSourceFS &m_fs;
+	std::vector<void*> m_readers;
+	SDL_mutex *m_readerLock;
+
+	std::map<Uint32,RefCountedPtr<FileData> > m_prefetched;
+	Uint64 m_prefetchedBytes;
+	std::vector<Job::Handle> m_prefetchJobs;
+	SDL_mutex *m_prefetchLock;
+
 	bool FindDirectoryAndFile(const std::string &path, const Directory* &dir, std::string &filename);
+	const FileStat *FindFile(const std::string &path);
 	void AddFile(const std::string &path, const FileStat &fileStat);
+
+	void *AcquireReader();
+	void ReleaseReader(void *reader);
+	RefCountedPtr<FileData> Extract(const FileStat &st);
 };
 
 }
@@ -4,6 +4,7 @@
 #include "libs.h"
 #include "FileSystem.h"
 #include "StringRange.h"
+#include "utils.h"
 #include <cassert>
 #include <sstream>
 #include <algorithm>
@@ -121,8 +122,11 @@ namespace FileSystem {
 
 	void Init()
 	{
-		gameDataFiles.AppendSource(&dataFilesUser);
+		// the user's data dir is written to while the game runs (compiled
+		// models, for one), the installed data isn't
+		gameDataFiles.AppendSource(&dataFilesUser, true);
 		gameDataFiles.AppendSource(&dataFilesApp);
+		gameDataFiles.BuildIndex();
 	}
 
 	void Uninit()
@@ -155,31 +159,111 @@ namespace FileSystem {
 		return MakeFileInfo(path, fileType, Time::DateTime());
 	}
 
-	FileSourceUnion::FileSourceUnion(): FileSource(":union:") {}
+	FileSourceUnion::FileSourceUnion(): FileSource(":union:"), m_indexed(false) {}
 	FileSourceUnion::~FileSourceUnion() {}
 
-	void FileSourceUnion::PrependSource(FileSource *fs)
+	void FileSourceUnion::PrependSource(FileSource *fs, bool live)
 	{
 		assert(fs);
 		RemoveSource(fs);
 		m_sources.insert(m_sources.begin(), fs);
+		if (live) m_liveSources.insert(m_liveSources.begin(), fs);
+		DropIndex();
 	}
 
-	void FileSourceUnion::AppendSource(FileSource *fs)
+	void FileSourceUnion::AppendSource(FileSource *fs, bool live)
 	{
 		assert(fs);
 		RemoveSource(fs);
 		m_sources.push_back(fs);
+		if (live) m_liveSources.push_back(fs);
+		DropIndex();
 	}
 
 	void FileSourceUnion::RemoveSource(FileSource *fs)
 	{
 		std::vector<FileSource*>::iterator nend = std::remove(m_sources.begin(), m_sources.end(), fs);
 		m_sources.erase(nend, m_sources.end());
+		m_liveSources.erase(std::remove(m_liveSources.begin(), m_liveSources.end(), fs), m_liveSources.end());
+		DropIndex();
+	}
+
+	// paths are case-insensitive on windows, and have to stay so when looked
+	// up through the index
+	static std::string IndexKey(const std::string &path)
+	{
+		std::string key = NormalisePath(path);
+#ifdef _WIN32
+		std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+#endif
+		return key;
+	}
+
+	void FileSourceUnion::BuildIndex()
+	{
+		PROFILE_SCOPED()
+		Profiler::Timer timer;
+		timer.Start();
+
+		m_index.clear();
+		m_indexed = false;
+
+		// sources are walked in priority order, so the first entry recorded
+		// for a path is the one Lookup would have found by searching
+		for (FileSource *fs : m_sources) {
+			const FileInfo root = fs->Lookup("");
+			if (root.IsDir()) {
+				m_index.insert(std::make_pair(std::string(), root));
+				IndexDirectory(fs, "");
+			}
+		}
+		m_indexed = true;
+
+		timer.Stop();
+		Output("FileSystem: indexed " SIZET_FMT " paths from " SIZET_FMT " sources in %lf milliseconds\n",
+			m_index.size(), m_sources.size(), timer.millicycles());
+	}
+
+	void FileSourceUnion::IndexDirectory(FileSource *fs, const std::string &path)
+	{
+		std::vector<FileInfo> entries;
+		fs->ReadDirectory(path, entries);
+		for (const FileInfo &info : entries) {
+			m_index.insert(std::make_pair(IndexKey(info.GetPath()), info));
+			// descend even if another source already claimed the directory,
+			// since this one may still hold files the others don't
+			if (info.IsDir())
+				IndexDirectory(fs, info.GetPath());
+		}
+	}
+
+	void FileSourceUnion::DropIndex()
+	{
+		m_index.clear();
+		m_indexed = false;
+	}
+
+	// a path the index doesn't have may have been created since it was built,
+	// in a live source. the others can't have changed, so aren't searched
+	// again. the index isn't changed, it's read from job threads without a
+	// lock
+	FileInfo FileSourceUnion::LookupLive(const std::string &path)
+	{
+		for (FileSource *fs : m_liveSources) {
+			FileInfo info = fs->Lookup(path);
+			if (info.Exists()) { return info; }
+		}
+		return MakeFileInfo(path, FileInfo::FT_NON_EXISTENT);
 	}
 
 	FileInfo FileSourceUnion::Lookup(const std::string &path)
 	{
+		if (m_indexed) {
+			auto it = m_index.find(IndexKey(path));
+			if (it != m_index.end()) { return it->second; }
+			return LookupLive(path);
+		}
+
 		for (std::vector<FileSource*>::const_iterator
 			it = m_sources.begin(); it != m_sources.end(); ++it)
 		{
@@ -191,6 +275,19 @@ namespace FileSystem {
 
 	RefCountedPtr<FileData> FileSourceUnion::ReadFile(const std::string &path)
 	{
+		if (m_indexed) {
+			auto it = m_index.find(IndexKey(path));
+			if (it == m_index.end()) {
+				const FileInfo info = LookupLive(path);
+				if (info.IsFile()) { return info.Read(); }
+				return RefCountedPtr<FileData>();
+			}
+			if (!it->second.IsFile()) { return RefCountedPtr<FileData>(); }
+			RefCountedPtr<FileData> data = it->second.Read();
+			if (data) { return data; }
+			// deleted since it was indexed, so search as if there were no index
+		}
+
 		for (std::vector<FileSource*>::const_iterator
 			it = m_sources.begin(); it != m_sources.end(); ++it)
 		{
@@ -12,6 +12,7 @@
 #include <vector>
 #include <deque>
 #include <memory>
+#include <unordered_map>
 
 /*
  * Functionality:
@@ -155,6 +156,18 @@ namespace FileSystem {
 		virtual ~FileDataMalloc() { std::free(m_data); }
 	};
 
+	// copy-on-write view of a file mapped into memory. FileSourceFS hands
+	// these out for files of at least MMAP_THRESHOLD bytes, which saves
+	// copying large models and textures through a malloc'd buffer
+	class FileDataMmap : public FileData {
+	public:
+		enum { MMAP_THRESHOLD = 64 * 1024 };
+
+		FileDataMmap(const FileInfo &info, size_t size, char *data):
+			FileData(info, size, data) {}
+		virtual ~FileDataMmap();
+	};
+
 	class FileSource {
 	public:
 		explicit FileSource(const std::string &root, bool trusted = false): m_root(root), m_trusted(trusted) {}
@@ -187,6 +200,8 @@ namespace FileSystem {
 		virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output);
 
 		bool MakeDirectory(const std::string &path);
+		// removes a file or an empty directory
+		bool RemoveFile(const std::string &path);
 
 		enum WriteFlags {
 			WRITE_TEXT = 1
@@ -205,17 +220,36 @@ namespace FileSystem {
 
 		// add and remove sources
 		// note: order is important. The array of sources works like a PATH array:
-		// that is, earlier sources take priority over later sources
-		void PrependSource(FileSource *fs);
-		void AppendSource(FileSource *fs);
+		// that is, earlier sources take priority over later sources.
+		// live sources are ones whose contents may change after the index is
+		// built, such as the user's data dir
+		void PrependSource(FileSource *fs, bool live = false);
+		void AppendSource(FileSource *fs, bool live = false);
 		void RemoveSource(FileSource *fs);
 
 		virtual FileInfo Lookup(const std::string &path);
 		virtual RefCountedPtr<FileData> ReadFile(const std::string &path);
 		virtual bool ReadDirectory(const std::string &path, std::vector<FileInfo> &output);
 
+		// walk every source once and record, for each path, the entry from the
+		// source that wins. while the index is valid Lookup and ReadFile are a
+		// single hash probe rather than a search through every source.
+		// changing the source list drops the index. paths the index doesn't
+		// have are looked for in the live sources only, so files created
+		// there after it was built are still found
+		void BuildIndex();
+		void DropIndex();
+		bool IsIndexed() const { return m_indexed; }
+		size_t GetIndexSize() const { return m_index.size(); }
+
 	private:
+		void IndexDirectory(FileSource *fs, const std::string &path);
+		FileInfo LookupLive(const std::string &path);
+
 		std::vector<FileSource*> m_sources;
+		std::vector<FileSource*> m_liveSources;
+		std::unordered_map<std::string, FileInfo> m_index;
+		bool m_indexed;
 	};
 
 	class FileEnumerator {
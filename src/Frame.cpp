@@ -99,6 +99,7 @@ void Frame::PostUnserializeFixup(Frame *f, Space *space)
 {
 	f->UpdateRootRelativeVars();
 	f->m_astroBody = space->GetBodyByIndex(f->m_astroBodyIndex);
+	f->m_aiObstacle.valid = false;
 	for (Frame* kid : f->GetChildren())
 		PostUnserializeFixup(kid, space);
 }
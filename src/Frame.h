@@ -55,10 +55,24 @@ public:
 	const Frame *GetRotFrame() const { return HasRotFrame() ? m_children.front() : this; }
 	Frame *GetRotFrame() { return HasRotFrame() ? m_children.front() : this; }
 
-	void SetBodies(SystemBody *s, Body *b) { m_sbody = s; m_astroBody = b; }
+	void SetBodies(SystemBody *s, Body *b) { m_sbody = s; m_astroBody = b; m_aiObstacle.valid = false; }
 	SystemBody *GetSystemBody() const { return m_sbody; }
 	Body *GetBody() const { return m_astroBody; }
 
+	// what the AI needs to know about the frame's body to keep clear of it.
+	// it's the same for every ship, and doesn't change, so the AI works it
+	// out the first time it asks and keeps it here
+	struct AIObstacle {
+		AIObstacle() : valid(false) {}
+		bool valid;
+		Body *body;
+		bool terrain;
+		double featureRad;
+		double effectRad;
+		double gm;
+	};
+	AIObstacle &GetAIObstacle() const { return m_aiObstacle; }
+
 	void AddChild(Frame *f) { m_children.push_back(f); }
 	void RemoveChild(Frame *f);
 	bool HasChildren() const { return !m_children.empty(); }
@@ -125,6 +139,8 @@ private:
 	matrix3x3d m_rootInterpOrient;	// updated by UpdateInterpTransform
 
 	int m_astroBodyIndex; // deserialisation
+
+	mutable AIObstacle m_aiObstacle;
 };
 
 #endif /* _FRAME_H */
@@ -30,7 +30,7 @@ extern "C" {
 #include "miniz/miniz.h"
 }
 
-static const int  s_saveVersion   = 83;
+static const int  s_saveVersion   = 84;
 static const char s_saveStart[]   = "PIONEER";
 static const char s_saveEnd[]     = "END";
 
@@ -136,6 +136,7 @@ m_forceTimeAccel(false)
 
 	// Preparing the Lua stuff
 	Pi::luaSerializer->InitTableRefs();
+	Pi::luaSerializer->LoadStreamFromJson(jsonObj);
 
 	// galaxy generator
 	m_galaxy = Galaxy::LoadFromJson(jsonObj);
@@ -39,7 +39,12 @@ GameConfig::GameConfig(const std::map<std::string,std::string> &override_)
 	map["DefaultLowThrustPower"] = "0.25";
 	map["VSync"] = "1";
 	map["UseTextureCompression"] = "1";
+	map["TextureCache"] = "1";
+	map["SystemCache"] = "1";
+	map["Telemetry"] = "1";
+	map["TelemetryFrames"] = "3600";
 	map["WorkerThreads"] = "0";
+	map["AITrafficLODDistance"] = "200000"; // km, 0 to simulate all ships fully
 	map["SpeedLines"] = "0";
 	map["EnableCockpit"] = "0";
 	map["HudTrails"] = "0";
@@ -3,6 +3,7 @@
 
 #include "JobQueue.h"
 #include "StringF.h"
+#include "Telemetry.h"
 
 void Job::UnlinkHandle()
 {
@@ -143,6 +144,7 @@ AsyncJobQueue::~AsyncJobQueue()
 Job::Handle AsyncJobQueue::Queue(Job *job, JobClient *client)
 {
 	Job::Handle handle(job, this, client);
+	job->m_queuedAt = SDL_GetPerformanceCounter();
 
 	// push the job onto the queue
 	SDL_LockMutex(m_queueLock);
@@ -185,6 +187,14 @@ Job *AsyncJobQueue::GetJob()
 	return job;
 }
 
+Uint32 AsyncJobQueue::GetNumQueued()
+{
+	SDL_LockMutex(m_queueLock);
+	const Uint32 queued = m_queue.size();
+	SDL_UnlockMutex(m_queueLock);
+	return queued;
+}
+
 // called by the runner when a job completes
 void AsyncJobQueue::Finish(Job *job, const uint8_t threadIdx)
 {
@@ -322,6 +332,9 @@ void AsyncJobQueue::JobRunner::Main()
 		m_job = job;
 		SDL_UnlockMutex(m_jobLock);
 
+		Telemetry::Add(Telemetry::JOBS_STARTED);
+		Telemetry::AddTime(Telemetry::JOB_WAIT_TIME, SDL_GetPerformanceCounter() - job->m_queuedAt);
+
 		// run the thing
 		job->OnRun();
 
@@ -374,6 +387,7 @@ SyncJobQueue::~SyncJobQueue()
 Job::Handle SyncJobQueue::Queue(Job *job, JobClient *client)
 {
 	Job::Handle handle(job, this, client);
+	job->m_queuedAt = SDL_GetPerformanceCounter();
 	m_queue.push_back(job);
 	return handle;
 }
@@ -436,6 +450,8 @@ Uint32 SyncJobQueue::RunJobs(Uint32 count)
 
 		Job* job = m_queue.front();
 		m_queue.pop_front();
+		Telemetry::Add(Telemetry::JOBS_STARTED);
+		Telemetry::AddTime(Telemetry::JOB_WAIT_TIME, SDL_GetPerformanceCounter() - job->m_queuedAt);
 		job->OnRun();
 		executed++;
 		m_finished.push_back(job);
@@ -66,7 +66,7 @@ public:
 	};
 
 public:
-	Job() : cancelled(false), m_handle(nullptr) {}
+	Job() : cancelled(false), m_handle(nullptr), m_queuedAt(0) {}
 	virtual ~Job();
 
 	Job(const Job&) = delete;
@@ -88,6 +88,7 @@ private:
 
 	bool cancelled;
 	Handle* m_handle;
+	Uint64 m_queuedAt; // performance counter, for telemetry
 };
 
 
@@ -155,6 +156,9 @@ public:
 	// finished jobs (not cancelled)
 	virtual Uint32 FinishJobs() override;
 
+	// jobs waiting for a runner
+	Uint32 GetNumQueued();
+
 private:
 	// a runner wraps a single thread, and calls into the queue when its ready for
 	// a new job. no user-servicable parts inside!
@@ -225,6 +229,8 @@ public:
 
 	Uint32 RunJobs(Uint32 count = 1);
 
+	Uint32 GetNumQueued() const { return m_queue.size(); }
+
 private:
 	std::deque<Job*> m_queue;
 	std::deque<Job*> m_finished;
@@ -506,6 +506,24 @@ void LuaConstants::Register(lua_State *l)
 	 *   experimental
 	 */
 
+	/*
+	 * Constants: RouteMetric
+	 *
+	 * What a hyperspace route is planned to make the least of. See
+	 * <SystemPath.GetHyperspaceRoute>.
+	 *
+	 * DISTANCE - total distance travelled, which is near enough the least fuel
+	 * JUMPS    - number of jumps, then distance
+	 *
+	 * Availability:
+	 *
+	 *   alpha 33
+	 *
+	 * Status:
+	 *
+	 *   experimental
+	 */
+
 	// XXX document UI tables
 
 	LUA_DEBUG_END(l, 0);
@@ -6,6 +6,8 @@
 #include "Pi.h"
 #include "WorldView.h"
 #include "Game.h"
+#include "LuaTimer.h"
+#include "LuaSerializer.h"
 
 /*
  * Lua commands used in development & debugging
@@ -30,6 +32,117 @@ static int l_dev_set_camera_offset(lua_State *l)
 	return 0;
 }
 
+static int _bench_timer_callback(lua_State *l)
+{
+	return 0;
+}
+
+/*
+ * Time the timer scheduler with a large number of registered timers. Uses a
+ * private LuaTimer, so timers belonging to the running game are untouched.
+ *
+ * Dev.BenchmarkTimers(count)
+ */
+static int l_dev_benchmark_timers(lua_State *l)
+{
+	const int count = luaL_optinteger(l, 1, 10000);
+	if (count <= 0)
+		return luaL_error(l, "Dev.BenchmarkTimers requires a positive timer count");
+
+	lua_pushcfunction(l, _bench_timer_callback);
+	const LuaRef callback(l, -1);
+	lua_pop(l, 1);
+
+	LuaTimer timers;
+	Profiler::Timer timer;
+
+	// spread due times over the range, scrambled so they don't arrive in order
+	timer.Start();
+	for (int i = 0; i < count; i++)
+		timers.Insert(1.0 + double((i * 7919) % count), 0.0, callback);
+	timer.Stop();
+	Output("Dev.BenchmarkTimers: inserted %d timers in %lf milliseconds\n", count, timer.millicycles());
+
+	const int idleTicks = 1000;
+	timer.Reset();
+	timer.Start();
+	for (int i = 0; i < idleTicks; i++)
+		timers.Tick(0.5);
+	timer.Stop();
+	Output("Dev.BenchmarkTimers: %d idle ticks in %lf milliseconds\n", idleTicks, timer.millicycles());
+
+	timer.Reset();
+	timer.Start();
+	timers.Tick(double(count) + 1.0);
+	timer.Stop();
+	Output("Dev.BenchmarkTimers: fired %d timers in %lf milliseconds (%u left)\n",
+		count, timer.millicycles(), unsigned(timers.GetNumTimers()));
+
+	return 0;
+}
+
+/*
+ * Time pickling and unpickling a synthetic persistent table with the given
+ * number of entries. Each entry is a small table with repeated key strings
+ * and a reference to a shared table, like typical mission data.
+ *
+ * Dev.BenchmarkSerializer(count)
+ */
+static int l_dev_benchmark_serializer(lua_State *l)
+{
+	const int count = luaL_optinteger(l, 1, 100000);
+	if (count <= 0)
+		return luaL_error(l, "Dev.BenchmarkSerializer requires a positive entry count");
+
+	LUA_DEBUG_START(l);
+
+	lua_newtable(l);
+	const int shared = lua_gettop(l);
+	pi_lua_settable(l, "name", "shared");
+
+	lua_newtable(l);
+	const int data = lua_gettop(l);
+	char name[32];
+	for (int i = 1; i <= count; i++) {
+		lua_newtable(l);
+		snprintf(name, sizeof(name), "item%d", i % 100);
+		pi_lua_settable(l, "name", name);
+		pi_lua_settable(l, "value", i * 0.25);
+		pi_lua_settable(l, "count", i);
+		pi_lua_settable(l, "flag", (i % 2) == 0);
+		lua_pushvalue(l, shared);
+		lua_setfield(l, -2, "shared");
+		lua_rawseti(l, data, i);
+	}
+
+	LuaSerializer serializer;
+	Profiler::Timer timer;
+
+	serializer.InitTableRefs();
+	timer.Start();
+	const Uint32 offset = serializer.PickleToStream(l, data);
+	timer.Stop();
+	Output("Dev.BenchmarkSerializer: pickled %d entries to " SIZET_FMT " bytes in %lf milliseconds\n",
+		count, serializer.GetStreamSize(), timer.millicycles());
+
+	// table ids are shared across the save, so reset them for the load side
+	lua_newtable(l);
+	lua_setfield(l, LUA_REGISTRYINDEX, "PiSerializerTableRefs");
+
+	timer.Reset();
+	timer.Start();
+	serializer.UnpickleFromStream(l, offset);
+	timer.Stop();
+	Output("Dev.BenchmarkSerializer: unpickled %d entries in %lf milliseconds\n", count, timer.millicycles());
+	serializer.UninitTableRefs();
+
+	lua_pop(l, 3);
+
+	LUA_DEBUG_END(l, 0);
+
+	return 0;
+}
+
 void LuaDev::Register()
 {
 	lua_State *l = Lua::manager->GetLuaState();
@@ -38,6 +151,8 @@ void LuaDev::Register()
 
 	static const luaL_Reg methods[]= {
 		{ "SetCameraOffset", l_dev_set_camera_offset },
+		{ "BenchmarkTimers", l_dev_benchmark_timers },
+		{ "BenchmarkSerializer", l_dev_benchmark_serializer },
 		{ 0, 0 }
 	};
 
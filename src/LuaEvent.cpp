@@ -5,66 +5,313 @@
 #include "LuaEvent.h"
 #include "LuaManager.h"
 #include "LuaObject.h"
+#include "LuaRef.h"
 #include "LuaUtils.h"
+#include <deque>
 
 namespace LuaEvent {
 
-static bool _get_method_onto_stack(lua_State *l, const char *method) {
-	LUA_DEBUG_START(l);
+struct EventType {
+	EventType(const char *_name) : name(_name), listened(false), timed(false), queued(0), dispatched(0) {}
 
-	int top = lua_gettop(l);
+	std::string name;
+	std::vector<LuaRef> listeners;
+	// whether anything has ever registered for it. modules register as
+	// they're loaded, so events nothing wanted then are dropped unconverted
+	bool listened;
+	bool timed;
+	Uint64 queued;
+	Uint64 dispatched;
+};
 
-	if (!pi_lua_import(l, "Event"))
-		return false;
+struct PendingEvent {
+	int type;
+	int firstArg;
+	int numArgs;
+};
 
-	lua_getfield(l, -1, method);
-	if (!lua_isfunction(l, -1)) {
-		lua_pop(l, 2);
-		LUA_DEBUG_END(l, 0);
-		return false;
-	}
+struct NameLess {
+	bool operator()(const char *a, const char *b) const { return strcmp(a, b) < 0; }
+};
+
+// deque so that references (and the name strings used as index keys) stay
+// put as new event types are interned
+static std::deque<EventType> s_types;
+static std::map<const char *, int, NameLess> s_typeIndex;
+
+// event arguments are stored flattened in a single registry table that is
+// reused every step; s_numArgs is the number of slots currently in use
+static std::vector<PendingEvent> s_pending;
+static int s_numArgs = 0;
+static bool s_emitting = false;
+
+static const char ARGS_TABLE[] = "PiEventArgs";
 
-	lua_insert(l, top+1);
-	lua_settop(l, top+1);
+static int _intern(const char *name)
+{
+	auto it = s_typeIndex.find(name);
+	if (it != s_typeIndex.end())
+		return it->second;
 
-	LUA_DEBUG_END(l, 1);
+	const int type = int(s_types.size());
+	s_types.push_back(EventType(name));
+	s_typeIndex.insert(std::make_pair(s_types.back().name.c_str(), type));
+	return type;
+}
 
-	return true;
+static void _compact_listeners(EventType &et)
+{
+	et.listeners.erase(
+		std::remove_if(et.listeners.begin(), et.listeners.end(), [](const LuaRef &r) { return !r.IsValid(); }),
+		et.listeners.end());
 }
 
-void Clear()
+// move the top n values on the stack into the args table, returning the
+// index of the first one
+static int _store_args(lua_State *l, int n)
 {
-	lua_State *l = Lua::manager->GetLuaState();
+	LUA_DEBUG_START(l);
+
+	lua_getfield(l, LUA_REGISTRYINDEX, ARGS_TABLE);
+	lua_insert(l, -n-1);
+	const int first = s_numArgs + 1;
+	for (int i = n; i > 0; i--)
+		lua_rawseti(l, -i-1, first + i - 1);
+	lua_pop(l, 1);
+	s_numArgs += n;
+
+	LUA_DEBUG_END(l, -n);
+
+	return first;
+}
 
+static void _release_args(lua_State *l)
+{
 	LUA_DEBUG_START(l);
-	if (!_get_method_onto_stack(l, "_Clear")) return;
-	pi_lua_protected_call(l, 0, 0);
+
+	lua_getfield(l, LUA_REGISTRYINDEX, ARGS_TABLE);
+	for (int i = 1; i <= s_numArgs; i++) {
+		lua_pushnil(l);
+		lua_rawseti(l, -2, i);
+	}
+	lua_pop(l, 1);
+	s_numArgs = 0;
+
 	LUA_DEBUG_END(l, 0);
 }
 
+void Clear()
+{
+	s_pending.clear();
+	_release_args(Lua::manager->GetLuaState());
+}
+
 void Emit()
 {
+	if (s_pending.empty() || s_emitting)
+		return;
+
 	lua_State *l = Lua::manager->GetLuaState();
 
 	LUA_DEBUG_START(l);
-	if (!_get_method_onto_stack(l, "_Emit")) return;
-	pi_lua_protected_call(l, 0, 0);
+
+	s_emitting = true;
+
+	lua_getfield(l, LUA_REGISTRYINDEX, ARGS_TABLE);
+	const int argsTable = lua_gettop(l);
+
+	// handlers may queue more events. those are appended and dispatched in
+	// this same pass, so index rather than iterate
+	for (size_t i = 0; i < s_pending.size(); i++) {
+		const PendingEvent ev = s_pending[i];
+		EventType &et = s_types[ev.type];
+		++et.dispatched;
+
+		// listeners deregistered during dispatch are invalidated in place and
+		// only removed once we're done, so indices stay valid here
+		for (size_t j = 0; j < et.listeners.size(); j++) {
+			const LuaRef cb = et.listeners[j];
+			if (!cb.IsValid())
+				continue;
+
+			lua_checkstack(l, ev.numArgs + 2);
+			cb.PushCopyToStack();
+			for (int a = 0; a < ev.numArgs; a++)
+				lua_rawgeti(l, argsTable, ev.firstArg + a);
+
+			if (!et.timed)
+				pi_lua_protected_call(l, ev.numArgs, 0);
+			else {
+				lua_Debug ar;
+				lua_pushvalue(l, -ev.numArgs-1);
+				lua_getinfo(l, ">S", &ar);
+
+				const Uint32 start = SDL_GetTicks();
+				pi_lua_protected_call(l, ev.numArgs, 0);
+				Output("DEBUG: %s %ums %s:%d\n", et.name.c_str(), SDL_GetTicks() - start, ar.source, ar.linedefined);
+			}
+		}
+	}
+
+	lua_pop(l, 1);
+
+	for (EventType &et : s_types)
+		_compact_listeners(et);
+
+	s_pending.clear();
+	_release_args(l);
+
+	s_emitting = false;
+
 	LUA_DEBUG_END(l, 0);
 }
 
 void Queue(const char *event, const ArgsBase &args)
 {
+	const int type = _intern(event);
+	EventType &et = s_types[type];
+	++et.queued;
+	if (!et.listened)
+		return;
+
+	// converted now even if every listener has gone for the moment. one
+	// registered before the next Emit still gets it, and the objects may not
+	// be around to convert by then
 	lua_State *l = Lua::manager->GetLuaState();
 
 	LUA_DEBUG_START(l);
-	if (!_get_method_onto_stack(l, "Queue")) return;
 
-	int top = lua_gettop(l);
-    lua_pushstring(l, event);
+	const int top = lua_gettop(l);
 	args.PrepareStack();
-	pi_lua_protected_call(l, lua_gettop(l) - top, 0);
+	const int n = lua_gettop(l) - top;
+
+	PendingEvent ev;
+	ev.type = type;
+	ev.numArgs = n;
+	ev.firstArg = _store_args(l, n);
+	s_pending.push_back(ev);
+
+	LUA_DEBUG_END(l, 0);
+}
+
+/*
+ * Interface: Event
+ *
+ * Core event queue. The documented interface, including the list of events,
+ * is in data/libs/Event.lua.
+ */
+
+static int l_event_register(lua_State *l)
+{
+	const char *name = luaL_checkstring(l, 1);
+	luaL_checktype(l, 2, LUA_TFUNCTION);
+
+	EventType &et = s_types[_intern(name)];
+	const LuaRef cb(l, 2);
+	for (const LuaRef &r : et.listeners)
+		if (r.IsValid() && r == cb)
+			return 0;
+	et.listeners.push_back(cb);
+	et.listened = true;
+
+	return 0;
+}
+
+static int l_event_deregister(lua_State *l)
+{
+	const char *name = luaL_checkstring(l, 1);
+
+	auto it = s_typeIndex.find(name);
+	if (it == s_typeIndex.end())
+		return 0;
+
+	EventType &et = s_types[it->second];
+	const LuaRef cb(l, 2);
+	for (LuaRef &r : et.listeners)
+		if (r.IsValid() && r == cb)
+			r = LuaRef();
+
+	if (!s_emitting)
+		_compact_listeners(et);
+
+	return 0;
+}
+
+static int l_event_queue(lua_State *l)
+{
+	const char *name = luaL_checkstring(l, 1);
+
+	const int type = _intern(name);
+	EventType &et = s_types[type];
+	++et.queued;
+	if (!et.listened)
+		return 0;
+
+	const int n = lua_gettop(l) - 1;
+
+	PendingEvent ev;
+	ev.type = type;
+	ev.numArgs = n;
+	ev.firstArg = _store_args(l, n);
+	s_pending.push_back(ev);
+
+	return 0;
+}
+
+static int l_event_debug_timer(lua_State *l)
+{
+	const char *name = luaL_checkstring(l, 1);
+	s_types[_intern(name)].timed = lua_toboolean(l, 2);
+	return 0;
+}
+
+static int l_event_get_stats(lua_State *l)
+{
+	lua_newtable(l);
+	for (const EventType &et : s_types) {
+		lua_newtable(l);
+		pi_lua_settable(l, "queued", double(et.queued));
+		pi_lua_settable(l, "dispatched", double(et.dispatched));
+		pi_lua_settable(l, "listeners", int(et.listeners.size()));
+		lua_setfield(l, -2, et.name.c_str());
+	}
+	return 1;
+}
+
+void Register()
+{
+	lua_State *l = Lua::manager->GetLuaState();
+
+	LUA_DEBUG_START(l);
+
+	lua_newtable(l);
+	lua_setfield(l, LUA_REGISTRYINDEX, ARGS_TABLE);
+	s_pending.reserve(256);
+
+	static const luaL_Reg l_methods[] = {
+		{ "Register",   l_event_register    },
+		{ "Deregister", l_event_deregister  },
+		{ "Queue",      l_event_queue       },
+		{ "DebugTimer", l_event_debug_timer },
+		{ "GetStats",   l_event_get_stats   },
+		{ 0, 0 }
+	};
+
+	lua_getfield(l, LUA_REGISTRYINDEX, "CoreImports");
+	luaL_newlib(l, l_methods);
+	lua_setfield(l, -2, "Event");
+	lua_pop(l, 1);
 
 	LUA_DEBUG_END(l, 0);
 }
 
+void Uninit()
+{
+	// listeners hold references into the lua state, so must go before it does
+	s_pending.clear();
+	s_numArgs = 0;
+	s_typeIndex.clear();
+	s_types.clear();
+}
+
 }
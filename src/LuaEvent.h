@@ -70,6 +70,12 @@ namespace LuaEvent {
 		inline void PrepareStack() const {}
 	};
 
+	// events are interned by name. their arguments are converted for lua as
+	// they're queued and handed to whatever is registered when they're
+	// emitted. events nothing has ever registered for are dropped as queued
+	void Register();
+	void Uninit();
+
 	void Clear();
 	void Emit();
 
@@ -97,11 +97,9 @@ void LuaRef::SaveToJson(Json::Value &jsonObj)
 		return;
 	}
 
-	std::string out;
 	PushCopyToStack();
-	serializer->pickle(m_lua, -1, out);
+	jsonObj["lua_ref"] = serializer->PickleToStream(m_lua, -1);
 	lua_pop(m_lua, 1);
-	jsonObj["lua_ref"] = out;
 
 	LUA_DEBUG_END(m_lua, 0);
 }
@@ -112,7 +110,7 @@ void LuaRef::LoadFromJson(const Json::Value &jsonObj)
 
 	if (!jsonObj.isMember("lua_ref")) throw SavedGameCorruptException();
 
-	std::string pickled = jsonObj["lua_ref"].asString();
+	const Uint32 offset = jsonObj["lua_ref"].asUInt();
 
 	LUA_DEBUG_START(m_lua);
 
@@ -125,7 +123,7 @@ void LuaRef::LoadFromJson(const Json::Value &jsonObj)
 		return;
 	}
 
-	serializer->unpickle(m_lua, pickled.c_str()); // loaded
+	serializer->UnpickleFromStream(m_lua, offset); // loaded
 	lua_getfield(m_lua, LUA_REGISTRYINDEX, "PiLuaRefLoadTable"); // loaded, reftable
 	lua_pushvalue(m_lua, -2); // loaded, reftable, copy
 	lua_gettable(m_lua, -2);  // loaded, reftable, luaref
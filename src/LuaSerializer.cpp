@@ -28,21 +28,92 @@
 // down into tables. it can do userdata assuming the appropriate Lua wrapper
 // class has registered a serializer and deseriaizer
 //
-// pickle format is newline-seperated. each line begins with a type value,
-// followed by data for that type as follows
-//   fNNN.nnn - number (float)
-//   bN       - boolean. N is 0 or 1 for true/false
-//   sNNN     - string. number is length, followed by newline, then string of bytes
-//   t        - table. followed by a float (fNNN.nnn) uniquely identifying the
-//            - table, then more pickled stuff (ie recursive)
-//   n        - end of table
-//   r        - reference to previously-seen table. followed by the table id
-//   uXXXX    - userdata. XXXX is type, followed by newline, followed by data
-//                everything after u is passed down to LuaObject::Serialize to
-//                generate using per-class serializers
-//   oXXXX    - object. XXX is type, followed by newline, followed by one
-//              pickled item (typically t[able])
+// pickle format is binary. each item begins with a one byte tag, followed by
+// data for that type as follows. "varint" is an unsigned LEB128 integer
+//   PICKLE_NIL      - nil
+//   PICKLE_FALSE    - boolean false
+//   PICKLE_TRUE     - boolean true
+//   PICKLE_INT      - number with an integral value that fits in 32 bits.
+//                     zigzag encoded varint
+//   PICKLE_NUMBER   - any other number. 8 byte little-endian double
+//   PICKLE_STRING   - string. varint length, then the bytes. the string gets
+//                     the next index in the string table
+//   PICKLE_STRREF   - string seen before. varint string table index
+//   PICKLE_TABLE    - table. varint id uniquely identifying the table, then
+//                     key/value pairs (pickled items), then PICKLE_END
+//   PICKLE_TABLEREF - reference to previously-seen table. varint table id
+//   PICKLE_USERDATA - userdata. varint length, then that many bytes from
+//                     LuaObject::Serialize (type, newline, per-class data)
+//   PICKLE_OBJECT   - object. class name (a pickled string), followed by one
+//                     pickled item (typically a table)
+//
+// the string table starts empty for every pickle() call. table ids count up
+// from zero between InitTableRefs() and UninitTableRefs(), so tables shared
+// between LuaRefs and module data are only written once per save.
+//
+// everything pickled during a save goes into a single stream that is stored
+// with the lua module data; LuaRef stores just its offset into it.
+
+enum PickleTag {
+	PICKLE_NIL = 0,
+	PICKLE_FALSE,
+	PICKLE_TRUE,
+	PICKLE_INT,
+	PICKLE_NUMBER,
+	PICKLE_STRING,
+	PICKLE_STRREF,
+	PICKLE_TABLE,
+	PICKLE_TABLEREF,
+	PICKLE_END,
+	PICKLE_USERDATA,
+	PICKLE_OBJECT
+};
+
+// strings longer than this are written out but not looked up in the string
+// table; they rarely repeat and hashing them isn't free
+static const size_t MAX_INTERNED_STRING = 64;
+
+static inline void write_varint(std::string &out, Uint32 v)
+{
+	while (v >= 0x80) {
+		out += char((v & 0x7f) | 0x80);
+		v >>= 7;
+	}
+	out += char(v);
+}
+
+static inline Uint32 read_varint(const char *&pos, const char *end)
+{
+	Uint32 v = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (pos >= end) throw SavedGameCorruptException();
+		const Uint8 b = Uint8(*pos++);
+		v |= Uint32(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return v;
+	}
+	throw SavedGameCorruptException();
+}
+
+static inline void write_double(std::string &out, double d)
+{
+	Uint64 bits;
+	memcpy(&bits, &d, sizeof(bits));
+	for (int i = 0; i < 8; i++)
+		out += char((bits >> (i * 8)) & 0xff);
+}
 
+static inline double read_double(const char *&pos, const char *end)
+{
+	if (end - pos < 8) throw SavedGameCorruptException();
+	Uint64 bits = 0;
+	for (int i = 0; i < 8; i++)
+		bits |= Uint64(Uint8(pos[i])) << (i * 8);
+	pos += 8;
+	double d;
+	memcpy(&d, &bits, sizeof(d));
+	return d;
+}
 
 // on serialize, if an item has a metatable with a "class" attribute, the
 // "Serialize" function under that namespace will be called with the type. the
@@ -54,8 +125,34 @@
 
 void LuaSerializer::pickle(lua_State *l, int to_serialize, std::string &out, const char *key)
 {
-	static char buf[256];
+	m_writeStrings.clear();
+	m_nextStringId = 0;
+	pickle_item(l, to_serialize, out, key);
+}
+
+void LuaSerializer::pickle_string(const char *str, size_t len, std::string &out)
+{
+	// every string written takes the next index, interned or not, so the
+	// reader can number them the same way without knowing the cutoff
+	const Uint32 id = m_nextStringId++;
+
+	if (len <= MAX_INTERNED_STRING) {
+		auto r = m_writeStrings.insert(std::make_pair(std::string(str, len), id));
+		if (!r.second) {
+			m_nextStringId--;
+			out += char(PICKLE_STRREF);
+			write_varint(out, r.first->second);
+			return;
+		}
+	}
+
+	out += char(PICKLE_STRING);
+	write_varint(out, Uint32(len));
+	out.append(str, len);
+}
 
+void LuaSerializer::pickle_item(lua_State *l, int to_serialize, std::string &out, const char *key)
+{
 	LUA_DEBUG_START(l);
 
 	// tables are pickled recursively, so we can run out of Lua stack space if we're not careful
@@ -73,8 +170,8 @@ void LuaSerializer::pickle(lua_State *l, int to_serialize, std::string &out, con
 			lua_pop(l, 2);
 
 		else {
-			const char *cl = lua_tostring(l, -1);
-			snprintf(buf, sizeof(buf), "o%s\n", cl);
+			size_t cllen;
+			const char *cl = lua_tolstring(l, -1, &cllen);
 
 			lua_getfield(l, LUA_REGISTRYINDEX, "PiSerializerClasses");
 
@@ -92,63 +189,72 @@ void LuaSerializer::pickle(lua_State *l, int to_serialize, std::string &out, con
 			idx = lua_gettop(l);
 
 			if (lua_isnil(l, idx)) {
+				// keep the stream well formed; the reader drops nil pairs
+				out += char(PICKLE_NIL);
 				lua_pop(l, 5);
 				LUA_DEBUG_END(l, 0);
 				return;
 			}
 
-			out += buf;
+			out += char(PICKLE_OBJECT);
+			pickle_string(cl, cllen, out);
 		}
 	}
 
 	switch (lua_type(l, idx)) {
 		case LUA_TNIL:
+			out += char(PICKLE_NIL);
 			break;
 
 		case LUA_TNUMBER: {
-			snprintf(buf, sizeof(buf), "f%f\n", lua_tonumber(l, idx));
-			out += buf;
+			const double n = lua_tonumber(l, idx);
+			const Sint32 i = Sint32(n);
+			if (n >= -2147483648.0 && n <= 2147483647.0 && double(i) == n) {
+				out += char(PICKLE_INT);
+				write_varint(out, (Uint32(i) << 1) ^ Uint32(i >> 31));
+			} else {
+				out += char(PICKLE_NUMBER);
+				write_double(out, n);
+			}
 			break;
 		}
 
 		case LUA_TBOOLEAN: {
-			snprintf(buf, sizeof(buf), "b%d", lua_toboolean(l, idx) ? 1 : 0);
-			out += buf;
+			out += char(lua_toboolean(l, idx) ? PICKLE_TRUE : PICKLE_FALSE);
 			break;
 		}
 
 		case LUA_TSTRING: {
-			lua_pushvalue(l, idx);
 			size_t len;
-			const char *str = lua_tolstring(l, -1, &len);
-			snprintf(buf, sizeof(buf), "s" SIZET_FMT "\n", len);
-			out += buf;
-			out.append(str, len);
-			lua_pop(l, 1);
+			const char *str = lua_tolstring(l, idx, &len);
+			pickle_string(str, len, out);
 			break;
 		}
 
 		case LUA_TTABLE: {
-			lua_pushinteger(l, lua_Integer(lua_topointer(l, to_serialize)));         // ptr
-
-			lua_getfield(l, LUA_REGISTRYINDEX, "PiSerializerTableRefs");    // ptr reftable
-			lua_pushvalue(l, -2);                                           // ptr reftable ptr
-			lua_rawget(l, -2);                                              // ptr reftable ???
+			// the ref table maps each table seen so far to its id. keying on
+			// the table itself also keeps it alive, so its address can't be
+			// reused by a temporary table later in the save
+			lua_getfield(l, LUA_REGISTRYINDEX, "PiSerializerTableRefs");   // reftable
+			lua_pushvalue(l, idx);                                         // reftable table
+			lua_rawget(l, -2);                                             // reftable id?
 
 			if (!lua_isnil(l, -1)) {
-				out += "r";
-				pickle(l, -3, out, key);
-				lua_pop(l, 3);                                              // [empty]
+				out += char(PICKLE_TABLEREF);
+				write_varint(out, Uint32(lua_tointeger(l, -1)));
+				lua_pop(l, 2);                                             // [empty]
 			}
 
 			else {
-				out += "t";
+				const Uint32 id = m_nextTableId++;
+				out += char(PICKLE_TABLE);
+				write_varint(out, id);
 
-				lua_pushvalue(l, -3);                                       // ptr reftable nil ptr
-				lua_pushvalue(l, to_serialize);                                      // ptr reftable nil ptr table
-				lua_rawset(l, -4);                                          // ptr reftable nil
-				pickle(l, -3, out, key);
-				lua_pop(l, 3);                                              // [empty]
+				lua_pop(l, 1);                                             // reftable
+				lua_pushvalue(l, idx);                                     // reftable table
+				lua_pushinteger(l, id);                                    // reftable table id
+				lua_rawset(l, -3);                                         // reftable
+				lua_pop(l, 1);                                             // [empty]
 
 				lua_pushvalue(l, idx);
 				lua_pushnil(l);
@@ -160,26 +266,27 @@ void LuaSerializer::pickle(lua_State *l, int to_serialize, std::string &out, con
 						lua_pop(l, 1);
 					}
 					// Copy the values to pickle, as they might be mutated by the pickling process.
-					pickle(l, -2, out, key);
-					pickle(l, -1, out, key);
+					pickle_item(l, -2, out, key);
+					pickle_item(l, -1, out, key);
 					lua_pop(l, 1);
 				}
 				lua_pop(l, 1);
-				out += "n";
+				out += char(PICKLE_END);
 			}
 
 			break;
 		}
 
 		case LUA_TUSERDATA: {
-			out += "u";
-
 			LuaObjectBase *lo = static_cast<LuaObjectBase*>(lua_touserdata(l, idx));
 			void *o = lo->GetObject();
 			if (!o)
 				Error("Lua serializer '%s' tried to serialize an invalid '%s' object", key, lo->GetType());
 
-			out += lo->Serialize();
+			const std::string data = lo->Serialize();
+			out += char(PICKLE_USERDATA);
+			write_varint(out, Uint32(data.size()));
+			out += data;
 			break;
 		}
 
@@ -194,7 +301,16 @@ void LuaSerializer::pickle(lua_State *l, int to_serialize, std::string &out, con
 	LUA_DEBUG_END(l, 0);
 }
 
-const char *LuaSerializer::unpickle(lua_State *l, const char *pos)
+const char *LuaSerializer::unpickle(lua_State *l, const char *pos, const char *end)
+{
+	m_readStrings.clear();
+	m_readPos = pos;
+	m_readEnd = end;
+	unpickle_item(l);
+	return m_readPos;
+}
+
+void LuaSerializer::unpickle_item(lua_State *l)
 {
 	LUA_DEBUG_START(l);
 
@@ -204,118 +320,144 @@ const char *LuaSerializer::unpickle(lua_State *l, const char *pos)
 	if (!lua_checkstack(l, 20))
 		luaL_error(l, "The Lua stack couldn't be extended (not enough memory?)");
 
-	char type = *pos++;
+	const char *&pos = m_readPos;
+	const char *end = m_readEnd;
+
+	if (pos >= end) throw SavedGameCorruptException();
+	const Uint8 type = Uint8(*pos++);
 
 	switch (type) {
 
-		case 'f': {
-			char *end;
-			double f = strtod(pos, &end);
-			if (pos == end) throw SavedGameCorruptException();
-			lua_pushnumber(l, f);
-			pos = end+1; // skip newline
+		case PICKLE_NIL:
+			lua_pushnil(l);
+			break;
+
+		case PICKLE_FALSE:
+		case PICKLE_TRUE:
+			lua_pushboolean(l, type == PICKLE_TRUE);
+			break;
+
+		case PICKLE_INT: {
+			const Uint32 z = read_varint(pos, end);
+			lua_pushnumber(l, double(Sint32((z >> 1) ^ (~(z & 1) + 1))));
 			break;
 		}
 
-		case 'b': {
-			if (*pos != '0' && *pos != '1') throw SavedGameCorruptException();
-			bool b = (*pos == '0') ? false : true;
-			lua_pushboolean(l, b);
-			pos++;
+		case PICKLE_NUMBER:
+			lua_pushnumber(l, read_double(pos, end));
+			break;
+
+		case PICKLE_STRING: {
+			const Uint32 len = read_varint(pos, end);
+			if (Uint32(end - pos) < len) throw SavedGameCorruptException();
+			lua_pushlstring(l, pos, len);
+			m_readStrings.push_back(std::make_pair(pos, size_t(len)));
+			pos += len;
 			break;
 		}
 
-		case 's': {
-			char *end;
-			int len = strtol(pos, const_cast<char**>(&end), 0);
-			if (pos == end) throw SavedGameCorruptException();
-			end++; // skip newline
-			lua_pushlstring(l, end, len);
-			pos = end + len;
+		case PICKLE_STRREF: {
+			const Uint32 n = read_varint(pos, end);
+			if (n >= m_readStrings.size()) throw SavedGameCorruptException();
+			lua_pushlstring(l, m_readStrings[n].first, m_readStrings[n].second);
 			break;
 		}
 
-		case 't': {
+		case PICKLE_TABLE: {
+			const Uint32 id = read_varint(pos, end);
+
 			lua_newtable(l);
 
 			lua_getfield(l, LUA_REGISTRYINDEX, "PiSerializerTableRefs");
-			pos = unpickle(l, pos);
-			lua_pushvalue(l, -3);
-			lua_rawset(l, -3);
+			lua_pushvalue(l, -2);
+			lua_rawseti(l, -2, id);
 			lua_pop(l, 1);
 
-			while (*pos != 'n') {
-				pos = unpickle(l, pos);
-				pos = unpickle(l, pos);
-				lua_rawset(l, -3);
+			while (true) {
+				if (pos >= end) throw SavedGameCorruptException();
+				if (Uint8(*pos) == PICKLE_END) {
+					pos++;
+					break;
+				}
+				unpickle_item(l);
+				unpickle_item(l);
+				// a class Serialize function that returned nil leaves a nil
+				// behind; drop the pair rather than erroring in rawset
+				if (lua_isnil(l, -2) || lua_isnil(l, -1))
+					lua_pop(l, 2);
+				else
+					lua_rawset(l, -3);
 			}
-			pos++;
 
 			break;
 		}
 
-		case 'r': {
-			pos = unpickle(l, pos);
+		case PICKLE_TABLEREF: {
+			const Uint32 id = read_varint(pos, end);
 
 			lua_getfield(l, LUA_REGISTRYINDEX, "PiSerializerTableRefs");
-			lua_pushvalue(l, -2);
-			lua_rawget(l, -2);
+			lua_rawgeti(l, -1, id);
+			lua_remove(l, -2);
 
 			if (lua_isnil(l, -1))
 				throw SavedGameCorruptException();
 
-			lua_insert(l, -3);
-			lua_pop(l, 2);
-
 			break;
 		}
 
-		case 'u': {
-			const char *end;
-			if (!LuaObjectBase::Deserialize(pos, &end))
+		case PICKLE_USERDATA: {
+			const Uint32 len = read_varint(pos, end);
+			if (Uint32(end - pos) < len) throw SavedGameCorruptException();
+
+			// per-class deserializers parse text and expect it to be terminated
+			const std::string data(pos, len);
+			const char *next;
+			if (!LuaObjectBase::Deserialize(data.c_str(), &next))
 				throw SavedGameCorruptException();
-			pos = end;
+			pos += len;
 			break;
 		}
 
-		case 'o': {
-			const char *end = strchr(pos, '\n');
-			if (!end) throw SavedGameCorruptException();
-			int len = end - pos;
-			end++; // skip newline
-
-			const char *cl = pos;
-
-			// unpickle the object, and insert it beneath the method table value
-			pos = unpickle(l, end);
+		case PICKLE_OBJECT: {
+			// class name, then the object itself
+			unpickle_item(l);
+			if (!lua_isstring(l, -1)) throw SavedGameCorruptException();
 
 			// If it is a reference, don't run the unserializer. It has either
 			// already been run, or the data is still building (cyclic
 			// references will do that to you.)
-			if (*end != 'r') {
-				// get PiSerializerClasses[typename]
-				lua_getfield(l, LUA_REGISTRYINDEX, "PiSerializerClasses");
-				lua_pushlstring(l, cl, len);
-				lua_gettable(l, -2);
-				lua_remove(l, -2);
+			if (pos >= end) throw SavedGameCorruptException();
+			const bool isRef = (Uint8(*pos) == PICKLE_TABLEREF);
 
-				if (lua_isnil(l, -1)) {
-					lua_pop(l, 2);
-					break;
-				}
+			unpickle_item(l);                                              // classname object
 
-				lua_getfield(l, -1, "Unserialize");
-				if (lua_isnil(l, -1)) {
-					lua_pushlstring(l, cl, len);
-					luaL_error(l, "No Unserialize method found for class '%s'\n", lua_tostring(l, -1));
-				}
+			if (isRef) {
+				lua_remove(l, -2);
+				break;
+			}
 
-				lua_insert(l, -3);
-				lua_pop(l, 1);
+			// get PiSerializerClasses[typename]
+			lua_getfield(l, LUA_REGISTRYINDEX, "PiSerializerClasses");    // classname object classes
+			lua_pushvalue(l, -3);
+			lua_rawget(l, -2);                                             // classname object classes class
+			lua_remove(l, -2);
 
-				pi_lua_protected_call(l, 1, 1);
+			if (lua_isnil(l, -1)) {
+				lua_pop(l, 1);
+				lua_remove(l, -2);
+				break;
 			}
 
+			lua_getfield(l, -1, "Unserialize");
+			if (lua_isnil(l, -1))
+				luaL_error(l, "No Unserialize method found for class '%s'\n", lua_tostring(l, -4));
+
+			lua_insert(l, -3);                                             // classname unserialize object class
+			lua_pop(l, 1);                                                 // classname unserialize object
+
+			pi_lua_protected_call(l, 1, 1);                                // classname result
+			lua_remove(l, -2);
+
 			break;
 		}
 
@@ -324,8 +466,20 @@ const char *LuaSerializer::unpickle(lua_State *l, const char *pos)
 	}
 
 	LUA_DEBUG_END(l, 1);
+}
 
-	return pos;
+Uint32 LuaSerializer::PickleToStream(lua_State *l, int idx)
+{
+	const Uint32 offset = Uint32(m_stream.size());
+	pickle(l, idx, m_stream);
+	return offset;
+}
+
+void LuaSerializer::UnpickleFromStream(lua_State *l, Uint32 offset)
+{
+	if (offset >= m_stream.size()) throw SavedGameCorruptException();
+	const char *start = m_stream.data();
+	unpickle(l, start + offset, start + m_stream.size());
 }
 
 void LuaSerializer::InitTableRefs() {
@@ -339,6 +493,9 @@ void LuaSerializer::InitTableRefs() {
 
 	lua_newtable(l);
 	lua_setfield(l, LUA_REGISTRYINDEX, "PiLuaRefLoadTable");
+
+	m_nextTableId = 0;
+	m_stream.clear();
 }
 
 void LuaSerializer::UninitTableRefs() {
@@ -352,6 +509,11 @@ void LuaSerializer::UninitTableRefs() {
 
 	lua_pushnil(l);
 	lua_setfield(l, LUA_REGISTRYINDEX, "PiLuaRefLoadTable");
+
+	m_stream.clear();
+	m_stream.shrink_to_fit();
+	m_writeStrings.clear();
+	m_readStrings.clear();
 }
 
 void LuaSerializer::ToJson(Json::Value &jsonObj)
@@ -385,29 +547,39 @@ void LuaSerializer::ToJson(Json::Value &jsonObj)
 
 	lua_pop(l, 1);
 
-	std::string pickled;
-	pickle(l, savetable, pickled);
+	// the stream already holds everything pickled for LuaRefs while the
+	// rest of the game was saved; the module table goes on the end
+	jsonObj["lua_modules_root"] = PickleToStream(l, savetable);
 
-	BinStrToJson(jsonObj, pickled, "lua_modules");
+	BinStrToJson(jsonObj, m_stream, "lua_modules");
 
 	lua_pop(l, 1);
 
 	LUA_DEBUG_END(l, 0);
 }
 
-void LuaSerializer::FromJson(const Json::Value &jsonObj)
+void LuaSerializer::LoadStreamFromJson(const Json::Value &jsonObj)
 {
+	PROFILE_SCOPED()
 	if (!jsonObj.isMember("lua_modules")) throw SavedGameCorruptException();
+	m_stream = JsonToBinStr(jsonObj, "lua_modules");
+}
+
+void LuaSerializer::FromJson(const Json::Value &jsonObj)
+{
+	PROFILE_SCOPED()
+	if (!jsonObj.isMember("lua_modules_root")) throw SavedGameCorruptException();
 
 	lua_State *l = Lua::manager->GetLuaState();
 
 	LUA_DEBUG_START(l);
 
-	std::string pickled = JsonToBinStr(jsonObj, "lua_modules");
-
-	const char *start = pickled.c_str();
-	const char *end = unpickle(l, start);
-	if (size_t(end - start) != pickled.length()) throw SavedGameCorruptException();
+	// the module table is the last thing in the stream
+	const Uint32 root = jsonObj["lua_modules_root"].asUInt();
+	if (root >= m_stream.size()) throw SavedGameCorruptException();
+	const char *start = m_stream.data();
+	const char *end = unpickle(l, start + root, start + m_stream.size());
+	if (end != start + m_stream.size()) throw SavedGameCorruptException();
 	if (!lua_istable(l, -1)) throw SavedGameCorruptException();
 	int savetable = lua_gettop(l);
 
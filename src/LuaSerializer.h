@@ -9,28 +9,58 @@
 #include "LuaRef.h"
 #include "DeleteEmitter.h"
 #include "Serializer.h"
+#include <unordered_map>
 
 class LuaSerializer : public DeleteEmitter {
 	friend class LuaObject<LuaSerializer>;
-	friend void LuaRef::SaveToJson(Json::Value &jsonObj);
-	friend void LuaRef::LoadFromJson(const Json::Value &jsonObj);
 
 public:
+	LuaSerializer() : m_nextStringId(0), m_nextTableId(0), m_readPos(0), m_readEnd(0) {}
+
 	void ToJson(Json::Value &jsonObj);
 	void FromJson(const Json::Value &jsonObj);
 
+	// load the pickle stream written by ToJson. must be called before
+	// anything that holds a LuaRef is loaded from the save
+	void LoadStreamFromJson(const Json::Value &jsonObj);
+
 	void WrLuaRef(LuaRef &ref, Serializer::Writer &wr);
 	void RdLuaRef(LuaRef &ref, Serializer::Reader &rd);
 
 	void InitTableRefs();
 	void UninitTableRefs();
 
+	// append a pickled value to the save stream, returning its offset
+	Uint32 PickleToStream(lua_State *l, int idx);
+	// push the value pickled at offset in the save stream
+	void UnpickleFromStream(lua_State *l, Uint32 offset);
+	size_t GetStreamSize() const { return m_stream.size(); }
+
 private:
 	static int l_register(lua_State *l);
 	static int l_register_class(lua_State *l);
 
-	static void pickle(lua_State *l, int idx, std::string &out, const char *key = 0);
-	static const char *unpickle(lua_State *l, const char *pos);
+	// pickle the value at idx onto the end of out. the string table is
+	// local to each call; table ids are shared by everything pickled between
+	// InitTableRefs() and UninitTableRefs()
+	void pickle(lua_State *l, int idx, std::string &out, const char *key = 0);
+	// unpickle one value from [pos,end) onto the stack, returning the
+	// position after it
+	const char *unpickle(lua_State *l, const char *pos, const char *end);
+
+	void pickle_item(lua_State *l, int idx, std::string &out, const char *key);
+	void unpickle_item(lua_State *l);
+	void pickle_string(const char *str, size_t len, std::string &out);
+
+	std::unordered_map<std::string, Uint32> m_writeStrings;
+	Uint32 m_nextStringId;
+	Uint32 m_nextTableId;
+
+	std::vector<std::pair<const char*, size_t>> m_readStrings;
+	const char *m_readPos;
+	const char *m_readEnd;
+
+	std::string m_stream;
 };
 
 #endif
@@ -3,6 +3,7 @@
 
 #include "LuaObject.h"
 #include "LuaUtils.h"
+#include "LuaConstants.h"
 #include "Pi.h"
 #include "Game.h"
 #include "galaxy/Galaxy.h"
@@ -10,6 +11,8 @@
 #include "galaxy/StarSystem.h"
 #include "galaxy/Sector.h"
 #include "galaxy/GalaxyCache.h"
+#include "galaxy/RoutePlanner.h"
+#include <cmath>
 
 /*
  * Class: SystemPath
@@ -313,6 +316,81 @@ static int l_sbodypath_distance_to(lua_State *l)
 	return 1;
 }
 
+/*
+ * Method: GetHyperspaceRoute
+ *
+ * Plan a route from this system to another, as a series of hyperspace jumps
+ *
+ * > route = path:GetHyperspaceRoute(system, range, metric)
+ *
+ * Parameters:
+ *
+ *   system - a <SystemPath> or <StarSystem> to plan the route to
+ *
+ *   range - the longest jump allowed, in light years. ranges over 100 are
+ *           planned as 100
+ *
+ *   metric - optional. a <Constants.RouteMetric> saying what to make the
+ *            least of. defaults to DISTANCE
+ *
+ * Return:
+ *
+ *   route - an array of <SystemPath>, starting with this system and ending
+ *           with the destination, or nil if there's no route
+ *
+ * Availability:
+ *
+ *   alpha 33
+ *
+ * Status:
+ *
+ *   experimental
+ */
+static int l_sbodypath_get_hyperspace_route(lua_State *l)
+{
+	PROFILE_SCOPED()
+	LUA_DEBUG_START(l);
+
+	const SystemPath *loc1 = LuaObject<SystemPath>::CheckFromLua(1);
+
+	const SystemPath *loc2 = LuaObject<SystemPath>::GetFromLua(2);
+	if (!loc2) {
+		StarSystem *s2 = LuaObject<StarSystem>::CheckFromLua(2);
+		loc2 = &(s2->GetPath());
+		assert(loc2->HasValidSystem());
+	}
+
+	const double range = luaL_checknumber(l, 3);
+	if (!std::isfinite(range))
+		return luaL_error(l, "SystemPath:GetHyperspaceRoute() range must be a finite number");
+
+	RoutePlanner::Metric metric = RoutePlanner::METRIC_DISTANCE;
+	if (!lua_isnoneornil(l, 4))
+		metric = static_cast<RoutePlanner::Metric>(LuaConstants::GetConstantFromArg(l, "RouteMetric", 4));
+
+	if (!loc1->HasValidSystem())
+		return luaL_error(l, "SystemPath:GetHyperspaceRoute() self argument does not refer to a system");
+	if (!loc2->HasValidSystem())
+		return luaL_error(l, "SystemPath:GetHyperspaceRoute() argument #1 does not refer to a system");
+
+	std::vector<SystemPath> route;
+	if (!Pi::game->GetGalaxy()->GetRoutePlanner()->Plan(loc1->SystemOnly(), loc2->SystemOnly(), float(range), metric, route)) {
+		lua_pushnil(l);
+		LUA_DEBUG_END(l, 1);
+		return 1;
+	}
+
+	lua_createtable(l, route.size(), 0);
+	for (size_t i = 0; i < route.size(); i++) {
+		lua_pushinteger(l, i+1);
+		LuaObject<SystemPath>::PushToLua(route[i]);
+		lua_rawset(l, -3);
+	}
+
+	LUA_DEBUG_END(l, 1);
+	return 1;
+}
+
 /*
  * Method: GetStarSystem
  *
@@ -575,6 +653,7 @@ template <> void LuaObject<SystemPath>::RegisterClass()
 		{ "SectorOnly", l_sbodypath_sector_only },
 
 		{ "DistanceTo", l_sbodypath_distance_to },
+		{ "GetHyperspaceRoute", l_sbodypath_get_hyperspace_route },
 
 		{ "GetStarSystem", l_sbodypath_get_star_system },
 		{ "GetSystemBody", l_sbodypath_get_system_body },
@@ -5,12 +5,43 @@
 #define _LUATIMER_H
 
 #include "LuaManager.h"
+#include "LuaRef.h"
 #include "DeleteEmitter.h"
+#include <vector>
 
 class LuaTimer : public DeleteEmitter {
 public:
+	LuaTimer() : m_nextSeq(0) {}
+
 	void Tick();
+	void Tick(double now);
 	void RemoveAll();
+
+	// schedule callback to run at game time 'at'. if every > 0 the timer is
+	// rescheduled after each call until the callback returns true
+	void Insert(double at, double every, const LuaRef &callback);
+
+	size_t GetNumTimers() const { return m_timers.size(); }
+
+private:
+	struct Timer {
+		double at;
+		double every;
+		Uint64 seq;
+		LuaRef callback;
+	};
+
+	// std heap functions build a max-heap, so this puts the earliest timer
+	// at the front. ties are broken by creation order so timers due at the
+	// same time fire in the order they were requested
+	struct TimerLater {
+		bool operator()(const Timer &a, const Timer &b) const {
+			return a.at > b.at || (a.at == b.at && a.seq > b.seq);
+		}
+	};
+
+	std::vector<Timer> m_timers;
+	Uint64 m_nextSeq;
 };
 
 #endif
@@ -6,6 +6,8 @@
 #include "FileSourceZip.h"
 #include "utils.h"
 
+static std::vector<FileSystem::FileSourceZip*> s_mods;
+
 void ModManager::Init() {
 	FileSystem::userFiles.MakeDirectory("mods");
 
@@ -14,7 +16,38 @@ void ModManager::Init() {
 		const std::string &zipPath = info.GetPath();
 		if (ends_with_ci(zipPath, ".zip")) {
 			Output("adding mod: %s\n", zipPath.c_str());
-			FileSystem::gameDataFiles.PrependSource(new FileSystem::FileSourceZip(FileSystem::userFiles, zipPath));
+			FileSystem::FileSourceZip *zip = new FileSystem::FileSourceZip(FileSystem::userFiles, zipPath);
+			FileSystem::gameDataFiles.PrependSource(zip);
+			s_mods.push_back(zip);
 		}
 	}
+
+	// adding sources drops the index built by FileSystem::Init
+	if (!FileSystem::gameDataFiles.IsIndexed())
+		FileSystem::gameDataFiles.BuildIndex();
+}
+
+void ModManager::Prefetch(JobQueue *jobs) {
+	static const char *dirs[] = { "models", "textures" };
+
+	for (FileSystem::FileSourceZip *zip : s_mods) {
+		std::vector<std::string> paths;
+		for (const char *dir : dirs) {
+			for (FileSystem::FileEnumerator files(*zip, dir, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
+				paths.push_back(files.Current().GetPath());
+		}
+		if (!paths.empty()) {
+			Output("prefetching " SIZET_FMT " files from mod: %s\n", paths.size(), zip->GetRoot().c_str());
+			zip->Prefetch(paths, jobs);
+		}
+	}
+}
+
+void ModManager::ClearPrefetched() {
+	for (FileSystem::FileSourceZip *zip : s_mods) {
+		const size_t unused = zip->GetNumPrefetched();
+		if (unused)
+			Output("dropping " SIZET_FMT " prefetched files nothing read from mod: %s\n", unused, zip->GetRoot().c_str());
+		zip->ClearPrefetched();
+	}
 }
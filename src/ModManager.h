@@ -7,9 +7,18 @@
 // right now this is little more than a stub class to hook up zipfiles to the
 // virtual filesystem
 
+class JobQueue;
+
 class ModManager {
 public:
 	static void Init();
+
+	// start decompressing the models and textures from every mod on the job
+	// queue, so they're ready by the time the loaders ask for them
+	static void Prefetch(JobQueue *jobs);
+	// once startup loading is done, so nothing prefetched but never read
+	// is held for the rest of the run
+	static void ClearPrefetched();
 };
 
 #endif
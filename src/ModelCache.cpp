@@ -2,11 +2,75 @@
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
 #include "ModelCache.h"
+#include "FileSystem.h"
 #include "scenegraph/SceneGraph.h"
+#include "scenegraph/BinaryConverter.h"
+#include "graphics/TextureBuilder.h"
 #include "Shields.h"
+#include "utils.h"
 
-ModelCache::ModelCache(Graphics::Renderer *r)
+// reads everything a model needs from disk. runs on a job thread for
+// RequestModel, or inline for FindModel
+class ModelCache::LoadJob : public Job {
+public:
+	LoadJob(ModelCache *cache, const std::string &name, const ModelFiles &files, bool preloadTextures) :
+		m_cache(cache), m_name(name), m_files(files), m_preloadTextures(preloadTextures), m_sgmSize(0) {}
+
+	virtual void OnRun() {
+		PROFILE_SCOPED()
+		if (!m_files.sgmPath.empty()) {
+			m_sgmFile = FileSystem::gameDataFiles.ReadFile(m_files.sgmPath);
+			if (m_sgmFile && SceneGraph::BinaryConverter::IsCompressed(m_sgmFile->AsByteRange())) {
+				m_sgm = SceneGraph::BinaryConverter::Decompress(m_sgmFile->AsByteRange(), m_sgmSize);
+				// if it wouldn't inflate, BuildModel reads it as it is, to
+				// report the version it has
+				if (m_sgm) m_sgmFile.Reset();
+			}
+		}
+
+		if (!m_preloadTextures)
+			return;
+
+		// we don't know which textures the model wants until it's been
+		// built, but they almost always live next to it
+		std::vector<FileSystem::FileInfo> entries;
+		FileSystem::gameDataFiles.ReadDirectory(m_files.GetDir(), entries);
+		for (const FileSystem::FileInfo &info : entries) {
+			const std::string &path = info.GetPath();
+			if (info.IsFile() && (ends_with_ci(path, ".png") || ends_with_ci(path, ".dds"))) {
+				Graphics::TextureBuilder::Preload(path);
+				m_textures.push_back(path);
+			}
+		}
+	}
+
+	virtual void OnFinish() {
+		m_cache->FinishLoad(*this);
+	}
+
+	ModelCache *m_cache;
+	const std::string m_name;
+	const ModelFiles m_files;
+	const bool m_preloadTextures;
+
+	// the .sgm as read (usually mapped), or inflated if it's an old one
+	RefCountedPtr<FileSystem::FileData> m_sgmFile;
+	std::unique_ptr<char, FreeDeleter> m_sgm;
+	size_t m_sgmSize;
+	std::vector<std::string> m_textures;
+};
+
+std::string ModelCache::ModelFiles::GetDir() const
+{
+	const std::string &path = sgmPath.empty() ? modelPath : sgmPath;
+	const size_t slash = path.rfind('/');
+	return (slash == std::string::npos) ? std::string() : path.substr(0, slash);
+}
+
+ModelCache::ModelCache(Graphics::Renderer *r, JobQueue *jobs)
 : m_renderer(r)
+, m_jobs(jobs)
+, m_scanned(false)
 {
 
 }
@@ -16,15 +80,90 @@ ModelCache::~ModelCache()
 	Flush();
 }
 
+void ModelCache::ScanModelFiles()
+{
+	PROFILE_SCOPED()
+	m_files.clear();
+	for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, "models", FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
+		const FileSystem::FileInfo &info = files.Current();
+		if (!info.IsFile())
+			continue;
+
+		// first one found wins, as it does for the loaders
+		const std::string name = info.GetName();
+		if (ends_with_ci(name, ".sgm")) {
+			ModelFiles &mf = m_files[name.substr(0, name.size()-4)];
+			if (mf.sgmPath.empty()) mf.sgmPath = info.GetPath();
+		} else if (ends_with_ci(name, ".model")) {
+			ModelFiles &mf = m_files[name.substr(0, name.size()-6)];
+			if (mf.modelPath.empty()) mf.modelPath = info.GetPath();
+		}
+	}
+	m_scanned = true;
+}
+
+// scanned once. a miss is a miss until Flush, rather than a walk of the
+// whole of models/ every time something asks for a model that isn't there
+const ModelCache::ModelFiles *ModelCache::FindModelFiles(const std::string &name)
+{
+	if (!m_scanned)
+		ScanModelFiles();
+
+	auto it = m_files.find(name);
+	return (it == m_files.end()) ? nullptr : &it->second;
+}
+
+SceneGraph::Model *ModelCache::BuildModel(const std::string &name, LoadJob &job)
+{
+	PROFILE_SCOPED()
+	const std::string dir = job.m_files.GetDir();
+	SceneGraph::Model *m = nullptr;
+
+	if (job.m_sgm || job.m_sgmFile) {
+		const std::string &path = job.m_files.sgmPath;
+		const ByteRange data = job.m_sgm ? ByteRange(job.m_sgm.get(), job.m_sgmSize) : job.m_sgmFile->AsByteRange();
+		SceneGraph::BinaryConverter bc(m_renderer);
+		m = bc.LoadDecompressed(path.substr(path.rfind('/')+1), dir, data);
+	}
+
+	// no .sgm, or it was out of date
+	if (!m && !job.m_files.modelPath.empty()) {
+		const std::string &path = job.m_files.modelPath;
+		SceneGraph::Loader loader(m_renderer, false, false);
+		m = loader.LoadModel(name, path.substr(0, path.rfind('/')));
+	}
+
+	if (!m)
+		throw SceneGraph::LoadingError("File not found");
+
+	Shields::ReparentShieldNodes(m);
+	return m;
+}
+
 SceneGraph::Model *ModelCache::FindModel(const std::string &name)
 {
 	ModelMap::iterator it = m_models.find(name);
 
 	if (it == m_models.end()) {
+		// a job is already reading it, and is further along than we'd be
+		// starting again
+		if (m_pending.count(name)) {
+			WaitForPending(std::vector<std::string>(1, name));
+			it = m_models.find(name);
+			if (it != m_models.end())
+				return it->second;
+		}
+		if (m_failed.count(name))
+			throw ModelNotFoundException();
+
+		const ModelFiles *files = FindModelFiles(name);
+		if (!files)
+			throw ModelNotFoundException();
+
 		try {
-			SceneGraph::Loader loader(m_renderer);
-			SceneGraph::Model *m = loader.LoadModel(name);
-			Shields::ReparentShieldNodes(m);
+			LoadJob job(this, name, *files, false);
+			job.OnRun();
+			SceneGraph::Model *m = BuildModel(name, job);
 			m_models[name] = m;
 			return m;
 		} catch (SceneGraph::LoadingError &) {
@@ -34,8 +173,114 @@ SceneGraph::Model *ModelCache::FindModel(const std::string &name)
 	return it->second;
 }
 
+SceneGraph::Model *ModelCache::RequestModel(const std::string &name)
+{
+	ModelMap::iterator it = m_models.find(name);
+	if (it != m_models.end())
+		return it->second;
+
+	if (!m_jobs)
+		return FindModel(name);
+
+	if (m_failed.count(name))
+		throw ModelNotFoundException();
+	if (m_pending.count(name))
+		return nullptr;
+
+	const ModelFiles *files = FindModelFiles(name);
+	if (!files)
+		throw ModelNotFoundException();
+
+	// models often share a directory (buildings especially), so only the
+	// first job for a directory decodes its textures
+	const bool preloadTextures = m_textureDirs.insert(files->GetDir()).second;
+
+	m_pending.insert(std::make_pair(name, m_jobs->Queue(new LoadJob(this, name, *files, preloadTextures))));
+	return nullptr;
+}
+
+void ModelCache::FinishLoad(LoadJob &job)
+{
+	// the handle was unlinked before we were called, so this doesn't cancel anything
+	m_pending.erase(job.m_name);
+
+	if (!m_models.count(job.m_name)) {
+		try {
+			m_models[job.m_name] = BuildModel(job.m_name, job);
+		} catch (SceneGraph::LoadingError &) {
+			Output("ModelCache: could not load model: %s\n", job.m_name.c_str());
+			m_failed.insert(job.m_name);
+		}
+	}
+
+	// anything the model didn't use (or that was already in the renderer's
+	// texture cache) would otherwise sit in memory forever
+	Graphics::TextureBuilder::DropPreloaded(job.m_textures);
+	if (job.m_preloadTextures)
+		m_textureDirs.erase(job.m_files.GetDir());
+}
+
+void ModelCache::Preload(const std::vector<std::string> &names)
+{
+	PROFILE_SCOPED()
+	Profiler::Timer timer;
+	timer.Start();
+
+	std::vector<std::string> waiting;
+	for (const std::string &name : names) {
+		try {
+			if (!RequestModel(name))
+				waiting.push_back(name);
+		} catch (ModelNotFoundException &) {
+			Output("ModelCache: could not find model: %s\n", name.c_str());
+		}
+	}
+
+	WaitForPending(waiting);
+
+	timer.Stop();
+	Output("ModelCache: preloaded " SIZET_FMT " models (" SIZET_FMT " in parallel) in %lf milliseconds\n",
+		names.size(), waiting.size(), timer.millicycles());
+}
+
+void ModelCache::RequestModels(const std::vector<std::string> &names)
+{
+	for (const std::string &name : names) {
+		try {
+			RequestModel(name);
+		} catch (ModelNotFoundException &) {
+			Output("ModelCache: could not find model: %s\n", name.c_str());
+		}
+	}
+}
+
+void ModelCache::WaitForPending(const std::vector<std::string> &names)
+{
+	if (!m_jobs)
+		return;
+
+	while (true) {
+		m_jobs->FinishJobs();
+		bool done = true;
+		for (const std::string &name : names) {
+			if (m_pending.count(name)) { done = false; break; }
+		}
+		if (done) break;
+		SDL_Delay(1);
+	}
+}
+
 void ModelCache::Flush()
 {
+	// cancels any loads in progress
+	m_pending.clear();
+	m_failed.clear();
+	m_textureDirs.clear();
+
+	// pick up models written since (eg by the model compiler)
+	m_files.clear();
+	m_scanned = false;
+
 	for(ModelMap::iterator it = m_models.begin(); it != m_models.end(); ++it) {
 		delete it->second;
 	}
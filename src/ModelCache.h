@@ -8,6 +8,7 @@
  * Also it only deals in New Models
  */
 #include "libs.h"
+#include "JobQueue.h"
 #include <stdexcept>
 
 namespace Graphics { class Renderer; }
@@ -18,15 +19,59 @@ public:
 	struct ModelNotFoundException : public std::runtime_error {
 		ModelNotFoundException() : std::runtime_error("Could not find model") { }
 	};
-	ModelCache(Graphics::Renderer*);
+	// without a job queue everything is loaded synchronously
+	ModelCache(Graphics::Renderer*, JobQueue *jobs = nullptr);
 	~ModelCache();
 	SceneGraph::Model *FindModel(const std::string&);
+
+	// start loading a model in the background: the files are read, the .sgm
+	// inflated and the textures in its directory decoded on a job thread, then
+	// the model is built and uploaded on the main thread when the job queue is
+	// next finished. returns the model once it's ready, nullptr until then
+	// (callers should show a placeholder meanwhile), and throws
+	// ModelNotFoundException if it couldn't be loaded. FindModel on a model
+	// that's still on its way waits for it
+	SceneGraph::Model *RequestModel(const std::string&);
+	bool IsPending(const std::string &name) const { return m_pending.count(name) > 0; }
+
+	// load all of the named models in parallel and wait for them
+	void Preload(const std::vector<std::string> &names);
+	// start loading all of them, without waiting
+	void RequestModels(const std::vector<std::string> &names);
+
 	void Flush();
 
 private:
+	class LoadJob;
+
+	struct ModelFiles {
+		std::string sgmPath;
+		std::string modelPath;
+
+		// the directory the model (and usually its textures) lives in
+		std::string GetDir() const;
+	};
+
+	const ModelFiles *FindModelFiles(const std::string &name);
+	void ScanModelFiles();
+	SceneGraph::Model *BuildModel(const std::string &name, LoadJob &job);
+	void FinishLoad(LoadJob &job);
+	void WaitForPending(const std::vector<std::string> &names);
+
 	typedef std::map<std::string, SceneGraph::Model*> ModelMap;
 	ModelMap m_models;
 	Graphics::Renderer *m_renderer;
+	JobQueue *m_jobs;
+
+	// short model name -> where to find it under models/
+	std::map<std::string, ModelFiles> m_files;
+	bool m_scanned;
+
+	std::map<std::string, Job::Handle> m_pending;
+	// models whose background load failed
+	std::set<std::string> m_failed;
+	// directories a pending job is already decoding textures from
+	std::set<std::string> m_textureDirs;
 };
 
 #endif
@@ -926,6 +926,13 @@ void ModelViewer::SetModel(const std::string &filename)
 		m_model->GetRoot()->Accept(d);
 		AddLog(d.GetModelStatistics());
 
+		//what each ship or station using this model costs in game
+		{
+			std::unique_ptr<SceneGraph::Model> inst(m_model->MakeInstance());
+			AddLog(stringf("Memory per instance: %0 bytes (%1 nodes copied, the rest shared)",
+				Uint32(inst->GetInstanceMemoryUsage()), inst->GetNumInstanceNodes()));
+		}
+
 		// If we've got the tag_landing set then use it for an offset otherwise grab the AABB
 		const SceneGraph::MatrixTransform *mt = m_model->FindTagByName("tag_landing");
 		if (mt)
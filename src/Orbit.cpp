@@ -4,6 +4,7 @@
 #include "Orbit.h"
 #include "libs.h"
 #include "gameconsts.h"
+#include "Serializer.h"
 
 #ifdef _MSC_VER
 	#include "win32/WinMath.h"
@@ -354,3 +355,23 @@ Orbit Orbit::FromBodyState(const vector3d &pos, const vector3d &vel, double cent
 
 	return ret;
 }
+
+void Orbit::Save(Serializer::Writer &wr) const
+{
+	wr.Double(m_eccentricity);
+	wr.Double(m_semiMajorAxis);
+	wr.Double(m_orbitalPhaseAtStart);
+	wr.Double(m_velocityAreaPerSecond);
+	for (int i = 0; i < 9; i++)
+		wr.Double(m_orient[i]);
+}
+
+void Orbit::Load(Serializer::Reader &rd)
+{
+	m_eccentricity = rd.Double();
+	m_semiMajorAxis = rd.Double();
+	m_orbitalPhaseAtStart = rd.Double();
+	m_velocityAreaPerSecond = rd.Double();
+	for (int i = 0; i < 9; i++)
+		m_orient[i] = rd.Double();
+}
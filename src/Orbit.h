@@ -8,6 +8,8 @@
 #include "vector3.h"
 #include "matrix3x3.h"
 
+namespace Serializer { class Writer; class Reader; }
+
 class Orbit {
 public:
 	// utility functions for simple calculations
@@ -52,6 +54,10 @@ public:
 	double GetOrbitalPhaseAtStart() const { return m_orbitalPhaseAtStart; }
 	const matrix3x3d &GetPlane() const { return m_orient; }
 
+	// the whole orbit, exactly, for caching generated systems
+	void Save(Serializer::Writer &wr) const;
+	void Load(Serializer::Reader &rd);
+
 private:
 	double TrueAnomalyFromMeanAnomaly(double MeanAnomaly) const;
 	double MeanAnomalyFromTrueAnomaly(double trueAnomaly) const;
@@ -58,6 +58,8 @@
 #include "StringF.h"
 #include "SystemInfoView.h"
 #include "SystemView.h"
+#include "Telemetry.h"
+#include "TelemetryOverlay.h"
 #include "Tombstone.h"
 #include "UIView.h"
 #include "KeyBindings.h"
@@ -68,10 +70,12 @@
 #include "galaxy/StarSystem.h"
 #include "gameui/Lua.h"
 #include "graphics/opengl/RendererGL.h"
+#include "graphics/dummy/RendererDummy.h"
 #include "graphics/Graphics.h"
 #include "graphics/Light.h"
 #include "graphics/Renderer.h"
 #include "graphics/Stats.h"
+#include "graphics/TextureBuilder.h"
 #include "gui/Gui.h"
 #include "scenegraph/Model.h"
 #include "scenegraph/Lua.h"
@@ -113,6 +117,7 @@ LuaConsole *Pi::luaConsole;
 Game *Pi::game;
 Random Pi::rng;
 float Pi::frameTime;
+bool Pi::showTelemetry = false;
 #if WITH_DEVKEYS
 bool Pi::showDebugInfo = false;
 #endif
@@ -151,6 +156,28 @@ Sound::MusicPlayer Pi::musicPlayer;
 std::unique_ptr<AsyncJobQueue> Pi::asyncJobQueue;
 std::unique_ptr<SyncJobQueue> Pi::syncJobQueue;
 
+static std::unique_ptr<TelemetryOverlay> s_telemetryOverlay;
+
+// everything the telemetry has kept, as CSV and as JSON
+static void ExportTelemetry()
+{
+	if (!Telemetry::IsEnabled()) {
+		Output("telemetry is off, nothing to save\n");
+		return;
+	}
+
+	char buf[64];
+	const time_t t = time(0);
+	strftime(buf, sizeof(buf), "telemetry-%Y%m%d-%H%M%S", localtime(&t));
+	FileSystem::userFiles.MakeDirectory("telemetry");
+	const std::string path = FileSystem::JoinPathBelow("telemetry", buf);
+
+	if (Telemetry::Export(path + ".csv", Telemetry::FORMAT_CSV) && Telemetry::Export(path + ".json", Telemetry::FORMAT_JSON))
+		Output("saved %u frames of telemetry to %s.csv/.json\n", Telemetry::GetNumFrames(), path.c_str());
+	else
+		Output("couldn't save telemetry to %s\n", path.c_str());
+}
+
 // Leaving define in place in case of future rendering problems.
 #define USE_RTT 0
 
@@ -284,6 +311,7 @@ static void LuaInit()
 	LuaServerAgent::Register();
 	LuaGame::Register();
 	LuaComms::Register();
+	LuaEvent::Register();
 	LuaFormat::Register();
 	LuaSpace::Register();
 	LuaShipDef::Register();
@@ -311,6 +339,7 @@ static void LuaUninit() {
 	delete Pi::luaSerializer;
 	delete Pi::luaTimer;
 
+	LuaEvent::Uninit();
 	Lua::Uninit();
 }
 
@@ -391,7 +420,7 @@ void TestGPUJobsSupport()
 	}
 }
 
-void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
+void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui, bool headless)
 {
 #ifdef PIONEER_PROFILER
 	Profiler::reset();
@@ -438,7 +467,7 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	Pi::detail.cities = config->Int("DetailCities");
 
 	// Initialize SDL
-	Uint32 sdlInitFlags = SDL_INIT_VIDEO | SDL_INIT_JOYSTICK;
+	Uint32 sdlInitFlags = headless ? SDL_INIT_JOYSTICK : (SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
 #if defined(DEBUG) || defined(_DEBUG)
 	sdlInitFlags |= SDL_INIT_NOPARACHUTE;
 #endif
@@ -450,10 +479,11 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	Output("SDL Version %d.%d.%d\n", ver.major, ver.minor, ver.patch);
 
 	Graphics::RendererOGL::RegisterRenderer();
+	Graphics::RendererDummy::RegisterRenderer();
 
 	// Do rest of SDL video initialization and create Renderer
 	Graphics::Settings videoSettings = {};
-	videoSettings.rendererType = Graphics::RENDERER_OPENGL;
+	videoSettings.rendererType = headless ? Graphics::RENDERER_DUMMY : Graphics::RENDERER_OPENGL;
 	videoSettings.width = config->Int("ScrWidth");
 	videoSettings.height = config->Int("ScrHeight");
 	videoSettings.fullscreen = (config->Int("StartFullscreen") != 0);
@@ -467,6 +497,7 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	videoSettings.title = "Pioneer";
 
 	Pi::renderer = Graphics::Init(videoSettings);
+	Graphics::TextureBuilder::SetCacheEnabled(config->Int("TextureCache") != 0, videoSettings.useTextureCompression);
 
 	Pi::CreateRenderTarget(videoSettings.width, videoSettings.height);
 	Pi::rng.IncRefCount(); // so nothing tries to free it
@@ -490,6 +521,8 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 
 	EnumStrings::Init();
 
+	Telemetry::Init(config->Int("Telemetry") != 0, config->Int("TelemetryFrames"));
+
 	// get threads up
 	Uint32 numThreads = config->Int("WorkerThreads");
 	const int numCores = OS::GetNumCores();
@@ -497,7 +530,11 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	if (numThreads == 0) numThreads = std::max(Uint32(numCores) - 1, 1U);
 	asyncJobQueue.reset(new AsyncJobQueue(numThreads));
 	Output("started %d worker threads\n", numThreads);
+
+	Ship::SetCoarseDistance(config->Float("AITrafficLODDistance") * 1000.0);
 	syncJobQueue.reset(new SyncJobQueue);
+
+	ModManager::Prefetch(asyncJobQueue.get());
 	
 	Output("ShipType::Init()\n");
 	// XXX early, Lua init needs it
@@ -565,6 +602,7 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	draw_progress(gauge, label, 0.0f);
 
 	Output("GalaxyGenerator::Init()\n");
+	GalaxyGenerator::SetSystemCacheEnabled(config->Int("SystemCache") != 0);
 	if (config->HasEntry("GalaxyGenerator"))
 		GalaxyGenerator::Init(config->String("GalaxyGenerator"),
 			config->Int("GalaxyGeneratorVersion", GalaxyGenerator::LAST_VERSION));
@@ -578,7 +616,23 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	draw_progress(gauge, label, 0.2f);
 
 	Output("new ModelCache\n");
-	modelCache = new ModelCache(Pi::renderer);
+	modelCache = new ModelCache(Pi::renderer, asyncJobQueue.get());
+	{
+		// the intro shows every player ship, so load them all up front
+		// where they can be read and decoded in parallel
+		std::vector<std::string> models;
+		for (auto i : ShipType::player_ships)
+			models.push_back(ShipType::types[i].modelName);
+		modelCache->Preload(models);
+
+		// the rest turn up as traffic. they load in the background while
+		// the menus are up, so a ship arriving in game doesn't stall on one
+		std::vector<std::string> traffic;
+		for (const auto &t : ShipType::types)
+			if (std::find(models.begin(), models.end(), t.second.modelName) == models.end())
+				traffic.push_back(t.second.modelName);
+		modelCache->RequestModels(traffic);
+	}
 	draw_progress(gauge, label, 0.3f);
 
 	Output("Shields::Init\n");
@@ -624,6 +678,8 @@ void Pi::Init(const std::map<std::string,std::string> &options, bool no_gui)
 	}
 	draw_progress(gauge, label, 0.9f);
 
+	ModManager::ClearPrefetched();
+
 	OS::NotifyLoadEnd();
 	draw_progress(gauge, label, 1.0f);
 
@@ -769,6 +825,7 @@ void Pi::Quit()
 	Pi::ui.Reset(0);
 	LuaUninit();
 	Gui::Uninit();
+	s_telemetryOverlay.reset();
 	delete Pi::modelCache;
 	delete Pi::renderer;
 	delete Pi::config;
@@ -778,6 +835,7 @@ void Pi::Quit()
 	FileSystem::Uninit();
 	asyncJobQueue.reset();
 	syncJobQueue.reset();
+	Telemetry::Uninit();
 	exit(0);
 }
 
@@ -872,6 +930,12 @@ void Pi::HandleEvents()
 							write_screenshot(sd, buf);
 							break;
 						}
+						case SDLK_t: // telemetry overlay, or with shift save it
+							if (KeyState(SDLK_LSHIFT) || KeyState(SDLK_RSHIFT))
+								ExportTelemetry();
+							else
+								Pi::showTelemetry = !Pi::showTelemetry;
+							break;
 #if WITH_DEVKEYS
 						case SDLK_i: // Toggle Debug info
 							Pi::showDebugInfo = !Pi::showDebugInfo;
@@ -1203,6 +1267,9 @@ void Pi::Start()
 		last_time = SDL_GetTicks();
 
 		Pi::serverAgent->ProcessResponses();
+
+		// models loading in the background are built as they come in
+		asyncJobQueue->FinishJobs();
 	}
 
 	ui->DropAllLayers();
@@ -1297,7 +1364,11 @@ void Pi::MainLoop()
 					accumulator = 0.0;
 					break;
 				}
-				game->TimeStep(step);
+				{
+					Telemetry::ScopedTimer timer(Telemetry::PHYSICS_TIME);
+					game->TimeStep(step);
+				}
+				Telemetry::Add(Telemetry::PHYSICS_TICKS);
 				BaseSphere::UpdateAllBaseSphereDerivatives();
 
 				accumulator -= step;
@@ -1335,6 +1406,7 @@ void Pi::MainLoop()
 			}
 		}
 
+		const Uint64 renderStart = SDL_GetPerformanceCounter();
 		Pi::BeginRenderTarget();
 		Pi::renderer->SetViewport(0, 0, Graphics::GetScreenWidth(), Graphics::GetScreenHeight());
 		Pi::renderer->BeginFrame();
@@ -1407,9 +1479,18 @@ void Pi::MainLoop()
 		}
 #endif
 
+		if (Pi::showTelemetry && Telemetry::IsEnabled()) {
+			if (!s_telemetryOverlay)
+				s_telemetryOverlay.reset(new TelemetryOverlay);
+			Gui::Screen::EnterOrtho();
+			s_telemetryOverlay->Draw();
+			Gui::Screen::LeaveOrtho();
+		}
+
 		Pi::EndRenderTarget();
 		Pi::DrawRenderTarget();
 		Pi::renderer->SwapBuffers();
+		Telemetry::AddTime(Telemetry::RENDER_TIME, SDL_GetPerformanceCounter() - renderStart);
 
 		// game exit will have cleared Pi::game. we can't continue.
 		if (!Pi::game)
@@ -1426,9 +1507,22 @@ void Pi::MainLoop()
 		Pi::game->GetCpan()->Update();
 		musicPlayer.Update();
 
-		syncJobQueue->RunJobs(SYNC_JOBS_PER_LOOP);
-		asyncJobQueue->FinishJobs();
-		syncJobQueue->FinishJobs();
+		{
+			Telemetry::ScopedTimer timer(Telemetry::FINISH_JOBS_TIME);
+			syncJobQueue->RunJobs(SYNC_JOBS_PER_LOOP);
+			asyncJobQueue->FinishJobs();
+			syncJobQueue->FinishJobs();
+		}
+
+		if (Telemetry::IsEnabled()) {
+			const Graphics::Stats::TFrameData &stats = Pi::renderer->GetStats().FrameStatsPrevious();
+			Telemetry::Set(Telemetry::JOBS_QUEUED, asyncJobQueue->GetNumQueued() + syncJobQueue->GetNumQueued());
+			Telemetry::Set(Telemetry::DRAW_CALLS, stats.m_stats[Graphics::Stats::STAT_DRAWCALL]);
+			Telemetry::Set(Telemetry::DRAW_TRIS, stats.m_stats[Graphics::Stats::STAT_DRAWTRIS]);
+			Telemetry::Set(Telemetry::BUFFERS_CREATED, stats.m_stats[Graphics::Stats::STAT_CREATE_BUFFER]);
+			Telemetry::Set(Telemetry::LUA_MEMORY, Lua::manager->GetMemoryUsage() >> 10);
+			Telemetry::EndFrame();
+		}
 
 #if WITH_DEVKEYS
 		if (Pi::showDebugInfo && SDL_GetTicks() - last_stats > 1000) {
@@ -1452,6 +1546,11 @@ void Pi::MainLoop()
 			const Uint32 numDrawStars			= stats.m_stats[Graphics::Stats::STAT_STARS];
 			const Uint32 numDrawShips			= stats.m_stats[Graphics::Stats::STAT_SHIPS];
 			const Uint32 numDrawBillBoards		= stats.m_stats[Graphics::Stats::STAT_BILLBOARD];
+			const Uint32 numCullTested			= stats.m_stats[Graphics::Stats::STAT_CULL_TESTED];
+			const Uint32 numCullOffscreen		= stats.m_stats[Graphics::Stats::STAT_CULL_OFFSCREEN];
+			const Uint32 numCullHidden			= stats.m_stats[Graphics::Stats::STAT_CULL_HIDDEN];
+			const Uint32 numCullVisible			= stats.m_stats[Graphics::Stats::STAT_CULL_VISIBLE];
+			const Sound::Stats soundStats = Sound::GetStats();
 			snprintf(
 				fps_readout, sizeof(fps_readout),
 				"%d fps (%.1f ms/f), %d phys updates, %d triangles, %.3f M tris/sec, %d glyphs/sec, %d patches/frame\n"
@@ -1459,14 +1558,22 @@ void Pi::MainLoop()
 				"Draw Calls (%u), of which were:\n Tris (%u)\n Point Sprites (%u)\n Billboards (%u)\n"
 				"Buildings (%u), Cities (%u), GroundStations (%u), SpaceStations (%u), Atmospheres (%u)\n"
 				"Patches (%u), Planets (%u), GasGiants (%u), Stars (%u), Ships (%u)\n"
-				"Buffers Created(%u)\n",
+				"Buffers Created(%u)\n"
+				"Bodies tested (%u): Off screen (%u), Too small (%u), Drawn (%u)\n\n"
+				"Audio: %.3f ms/callback (max %.3f), %u underruns (%u frames), %.0f ms buffered (min), %u ms start latency (max)\n"
+				"Sound cache: %u KB decoded, %u loads, %u evictions\n",
 				frame_stat, (1000.0/frame_stat), phys_stat, Pi::statSceneTris, Pi::statSceneTris*frame_stat*1e-6,
 				Text::TextureFont::GetGlyphCount(), Pi::statNumPatches,
 				lua_memMB, lua_memKB, lua_memB, lua_gettop(Lua::manager->GetLuaState()),
 				numDrawCalls, numDrawTris, numDrawPointSprites, numDrawBillBoards,
 				numDrawBuildings, numDrawCities, numDrawGroundStations, numDrawSpaceStations, numDrawAtmospheres,
-				numDrawPatches, numDrawPlanets, numDrawGasGiants, numDrawStars, numDrawShips, numBuffersCreated
+				numDrawPatches, numDrawPlanets, numDrawGasGiants, numDrawStars, numDrawShips, numBuffersCreated,
+				numCullTested, numCullOffscreen, numCullHidden, numCullVisible,
+				soundStats.mixTimeMs / std::max(soundStats.callbacks, 1u), soundStats.maxMixTimeMs,
+				soundStats.underruns, soundStats.underrunFrames, std::max(soundStats.minBufferedMs, 0.0f), soundStats.maxStartLatency,
+				Uint32(soundStats.decodedBytes >> 10), soundStats.loads, soundStats.evictions
 			);
+			Sound::ClearStats();
 			frame_stat = 0;
 			phys_stat = 0;
 			Text::TextureFont::ClearGlyphCount();
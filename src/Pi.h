@@ -55,7 +55,8 @@ class Game;
 
 class Pi {
 public:
-	static void Init(const std::map<std::string,std::string> &options, bool no_gui = false);
+	// headless runs with the dummy renderer and doesn't need a display at all
+	static void Init(const std::map<std::string,std::string> &options, bool no_gui = false, bool headless = false);
 	static void InitGame();
 	static void StartGame();
 	static void RequestEndGame(); // request that the game is ended as soon as safely possible
@@ -145,6 +146,7 @@ public:
 		return bRet; 
 	}
 
+	static bool showTelemetry;
 #if WITH_DEVKEYS
 	static bool showDebugInfo;
 #endif
@@ -7,7 +7,7 @@
 #include "SmartPtr.h"
 #include <SDL_surface.h>
 
-namespace FileSystem { class FileSource; }
+namespace FileSystem { class FileSource; class FileData; }
 
 struct SDL_Surface;
 
@@ -31,5 +31,7 @@ public:
 
 SDLSurfacePtr LoadSurfaceFromFile(const std::string &fname, FileSystem::FileSource &source);
 SDLSurfacePtr LoadSurfaceFromFile(const std::string &fname);
+// decode an image that's already been read. fname is only for messages
+SDLSurfacePtr LoadSurfaceFromData(const std::string &fname, const FileSystem::FileData &filedata);
 
 #endif
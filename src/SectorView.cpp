@@ -23,6 +23,7 @@
 #include "gui/Gui.h"
 #include "KeyBindings.h"
 #include <algorithm>
+#include <cctype>
 #include <sstream>
 #include <SDL_stdinc.h>
 
@@ -134,6 +135,9 @@ void SectorView::InitDefaults()
 	m_cacheYMin = 0;
 	m_cacheYMax = 0;
 
+	m_searchNamesDirty = true;
+	m_searchNamesCacheSize = 0;
+
 	m_sectorCache = m_galaxy->NewSectorSlaveCache();
 }
 
@@ -395,6 +399,15 @@ void SectorView::SaveToJson(Json::Value &jsonObj)
 	jsonObj["sector_view"] = sectorViewObj; // Add sector view object to supplied object.
 }
 
+// as strncasecmp compares
+static std::string ToLower(const std::string &s)
+{
+	std::string lower(s);
+	for (char &c : lower)
+		c = char(tolower(static_cast<unsigned char>(c)));
+	return lower;
+}
+
 void SectorView::OnSearchBoxKeyPress(const SDL_Keysym *keysym)
 {
 	//remember the last search text, hotkey: up
@@ -417,65 +430,74 @@ void SectorView::OnSearchBoxKeyPress(const SDL_Keysym *keysym)
 		return;
 	} catch (SystemPath::ParseFailure) {}
 
-	bool gotMatch = false, gotStartMatch = false;
-	SystemPath bestMatch;
-	const std::string *bestMatchName = 0;
+	UpdateSearchNames();
 
-	for (auto i = m_sectorCache->Begin(); i != m_sectorCache->End(); ++i)
+	const std::string lowerSearch = ToLower(search);
 
-		for (unsigned int systemIndex = 0; systemIndex < (*i).second->m_systems.size(); systemIndex++) {
-			const Sector::System *ss = &((*i).second->m_systems[systemIndex]);
+	const SearchName *bestMatch = 0;
 
-			// compare with the start of the current system
-			if (strncasecmp(search.c_str(), ss->GetName().c_str(), search.size()) == 0) {
+	// names starting with the search term are together. the first is an
+	// exact match if there is one, otherwise take the shortest
+	auto first = std::lower_bound(m_searchNames.begin(), m_searchNames.end(), lowerSearch,
+		[](const SearchName &sn, const std::string &s) { return sn.lowerName < s; });
+	for (auto i = first; i != m_searchNames.end(); ++i) {
+		if (i->lowerName.compare(0, lowerSearch.size(), lowerSearch) != 0)
+			break;
 
-				// matched, see if they're the same size
-				if (search.size() == ss->GetName().size()) {
+		if (i->lowerName.size() == lowerSearch.size()) {
+			// exact match, take it and go
+			const std::string &name = GetCached(i->path)->m_systems[i->path.systemIndex].GetName();
+			m_statusLabel->SetText(stringf(Lang::EXACT_MATCH_X, formatarg("system", name)));
+			GotoSystem(i->path);
+			return;
+		}
 
-					// exact match, take it and go
-					SystemPath path = (*i).first;
-					path.systemIndex = systemIndex;
-					m_statusLabel->SetText(stringf(Lang::EXACT_MATCH_X, formatarg("system", ss->GetName())));
-					GotoSystem(path);
-					return;
-				}
+		if (!bestMatch || bestMatch->lowerName.size() > i->lowerName.size())
+			bestMatch = &(*i);
+	}
 
-				// partial match at start of name
-				if (!gotMatch || !gotStartMatch || bestMatchName->size() > ss->GetName().size()) {
+	// otherwise look for the search term somewhere within the names
+	if (!bestMatch) {
+		for (const SearchName &sn : m_searchNames) {
+			if (sn.lowerName.find(lowerSearch) == std::string::npos)
+				continue;
+			if (!bestMatch || bestMatch->lowerName.size() > sn.lowerName.size())
+				bestMatch = &sn;
+		}
+	}
 
-					// don't already have one or its shorter than the previous
-					// one, take it
-					bestMatch = (*i).first;
-					bestMatch.systemIndex = systemIndex;
-					bestMatchName = &(ss->GetName());
-					gotMatch = gotStartMatch = true;
-				}
+	if (bestMatch) {
+		const std::string &name = GetCached(bestMatch->path)->m_systems[bestMatch->path.systemIndex].GetName();
+		m_statusLabel->SetText(stringf(Lang::NOT_FOUND_BEST_MATCH_X, formatarg("system", name)));
+		GotoSystem(bestMatch->path);
+	}
 
-				continue;
-			}
+	else
+		m_statusLabel->SetText(Lang::NOT_FOUND);
+}
 
-			// look for the search term somewhere within the current system
-			if (pi_strcasestr(ss->GetName().c_str(), search.c_str())) {
+void SectorView::UpdateSearchNames()
+{
+	if (!m_searchNamesDirty && m_searchNamesCacheSize == m_sectorCache->Size())
+		return;
 
-				// found it
-				if (!gotMatch || !gotStartMatch || bestMatchName->size() > ss->GetName().size()) {
+	PROFILE_SCOPED()
 
-					// best we've found so far, take it
-					bestMatch = (*i).first;
-					bestMatch.systemIndex = systemIndex;
-					bestMatchName = &(ss->GetName());
-					gotMatch = true;
-				}
-			}
+	m_searchNames.clear();
+	for (auto i = m_sectorCache->Begin(); i != m_sectorCache->End(); ++i) {
+		const std::vector<Sector::System> &systems = (*i).second->m_systems;
+		for (unsigned int systemIndex = 0; systemIndex < systems.size(); systemIndex++) {
+			SearchName sn;
+			sn.lowerName = ToLower(systems[systemIndex].GetName());
+			sn.path = (*i).first;
+			sn.path.systemIndex = systemIndex;
+			m_searchNames.push_back(sn);
 		}
-
-	if (gotMatch) {
-		m_statusLabel->SetText(stringf(Lang::NOT_FOUND_BEST_MATCH_X, formatarg("system", *bestMatchName)));
-		GotoSystem(bestMatch);
 	}
+	std::sort(m_searchNames.begin(), m_searchNames.end());
 
-	else
-		m_statusLabel->SetText(Lang::NOT_FOUND);
+	m_searchNamesDirty = false;
+	m_searchNamesCacheSize = m_sectorCache->Size();
 }
 
 #define FFRAC(_x)	((_x)-floor(_x))
@@ -647,11 +669,14 @@ void SectorView::OnClickSystem(const SystemPath &path)
 	}
 }
 
-void SectorView::PutSystemLabels(RefCountedPtr<Sector> sec, const vector3f &origin, int drawRadius)
+void SectorView::PutSystemLabels(const NearSector &ns, const vector3f &origin, int drawRadius)
 {
 	PROFILE_SCOPED()
-	Uint32 sysIdx = 0;
-	for (std::vector<Sector::System>::iterator sys = sec->m_systems.begin(); sys !=sec->m_systems.end(); ++sys, ++sysIdx) {
+	for (Uint32 n = ns.first; n < ns.first + ns.count; n++) {
+		const NearSystem &nearSys = m_nearSystems[n];
+		Sector::System *sys = nearSys.sys;
+		const Uint32 sysIdx = nearSys.idx;
+
 		// skip the system if it doesn't fall within the sphere we're viewing.
 		if ((m_pos*Sector::SIZE - (*sys).GetFullPosition()).Length() > drawRadius) continue;
 
@@ -664,9 +689,7 @@ void SectorView::PutSystemLabels(RefCountedPtr<Sector> sec, const vector3f &orig
 		if (m_hiddenFactions.find(sys->GetFaction()) != m_hiddenFactions.end() && can_skip) continue;
 
 		// determine if system in hyperjump range or not
-		RefCountedPtr<const Sector> playerSec = GetCached(m_current);
-		float dist = Sector::DistanceBetween(sec, sysIdx, playerSec, m_current.systemIndex);
-		bool inRange = dist <= m_playerHyperspaceRange;
+		bool inRange = nearSys.playerDist <= m_playerHyperspaceRange;
 
 		// place the label
 		vector3d systemPos = vector3d((*sys).GetFullPosition() - origin);
@@ -920,36 +943,69 @@ void SectorView::DrawNearSectors(const matrix4x4f& modelview)
 	RefCountedPtr<const Sector> playerSec = GetCached(m_current);
 	const vector3f playerPos = Sector::SIZE * vector3f(float(m_current.sectorX), float(m_current.sectorY), float(m_current.sectorZ)) + playerSec->m_systems[m_current.systemIndex].GetPosition();
 
-	for (int sx = -DRAW_RAD; sx <= DRAW_RAD; sx++) {
-		for (int sy = -DRAW_RAD; sy <= DRAW_RAD; sy++) {
-			for (int sz = -DRAW_RAD; sz <= DRAW_RAD; sz++) {
-				DrawNearSector(int(floorf(m_pos.x))+sx, int(floorf(m_pos.y))+sy, int(floorf(m_pos.z))+sz, playerPos,
-					modelview * matrix4x4f::Translation(Sector::SIZE*sx, Sector::SIZE*sy, Sector::SIZE*sz));
-			}
-		}
+	UpdateNearSystems();
+
+	for (const NearSector &ns : m_nearSectors) {
+		const vector3f offset = Sector::SIZE * (vector3f(float(ns.sx), float(ns.sy), float(ns.sz)) - m_nearOrigin);
+		DrawNearSector(ns, playerPos, modelview * matrix4x4f::Translation(offset.x, offset.y, offset.z));
 	}
 
 	// ...then switch and do all the labels
-	const vector3f secOrigin = vector3f(int(floorf(m_pos.x)), int(floorf(m_pos.y)), int(floorf(m_pos.z)));
-
 	m_renderer->SetTransform(modelview);
 	m_renderer->SetDepthRange(0,1);
 	Gui::Screen::EnterOrtho();
+	for (const NearSector &ns : m_nearSectors)
+		PutSystemLabels(ns, Sector::SIZE * m_nearOrigin, Sector::SIZE * DRAW_RAD);
+	Gui::Screen::LeaveOrtho();
+}
+
+void SectorView::UpdateNearSystems()
+{
+	const vector3f origin(floorf(m_pos.x), floorf(m_pos.y), floorf(m_pos.z));
+	if (!m_nearSectors.empty() && origin.ExactlyEqual(m_nearOrigin) && m_current == m_nearCurrent)
+		return;
+
+	PROFILE_SCOPED()
+
+	m_nearOrigin = origin;
+	m_nearCurrent = m_current;
+	m_nearSectors.clear();
+	m_nearSystems.clear();
+
+	RefCountedPtr<const Sector> playerSec = GetCached(m_current);
+	const Sector::System *playerSys = &playerSec->m_systems[m_current.systemIndex];
+
+	// in the order they were always drawn, so the same labels win out
 	for (int sx = -DRAW_RAD; sx <= DRAW_RAD; sx++) {
 		for (int sy = -DRAW_RAD; sy <= DRAW_RAD; sy++) {
 			for (int sz = -DRAW_RAD; sz <= DRAW_RAD; sz++) {
-				PutSystemLabels(GetCached(SystemPath(sx + secOrigin.x, sy + secOrigin.y, sz + secOrigin.z)), Sector::SIZE * secOrigin, Sector::SIZE * DRAW_RAD);
+				NearSector ns;
+				ns.sx = int(origin.x) + sx;
+				ns.sy = int(origin.y) + sy;
+				ns.sz = int(origin.z) + sz;
+				ns.sec = GetCached(SystemPath(ns.sx, ns.sy, ns.sz));
+				ns.first = m_nearSystems.size();
+				ns.count = ns.sec->m_systems.size();
+
+				for (Uint32 idx = 0; idx < ns.count; idx++) {
+					NearSystem nearSys;
+					nearSys.sys = &ns.sec->m_systems[idx];
+					nearSys.idx = idx;
+					nearSys.playerDist = Sector::System::DistanceBetween(nearSys.sys, playerSys);
+					m_nearSystems.push_back(nearSys);
+				}
+
+				m_nearSectors.push_back(ns);
 			}
 		}
 	}
-	Gui::Screen::LeaveOrtho();
 }
 
-void SectorView::DrawNearSector(const int sx, const int sy, const int sz, const vector3f &playerAbsPos,const matrix4x4f &trans)
+void SectorView::DrawNearSector(const NearSector &ns, const vector3f &playerAbsPos, const matrix4x4f &trans)
 {
 	PROFILE_SCOPED()
 	m_renderer->SetTransform(trans);
-	RefCountedPtr<Sector> ps = GetCached(SystemPath(sx, sy, sz));
+	const int sx = ns.sx, sy = ns.sy, sz = ns.sz;
 
 	const int cz = int(floor(m_pos.z+0.5f));
 
@@ -977,12 +1033,15 @@ void SectorView::DrawNearSector(const int sx, const int sy, const int sz, const
 		m_secLineVerts->Add(vts[0], darkgreen);
 	}
 
-	const size_t numLineVerts = ps->m_systems.size() * 8;
+	const size_t numLineVerts = ns.count * 8;
 	m_lineVerts->position.reserve(numLineVerts);
 	m_lineVerts->diffuse.reserve(numLineVerts);
 
-	Uint32 sysIdx = 0;
-	for (std::vector<Sector::System>::iterator i = ps->m_systems.begin(); i != ps->m_systems.end(); ++i, ++sysIdx) {
+	for (Uint32 n = ns.first; n < ns.first + ns.count; n++) {
+		const NearSystem &nearSys = m_nearSystems[n];
+		Sector::System *i = nearSys.sys;
+		const Uint32 sysIdx = nearSys.idx;
+
 		// calculate where the system is in relation the centre of the view...
 		const vector3f sysAbsPos = Sector::SIZE*vector3f(float(sx), float(sy), float(sz)) + i->GetPosition();
 		const vector3f toCentreOfView = m_pos*Sector::SIZE - sysAbsPos;
@@ -1003,9 +1062,7 @@ void SectorView::DrawNearSector(const int sx, const int sy, const int sz, const
 		if (m_hiddenFactions.find(i->GetFaction()) != m_hiddenFactions.end() && can_skip) continue;
 
 		// determine if system in hyperjump range or not
-		RefCountedPtr<const Sector> playerSec = GetCached(m_current);
-		float dist = Sector::DistanceBetween(ps, sysIdx, playerSec, m_current.systemIndex);
-		bool inRange = dist <= m_playerHyperspaceRange;
+		bool inRange = nearSys.playerDist <= m_playerHyperspaceRange;
 
 		// don't worry about looking for inhabited systems if they're
 		// unexplored (same calculation as in StarSystem.cpp) or we've
@@ -1477,6 +1534,8 @@ void SectorView::ShrinkCache()
 			}
 		}
 
+		m_searchNamesDirty = true;
+
 		m_cacheXMin = xmin;
 		m_cacheXMax = xmax;
 		m_cacheYMin = ymin;
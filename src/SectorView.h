@@ -68,9 +68,35 @@ private:
 		Gui::Label *shortDesc;
 	};
 
+	// a sector in the DRAW_RAD cube around the view centre, and its systems
+	// with what doesn't change until the centre moves a sector or the
+	// player changes system. the near sectors are drawn and labelled from
+	// these instead of looking up every sector and working out every
+	// system's distance from the player each frame
+	struct NearSystem {
+		Sector::System *sys;
+		Uint32 idx;
+		float playerDist;
+	};
+	struct NearSector {
+		RefCountedPtr<Sector> sec;
+		int sx, sy, sz;
+		Uint32 first, count;	// in m_nearSystems
+	};
+
+	// a system name in the sector cache, lower case, for the search box
+	struct SearchName {
+		std::string lowerName;
+		SystemPath path;
+		bool operator<(const SearchName &o) const { return lowerName < o.lowerName || (lowerName == o.lowerName && path < o.path); }
+	};
+
+	void UpdateNearSystems();
+	void UpdateSearchNames();
+
 	void DrawNearSectors(const matrix4x4f& modelview);
-	void DrawNearSector(const int sx, const int sy, const int sz, const vector3f &playerAbsPos, const matrix4x4f &trans);
-	void PutSystemLabels(RefCountedPtr<Sector> sec, const vector3f &origin, int drawRadius);
+	void DrawNearSector(const NearSector &ns, const vector3f &playerAbsPos, const matrix4x4f &trans);
+	void PutSystemLabels(const NearSector &ns, const vector3f &origin, int drawRadius);
 
 	void DrawFarSectors(const matrix4x4f& modelview);
 	void BuildFarSector(RefCountedPtr<Sector> sec, const vector3f &origin, std::vector<vector3f> &points, std::vector<Color> &colors);
@@ -158,6 +184,17 @@ private:
 	RefCountedPtr<SectorCache::Slave> m_sectorCache;
 	std::string m_previousSearch;
 
+	std::vector<NearSector> m_nearSectors;
+	std::vector<NearSystem> m_nearSystems;
+	vector3f m_nearOrigin;
+	SystemPath m_nearCurrent;
+
+	// sorted, so prefixes are a binary search. rebuilt for a search if the
+	// cache has changed since
+	std::vector<SearchName> m_searchNames;
+	bool m_searchNamesDirty;
+	size_t m_searchNamesCacheSize;
+
 	float m_playerHyperspaceRange;
 	Graphics::Drawables::Line3D m_selectedLine;
 	Graphics::Drawables::Line3D m_secondLine;
@@ -122,6 +122,14 @@ void Writer::Color4UB(const Color &c)
 	Byte(c.a);
 }
 
+void Writer::AlignedBlob(const void *data, Uint32 size)
+{
+	Int32(size);
+	const size_t pad = (16 - (m_str.size() % 16)) % 16;
+	m_str.append(pad, '\0');
+	m_str.append(static_cast<const char*>(data), size);
+}
+
 Reader::Reader(const ByteRange &data):
 	m_data(data),
 	m_at(data.begin)
@@ -224,6 +232,24 @@ ByteRange Reader::Blob()
 	return range;
 }
 
+ByteRange Reader::AlignedBlob()
+{
+	size_t size = Int32();
+	const size_t pad = (16 - ((m_at - m_data.begin) % 16)) % 16;
+
+	if (pad + size > size_t(m_data.end - m_at)) {
+		// XXX error condition -- exception? some kind of error state on the Reader?
+		assert(0 && "Serializer:Reader stream is truncated");
+		m_at = m_data.end;
+		return ByteRange();
+	}
+
+	m_at += pad;
+	ByteRange range = ByteRange(m_at, m_at + size);
+	m_at += size;
+	return range;
+}
+
 std::string Reader::String()
 {
 	ByteRange range = Blob();
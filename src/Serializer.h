@@ -38,6 +38,10 @@ namespace Serializer {
 		void Vector3d(vector3d vec);
 		void WrQuaternionf(const Quaternionf &q);
 		void Color4UB(const Color&);
+		// raw bytes, padded so they start 16-byte aligned relative to the
+		// start of the stream. a reader over an aligned buffer (eg a mapped
+		// file) can then hand them out in place
+		void AlignedBlob(const void *data, Uint32 size);
 		void WrSection(const std::string &section_label, const std::string &section_data) {
 			String(section_label);
 			String(section_data);
@@ -71,6 +75,7 @@ namespace Serializer {
 		vector3d Vector3d();
 		Quaternionf RdQuaternionf();
 		Color Color4UB();
+		ByteRange AlignedBlob();
 		Reader RdSection(const std::string &section_label_expected) {
 			if (section_label_expected != String()) {
 				throw SavedGameCorruptException();
@@ -15,7 +15,6 @@ namespace {
 	static RefCountedPtr<Graphics::Material> s_matShield;
 	static ShieldRenderParameters s_renderParams;
 	static const std::string s_shieldGroupName("Shields");
-	static const std::string s_matrixTransformName("_accMtx4");
 
 	static RefCountedPtr<Graphics::Material> GetGlobalShieldMaterial()
 	{
@@ -143,7 +142,7 @@ void Shields::ReparentShieldNodes(SceneGraph::Model* model)
 					// set our nodes transformation to be the accumulated transform
 					MatrixTransform *sg_transform_parent = new MatrixTransform(renderer, mav.outMat);
 					std::stringstream nodeStream;
-					nodeStream << iChild << s_matrixTransformName;
+					nodeStream << iChild << SceneGraph::SHIELD_TRANSFORM_SUFFIX;
 					sg_transform_parent->SetName(nodeStream.str());
 					sg_transform_parent->AddChild(sg.Get());
 
@@ -178,7 +177,7 @@ Shields::Shields(SceneGraph::Model *model)
 	using SceneGraph::CollisionGeometry;
 
 	//This will find all matrix transforms meant for shields.
-	SceneGraph::FindNodeVisitor shieldFinder(SceneGraph::FindNodeVisitor::MATCH_NAME_ENDSWITH, s_matrixTransformName);
+	SceneGraph::FindNodeVisitor shieldFinder(SceneGraph::FindNodeVisitor::MATCH_NAME_ENDSWITH, SceneGraph::SHIELD_TRANSFORM_SUFFIX);
 	model->GetRoot()->Accept(shieldFinder);
 	const std::vector<Node*> &results = shieldFinder.GetResults();
 
@@ -368,3 +368,124 @@ double Ship::AITravelTime(double targdist, double relspeed, double endspeed, dou
 	return time1+time2+time3;
 }
 */
+
+// coarse simulation of distant traffic. every COARSE_UPDATE_TICKS ticks the
+// ship plans a straight flight to its AI waypoint: the velocity it would
+// have after speeding up or slowing down for the interval, and the fuel that
+// would take. between updates it just coasts. anything that needs the real
+// AI (getting near the player, a planet or the waypoint, being shot or
+// bumped, a new kind of command) puts it back to full simulation.
+
+double Ship::s_coarseDistance = 0.0;
+
+// the AI takes over for the last part of the approach
+static const double COARSE_APPROACH_DIST = 10000000.0;
+
+void Ship::EndCoarse()
+{
+	if (!m_coarse) return;
+	m_coarse = false;
+	m_coarseTicks = 0;
+	m_coarseTime = 0.0f;
+	CalcExternalForce();
+}
+
+bool Ship::CanBeCoarse() const
+{
+	if (m_flightState != FLYING || !m_curAICmd || m_launchLockTimeout > 0.0f) return false;
+	if (m_hyperspace.countdown > 0.0f || m_hyperspace.now) return false;
+	for (int i=0; i<ShipType::GUNMOUNT_MAX; i++)
+		if (m_gun[i].state) return false;
+
+	// near enough to a surface to collide with terrain or a station
+	if (GetFrame()->IsRotFrame()) return false;
+
+	const Player *player = Pi::game->GetPlayer();
+	if (!player || player->GetFrame() == nullptr) return false;
+
+	// a little closer to come out than to go in, so ships around the
+	// distance don't flip every update
+	const double dist = m_coarse ? 0.9 * s_coarseDistance : s_coarseDistance;
+	return GetPositionRelTo(player).LengthSqr() > dist * dist;
+}
+
+bool Ship::AICoarseFlight(float interval)
+{
+	vector3d targpos, targvel;
+	double endvel;
+	if (!m_curAICmd->GetWaypoint(targpos, targvel, endvel)) return false;
+
+	const vector3d relpos = targpos - GetPosition();
+	const double targdist = relpos.Length();
+	const vector3d reldir = relpos / targdist;
+	const double curspeed = (GetVelocity() - targvel).Dot(reldir);
+	const double accel = GetAccelFwd();
+	if (accel <= 0.0) return false;
+
+	if (targdist < std::max(COARSE_APPROACH_DIST, 2.0 * fabs(curspeed) * interval)) return false;
+
+	// straight through a planet isn't a path. let the AI go round it
+	const Body *body = GetFrame()->GetBody();
+	if (body && body->IsType(Object::TERRAINBODY)) {
+		const double t = Clamp(-GetPosition().Dot(reldir), 0.0, targdist);
+		if ((GetPosition() + reldir * t).Length() < 1.5 * body->GetPhysRadius()) return false;
+	}
+
+	// as AICmdFlyTo: as fast as it can go and still slow to endvel at the
+	// waypoint (flipping to use the main thrusters), unless it's running
+	// out of fuel
+	double ispeed = 0.9 * sqrt(endvel * endvel + 2.0 * accel * targdist);
+	if (ispeed > curspeed && curspeed > 0.9 * GetSpeedReachedWithFuel()) ispeed = curspeed;
+
+	// the next interval is taken to be as long as the last
+	const double maxdv = accel * interval;
+	const double speed = ispeed > curspeed ? std::min(ispeed, curspeed + maxdv) : std::max(ispeed, curspeed - maxdv);
+
+	const vector3d vel = targvel + reldir * speed;
+	const double dv = (vel - GetVelocity()).Length();
+	SetVelocity(vel);
+	SetAngVelocity(vector3d(0.0));
+	UpdateFuel(interval, vector3d(0.0, 0.0, std::min(dv / interval, accel) * GetMass()));
+
+	return true;
+}
+
+bool Ship::AICoarseTimeStep(float &timeStep)
+{
+	if (s_coarseDistance <= 0.0) {
+		EndCoarse();
+		return true;
+	}
+
+	m_coarseTime += timeStep;
+	if (++m_coarseTicks < COARSE_UPDATE_TICKS)
+		return !m_coarse;
+
+	const float interval = m_coarseTime;
+	m_coarseTicks = 0;
+	m_coarseTime = 0.0f;
+
+	if (!CanBeCoarse()) {
+		EndCoarse();
+		return true;
+	}
+
+	const bool wasCoarse = m_coarse;
+	if (!AICoarseFlight(interval)) {
+		EndCoarse();
+		return true;
+	}
+
+	if (!wasCoarse) {
+		m_coarse = true;
+		ClearThrusterState();
+		SetForce(vector3d(0.0));
+		SetTorque(vector3d(0.0));
+		m_decelerating = false;
+		return true;
+	}
+
+	// the rest of the ship's systems catch up on the whole interval
+	timeStep = interval;
+	return true;
+}
@@ -250,6 +250,12 @@ void Ship::Init()
 {
 	m_invulnerable = false;
 
+	// spread the coarse updates out over the ticks
+	static Uint32 s_coarseTickOffset = 0;
+	m_coarse = false;
+	m_coarseTicks = s_coarseTickOffset++ % COARSE_UPDATE_TICKS;
+	m_coarseTime = 0.0f;
+
 	m_sensors.reset(new Sensors(this));
 
 	m_navLights.reset(new NavLights(GetModel()));
@@ -400,6 +406,8 @@ double Ship::GetSpeedReachedWithFuel() const
 
 bool Ship::OnDamage(Object *attacker, float kgDamage, const CollisionContact& contactData)
 {
+	EndCoarse();
+
 	if (m_invulnerable) {
 		Sound::BodyMakeNoise(this, "Hull_hit_Small", 0.5f);
 		return true;
@@ -453,6 +461,8 @@ bool Ship::OnDamage(Object *attacker, float kgDamage, const CollisionContact& co
 
 bool Ship::OnCollision(Object *b, Uint32 flags, double relVel)
 {
+	EndCoarse();
+
 	// hitting space station docking surfaces shouldn't do damage
 	if (b->IsType(Object::SPACESTATION) && (flags & 0x10)) {
 		return true;
@@ -814,6 +824,11 @@ void Ship::SetFrame(Frame *f)
 
 void Ship::TimeStepUpdate(const float timeStep)
 {
+	if (m_coarse) {
+		CoastTimeStep(timeStep);
+		return;
+	}
+
 	// If docked, station is responsible for updating position/orient of ship
 	// but we call this crap anyway and hope it doesn't do anything bad
 
@@ -1077,14 +1092,17 @@ void Ship::UpdateFuel(const float timeStep, const vector3d &thrust)
 		LuaEvent::Queue("onShipFuelChanged", this, EnumStrings::GetString("ShipFuelStatus", currentState));
 }
 
-void Ship::StaticUpdate(const float timeStep)
+void Ship::StaticUpdate(const float step)
 {
 	// do player sounds before dead check, so they also turn off
 	if (IsType(Object::PLAYER)) DoThrusterSounds();
 
 	if (IsDead()) return;
 
-	if (m_controller) m_controller->StaticUpdate(timeStep);
+	float timeStep = step;
+	if (!IsType(Object::PLAYER) && !AICoarseTimeStep(timeStep)) return;
+
+	if (m_controller && !m_coarse) m_controller->StaticUpdate(timeStep);
 
 	if (GetHullTemperature() > 1.0)
 		Explode();
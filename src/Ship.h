@@ -210,6 +210,16 @@ public:
 
 	void AIBodyDeleted(const Body* const body) {};		// todo: signals
 
+	// distant AI traffic. ships further than this from the player (in
+	// metres) that are flying to a waypoint skip the AI and physics and are
+	// moved along a planned straight path instead, replanned every few
+	// ticks. 0 turns it off
+	static void SetCoarseDistance(double dist) { s_coarseDistance = dist; }
+	static double GetCoarseDistance() { return s_coarseDistance; }
+	bool IsCoarse() const { return m_coarse; }
+	// back to full simulation, eg because something has happened to the ship
+	void EndCoarse();
+
 	virtual void PostLoadFixup(Space *space);
 
 	const ShipType *GetShipType() const { return m_type; }
@@ -270,6 +280,10 @@ protected:
 	void RenderLaserfire();
 
 	bool AITimeStep(float timeStep); // Called by controller. Returns true if complete
+	// called at the start of StaticUpdate. false if the rest of it can be
+	// skipped this tick. at a coarse update timeStep becomes the time since
+	// the last one
+	bool AICoarseTimeStep(float &timeStep);
 
 	virtual void SetAlertState(AlertState as);
 
@@ -347,6 +361,15 @@ private:
 	AIError m_aiMessage;
 	bool m_decelerating;
 
+	bool CanBeCoarse() const;
+	bool AICoarseFlight(float interval);
+
+	static double s_coarseDistance;
+	static const Uint32 COARSE_UPDATE_TICKS = 10;
+	bool m_coarse;
+	Uint32 m_coarseTicks;	// since the last coarse update (or check for one)
+	float m_coarseTime;
+
 	double m_thrusterFuel;	// remaining fuel 0.0-1.0
 	double m_reserveFuel;	// 0-1, fuel not to touch for the current AI program
 
@@ -550,13 +550,38 @@ static double MaxEffectRad(Body *body, Ship *ship)
 	return std::max(body->GetPhysRadius(), sqrt(G * body->GetMass() / ship->GetAccelUp()));
 }
 
+typedef Frame::AIObstacle Obstacle;
+
+static const Obstacle &GetObstacle(const Frame *frame)
+{
+	Obstacle &o = frame->GetAIObstacle();
+	if (!o.valid) {
+		Body *body = frame->GetBody();
+		o.body = body;
+		o.featureRad = MaxFeatureRad(body);
+		o.terrain = body && body->IsType(Object::TERRAINBODY);
+		// less the part that depends on the ship, see GetEffectRad
+		o.effectRad = o.terrain ? body->GetPhysRadius() : MaxEffectRad(body, 0);
+		// stations have no gravity
+		o.gm = (!body || body->IsType(Object::SPACESTATION)) ? 0.0 : G * body->GetMass();
+		o.valid = true;
+	}
+	return o;
+}
+
+static double GetEffectRad(const Obstacle &obs, Ship *ship)
+{
+	if (!obs.terrain) return obs.effectRad;
+	return std::max(obs.effectRad, sqrt(obs.gm / ship->GetAccelUp()));
+}
+
 // returns acceleration due to gravity at that point
 static double GetGravityAtPos(Frame *targframe, const vector3d &posoff)
 {
-	Body *body = targframe->GetBody();
-	if (!body || body->IsType(Object::SPACESTATION)) return 0;
+	const double gm = GetObstacle(targframe).gm;
+	if (gm == 0.0) return 0;
 	double rsqr = posoff.LengthSqr();
-	return G * body->GetMass() / rsqr;
+	return gm / rsqr;
 	// inverse is: sqrt(G * m1m2 / thrust)
 }
 
@@ -599,15 +624,14 @@ static vector3d GenerateTangent(Ship *ship, Frame *targframe, const vector3d &sh
 //2 - unsafe escape from effect radius
 //3 - unsafe entry to effect radius
 //4 - probable path intercept
-static int CheckCollision(Ship *ship, const vector3d &pathdir, double pathdist, const vector3d &tpos, double endvel, double r)
+static int CheckCollision(Ship *ship, const Obstacle &obs, const vector3d &pathdir, double pathdist, const vector3d &tpos, double endvel, double r)
 {
 	// ship is in obstructor's frame anyway, so is tpos
 	if (pathdist < 100.0) return 0;
-	Body *body = ship->GetFrame()->GetBody();
-	if (!body) return 0;
+	if (!obs.body) return 0;
 	vector3d spos = ship->GetPosition();
 	double tlen = tpos.Length(), slen = spos.Length();
-	double fr = MaxFeatureRad(body);
+	double fr = obs.featureRad;
 
 	// if target inside, check if direct entry is safe (30 degree)
 	if (tlen < r) {
@@ -652,11 +676,12 @@ static int CheckCollision(Ship *ship, const vector3d &pathdir, double pathdist,
 static bool ParentSafetyAdjust(Ship *ship, Frame *targframe, vector3d &targpos, vector3d &targvel)
 {
 	Body *body = 0;
+	Frame *bodyframe = 0;
 	Frame *frame = targframe->GetNonRotFrame();
 	while (frame)
 	{
 		if (ship->GetFrame()->GetNonRotFrame() == frame) break;		// ship in frame, stop
-		if (frame->GetBody()) body = frame->GetBody();			// ignore grav points?
+		if (frame->GetBody()) { body = frame->GetBody(); bodyframe = frame; }	// ignore grav points?
 
 		double sdist = ship->GetPositionRelTo(frame).Length();
 		if (sdist < frame->GetRadius()) break;					// ship inside frame, stop
@@ -674,7 +699,7 @@ static bool ParentSafetyAdjust(Ship *ship, Frame *targframe, vector3d &targpos,
 
 	vector3d targpos2 = targpos - ship->GetPosition();
 	double targdist = targpos2.Length();
-	double bodydist = body->GetPositionRelTo(ship).Length() - MaxEffectRad(body, ship)*1.5;
+	double bodydist = body->GetPositionRelTo(ship).Length() - GetEffectRad(GetObstacle(bodyframe), ship)*1.5;
 	if (targdist < bodydist) return false;
 	targpos -= (targdist - bodydist) * targpos2 / targdist;
 	targvel = body->GetVelocityRelTo(ship->GetFrame());
@@ -685,11 +710,11 @@ static bool ParentSafetyAdjust(Ship *ship, Frame *targframe, vector3d &targpos,
 // tandir is normal vector from planet to target pos or dir
 static bool CheckSuicide(Ship *ship, const vector3d &tandir)
 {
-	Body *body = ship->GetFrame()->GetBody();
-	if (!body || !body->IsType(Object::TERRAINBODY)) return false;
+	const Obstacle &obs = GetObstacle(ship->GetFrame());
+	if (!obs.body || !obs.terrain) return false;
 
 	double vel = ship->GetVelocity().Dot(tandir);		// vel towards is negative
-	double dist = ship->GetPosition().Length() - MaxFeatureRad(body);
+	double dist = ship->GetPosition().Length() - obs.featureRad;
 	if (vel < -1.0 && vel*vel > 2.0*ship->GetAccelMin()*dist)
 		return true;
 	return false;
@@ -729,6 +754,28 @@ AICmdFlyTo::AICmdFlyTo(Ship *ship, Frame *targframe, const vector3d &posoff, dou
 {
 }
 
+bool AICmdFlyTo::GetWaypoint(vector3d &pos, vector3d &vel, double &endvel) const
+{
+	// flying around something, or on a tangent path that gets replanned on
+	// every frame change
+	if (m_child || m_tangent) return false;
+	if (m_ship->GetFlightState() != Ship::FLYING) return false;
+
+	// as TimeStepUpdate, without the parent safety adjustment
+	if (m_target) {
+		pos = m_target->GetPositionRelTo(m_ship->GetFrame());
+		pos -= (pos - m_ship->GetPosition()).NormalizedSafe() * m_dist;
+		vel = m_target->GetVelocityRelTo(m_ship->GetFrame());
+	} else if (m_targframe) {
+		pos = GetPosInFrame(m_ship->GetFrame(), m_targframe, m_posoff);
+		vel = GetVelInFrame(m_ship->GetFrame(), m_targframe, m_posoff);
+	} else
+		return false;
+
+	endvel = m_endvel;
+	return true;
+}
+
 bool AICmdFlyTo::TimeStepUpdate()
 {
 	if (m_ship->GetFlightState() == Ship::JUMPING) return false;
@@ -772,12 +819,13 @@ Output("Autopilot dist = %.1f, speed = %.1f, zthrust = %.2f, state = %i\n",
 
 // TODO: collision needs to be processed according to vdiff, not reldir?
 
-	Body *body = m_frame->GetBody();
-	double erad = MaxEffectRad(body, m_ship);
+	const Obstacle &obs = GetObstacle(m_frame);
+	Body *body = obs.body;
+	double erad = GetEffectRad(obs, m_ship);
 	if ((m_target && body != m_target)
 		|| (m_targframe && (!m_tangent || body != m_targframe->GetBody())))
 	{
-		int coll = CheckCollision(m_ship, reldir, targdist, targpos, m_endvel, erad);
+		int coll = CheckCollision(m_ship, obs, reldir, targdist, targpos, m_endvel, erad);
 		if (coll == 0) {				// no collision
 			if (m_child) { m_child.reset(); }
 		}
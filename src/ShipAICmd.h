@@ -25,6 +25,10 @@ public:
 
 	virtual bool TimeStepUpdate() = 0;
 	bool ProcessChild();				// returns false if child is active
+
+	// where the command is taking the ship right now, in the ship's frame,
+	// if it's a straight flight there. for coarse simulation of distant ships
+	virtual bool GetWaypoint(vector3d &pos, vector3d &vel, double &endvel) const { return false; }
 	virtual void GetStatusText(char *str) {
 		if (m_child) m_child->GetStatusText(str);
 		else strcpy(str, "AI state unknown");
@@ -52,6 +56,11 @@ public:
 	virtual bool TimeStepUpdate();
 	AICmdDock(Ship *ship, SpaceStation *target);
 
+	// on the way to the station, if it's far off
+	virtual bool GetWaypoint(vector3d &pos, vector3d &vel, double &endvel) const {
+		return m_child ? m_child->GetWaypoint(pos, vel, endvel) : false;
+	}
+
 	virtual void GetStatusText(char *str) {
 		if (m_child) m_child->GetStatusText(str);
 		else snprintf(str, 255, "Dock: target %s, state %i", m_target->GetLabel().c_str(), m_state);
@@ -122,6 +131,8 @@ public:
 	AICmdFlyTo(Ship *ship, Frame *targframe, const vector3d &posoff, double endvel, bool tangent);
 	AICmdFlyTo(Ship *ship, Body *target);
 
+	virtual bool GetWaypoint(vector3d &pos, vector3d &vel, double &endvel) const;
+
 	virtual void GetStatusText(char *str) {
 		if (m_child) m_child->GetStatusText(str);
 		else if (m_target) snprintf(str, 255, "Intercept: %s, dist %.1fkm, state %i",
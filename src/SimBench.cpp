@@ -0,0 +1,292 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "SimBench.h"
+#include "Pi.h"
+#include "Game.h"
+#include "Space.h"
+#include "Frame.h"
+#include "Ship.h"
+#include "Player.h"
+#include "Planet.h"
+#include "SpaceStation.h"
+#include "MathUtil.h"
+#include "Serializer.h"
+#include "LuaObject.h"
+#include "LuaUtils.h"
+#include "Lua.h"
+#include "galaxy/SystemPath.h"
+#include "json/json.h"
+#include <cstdio>
+
+namespace SimBench {
+
+// the same place and time as the "start at Earth" new game
+static const SystemPath START_PATH(0,0,0,0,9);
+static const double START_TIME = 48600.0;
+
+static const Uint32 RNG_SEED = 0x51b3e7c1;
+
+static const char *SHIP_TYPES[] = {
+	"kanara", "sinonatrix", "pumpkinseed", "xylophis", "natrix", "malabar"
+};
+
+static ShipType::Id PickShipType(int i)
+{
+	// whatever's there of the list, in order
+	for (unsigned int n = 0; n < COUNTOF(SHIP_TYPES); n++) {
+		const char *type = SHIP_TYPES[(i + n) % COUNTOF(SHIP_TYPES)];
+		if (ShipType::Get(type))
+			return type;
+	}
+	return ShipType::player_ships.front();
+}
+
+// as Space.SpawnShipNear, distances in metres
+static Ship *SpawnShipNear(const ShipType::Id &type, Body *nearbody, double minDist, double maxDist)
+{
+	Ship *ship = new Ship(type);
+
+	Frame *frame = nearbody->GetFrame();
+	const vector3d pos = MathUtil::RandomPointOnSphere(minDist, maxDist) + nearbody->GetPosition();
+
+	// too far out for a rotating frame gets a massive velocity when it's
+	// bumped out of it on the first update
+	if (frame->IsRotFrame() && frame->GetRadius() < pos.Length()) {
+		assert(frame->GetParent());
+		frame = frame->GetParent();
+	}
+
+	ship->SetFrame(frame);
+	ship->SetPosition(pos);
+	ship->SetVelocity(nearbody->GetVelocity());
+	Pi::game->GetSpace()->AddBody(ship);
+
+	return ship;
+}
+
+// give it a laser the way the Lua modules do, so the AI has something to
+// shoot with
+static void ArmShip(Ship *ship)
+{
+	lua_State *l = Lua::manager->GetLuaState();
+
+	LUA_DEBUG_START(l);
+
+	if (!pi_lua_import(l, "Equipment"))
+		return;
+	lua_getfield(l, -1, "laser");
+	lua_getfield(l, -1, "pulsecannon_1mw");
+
+	LuaObject<Ship>::PushToLua(ship);
+	lua_getfield(l, -1, "AddEquip");
+	lua_pushvalue(l, -2);
+	lua_pushvalue(l, -4);
+	pi_lua_protected_call(l, 2, 1);
+
+	lua_pop(l, 5);
+
+	LUA_DEBUG_END(l, 0);
+}
+
+static bool StartGame()
+{
+	try {
+		Pi::game = new Game(START_PATH, START_TIME);
+	}
+	catch (InvalidGameStartLocation &e) {
+		Output("simbench: invalid starting location: %s\n", e.error.c_str());
+		return false;
+	}
+	return true;
+}
+
+// ships coming in to dock at the player's station
+static bool SetupStation(int ships)
+{
+	if (!StartGame()) return false;
+	Pi::InitGame();
+	Pi::StartGame();
+
+	SpaceStation *station = Pi::player->GetDockedWith();
+	assert(station);
+
+	for (int i = 0; i < ships; i++) {
+		Ship *ship = SpawnShipNear(PickShipType(i), station, 10000.0, 50000.0);
+		ship->AIDock(station);
+	}
+
+	return true;
+}
+
+// two sides, each ship after one on the other side
+static bool SetupBattle(int ships)
+{
+	if (!StartGame()) return false;
+	Pi::InitGame();
+	Pi::StartGame();
+
+	SpaceStation *station = Pi::player->GetDockedWith();
+	assert(station);
+
+	std::vector<Ship*> sides[2];
+	for (int i = 0; i < ships; i++) {
+		Ship *ship = SpawnShipNear(PickShipType(i), station, 50000.0, 60000.0);
+		ArmShip(ship);
+		sides[i & 1].push_back(ship);
+	}
+
+	for (int side = 0; side < 2; side++) {
+		const std::vector<Ship*> &enemies = sides[side ^ 1];
+		if (enemies.empty()) continue;
+		for (size_t i = 0; i < sides[side].size(); i++)
+			sides[side][i]->AIKill(enemies[i % enemies.size()]);
+	}
+
+	return true;
+}
+
+// ships heading for the furthest planet, at high time acceleration
+static bool SetupTransit(int ships)
+{
+	if (!StartGame()) return false;
+	Pi::InitGame();
+	Pi::StartGame();
+
+	SpaceStation *station = Pi::player->GetDockedWith();
+	assert(station);
+
+	Body *target = 0;
+	double targetDist = 0.0;
+	for (Body *b : Pi::game->GetSpace()->GetBodies()) {
+		if (!b->IsType(Object::PLANET)) continue;
+		const double dist = b->GetPositionRelTo(station).Length();
+		if (dist > targetDist) {
+			target = b;
+			targetDist = dist;
+		}
+	}
+	if (!target) {
+		Output("simbench: no planet to fly to\n");
+		return false;
+	}
+
+	for (int i = 0; i < ships; i++) {
+		Ship *ship = SpawnShipNear(PickShipType(i), station, 20000.0, 40000.0);
+		ship->AIFlyTo(target);
+	}
+
+	Pi::game->SetTimeAccel(Game::TIMEACCEL_1000X);
+
+	return true;
+}
+
+static bool LoadGame(const std::string &filename)
+{
+	try {
+		Pi::game = Game::LoadGame(filename);
+	}
+	catch (SavedGameCorruptException) {
+		Output("simbench: saved game '%s' is corrupt\n", filename.c_str());
+		return false;
+	}
+	catch (SavedGameWrongVersionException) {
+		Output("simbench: saved game '%s' is from a different version\n", filename.c_str());
+		return false;
+	}
+	catch (CouldNotOpenFileException) {
+		Output("simbench: could not open saved game '%s'\n", filename.c_str());
+		return false;
+	}
+	Pi::InitGame();
+	Pi::StartGame();
+	return true;
+}
+
+static double TicksToMs(Uint64 ticks)
+{
+	return double(ticks) * 1000.0 / double(SDL_GetPerformanceFrequency());
+}
+
+bool Run(const std::string &scenario, int ticks, int ships)
+{
+	// the same every time, including anything the Lua modules roll
+	Pi::rng.seed(RNG_SEED);
+
+	bool ok;
+	if (scenario == "station")
+		ok = SetupStation(ships > 0 ? ships : 40);
+	else if (scenario == "battle")
+		ok = SetupBattle(ships > 0 ? ships : 40);
+	else if (scenario == "transit")
+		ok = SetupTransit(ships > 0 ? ships : 20);
+	else
+		ok = LoadGame(scenario);
+	if (!ok)
+		return false;
+
+	Space *space = Pi::game->GetSpace();
+	space->ClearTimeStepStats();
+
+	const unsigned int startBodies = space->GetNumBodies();
+	const double startTime = Pi::game->GetTime();
+
+	std::vector<double> tickMs;
+	tickMs.reserve(ticks);
+
+	Space::TimeStepStats stats;
+	Uint64 totalTicks = 0;
+	int tick = 0;
+	while (tick < ticks) {
+		const Uint64 start = SDL_GetPerformanceCounter();
+		Pi::game->TimeStep(Pi::game->GetTimeStep());
+		const Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+
+		totalTicks += elapsed;
+		tickMs.push_back(TicksToMs(elapsed));
+		tick++;
+
+		// stop at a change of system. the old space (and its phase timings)
+		// is gone
+		if (Pi::game->GetSpace() != space)
+			break;
+		stats = space->GetTimeStepStats();
+	}
+
+	Json::Value out(Json::objectValue);
+	out["scenario"] = scenario;
+	out["ticks"] = tick;
+	out["bodies_start"] = startBodies;
+	out["bodies_end"] = Pi::game->GetSpace()->GetNumBodies();
+	out["sim_seconds"] = Pi::game->GetTime() - startTime;
+
+	std::sort(tickMs.begin(), tickMs.end());
+	const double totalMs = TicksToMs(totalTicks);
+	out["total_ms"] = totalMs;
+	out["tick_ms_mean"] = tick ? totalMs / tick : 0.0;
+	out["tick_ms_p50"] = tickMs.empty() ? 0.0 : tickMs[tickMs.size() / 2];
+	out["tick_ms_p95"] = tickMs.empty() ? 0.0 : tickMs[(tickMs.size() * 95) / 100];
+	out["tick_ms_max"] = tickMs.empty() ? 0.0 : tickMs.back();
+
+	// what Space::TimeStep doesn't account for is the rest of Game::TimeStep
+	// (cockpit, effects, log)
+	Json::Value phases(Json::objectValue);
+	double phaseMs = 0.0;
+	for (int i = 0; i < Space::PHASE_MAX; i++) {
+		const double ms = TicksToMs(stats.ticks[i]);
+		phases[Space::GetTimeStepPhaseName(Space::TimeStepPhase(i))] = ms;
+		phaseMs += ms;
+	}
+	phases["other"] = std::max(0.0, totalMs - phaseMs);
+	out["phases_ms"] = phases;
+
+	Json::FastWriter writer;
+	fputs(writer.write(out).c_str(), stdout);
+	fflush(stdout);
+
+	Pi::EndGame();
+
+	return true;
+}
+
+}
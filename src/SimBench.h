@@ -0,0 +1,31 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef SIMBENCH_H
+#define SIMBENCH_H
+
+#include "libs.h"
+
+// headless simulation benchmark. sets up a scenario (or loads a saved game),
+// runs the game for a fixed number of physics ticks with no rendering or
+// sound, and prints where the time went as a line of JSON.
+//
+// the built-in scenarios are:
+//   station  - ships flying in to dock at a busy station
+//   battle   - two sides of armed ships fighting each other
+//   transit  - ships flying out to a distant planet at high time acceleration
+//
+// anything else is taken as the name of a saved game.
+//
+// Pi::Init must have been called (headless). the RNG is seeded the same
+// every time, so runs of the same scenario are comparable
+
+namespace SimBench {
+	static const int DEFAULT_TICKS = 3600;
+
+	// ships = 0 for the scenario's default. returns false if the scenario
+	// couldn't be set up
+	bool Run(const std::string &scenario, int ticks, int ships);
+}
+
+#endif
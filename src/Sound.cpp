@@ -12,6 +12,8 @@
 #include <vector>
 #include <string>
 #include <cerrno>
+#include <atomic>
+#include <deque>
 #include "Sound.h"
 #include "Body.h"
 #include "Pi.h"
@@ -25,6 +27,22 @@ static const unsigned int BUF_SIZE = 4096;
 static const unsigned int MAX_WAVSTREAMS = 10; //first two are for music
 static const double STREAM_IF_LONGER_THAN = 10.0;
 
+// decoded audio (in samples, not frames) a streaming sound keeps ahead of
+// playback. a callback takes up to BUF_SIZE frames, so this is a few
+// callbacks' worth even for stereo. must be a power of two
+static const Uint32 STREAM_RING_SIZE = 1 << 15;
+// the decoder tops a ring up once there's at least this much room
+static const Uint32 STREAM_DECODE_CHUNK = 4096;
+// how long the decoder sleeps with nothing to do if nobody wakes it
+static const Uint32 DECODER_IDLE_MS = 20;
+
+// sound effects are decoded the first time they're played. once the decoded
+// ones take up more than this, the least recently played are dropped again
+static const size_t DECODED_SAMPLES_LIMIT = 32 * 1024 * 1024;
+
+// interface sounds, decoded at startup so they're never late
+static const char *PRELOAD_SAMPLES[] = { "Click", "OK", "warning" };
+
 class OggFileDataStream {
 public:
 	static const ov_callbacks CALLBACKS;
@@ -160,9 +178,7 @@ eventid BodyMakeNoise(const Body *b, const char *sfx, float vol)
 }
 
 struct SoundEvent {
-	const Sample *sample;
-	OggVorbis_File *oggv; // if sample->buf = 0 then stream this
-	OggFileDataStream ogg_data_stream;
+	Sample *sample;
 	Uint32 buf_pos;
 	float volume[2]; // left and right channels
 	eventid identifier;
@@ -171,11 +187,387 @@ struct SoundEvent {
 	float targetVolume[2];
 	float rateOfChange[2]; // per sample
 	bool ascend[2];
+
+	// waiting for its sample to be loaded
+	bool waiting;
+
+	// when it was started, and whether any of it has been heard yet (for the
+	// latency stats)
+	Uint32 startTicks;
+	bool started;
 };
 
 static std::map<std::string, Sample> sfx_samples;
 struct SoundEvent wavstream[MAX_WAVSTREAMS];
 
+// decoded audio for a streaming event, kept ahead of playback by the decoder
+// thread. the decoder fills the ring and the audio callback empties it
+// without taking a lock: each side only moves its own position. the event it
+// belongs to is set by whoever starts or stops the event (with the audio
+// locked), and the decoder picks that up next time round
+struct StreamBuffer {
+	StreamBuffer() : readPos(0), writePos(0), request(0), ready(0), sample(nullptr), repeat(false), eof(false), current(0), open(false) {}
+
+	Sint16 ring[STREAM_RING_SIZE];
+	std::atomic<Uint32> readPos;  // in samples (not frames), only ever increase
+	std::atomic<Uint32> writePos;
+
+	std::atomic<Uint32> request;  // event that should be playing, 0 for none
+	std::atomic<Uint32> ready;    // event the ring has been set up for
+	std::atomic<const Sample*> sample;
+	std::atomic<bool> repeat;
+	std::atomic<bool> eof;        // reached the end, there'll be no more
+
+	// decoder thread only
+	Uint32 current;
+	bool open;
+	OggVorbis_File oggv;
+	OggFileDataStream data;
+};
+static StreamBuffer streams[MAX_WAVSTREAMS];
+
+static SDL_Thread *decoderThread = nullptr;
+static SDL_sem *decoderWake = nullptr;
+static std::atomic<bool> decoderQuit(false);
+
+// samples waiting for the decoder to load them
+static SDL_mutex *loadLock = nullptr;
+static std::deque<Sample*> loadQueue;
+
+// memory held by decoded samples. with the audio locked
+static size_t decodedBytes = 0;
+
+// only touched from the audio callback, or with the audio locked
+static Stats stats;
+
+static void WakeDecoder()
+{
+	// one pending wakeup is enough
+	if (decoderWake && SDL_SemValue(decoderWake) == 0)
+		SDL_SemPost(decoderWake);
+}
+
+static bool IsStreaming(const SoundEvent *ev)
+{
+	return ev->sample && (ev->sample->state == Sample::STATE_READY) && !ev->sample->buf;
+}
+
+// what loading a sample finds out. filled in without the audio locked
+struct DecodedSample {
+	DecodedSample() : buf(0), buf_len(0), channels(0), upsample(1) {}
+	Uint16 *buf;
+	Uint32 buf_len;
+	Uint32 channels;
+	int upsample;
+};
+
+// reads an ogg's header and, if it's short enough, decodes the whole thing.
+// longer ones are streamed when they're played
+static bool DecodeSample(const std::string &path, DecodedSample &decoded)
+{
+	OggVorbis_File oggv;
+
+	RefCountedPtr<FileSystem::FileData> oggdata = FileSystem::gameDataFiles.ReadFile(path);
+	if (!oggdata) {
+		Output("Could not read '%s'\n", path.c_str());
+		return false;
+	}
+	OggFileDataStream datastream(oggdata);
+	oggdata.Reset();
+	if (ov_open_callbacks(&datastream, &oggv, 0, 0, OggFileDataStream::CALLBACKS) < 0) {
+		Output("Vorbis could not understand '%s'\n", path.c_str());
+		return false;
+	}
+	struct vorbis_info *info;
+	info = ov_info(&oggv, -1);
+
+	if ((static_cast<unsigned int>(info->rate) != FREQ) && (static_cast<unsigned int>(info->rate) != (FREQ>>1))) {
+		Output("Vorbis file %s is not %dHz or %dHz. Bad!\n", path.c_str(), FREQ, FREQ>>1);
+		ov_clear(&oggv);
+		return false;
+	}
+	if ((info->channels < 1) || (info->channels > 2)) {
+		Output("Vorbis file %s is not mono or stereo. Bad!\n", path.c_str());
+		ov_clear(&oggv);
+		return false;
+	}
+
+	int resample_multiplier = ((info->rate == (FREQ>>1)) ? 2 : 1);
+	const Sint64 num_samples = ov_pcm_total(&oggv, -1);
+	// since samples are 16 bits we have:
+
+	decoded.buf = 0;
+	decoded.buf_len = num_samples * info->channels;
+	decoded.channels = info->channels;
+	decoded.upsample = resample_multiplier;
+
+	const float seconds = num_samples/float(info->rate);
+	//Output("%f seconds\n", seconds);
+
+	// immediately decode and store as raw sample if short enough
+	if (seconds < STREAM_IF_LONGER_THAN) {
+		decoded.buf = new Uint16[decoded.buf_len];
+
+		Uint32 i=0;
+		while (i < 2*decoded.buf_len) {
+			int music_section;
+			long amt = ov_read(&oggv, reinterpret_cast<char*>(decoded.buf) + i,
+					2*decoded.buf_len - i, 0, 2, 1, &music_section);
+			if (amt == OV_HOLE) continue;
+			if (amt <= 0) break;
+			i += amt;
+		}
+		// anything it came up short of is silence
+		if (i < 2*decoded.buf_len)
+			memset(reinterpret_cast<char*>(decoded.buf) + i, 0, 2*decoded.buf_len - i);
+	}
+
+	ov_clear(&oggv);
+	return true;
+}
+
+static bool IsSampleInUse(const Sample *sample)
+{
+	for (unsigned int i = 0; i < MAX_WAVSTREAMS; i++) {
+		if (wavstream[i].sample == sample)
+			return true;
+	}
+	return false;
+}
+
+// drop decoded samples, least recently played first, until they fit in the
+// limit. the audio must be locked
+static void EvictSamples()
+{
+	while (decodedBytes > DECODED_SAMPLES_LIMIT) {
+		Sample *oldest = 0;
+		for (std::map<std::string, Sample>::iterator it = sfx_samples.begin(); it != sfx_samples.end(); ++it) {
+			Sample &sample = it->second;
+			if ((sample.state != Sample::STATE_READY) || !sample.buf || sample.pinned || IsSampleInUse(&sample))
+				continue;
+			if (!oldest || (sample.lastUsed < oldest->lastUsed))
+				oldest = &sample;
+		}
+		if (!oldest)
+			break;
+
+		decodedBytes -= oldest->buf_len * sizeof(Uint16);
+		delete[] oldest->buf;
+		oldest->buf = 0;
+		oldest->state = Sample::STATE_UNLOADED;
+		stats.evictions++;
+	}
+}
+
+// make a loaded sample available to play. the audio must be locked
+static void PublishSample(Sample &sample, const DecodedSample &decoded, bool ok)
+{
+	stats.loads++;
+
+	if (!ok) {
+		sample.state = Sample::STATE_FAILED;
+		return;
+	}
+
+	sample.buf = decoded.buf;
+	sample.buf_len = decoded.buf_len;
+	sample.channels = decoded.channels;
+	sample.upsample = decoded.upsample;
+	sample.state = Sample::STATE_READY;
+
+	if (sample.buf) {
+		decodedBytes += sample.buf_len * sizeof(Uint16);
+		EvictSamples();
+	}
+}
+
+// queue a sample for the decoder to load. the audio must be locked
+static void RequestLoad(Sample *sample)
+{
+	if (sample->state != Sample::STATE_UNLOADED)
+		return;
+	sample->state = Sample::STATE_LOADING;
+
+	SDL_LockMutex(loadLock);
+	loadQueue.push_back(sample);
+	SDL_UnlockMutex(loadLock);
+
+	WakeDecoder();
+}
+
+static void CloseStream(StreamBuffer &sb)
+{
+	if (sb.open) {
+		ov_clear(&sb.oggv);
+		sb.data.Reset();
+		sb.open = false;
+	}
+}
+
+static bool OpenStream(StreamBuffer &sb, const Sample *sample)
+{
+	RefCountedPtr<FileSystem::FileData> oggdata = FileSystem::gameDataFiles.ReadFile(sample->path);
+	if (!oggdata) {
+		Output("Could not open '%s'\n", sample->path.c_str());
+		return false;
+	}
+	sb.data.Reset(oggdata);
+	oggdata.Reset();
+	if (ov_open_callbacks(&sb.data, &sb.oggv, 0, 0, OggFileDataStream::CALLBACKS) < 0) {
+		Output("Vorbis could not understand '%s'\n", sample->path.c_str());
+		sb.data.Reset();
+		return false;
+	}
+	sb.open = true;
+	return true;
+}
+
+// does one step of work on a stream: switching to a new event, or decoding
+// some more into the ring. returns false if there was nothing to do
+static bool DecodeStream(StreamBuffer &sb)
+{
+	const Uint32 id = sb.request.load(std::memory_order_acquire);
+	if (id != sb.current) {
+		// new event in the slot, or the old one was stopped. the callback
+		// won't read from the ring until it's marked ready for its event
+		sb.ready.store(0, std::memory_order_release);
+		CloseStream(sb);
+		sb.current = 0;
+		if (!id)
+			return true;
+
+		const Sample *sample = sb.sample.load(std::memory_order_acquire);
+		// replaced again while we were looking. get it next time
+		if (sb.request.load(std::memory_order_acquire) != id)
+			return true;
+
+		sb.current = id;
+		sb.readPos.store(0, std::memory_order_relaxed);
+		sb.writePos.store(0, std::memory_order_relaxed);
+		// one that won't open just ends straight away
+		sb.eof.store(!OpenStream(sb, sample), std::memory_order_relaxed);
+		sb.ready.store(id, std::memory_order_release);
+	}
+
+	if (!sb.open || sb.eof.load(std::memory_order_relaxed))
+		return false;
+
+	const Uint32 readPos = sb.readPos.load(std::memory_order_acquire);
+	const Uint32 writePos = sb.writePos.load(std::memory_order_relaxed);
+	const Uint32 space = STREAM_RING_SIZE - (writePos - readPos);
+	if (space < STREAM_DECODE_CHUNK)
+		return false;
+
+	// up to the end of the ring. the next call wraps round
+	const Uint32 offset = writePos & (STREAM_RING_SIZE - 1);
+	const Uint32 wanted = std::min(space, STREAM_RING_SIZE - offset);
+
+	int music_section;
+	const long amt = ov_read(&sb.oggv, reinterpret_cast<char*>(&sb.ring[offset]), wanted*2, 0, 2, 1, &music_section);
+	if (amt == OV_HOLE)
+		return true;
+	if (amt <= 0) {
+		if (amt == 0 && sb.repeat.load(std::memory_order_relaxed))
+			ov_pcm_seek(&sb.oggv, 0);
+		else
+			sb.eof.store(true, std::memory_order_release);
+		return true;
+	}
+
+	sb.writePos.store(writePos + Uint32(amt/2), std::memory_order_release);
+	return true;
+}
+
+// loads one sample from the queue. returns false if there weren't any
+static bool LoadNextSample()
+{
+	SDL_LockMutex(loadLock);
+	if (loadQueue.empty()) {
+		SDL_UnlockMutex(loadLock);
+		return false;
+	}
+	Sample *sample = loadQueue.front();
+	loadQueue.pop_front();
+	SDL_UnlockMutex(loadLock);
+
+	// the path never changes once the sample is registered
+	DecodedSample decoded;
+	const bool ok = DecodeSample(sample->path, decoded);
+
+	SDL_LockAudio();
+	PublishSample(*sample, decoded, ok);
+	SDL_UnlockAudio();
+
+	return true;
+}
+
+static int decoder_thread(void *)
+{
+	while (!decoderQuit.load()) {
+		bool busy = false;
+		for (unsigned int i = 0; i < MAX_WAVSTREAMS; i++)
+			busy = DecodeStream(streams[i]) || busy;
+
+		// streams first, they're already playing
+		busy = LoadNextSample() || busy;
+
+		// the callback wakes us when it's taken some
+		if (!busy)
+			SDL_SemWaitTimeout(decoderWake, DECODER_IDLE_MS);
+	}
+
+	for (unsigned int i = 0; i < MAX_WAVSTREAMS; i++) {
+		streams[i].ready.store(0);
+		CloseStream(streams[i]);
+		streams[i].current = 0;
+	}
+
+	return 0;
+}
+
+// starts playing an event whose sample is loaded. the audio must be locked
+// (or it's the callback)
+static void BeginEvent(SoundEvent *ev)
+{
+	ev->waiting = false;
+
+	if (IsStreaming(ev)) {
+		StreamBuffer &sb = streams[ev - wavstream];
+		sb.sample.store(ev->sample, std::memory_order_relaxed);
+		sb.repeat.store((ev->op & OP_REPEAT) != 0, std::memory_order_relaxed);
+		sb.request.store(ev->identifier, std::memory_order_release);
+		WakeDecoder();
+	}
+}
+
+static void StartEvent(SoundEvent *ev)
+{
+	ev->startTicks = SDL_GetTicks();
+	ev->started = false;
+	ev->waiting = false;
+
+	Sample *sample = ev->sample;
+	if (!sample)
+		return;
+	sample->lastUsed = ev->identifier;
+
+	// not loaded yet. the callback starts it once it is
+	if (sample->state != Sample::STATE_READY) {
+		ev->waiting = true;
+		RequestLoad(sample);
+		return;
+	}
+
+	BeginEvent(ev);
+}
+
+static void SetEventOp(SoundEvent *ev, Op op)
+{
+	ev->op = op;
+	if (IsStreaming(ev))
+		streams[ev - wavstream].repeat.store((op & OP_REPEAT) != 0, std::memory_order_relaxed);
+}
+
 static Sample *GetSample(const char *filename)
 {
 	if (sfx_samples.find(filename) != sfx_samples.end()) {
@@ -202,7 +594,7 @@ bool SetOp(eventid id, Op op)
 	SDL_LockAudio();
 	SoundEvent *se = GetEvent(id);
 	if (se) {
-		se->op = op;
+		SetEventOp(se, op);
 		ret = true;
 	}
 	SDL_UnlockAudio();
@@ -211,12 +603,9 @@ bool SetOp(eventid id, Op op)
 
 static void DestroyEvent(SoundEvent *ev)
 {
-	if (ev->oggv) {
-		// streaming ogg
-		ov_clear(ev->oggv);
-		delete ev->oggv;
-		ev->oggv = 0;
-		ev->ogg_data_stream.Reset();
+	if (IsStreaming(ev)) {
+		// the decoder closes it
+		streams[ev - wavstream].request.store(0, std::memory_order_release);
 	}
 	ev->sample = 0;
 }
@@ -246,7 +635,6 @@ eventid PlaySfx (const char *fx, const float volume_left, const float volume_rig
 		DestroyEvent(&wavstream[idx]);
 	}
 	wavstream[idx].sample = GetSample(fx);
-	wavstream[idx].oggv = 0;
 	wavstream[idx].buf_pos = 0;
 	wavstream[idx].volume[0] = volume_left * GetSfxVolume();
 	wavstream[idx].volume[1] = volume_right * GetSfxVolume();
@@ -255,6 +643,7 @@ eventid PlaySfx (const char *fx, const float volume_left, const float volume_rig
 	wavstream[idx].targetVolume[0] = volume_left * GetSfxVolume();
 	wavstream[idx].targetVolume[1] = volume_right * GetSfxVolume();
 	wavstream[idx].rateOfChange[0] = wavstream[idx].rateOfChange[1] = 0.0f;
+	StartEvent(&wavstream[idx]);
 	SDL_UnlockAudio();
 	return identifier++;
 }
@@ -270,7 +659,6 @@ eventid PlayMusic(const char *fx, const float volume_left, const float volume_ri
 	if (wavstream[idx].sample)
 		DestroyEvent(&wavstream[idx]);
 	wavstream[idx].sample = GetSample(fx);
-	wavstream[idx].oggv = 0;
 	wavstream[idx].buf_pos = 0;
 	wavstream[idx].volume[0] = volume_left;
 	wavstream[idx].volume[1] = volume_right;
@@ -279,158 +667,242 @@ eventid PlayMusic(const char *fx, const float volume_left, const float volume_ri
 	wavstream[idx].targetVolume[0] = volume_left; //already scaled in MusicPlayer
 	wavstream[idx].targetVolume[1] = volume_right;
 	wavstream[idx].rateOfChange[0] = wavstream[idx].rateOfChange[1] = 0.0f;
+	StartEvent(&wavstream[idx]);
 	SDL_UnlockAudio();
 	return identifier++;
 }
 
 /*
- * len is the number of floats to put in buffer, NOT full samples (a sample would be 2 floats since stereo)
+ * Copies the next frames of a stream into planar float buffers at the output
+ * rate (so mono is doubled up and 22050Hz samples are repeated). Returns the
+ * number of frames it could provide. That's short when a sample that doesn't
+ * repeat comes to an end (the event is destroyed), or when a streaming event
+ * has run out of decoded audio.
  */
 template <int T_channels, int T_upsample>
-static void fill_audio_1stream(float *buffer, int len, int stream_num)
+static int fetch_1stream(float *left, float *right, int frames, int stream_num)
 {
-	// inbuf will be smaller for mono and for 22050hz samples
-	Sint16 *inbuf = static_cast<Sint16*>(alloca(len*T_channels / T_upsample));
-	// hm pity to put this here ^^ since not used by ev.sample->buf case
 	SoundEvent &ev = wavstream[stream_num];
-	int inbuf_pos = 0;
+	StreamBuffer &sb = streams[stream_num];
+	const bool streaming = IsStreaming(&ev);
+
 	int pos = 0;
-	while ((pos < len) && ev.sample) {
-		if (ev.sample->buf) {
+	while ((pos < frames) && ev.sample) {
+		const Sint16 *inbuf;
+		Uint32 avail;
+		Uint32 readPos = 0;
+
+		if (!streaming) {
 			// already decoded
-			inbuf = reinterpret_cast<Sint16 *>(ev.sample->buf);
-			inbuf_pos = ev.buf_pos;
+			inbuf = reinterpret_cast<const Sint16*>(ev.sample->buf) + ev.buf_pos;
+			avail = ev.sample->buf_len - ev.buf_pos;
 		} else {
-			// stream ogg vorbis
-			// ogg vorbis streaming
-			if (!ev.oggv) {
-				// open file to start streaming
-				ev.oggv = new OggVorbis_File;
-				RefCountedPtr<FileSystem::FileData> oggdata = FileSystem::gameDataFiles.ReadFile(ev.sample->path);
-				if (!oggdata) {
-					Output("Could not open '%s'", ev.sample->path.c_str());
-					ev.sample = 0;
-					return;
-				}
-				ev.ogg_data_stream.Reset(oggdata);
-				oggdata.Reset();
-				if (ov_open_callbacks(&ev.ogg_data_stream, ev.oggv, 0, 0, OggFileDataStream::CALLBACKS) < 0) {
-					Output("Vorbis could not understand '%s'", ev.sample->path.c_str());
-					ev.sample = 0;
-					return;
+			// not started yet
+			if (sb.ready.load(std::memory_order_acquire) != ev.identifier)
+				break;
+
+			readPos = sb.readPos.load(std::memory_order_relaxed);
+			const Uint32 filled = sb.writePos.load(std::memory_order_acquire) - readPos;
+			if (!filled) {
+				if (sb.eof.load(std::memory_order_acquire))
+					DestroyEvent(&ev);
+				else {
+					stats.underruns++;
+					stats.underrunFrames += frames - pos;
 				}
+				break;
 			}
-			int i=0;
-			// (len-pos) = num floats the destination buffer wants.
-			// if we are stereo then to fill this we need (len-pos)*2 bytes
-			// if we are mono we want (len-pos) bytes
-			int wanted_bytes = (len-pos)*T_channels / T_upsample;
-			for (;;) {
-				int music_section;
-				if (wanted_bytes == 0) break;
-				int amt = ov_read(ev.oggv, reinterpret_cast<char*>(inbuf) + i,
-						wanted_bytes, 0, 2, 1, &music_section);
-				i += amt;
-				wanted_bytes -= amt;
-				if (amt == 0) break;
-			}
+
+			// up to the end of the ring. the next time round wraps
+			const Uint32 offset = readPos & (STREAM_RING_SIZE - 1);
+			inbuf = &sb.ring[offset];
+			avail = std::min(filled, STREAM_RING_SIZE - offset);
+
 		}
 
-		while (pos < len) {
-			/* Volume animations */
-			for (int chan=0; chan<2; chan++) {
-				if (ev.ascend[chan]) {
-					ev.volume[chan] = std::min(ev.volume[chan] + ev.rateOfChange[chan], ev.targetVolume[chan]);
-				} else {
-					ev.volume[chan] = std::max(ev.volume[chan] - ev.rateOfChange[chan], ev.targetVolume[chan]);
-				}
+		// a frame left over at the end of the buffer still takes a whole
+		// 22050Hz frame (there's room for it)
+		const int wanted = std::max(1, (frames - pos) / T_upsample);
+		const int n = std::min(wanted, int(avail / T_channels));
+
+		for (int i = 0; i < n; i++) {
+			const float s0 = float(inbuf[i*T_channels]);
+			const float s1 = (T_channels == 1) ? s0 : float(inbuf[i*T_channels+1]);
+			for (int j = 0; j < T_upsample; j++) {
+				left[pos + i*T_upsample + j] = s0;
+				right[pos + i*T_upsample + j] = s1;
 			}
+		}
+		pos += n * T_upsample;
 
-			float s0, s1;
-
-			if (T_channels == 1) {
-				s0 = float(inbuf[inbuf_pos++]);
-				s1 = ev.volume[1] * s0;
-				s0 = ev.volume[0] * s0;
-				ev.buf_pos += 1;
-			} else /* stereo */ {
-				s0 = ev.volume[0] * float(inbuf[inbuf_pos++]);
-				s1 = ev.volume[1] * float(inbuf[inbuf_pos++]);
-				ev.buf_pos += 2;
-			}
+		const Uint32 used = n * T_channels;
+		ev.buf_pos += used;
 
-			if (T_upsample == 1) {
-				buffer[pos] += s0;
-				buffer[pos+1] += s1;
-				pos += 2;
-			} else {
-				buffer[pos] += s0;
-				buffer[pos+1] += s1;
-				buffer[pos+2] += s0;
-				buffer[pos+3] += s1;
-				pos += 4;
+		if (streaming) {
+			sb.readPos.store(readPos + used, std::memory_order_release);
+		}
+		/* Repeat or end? */
+		else if (ev.buf_pos >= ev.sample->buf_len) {
+			ev.buf_pos = 0;
+			if (!(ev.op & OP_REPEAT)) {
+				DestroyEvent(&ev);
+				break;
 			}
+		}
+	}
 
-			/* Repeat or end? */
-			if (ev.buf_pos >= ev.sample->buf_len) {
-				ev.buf_pos = 0;
-				inbuf_pos = 0;
-				if (!(ev.op & OP_REPEAT)) {
-					DestroyEvent(&ev);
-					break;
-				}
-				if (ev.oggv) {
-					// streaming ogg
-					ov_pcm_seek(ev.oggv, 0);
-					// repeat outer loop to decode some
-					// more vorbis from the start of the stream
-					break;
-				}
-			}
+	return std::min(pos, frames);
+}
+
+/*
+ * Adds one channel of a stream into the mix, moving its volume towards the
+ * target at its rate of change (per output frame) on the way. Done as the
+ * part that's still ramping and the part that's at a steady volume, both
+ * plain loops over contiguous floats that the compiler can vectorise.
+ */
+static void mix_channel(float * __restrict mix, const float * __restrict src, int frames, float &volume, float target, float rate, bool ascend)
+{
+	const float v0 = volume;
+	int ramp = 0;
+
+	if (v0 != target && rate > 0.0f) {
+		const float steps = ceilf(fabsf(target - v0) / rate);
+		ramp = int(std::min(steps, float(frames)));
+
+		const float step = ascend ? rate : -rate;
+		if (ascend) {
+			for (int i = 0; i < ramp; i++)
+				mix[i] += src[i] * std::min(v0 + step * float(i+1), target);
+		} else {
+			for (int i = 0; i < ramp; i++)
+				mix[i] += src[i] * std::max(v0 + step * float(i+1), target);
 		}
+
+		if (float(ramp) >= steps)
+			volume = target;
+		else
+			volume = ascend ? std::min(v0 + step * float(ramp), target) : std::max(v0 + step * float(ramp), target);
 	}
+
+	const float v = volume;
+	for (int i = ramp; i < frames; i++)
+		mix[i] += src[i] * v;
 }
 
 static void fill_audio(void *udata, Uint8 *dsp_buf, int len)
 {
-	const int len_in_floats = len>>1;
-	float *tmpbuf = static_cast<float*>(alloca(sizeof(float)*len_in_floats)); // len is in chars not samples
-	memset(static_cast<void*>(tmpbuf), 0, sizeof(float)*len_in_floats);
+	const Uint64 start = SDL_GetPerformanceCounter();
+
+	// len is in bytes, stereo Sint16
+	const int frames = len / int(2*sizeof(Sint16));
+
+	// planar mix and source buffers. the source ones get one spare frame
+	// for a 22050Hz frame that doesn't fit evenly (see fetch_1stream)
+	float *mix[2], *src[2];
+	for (int c = 0; c < 2; c++) {
+		mix[c] = static_cast<float*>(alloca(sizeof(float)*frames));
+		src[c] = static_cast<float*>(alloca(sizeof(float)*(frames+1)));
+		memset(static_cast<void*>(mix[c]), 0, sizeof(float)*frames);
+	}
+
+	float minBuffered = -1.0f;
 
 	for (unsigned int i = 0; i < MAX_WAVSTREAMS; i++) {
-		if (!wavstream[i].sample) continue;
+		SoundEvent &ev = wavstream[i];
+		if (!ev.sample) continue;
 
-		wavstream[i].ascend[0] = (wavstream[i].targetVolume[0] > wavstream[i].volume[0]);
-		wavstream[i].ascend[1] = (wavstream[i].targetVolume[1] > wavstream[i].volume[1]);
+		if (ev.waiting) {
+			if (ev.sample->state == Sample::STATE_READY) {
+				BeginEvent(&ev);
+			} else {
+				// couldn't be loaded
+				if (ev.sample->state == Sample::STATE_FAILED)
+					DestroyEvent(&ev);
+				continue;
+			}
+		}
 
-		if (wavstream[i].op & OP_STOP_AT_TARGET_VOLUME) {
-			if ((wavstream[i].targetVolume[0] <= wavstream[i].volume[0]) &&
-			    (wavstream[i].targetVolume[1] <= wavstream[i].volume[1])) {
-				DestroyEvent(&wavstream[i]);
+		ev.ascend[0] = (ev.targetVolume[0] > ev.volume[0]);
+		ev.ascend[1] = (ev.targetVolume[1] > ev.volume[1]);
+
+		if (ev.op & OP_STOP_AT_TARGET_VOLUME) {
+			if ((ev.targetVolume[0] <= ev.volume[0]) &&
+			    (ev.targetVolume[1] <= ev.volume[1])) {
+				DestroyEvent(&ev);
 				continue;
 			}
 		}
 
-		if (wavstream[i].sample->channels == 1) {
-			if (wavstream[i].sample->upsample == 1) {
-				fill_audio_1stream<1,1>(tmpbuf, len_in_floats, i);
+		const Uint32 channels = ev.sample->channels;
+		const int upsample = ev.sample->upsample;
+		const bool streaming = IsStreaming(&ev);
+
+		int got;
+		if (channels == 1) {
+			if (upsample == 1) {
+				got = fetch_1stream<1,1>(src[0], src[1], frames, i);
 			} else {
-				fill_audio_1stream<1,2>(tmpbuf, len_in_floats, i);
+				got = fetch_1stream<1,2>(src[0], src[1], frames, i);
 			}
 		} else {
-			if (wavstream[i].sample->upsample == 1) {
-				fill_audio_1stream<2,1>(tmpbuf, len_in_floats, i);
+			if (upsample == 1) {
+				got = fetch_1stream<2,1>(src[0], src[1], frames, i);
 			} else {
-				fill_audio_1stream<2,2>(tmpbuf, len_in_floats, i);
+				got = fetch_1stream<2,2>(src[0], src[1], frames, i);
 			}
 		}
+
+		if (got && !ev.started) {
+			stats.maxStartLatency = std::max(stats.maxStartLatency, SDL_GetTicks() - ev.startTicks);
+			ev.started = true;
+		}
+
+		for (int c = 0; c < 2; c++)
+			mix_channel(mix[c], src[c], got, ev.volume[c], ev.targetVolume[c], ev.rateOfChange[c], ev.ascend[c]);
+
+		// how far ahead of playback the decoder is
+		if (streaming && ev.sample && ev.started) {
+			const StreamBuffer &sb = streams[i];
+			const Uint32 filled = sb.writePos.load(std::memory_order_relaxed) - sb.readPos.load(std::memory_order_relaxed);
+			const float ms = 1000.0f * float(filled / channels) * float(upsample) / float(FREQ);
+			minBuffered = (minBuffered < 0.0f) ? ms : std::min(minBuffered, ms);
+		}
 	}
 
+	// the decoder can top up whatever we've taken
+	WakeDecoder();
+
 	/* Convert float sample buffer to Sint16 samples the hardware likes */
-	for (int pos=0; pos<len_in_floats; pos++) {
-		const float val = m_masterVol * tmpbuf[pos];
-		(reinterpret_cast<Sint16*>(dsp_buf))[pos] = Sint16(Clamp(val, -32768.0f, 32767.0f));
+	Sint16 *out = reinterpret_cast<Sint16*>(dsp_buf);
+	const float masterVol = m_masterVol;
+	for (int pos = 0; pos < frames; pos++) {
+		out[pos*2]   = Sint16(Clamp(masterVol * mix[0][pos], -32768.0f, 32767.0f));
+		out[pos*2+1] = Sint16(Clamp(masterVol * mix[1][pos], -32768.0f, 32767.0f));
 	}
+
+	const double mixTimeMs = double(SDL_GetPerformanceCounter() - start) * 1000.0 / double(SDL_GetPerformanceFrequency());
+
+	stats.callbacks++;
+	stats.mixTimeMs += mixTimeMs;
+	stats.maxMixTimeMs = std::max(stats.maxMixTimeMs, mixTimeMs);
+	if (minBuffered >= 0.0f)
+		stats.minBufferedMs = (stats.minBufferedMs < 0.0f) ? minBuffered : std::min(stats.minBufferedMs, minBuffered);
+}
+
+Stats GetStats()
+{
+	SDL_LockAudio();
+	Stats s(stats);
+	s.decodedBytes = decodedBytes;
+	SDL_UnlockAudio();
+	return s;
+}
+
+void ClearStats()
+{
+	SDL_LockAudio();
+	stats = Stats();
+	SDL_UnlockAudio();
 }
 
 void DestroyAllEvents()
@@ -443,70 +915,23 @@ void DestroyAllEvents()
 	SDL_UnlockAudio();
 }
 
-static void load_sound(const std::string &basename, const std::string &path, bool is_music)
+// sounds are only registered at startup. they're loaded when they're first
+// played (see StartEvent)
+static void register_sound(const std::string &basename, const std::string &path, bool is_music)
 {
 	if (!ends_with_ci(basename, ".ogg")) return;
 
-	Sample sample;
-	OggVorbis_File oggv;
-
-	RefCountedPtr<FileSystem::FileData> oggdata = FileSystem::gameDataFiles.ReadFile(path);
-	if (!oggdata) {
-		Error("Could not read '%s'", path.c_str());
-	}
-	OggFileDataStream datastream(oggdata);
-	oggdata.Reset();
-	if (ov_open_callbacks(&datastream, &oggv, 0, 0, OggFileDataStream::CALLBACKS) < 0) {
-		Error("Vorbis could not understand '%s'", path.c_str());
-	}
-	struct vorbis_info *info;
-	info = ov_info(&oggv, -1);
-
-	if ((static_cast<unsigned int>(info->rate) != FREQ) && (static_cast<unsigned int>(info->rate) != (FREQ>>1))) {
-		Error("Vorbis file %s is not %dHz or %dHz. Bad!", path.c_str(), FREQ, FREQ>>1);
-	}
-	if ((info->channels < 1) || (info->channels > 2)) {
-		Error("Vorbis file %s is not mono or stereo. Bad!", path.c_str());
-	}
-
-	int resample_multiplier = ((info->rate == (FREQ>>1)) ? 2 : 1);
-	const Sint64 num_samples = ov_pcm_total(&oggv, -1);
-	// since samples are 16 bits we have:
-
-	sample.buf = 0;
-	sample.buf_len = num_samples * info->channels;
-	sample.channels = info->channels;
-	sample.upsample = resample_multiplier;
-	sample.path = path;
-
-	const float seconds = num_samples/float(info->rate);
-	//Output("%f seconds\n", seconds);
-
-	// immediately decode and store as raw sample if short enough
-	if (seconds < STREAM_IF_LONGER_THAN) {
-		sample.buf = new Uint16[sample.buf_len];
-
-		int i=0;
-		for (;;) {
-			int music_section;
-			int amt = ov_read(&oggv, reinterpret_cast<char*>(sample.buf) + i,
-					2*sample.buf_len - i, 0, 2, 1, &music_section);
-			i += amt;
-			if (amt == 0) break;
-		}
-	}
-
+	Sample *sample;
 	if (is_music) {
-		sample.isMusic = true;
 		// music keyed by pathname minus (datapath)/music/ and extension
-		sfx_samples[path.substr(0, path.size() - 4)] = sample;
+		sample = &sfx_samples[path.substr(0, path.size() - 4)];
+		sample->isMusic = true;
 	} else {
-		sample.isMusic = false;
 		// sfx keyed by basename minus the .ogg
-		sfx_samples[basename.substr(0, basename.size()-4)] = sample;
+		sample = &sfx_samples[basename.substr(0, basename.size()-4)];
+		sample->isMusic = false;
 	}
-
-	ov_clear(&oggv);
+	sample->path = path;
 }
 
 bool Init ()
@@ -534,19 +959,48 @@ bool Init ()
 			return false;
 		}
 
-		// load all the wretched effects
+		const double msPerTick = 1000.0 / double(SDL_GetPerformanceFrequency());
+		const Uint64 registerStart = SDL_GetPerformanceCounter();
+
+		// register all the wretched effects
 		for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, "sounds", FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
 			const FileSystem::FileInfo &info = files.Current();
 			assert(info.IsFile());
-			load_sound(info.GetName(), info.GetPath(), false);
+			register_sound(info.GetName(), info.GetPath(), false);
 		}
 
 		//I'd rather do this in MusicPlayer and store in a different map too, this will do for now
 		for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, "music", FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
 			const FileSystem::FileInfo &info = files.Current();
 			assert(info.IsFile());
-			load_sound(info.GetName(), info.GetPath(), true);
+			register_sound(info.GetName(), info.GetPath(), true);
 		}
+
+		const Uint64 preloadStart = SDL_GetPerformanceCounter();
+
+		// the interface sounds are wanted straight away, and are never dropped
+		for (unsigned int i = 0; i < COUNTOF(PRELOAD_SAMPLES); i++) {
+			Sample *sample = GetSample(PRELOAD_SAMPLES[i]);
+			if (!sample) continue;
+			DecodedSample decoded;
+			const bool ok = DecodeSample(sample->path, decoded);
+			SDL_LockAudio();
+			sample->pinned = true;
+			PublishSample(*sample, decoded, ok);
+			SDL_UnlockAudio();
+		}
+
+		const Uint64 preloadEnd = SDL_GetPerformanceCounter();
+		Output("Sound::Init: %u sounds registered in %.3lf ms, %u preloaded in %.3lf ms\n",
+			Uint32(sfx_samples.size()), double(preloadStart - registerStart) * msPerTick,
+			Uint32(COUNTOF(PRELOAD_SAMPLES)), double(preloadEnd - preloadStart) * msPerTick);
+
+		// long samples and music are decoded ahead of playback, and
+		// everything else loaded on first use, away from the audio callback
+		decoderQuit = false;
+		decoderWake = SDL_CreateSemaphore(0);
+		loadLock = SDL_CreateMutex();
+		decoderThread = SDL_CreateThread(&decoder_thread, "SoundDecoder", 0);
 	}
 
 	/* silence any sound events */
@@ -558,6 +1012,17 @@ bool Init ()
 void Uninit ()
 {
 	DestroyAllEvents();
+	if (decoderThread) {
+		decoderQuit = true;
+		SDL_SemPost(decoderWake);
+		SDL_WaitThread(decoderThread, 0);
+		SDL_DestroySemaphore(decoderWake);
+		SDL_DestroyMutex(loadLock);
+		decoderThread = nullptr;
+		decoderWake = nullptr;
+		loadLock = nullptr;
+		loadQueue.clear();
+	}
 	std::map<std::string, Sample>::iterator i;
 	for (i=sfx_samples.begin(); i!=sfx_samples.end(); ++i) delete[] (*i).second.buf;
 	SDL_CloseAudio ();
@@ -601,7 +1066,7 @@ bool Event::SetOp(Op op) {
 	SDL_LockAudio();
 	SoundEvent *se = GetEvent(eid);
 	if (se) {
-		se->op = op;
+		SetEventOp(se, op);
 		ret = true;
 	}
 	SDL_UnlockAudio();
@@ -19,6 +19,15 @@ enum {
 typedef Uint32 Op;
 
 struct Sample {
+	enum State {
+		STATE_UNLOADED, // registered, but not read yet
+		STATE_LOADING,  // queued for the decoder
+		STATE_READY,
+		STATE_FAILED
+	};
+
+	Sample() : buf(0), buf_len(0), channels(0), upsample(1), isMusic(false), state(STATE_UNLOADED), pinned(false), lastUsed(0) {}
+
 	Uint16 *buf;
 	Uint32 buf_len;
 	Uint32 channels;
@@ -26,6 +35,12 @@ struct Sample {
 	/* if buf is null, this will be path to an ogg we must stream */
 	std::string path;
 	bool isMusic;
+
+	// samples are loaded the first time they're played. buf, buf_len,
+	// channels and upsample are only valid once they're ready
+	State state;
+	bool pinned;     // never unloaded to make room
+	Uint32 lastUsed; // event it was last played by, for unloading the least recently used
 };
 
 class Event {
@@ -69,6 +84,24 @@ void SetSfxVolume(const float vol);
 float GetSfxVolume();
 const std::map<std::string, Sample> & GetSamples();
 
+// how the audio thread is keeping up, for the debug display. gathered since
+// the last ClearStats()
+struct Stats {
+	Stats() : callbacks(0), underruns(0), underrunFrames(0), maxStartLatency(0), minBufferedMs(-1.0f), mixTimeMs(0.0), maxMixTimeMs(0.0), loads(0), evictions(0), decodedBytes(0) {}
+	Uint32 callbacks;
+	Uint32 underruns;       // times a streaming sound ran out of decoded audio
+	Uint32 underrunFrames;  // frames of silence that caused
+	Uint32 maxStartLatency; // longest wait (ms) between starting a sound and hearing it
+	float minBufferedMs;    // least decoded audio a stream had in hand after a callback. -1 if none played
+	double mixTimeMs;       // total time spent in the audio callback
+	double maxMixTimeMs;    // longest single callback
+	Uint32 loads;           // samples loaded on first use
+	Uint32 evictions;       // decoded samples dropped to stay under the limit
+	size_t decodedBytes;    // memory held by decoded samples now
+};
+Stats GetStats();
+void ClearStats();
+
 } /* namespace Sound */
 
 #endif /* __OGGMIX_H */
@@ -18,6 +18,8 @@
 #include "Serializer.h"
 #include "collider/collider.h"
 #include "Missile.h"
+#include "ShipAICmd.h"
+#include "Telemetry.h"
 #include "HyperspaceCloud.h"
 #include "graphics/Graphics.h"
 #include "WorldView.h"
@@ -932,6 +934,26 @@ void Space::CollideFrame(Frame *f)
 		CollideFrame(kid);
 }
 
+const char *Space::GetTimeStepPhaseName(TimeStepPhase phase)
+{
+	static const char *names[PHASE_MAX] = {
+		"collision", "frames", "static_update", "orbit_rails", "timestep_update", "lua", "bodies"
+	};
+	assert(phase < PHASE_MAX);
+	return names[phase];
+}
+
+// charge the time since start to a phase, and start the next one. returns
+// the time charged
+static inline Uint64 EndPhase(Space::TimeStepStats &stats, Space::TimeStepPhase phase, Uint64 &start)
+{
+	const Uint64 now = SDL_GetPerformanceCounter();
+	const Uint64 ticks = now - start;
+	stats.ticks[phase] += ticks;
+	start = now;
+	return ticks;
+}
+
 void Space::TimeStep(float step)
 {
 	PROFILE_SCOPED()
@@ -941,30 +963,41 @@ void Space::TimeStep(float step)
 
 	m_frameIndexValid = m_bodyIndexValid = m_sbodyIndexValid = false;
 
+	Uint64 phaseStart = SDL_GetPerformanceCounter();
+
 	// XXX does not need to be done this often
 	CollideFrame(m_rootFrame.get());
 	for (Body* b : m_bodies)
 		CollideWithTerrain(b);
+	Telemetry::AddTime(Telemetry::COLLISION_TIME, EndPhase(m_timeStepStats, PHASE_COLLISION, phaseStart));
 
 	// update frames of reference
 	for (Body* b : m_bodies)
 		b->UpdateFrame();
+	EndPhase(m_timeStepStats, PHASE_FRAMES, phaseStart);
 
 	// AI acts here, then move all bodies and frames
 	for (Body* b : m_bodies)
 		b->StaticUpdate(step);
+	EndPhase(m_timeStepStats, PHASE_STATIC_UPDATE, phaseStart);
 
 	m_rootFrame->UpdateOrbitRails(m_game->GetTime(), m_game->GetTimeStep());
+	EndPhase(m_timeStepStats, PHASE_ORBIT_RAILS, phaseStart);
 
 	for (Body* b : m_bodies)
 		b->TimeStepUpdate(step);
+	EndPhase(m_timeStepStats, PHASE_TIMESTEP_UPDATE, phaseStart);
 
 	LuaEvent::Emit();
 	Pi::luaTimer->Tick();
+	Telemetry::AddTime(Telemetry::LUA_TIME, EndPhase(m_timeStepStats, PHASE_LUA, phaseStart));
 
 	UpdateBodies();
 
 	m_bodyNearFinder.Prepare();
+	EndPhase(m_timeStepStats, PHASE_BODIES, phaseStart);
+
+	m_timeStepStats.steps++;
 }
 
 void Space::UpdateBodies()
@@ -55,6 +55,26 @@ public:
 
 	void TimeStep(float step);
 
+	// where TimeStep spends its time, for benchmarking
+	enum TimeStepPhase {
+		PHASE_COLLISION,       // body/body and body/terrain
+		PHASE_FRAMES,          // moving bodies between frames
+		PHASE_STATIC_UPDATE,   // AI, controllers, thrusters
+		PHASE_ORBIT_RAILS,
+		PHASE_TIMESTEP_UPDATE, // integrating motion
+		PHASE_LUA,             // queued events and timers
+		PHASE_BODIES,          // removing bodies, rebuilding the near finder
+		PHASE_MAX
+	};
+	struct TimeStepStats {
+		TimeStepStats() : steps(0) { std::fill(ticks, ticks + PHASE_MAX, 0); }
+		Uint32 steps;
+		Uint64 ticks[PHASE_MAX]; // SDL performance counter units
+	};
+	static const char *GetTimeStepPhaseName(TimeStepPhase phase);
+	const TimeStepStats &GetTimeStepStats() const { return m_timeStepStats; }
+	void ClearTimeStepStats() { m_timeStepStats = TimeStepStats(); }
+
 	vector3d GetHyperspaceExitPoint(const SystemPath &source, const SystemPath &dest) const;
 	vector3d GetHyperspaceExitPoint(const SystemPath &source) const {
 		return GetHyperspaceExitPoint(source, m_starSystem->GetPath());
@@ -150,6 +170,8 @@ private:
 
 	BodyNearFinder m_bodyNearFinder;
 
+	TimeStepStats m_timeStepStats;
+
 #ifndef NDEBUG
 	//to check RemoveBody and KillBody are not called from within
 	//the NotifyRemoved callback (#735)
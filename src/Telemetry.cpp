@@ -0,0 +1,241 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "Telemetry.h"
+#include "FileSystem.h"
+#include "json/json.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+namespace Telemetry {
+
+static const char *s_channelNames[CHANNEL_MAX] = {
+	"frame_ms", "render_ms", "physics_ms", "physics_ticks", "collision_ms", "lua_ms",
+	"finish_jobs_ms", "jobs_queued", "jobs_started", "job_wait_ms",
+	"draw_calls", "draw_tris", "buffers_created", "lua_kb"
+};
+
+static bool IsTimeChannel(Channel channel)
+{
+	switch (channel) {
+		case FRAME_TIME: case RENDER_TIME: case PHYSICS_TIME: case COLLISION_TIME:
+		case LUA_TIME: case FINISH_JOBS_TIME: case JOB_WAIT_TIME:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// what the threads add to. each thread has one to itself, on its own cache
+// line, so adding never contends with another thread. threads past the last
+// slot share it, which is still correct, just slower
+struct alignas(64) Slot {
+	std::atomic<Uint64> value[CHANNEL_MAX];
+};
+
+static const Uint32 MAX_SLOTS = 72;
+static Slot s_slots[MAX_SLOTS];
+static std::atomic<Uint32> s_numSlots(0);
+static thread_local Slot *t_slot = nullptr;
+
+static bool s_enabled = false;
+
+// the ring of finished frames
+struct FrameRecord {
+	Uint64 number;
+	float value[CHANNEL_MAX];
+};
+static std::vector<FrameRecord> s_frames;
+static Uint32 s_head = 0;   // where the next frame goes
+static Uint32 s_count = 0;
+static Uint64 s_frameNumber = 0;
+
+// values Set() for the frame being gathered
+static float s_set[CHANNEL_MAX];
+static bool s_isSet[CHANNEL_MAX];
+
+static Uint64 s_lastFrameEnd = 0;
+static double s_msPerTick = 0.0;
+
+static Slot &GetSlot()
+{
+	if (!t_slot) {
+		const Uint32 idx = s_numSlots.fetch_add(1, std::memory_order_relaxed);
+		t_slot = &s_slots[std::min(idx, MAX_SLOTS-1)];
+	}
+	return *t_slot;
+}
+
+void Init(bool enabled, Uint32 frames)
+{
+	s_enabled = enabled && frames > 0;
+	s_frames.clear();
+	s_head = s_count = 0;
+	s_frameNumber = 0;
+	if (!s_enabled)
+		return;
+
+	s_frames.resize(frames);
+	for (Uint32 i = 0; i < MAX_SLOTS; i++)
+		for (int c = 0; c < CHANNEL_MAX; c++)
+			s_slots[i].value[c].store(0, std::memory_order_relaxed);
+	std::fill(s_isSet, s_isSet + CHANNEL_MAX, false);
+	s_msPerTick = 1000.0 / double(SDL_GetPerformanceFrequency());
+	s_lastFrameEnd = SDL_GetPerformanceCounter();
+}
+
+void Uninit()
+{
+	s_enabled = false;
+	std::vector<FrameRecord>().swap(s_frames);
+	s_head = s_count = 0;
+}
+
+bool IsEnabled()
+{
+	return s_enabled;
+}
+
+const char *GetChannelName(Channel channel)
+{
+	assert(channel < CHANNEL_MAX);
+	return s_channelNames[channel];
+}
+
+void AddTime(Channel channel, Uint64 ticks)
+{
+	Add(channel, ticks);
+}
+
+void Add(Channel channel, Uint64 count)
+{
+	if (!s_enabled) return;
+	GetSlot().value[channel].fetch_add(count, std::memory_order_relaxed);
+}
+
+void Set(Channel channel, float value)
+{
+	if (!s_enabled) return;
+	s_set[channel] = value;
+	s_isSet[channel] = true;
+}
+
+void EndFrame()
+{
+	if (!s_enabled) return;
+	PROFILE_SCOPED()
+
+	const Uint64 now = SDL_GetPerformanceCounter();
+
+	// everything added since the last frame. a thread adding as this runs
+	// lands in one frame or the other, never neither
+	Uint64 total[CHANNEL_MAX] = {};
+	const Uint32 numSlots = std::min(s_numSlots.load(std::memory_order_relaxed), MAX_SLOTS);
+	for (Uint32 i = 0; i < numSlots; i++)
+		for (int c = 0; c < CHANNEL_MAX; c++)
+			total[c] += s_slots[i].value[c].exchange(0, std::memory_order_relaxed);
+	total[FRAME_TIME] += now - s_lastFrameEnd;
+	s_lastFrameEnd = now;
+
+	FrameRecord &frame = s_frames[s_head];
+	frame.number = s_frameNumber++;
+	for (int c = 0; c < CHANNEL_MAX; c++) {
+		if (s_isSet[c])
+			frame.value[c] = s_set[c];
+		else if (IsTimeChannel(Channel(c)))
+			frame.value[c] = float(double(total[c]) * s_msPerTick);
+		else
+			frame.value[c] = float(total[c]);
+	}
+	if (!s_isSet[JOB_WAIT_TIME])
+		frame.value[JOB_WAIT_TIME] = total[JOBS_STARTED] ? float(double(total[JOB_WAIT_TIME]) * s_msPerTick / double(total[JOBS_STARTED])) : 0.0f;
+	std::fill(s_isSet, s_isSet + CHANNEL_MAX, false);
+
+	s_head = (s_head + 1) % s_frames.size();
+	if (s_count < s_frames.size())
+		s_count++;
+}
+
+Uint32 GetNumFrames()
+{
+	return s_count;
+}
+
+static const FrameRecord &GetRecord(Uint32 age)
+{
+	assert(age < s_count);
+	return s_frames[(s_head + s_frames.size() - 1 - age) % s_frames.size()];
+}
+
+Uint64 GetFrameNumber(Uint32 age)
+{
+	return GetRecord(age).number;
+}
+
+const float *GetFrame(Uint32 age)
+{
+	return GetRecord(age).value;
+}
+
+static std::string ToCSV()
+{
+	std::string out = "frame";
+	for (int c = 0; c < CHANNEL_MAX; c++) {
+		out += ',';
+		out += s_channelNames[c];
+	}
+	out += '\n';
+
+	char buf[64];
+	for (Uint32 age = s_count; age-- > 0;) {
+		const FrameRecord &frame = GetRecord(age);
+		snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(frame.number));
+		out += buf;
+		for (int c = 0; c < CHANNEL_MAX; c++) {
+			snprintf(buf, sizeof(buf), ",%g", frame.value[c]);
+			out += buf;
+		}
+		out += '\n';
+	}
+	return out;
+}
+
+// one array per channel, which is a lot smaller than an object per frame
+static std::string ToJSON()
+{
+	Json::Value frames(Json::arrayValue);
+	Json::Value channels(Json::objectValue);
+	for (int c = 0; c < CHANNEL_MAX; c++)
+		channels[s_channelNames[c]] = Json::Value(Json::arrayValue);
+
+	for (Uint32 age = s_count; age-- > 0;) {
+		const FrameRecord &frame = GetRecord(age);
+		frames.append(Json::Value(Json::UInt64(frame.number)));
+		for (int c = 0; c < CHANNEL_MAX; c++)
+			channels[s_channelNames[c]].append(frame.value[c]);
+	}
+
+	Json::Value out(Json::objectValue);
+	out["frame"] = frames;
+	out["channels"] = channels;
+
+	Json::FastWriter writer;
+	return writer.write(out);
+}
+
+bool Export(const std::string &filename, Format format)
+{
+	PROFILE_SCOPED()
+
+	const std::string data = format == FORMAT_JSON ? ToJSON() : ToCSV();
+
+	FILE *f = FileSystem::userFiles.OpenWriteStream(filename, FileSystem::FileSourceFS::WRITE_TEXT);
+	if (!f) return false;
+	const bool ok = fwrite(data.data(), data.size(), 1, f) == 1;
+	fclose(f);
+	return ok;
+}
+
+}
@@ -0,0 +1,83 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "libs.h"
+#include <string>
+
+// per-frame telemetry. a handful of numbers (times, counts, memory) are
+// gathered over each frame of the main loop, and the last few thousand
+// frames are kept in a ring buffer for the overlay (Ctrl+T) and for
+// exporting as CSV or JSON (Ctrl+Shift+T, into <user dir>/telemetry).
+//
+// AddTime() and Add() can be called from any thread. each thread gets its
+// own set of atomic counters the first time it adds something, so writers
+// never wait on each other or on the main thread. EndFrame(), on the main
+// thread, takes everything they've added into the frame's record.
+//
+// when it's off, adding is a test of a flag and nothing else
+
+namespace Telemetry {
+	enum Channel {
+		FRAME_TIME,        // ms, end of one frame to the end of the next
+		RENDER_TIME,       // ms, view update and draw to buffer swap
+		PHYSICS_TIME,      // ms, all physics ticks in the frame
+		PHYSICS_TICKS,
+		COLLISION_TIME,    // ms, part of the physics time
+		LUA_TIME,          // ms, events and timers run by the physics ticks
+		FINISH_JOBS_TIME,  // ms, running sync jobs and finishing all jobs
+		JOBS_QUEUED,       // jobs waiting to start at the end of the frame
+		JOBS_STARTED,
+		JOB_WAIT_TIME,     // ms, mean time from queued to started
+		DRAW_CALLS,        // as the renderer counts them
+		DRAW_TRIS,
+		BUFFERS_CREATED,
+		LUA_MEMORY,        // KB
+		CHANNEL_MAX
+	};
+
+	enum Format {
+		FORMAT_CSV,
+		FORMAT_JSON
+	};
+
+	// frames is how many frames to keep
+	void Init(bool enabled, Uint32 frames);
+	void Uninit();
+	bool IsEnabled();
+
+	const char *GetChannelName(Channel channel);
+
+	// any thread. times are in SDL performance counter units
+	void AddTime(Channel channel, Uint64 ticks);
+	void Add(Channel channel, Uint64 count = 1);
+
+	// main thread only. a value for the frame being gathered, instead of
+	// whatever has been added to it
+	void Set(Channel channel, float value);
+
+	// main thread only. closes the frame being gathered and starts the next
+	void EndFrame();
+
+	// frames kept so far, and one of them (0 is the last one ended). the
+	// frame number counts from Init
+	Uint32 GetNumFrames();
+	Uint64 GetFrameNumber(Uint32 age);
+	const float *GetFrame(Uint32 age);
+
+	// every frame kept, oldest first. false if the file couldn't be written
+	bool Export(const std::string &filename, Format format);
+
+	class ScopedTimer {
+	public:
+		ScopedTimer(Channel channel) : m_channel(channel), m_start(IsEnabled() ? SDL_GetPerformanceCounter() : 0) {}
+		~ScopedTimer() { if (m_start) AddTime(m_channel, SDL_GetPerformanceCounter() - m_start); }
+	private:
+		Channel m_channel;
+		Uint64 m_start;
+	};
+}
+
+#endif
@@ -0,0 +1,132 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "TelemetryOverlay.h"
+#include "Telemetry.h"
+#include "gui/Gui.h"
+#include "graphics/Renderer.h"
+#include <cstdio>
+
+static const Uint32 GRAPH_FRAMES = 300;
+static const float GRAPH_WIDTH = 300.0f;
+static const float GRAPH_HEIGHT = 100.0f;
+static const float TEXT_HEIGHT = 100.0f;
+static const float MARGIN = 10.0f;
+
+// the numbers only change twice a second, they can't be read any faster and
+// every new string is a new text buffer
+static const Uint32 TEXT_INTERVAL = 500;
+
+// graphed, and the colour each is graphed in. the text uses the same colours
+static const struct {
+	Telemetry::Channel channel;
+	Color color;
+} s_series[] = {
+	{ Telemetry::FRAME_TIME,       Color(255, 255, 255) },
+	{ Telemetry::RENDER_TIME,      Color(255, 255, 0) },
+	{ Telemetry::PHYSICS_TIME,     Color(0, 255, 0) },
+	{ Telemetry::LUA_TIME,         Color(255, 0, 255) },
+	{ Telemetry::FINISH_JOBS_TIME, Color(0, 255, 255) },
+};
+
+TelemetryOverlay::TelemetryOverlay() :
+	m_lastText(0)
+{
+}
+
+void TelemetryOverlay::UpdateText(Uint32 numFrames)
+{
+	const float *latest = Telemetry::GetFrame(0);
+
+	float avgFrame = 0.0f, maxFrame = 0.0f;
+	for (Uint32 age = 0; age < numFrames; age++) {
+		const float ms = Telemetry::GetFrame(age)[Telemetry::FRAME_TIME];
+		avgFrame += ms;
+		maxFrame = std::max(maxFrame, ms);
+	}
+	avgFrame /= float(numFrames);
+
+	char buf[512];
+	snprintf(buf, sizeof(buf),
+		"#fff%.1f ms/f (avg %.1f, max %.1f)\n"
+		"#ff0render %.1f  #0f0physics %.1f (%d ticks, collision %.1f)\n"
+		"#f0flua %.1f  #0ffjobs %.1f\n"
+		"#fffjobs queued %d, started %d, wait %.2f ms\n"
+		"draw calls %d, tris %d, buffers created %d\n"
+		"lua memory %d KB",
+		latest[Telemetry::FRAME_TIME], avgFrame, maxFrame,
+		latest[Telemetry::RENDER_TIME], latest[Telemetry::PHYSICS_TIME],
+		int(latest[Telemetry::PHYSICS_TICKS]), latest[Telemetry::COLLISION_TIME],
+		latest[Telemetry::LUA_TIME], latest[Telemetry::FINISH_JOBS_TIME],
+		int(latest[Telemetry::JOBS_QUEUED]), int(latest[Telemetry::JOBS_STARTED]), latest[Telemetry::JOB_WAIT_TIME],
+		int(latest[Telemetry::DRAW_CALLS]), int(latest[Telemetry::DRAW_TRIS]), int(latest[Telemetry::BUFFERS_CREATED]),
+		int(latest[Telemetry::LUA_MEMORY]));
+	m_text = buf;
+}
+
+void TelemetryOverlay::Draw()
+{
+	PROFILE_SCOPED()
+
+	const Uint32 numFrames = std::min(Telemetry::GetNumFrames(), GRAPH_FRAMES);
+	if (!numFrames)
+		return;
+
+	Graphics::Renderer *r = Gui::Screen::GetRenderer();
+
+	const float left = float(Gui::Screen::GetWidth()) - GRAPH_WIDTH - MARGIN;
+	const float top = MARGIN;
+	const float bottom = top + GRAPH_HEIGHT;
+
+	if (!m_background)
+		m_background.reset(new Graphics::Drawables::Rect(r, vector2f(left - MARGIN, 0.0f), vector2f(GRAPH_WIDTH + 2.0f*MARGIN, GRAPH_HEIGHT + TEXT_HEIGHT + 2.0f*MARGIN), Color(0, 0, 0, 160), Gui::Screen::alphaBlendState, false));
+	else
+		m_background->Update(vector2f(left - MARGIN, 0.0f), vector2f(GRAPH_WIDTH + 2.0f*MARGIN, GRAPH_HEIGHT + TEXT_HEIGHT + 2.0f*MARGIN), Color(0, 0, 0, 160));
+	m_background->Draw(r);
+
+	// at least down to 30 fps, more if a frame in the graph was longer
+	float scale = 1000.0f / 30.0f;
+	for (Uint32 age = 0; age < numFrames; age++)
+		scale = std::max(scale, Telemetry::GetFrame(age)[Telemetry::FRAME_TIME]);
+	scale = GRAPH_HEIGHT / scale;
+
+	m_vertices.clear();
+	m_colors.clear();
+
+	// 60 and 30 fps
+	const Color grey(128, 128, 128);
+	for (const float ms : { 1000.0f / 60.0f, 1000.0f / 30.0f }) {
+		const float y = bottom - ms * scale;
+		m_vertices.push_back(vector3f(left, y, 0.0f));
+		m_vertices.push_back(vector3f(left + GRAPH_WIDTH, y, 0.0f));
+		m_colors.push_back(grey);
+		m_colors.push_back(grey);
+	}
+
+	// newest on the right
+	const float step = GRAPH_WIDTH / float(GRAPH_FRAMES - 1);
+	for (const auto &series : s_series) {
+		for (Uint32 age = 0; age + 1 < numFrames; age++) {
+			const float x = left + GRAPH_WIDTH - float(age) * step;
+			m_vertices.push_back(vector3f(x, bottom - Telemetry::GetFrame(age)[series.channel] * scale, 0.0f));
+			m_vertices.push_back(vector3f(x - step, bottom - Telemetry::GetFrame(age + 1)[series.channel] * scale, 0.0f));
+			m_colors.push_back(series.color);
+			m_colors.push_back(series.color);
+		}
+	}
+
+	m_lines.SetData(m_vertices.size(), &m_vertices[0], &m_colors[0]);
+	m_lines.Draw(r, Gui::Screen::alphaBlendState);
+
+	const Uint32 now = SDL_GetTicks();
+	if (m_text.empty() || now - m_lastText > TEXT_INTERVAL) {
+		UpdateText(numFrames);
+		m_lastText = now;
+	}
+
+	Graphics::Renderer::MatrixTicket ticket(r, Graphics::MatrixMode::MODELVIEW);
+	r->Translate(left, bottom + MARGIN, 0.0f);
+	Gui::Screen::PushFont("ConsoleFont");
+	Gui::Screen::RenderMarkupBuffer(m_textBuffer, m_text);
+	Gui::Screen::PopFont();
+}
@@ -0,0 +1,37 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef TELEMETRYOVERLAY_H
+#define TELEMETRYOVERLAY_H
+
+#include "libs.h"
+#include "graphics/Drawables.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// graphs the last few seconds of telemetry in the top right corner, frame
+// time against 60 and 30 fps lines with the parts of it that are measured
+// underneath, and the latest numbers below
+
+class TelemetryOverlay {
+public:
+	TelemetryOverlay();
+
+	// in ortho, as the rest of the gui
+	void Draw();
+
+private:
+	void UpdateText(Uint32 numFrames);
+
+	std::unique_ptr<Graphics::Drawables::Rect> m_background;
+	Graphics::Drawables::Lines m_lines;
+	RefCountedPtr<Graphics::VertexBuffer> m_textBuffer;
+	std::vector<vector3f> m_vertices;
+	std::vector<Color> m_colors;
+
+	std::string m_text;
+	Uint32 m_lastText;
+};
+
+#endif
@@ -152,6 +152,30 @@ GeomTree::GeomTree(const int numVerts, const int numTris, const std::vector<vect
 	//Output(" - - GeomTree::GeomTree took: %lf milliseconds\n", timer.millicycles());
 }
 
+// the arrays are stored as raw memory images, so make sure the structs
+// have the layout the files were written with
+static_assert(sizeof(Aabb) == 7 * sizeof(double), "Aabb layout changed");
+static_assert(sizeof(GeomTree::Edge) == 7 * sizeof(Uint32), "GeomTree::Edge layout changed");
+static_assert(sizeof(vector3f) == 3 * sizeof(float), "vector3f layout changed");
+
+template <typename T>
+static void WriteArray(Serializer::Writer &wr, const std::vector<T> &v, int count)
+{
+	assert(count >= 0 && size_t(count) <= v.size());
+	wr.AlignedBlob(count ? &v[0] : nullptr, count * sizeof(T));
+}
+
+template <typename T>
+static void ReadArray(Serializer::Reader &rd, std::vector<T> &v, int count)
+{
+	const ByteRange data = rd.AlignedBlob();
+	if (count < 0 || data.Size() != size_t(count) * sizeof(T))
+		throw SavedGameCorruptException();
+	v.resize(count);
+	if (count)
+		memcpy(&v[0], data.begin, data.Size());
+}
+
 GeomTree::GeomTree(Serializer::Reader &rd)
 {
 	PROFILE_SCOPED()
@@ -165,33 +189,11 @@ GeomTree::GeomTree(Serializer::Reader &rd)
 	m_aabb.radius = rd.Double();
 
 	const Uint32 numAabbs = rd.Int32();
-	m_aabbs.resize(numAabbs);
-	for (Uint32 iAabb = 0; iAabb < numAabbs; ++iAabb) {
-		m_aabbs[iAabb].max = rd.Vector3d();
-		m_aabbs[iAabb].min = rd.Vector3d();
-		m_aabbs[iAabb].radius = rd.Double();
-	}
-
-	m_edges.resize(m_numEdges);
-	for (Sint32 iEdge = 0; iEdge < m_numEdges; ++iEdge) {
-		m_edges[iEdge].Load(rd);
-	}
-
-	m_vertices.resize(m_numVertices);
-	for (Sint32 iVert = 0; iVert < m_numVertices; ++iVert) {
-		m_vertices[iVert] = rd.Vector3f();
-	}
-
-	const int numIndicies(m_numTris * 3);
-	m_indices.resize(numIndicies);
-	for (Sint32 iIndi = 0; iIndi < numIndicies; ++iIndi) {
-		m_indices[iIndi] = rd.Int32();
-	}
-
-	m_triFlags.resize(m_numTris);
-	for (Sint32 iTri = 0; iTri < m_numTris; ++iTri) {
-		m_triFlags[iTri] = rd.Int32();
-	}
+	ReadArray(rd, m_aabbs, numAabbs);
+	ReadArray(rd, m_edges, m_numEdges);
+	ReadArray(rd, m_vertices, m_numVertices);
+	ReadArray(rd, m_indices, m_numTris * 3);
+	ReadArray(rd, m_triFlags, m_numTris);
 
 	// activeTris = tris we are still trying to put into leaves
 	std::vector<int> activeTris;
@@ -331,25 +333,9 @@ void GeomTree::Save(Serializer::Writer &wr) const
 	wr.Double(m_aabb.radius);
 
 	wr.Int32(m_numEdges);
-	for (Sint32 iAabb = 0; iAabb < m_numEdges; ++iAabb) {
-		wr.Vector3d(m_aabbs[iAabb].max);
-		wr.Vector3d(m_aabbs[iAabb].min);
-		wr.Double(m_aabbs[iAabb].radius);
-	}
-
-	for (Sint32 iEdge = 0; iEdge < m_numEdges; ++iEdge) {
-		m_edges[iEdge].Save(wr);
-	}
-
-	for (Sint32 iVert = 0; iVert < m_numVertices; ++iVert) {
-		wr.Vector3f(m_vertices[iVert]);
-	}
-
-	for (Sint32 iIndi = 0; iIndi < (m_numTris * 3); ++iIndi) {
-		wr.Int32(m_indices[iIndi]);
-	}
-
-	for (Sint32 iTri = 0; iTri < m_numTris; ++iTri) {
-		wr.Int32(m_triFlags[iTri]);
-	}
+	WriteArray(wr, m_aabbs, m_numEdges);
+	WriteArray(wr, m_edges, m_numEdges);
+	WriteArray(wr, m_vertices, m_numVertices);
+	WriteArray(wr, m_indices, m_numTris * 3);
+	WriteArray(wr, m_triFlags, m_numTris);
 }
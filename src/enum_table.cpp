@@ -12,6 +12,7 @@
 #include "Ship.h"
 #include "ShipType.h"
 #include "galaxy/Economy.h"
+#include "galaxy/RoutePlanner.h"
 #include "galaxy/StarSystem.h"
 #include "gameui/Face.h"
 #include "gameui/LabelOverlay.h"
@@ -194,6 +195,12 @@ const struct EnumItem ENUM_CommodityType[] = {
 	{ 0, 0 },
 };
 
+const struct EnumItem ENUM_RouteMetric[] = {
+	{ "DISTANCE", int(RoutePlanner::METRIC_DISTANCE) },
+	{ "JUMPS", int(RoutePlanner::METRIC_JUMPS) },
+	{ 0, 0 },
+};
+
 const struct EnumItem ENUM_BodyType[] = {
 	{ "GRAVPOINT", int(SystemBody::TYPE_GRAVPOINT) },
 	{ "BROWN_DWARF", int(SystemBody::TYPE_BROWN_DWARF) },
@@ -470,6 +477,7 @@ const struct EnumTable ENUM_TABLES[] = {
 	{ "ShipTypeTag", ENUM_ShipTypeTag },
 	{ "EconType", ENUM_EconType },
 	{ "CommodityType", ENUM_CommodityType },
+	{ "RouteMetric", ENUM_RouteMetric },
 	{ "BodyType", ENUM_BodyType },
 	{ "BodySuperType", ENUM_BodySuperType },
 	{ "GameUIFaceFlags", ENUM_GameUIFaceFlags },
@@ -513,6 +521,7 @@ const struct EnumTable ENUM_TABLES_PUBLIC[] = {
 	{ "ShipTypeTag", ENUM_ShipTypeTag },
 	{ "EconType", ENUM_EconType },
 	{ "CommodityType", ENUM_CommodityType },
+	{ "RouteMetric", ENUM_RouteMetric },
 	{ "BodyType", ENUM_BodyType },
 	{ "BodySuperType", ENUM_BodySuperType },
 	{ "GameUIFaceFlags", ENUM_GameUIFaceFlags },
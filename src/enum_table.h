@@ -25,6 +25,7 @@ extern const struct EnumItem ENUM_DualLaserOrientation[];
 extern const struct EnumItem ENUM_ShipTypeTag[];
 extern const struct EnumItem ENUM_EconType[];
 extern const struct EnumItem ENUM_CommodityType[];
+extern const struct EnumItem ENUM_RouteMetric[];
 extern const struct EnumItem ENUM_BodyType[];
 extern const struct EnumItem ENUM_BodySuperType[];
 extern const struct EnumItem ENUM_GameUIFaceFlags[];
@@ -13,7 +13,8 @@ Galaxy::Galaxy(RefCountedPtr<GalaxyGenerator> galaxyGenerator, float radius, flo
 	const std::string& factionsDir, const std::string& customSysDir)
 	: GALAXY_RADIUS(radius), SOL_OFFSET_X(sol_offset_x), SOL_OFFSET_Y(sol_offset_y),
 	m_initialized(false), m_galaxyGenerator(galaxyGenerator), m_sectorCache(this),
-	m_starSystemCache(this), m_factions(this, factionsDir), m_customSystems(this, customSysDir)
+	m_starSystemCache(this), m_factions(this, factionsDir), m_customSystems(this, customSysDir),
+	m_routePlanner(this)
 {
 }
 
@@ -69,6 +70,7 @@ void Galaxy::Init()
 
 void Galaxy::FlushCaches()
 {
+	m_routePlanner.Clear();
 	m_factions.ClearCache();
 	m_starSystemCache.OutputCacheStatistics();
 	m_starSystemCache.ClearCache();
@@ -77,19 +79,124 @@ void Galaxy::FlushCaches()
 	assert(m_sectorCache.IsEmpty());
 }
 
-void Galaxy::Dump(FILE* file, Sint32 centerX, Sint32 centerY, Sint32 centerZ, Sint32 radius)
+// sectors ordered from the job queue at a time. two windows are in flight,
+// one being written while the next is generated
+static const size_t DUMP_WINDOW_SECTORS = 2048;
+
+namespace {
+	struct DumpWindow {
+		RefCountedPtr<SectorCache::Slave> cache;
+		SectorCache::PathVector paths;
+		bool filled;
+	};
+}
+
+static void WriteCSVString(FILE* file, const std::string& str)
 {
-	for (Sint32 sx = centerX - radius; sx <= centerX + radius; ++sx) {
-		for (Sint32 sy = centerY - radius; sy <= centerY + radius; ++sy) {
-			for (Sint32 sz = centerZ - radius; sz <= centerZ + radius; ++sz) {
-				RefCountedPtr<const Sector> sector = GetSector(SystemPath(sx, sy, sz));
-				sector->Dump(file);
-			}
-			m_starSystemCache.ClearCache();
+	fputc('"', file);
+	for (char c : str) {
+		if (c == '"') fputc('"', file);
+		fputc(c, file);
+	}
+	fputc('"', file);
+}
+
+static void WriteCSVHeader(FILE* file, bool withSystems)
+{
+	fputs("sx,sy,sz,index,name,x,y,z,seed,stars,explored,custom,faction,population", file);
+	if (withSystems)
+		fputs(",bodies,stations,total_population,econ_type,metallicity,industrial,agricultural", file);
+	fputc('\n', file);
+}
+
+static void WriteCSVSector(FILE* file, Galaxy* galaxy, const Sector* sector, bool withSystems)
+{
+	for (const Sector::System& sys : sector->m_systems) {
+		fprintf(file, "%d,%d,%d,%u,", sys.sx, sys.sy, sys.sz, sys.idx);
+		WriteCSVString(file, sys.GetName());
+		fprintf(file, ",%f,%f,%f,%u,%u,%d,%d,", double(sys.GetPosition().x), double(sys.GetPosition().y), double(sys.GetPosition().z),
+			sys.GetSeed(), sys.GetNumStars(), sys.IsExplored() ? 1 : 0, sys.GetCustomSystem() != nullptr ? 1 : 0);
+		WriteCSVString(file, sys.GetFaction() ? sys.GetFaction()->name : "");
+		fprintf(file, ",%.0f", sys.GetPopulation().ToDouble() * 1e9);
+		if (withSystems) {
+			RefCountedPtr<const StarSystem> ssys = galaxy->GetStarSystem(SystemPath(sys.sx, sys.sy, sys.sz, sys.idx));
+			fprintf(file, ",%u,%u,%.0f,%d,%f,%f,%f", ssys->GetNumBodies(), ssys->GetNumSpaceStations(), ssys->GetTotalPop().ToDouble() * 1e9,
+				int(ssys->GetEconType()), ssys->GetMetallicity().ToDouble(), ssys->GetIndustrial().ToDouble(), ssys->GetAgricultural().ToDouble());
 		}
+		fputc('\n', file);
 	}
 }
 
+void Galaxy::Dump(FILE* file, Sint32 centerX, Sint32 centerY, Sint32 centerZ, Sint32 radius, DumpFormat format, bool withSystems)
+{
+	PROFILE_SCOPED()
+
+	const Uint64 freq = SDL_GetPerformanceFrequency();
+	const Uint64 start = SDL_GetPerformanceCounter();
+	Uint64 waitTicks = 0;
+
+	// sectors in x, y, z order, the same as the old nested loops
+	const Uint64 side = Uint64(2 * radius + 1);
+	const Uint64 numSectors = side * side * side;
+	Uint64 nextSector = 0;
+
+	auto order = [&](DumpWindow& w) {
+		w.paths.clear();
+		w.filled = false;
+		for (; nextSector < numSectors && w.paths.size() < DUMP_WINDOW_SECTORS; ++nextSector) {
+			const Sint32 sx = centerX - radius + Sint32(nextSector / (side * side));
+			const Sint32 sy = centerY - radius + Sint32((nextSector / side) % side);
+			const Sint32 sz = centerZ - radius + Sint32(nextSector % side);
+			w.paths.push_back(SystemPath(sx, sy, sz));
+		}
+		if (w.paths.empty())
+			w.filled = true;
+		else
+			w.cache->FillCache(w.paths, [&w]() { w.filled = true; });
+	};
+
+	DumpWindow windows[2];
+	for (DumpWindow& w : windows) {
+		w.cache = m_sectorCache.NewSlaveCache();
+		order(w);
+	}
+
+	if (format == DUMP_CSV)
+		WriteCSVHeader(file, withSystems);
+
+	Uint64 sectors = 0, systems = 0;
+	for (int current = 0; !windows[current].paths.empty(); current ^= 1) {
+		DumpWindow& w = windows[current];
+
+		const Uint64 waitStart = SDL_GetPerformanceCounter();
+		while (!w.filled) {
+			if (!Pi::GetAsyncJobQueue()->FinishJobs())
+				SDL_Delay(1);
+		}
+		waitTicks += SDL_GetPerformanceCounter() - waitStart;
+
+		for (const SystemPath& path : w.paths) {
+			RefCountedPtr<const Sector> sector = w.cache->GetCached(path);
+			if (format == DUMP_CSV)
+				WriteCSVSector(file, this, sector.Get(), withSystems);
+			else
+				sector->Dump(file, "", withSystems);
+			sectors++;
+			systems += sector->m_systems.size();
+		}
+
+		w.cache->ClearCache();
+		m_starSystemCache.ClearCache();
+		order(w);
+	}
+
+	const double seconds = double(SDL_GetPerformanceCounter() - start) / double(freq);
+	const double waitSeconds = double(waitTicks) / double(freq);
+	Output("galaxy dump: %llu sectors, %llu systems in %.2f s (%.0f sectors/s, %.0f systems/s), %.2f s waiting for sectors\n",
+		(unsigned long long)sectors, (unsigned long long)systems, seconds,
+		seconds > 0.0 ? sectors / seconds : 0.0, seconds > 0.0 ? systems / seconds : 0.0, waitSeconds);
+}
+
 RefCountedPtr<GalaxyGenerator> Galaxy::GetGenerator() const
 {
 	return m_galaxyGenerator;
@@ -10,6 +10,7 @@
 #include "Factions.h"
 #include "CustomSystem.h"
 #include "GalaxyCache.h"
+#include "RoutePlanner.h"
 #include "json/json.h"
 
 struct SDL_Surface;
@@ -47,8 +48,19 @@ public:
 	RefCountedPtr<StarSystem> GetStarSystem(const SystemPath& path) { return m_starSystemCache.GetCached(path); }
 	RefCountedPtr<StarSystemCache::Slave> NewStarSystemSlaveCache() { return m_starSystemCache.NewSlaveCache(); }
 
+	RoutePlanner* GetRoutePlanner() { return &m_routePlanner; }
+
 	void FlushCaches();
-	void Dump(FILE* file, Sint32 centerX, Sint32 centerY, Sint32 centerZ, Sint32 radius);
+
+	enum DumpFormat {
+		DUMP_TEXT,  // nested, human readable
+		DUMP_CSV    // one line per system
+	};
+	// sectors are generated in parallel on the async job queue, a window at a
+	// time, and written out in order. star systems can only be generated on
+	// the main thread; without them the dump is much faster
+	void Dump(FILE* file, Sint32 centerX, Sint32 centerY, Sint32 centerZ, Sint32 radius,
+		DumpFormat format = DUMP_TEXT, bool withSystems = true);
 
 	RefCountedPtr<GalaxyGenerator> GetGenerator() const;
 	const std::string& GetGeneratorName() const;
@@ -61,6 +73,7 @@ private:
 	StarSystemCache m_starSystemCache;
 	FactionsDatabase m_factions;
 	CustomSystemsDatabase m_customSystems;
+	RoutePlanner m_routePlanner;
 };
 
 class DensityMapGalaxy : public Galaxy {
@@ -53,6 +53,7 @@ public:
 		void Erase(const typename CacheMap::const_iterator& it);
 		void ClearCache();
 		bool IsEmpty() { return m_cache.empty(); }
+		size_t Size() const { return m_cache.size(); }
 		~Slave();
 
 	private:
@@ -6,12 +6,200 @@
 #include "GalaxyGenerator.h"
 #include "SectorGenerator.h"
 #include "galaxy/StarSystemGenerator.h"
+#include "Factions.h"
+#include "FileSystem.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdio>
 
 static const GalaxyGenerator::Version LAST_VERSION_LEGACY = 1;
 
 std::string GalaxyGenerator::s_defaultGenerator = "legacy";
 GalaxyGenerator::Version GalaxyGenerator::s_defaultVersion = LAST_VERSION_LEGACY;
 RefCountedPtr<Galaxy> GalaxyGenerator::s_galaxy;
+bool GalaxyGenerator::s_systemCacheEnabled = false;
+
+// system cache files live in <user dir>/systemcache/<generator>-<version>-<data
+// hash>/, one per system. bump the version whenever what goes into them changes
+static const Uint32 SYSTEM_CACHE_VERSION = 1;
+static const char SYSTEM_CACHE_DIR[] = "systemcache";
+static const char SYSTEM_CACHE_MAGIC[4] = { 'P', 'S', 'Y', 'S' };
+// trimmed back to this many systems at startup, oldest first
+static const size_t SYSTEM_CACHE_MAX_FILES = 20000;
+
+// what gets generated from, besides the code: custom systems, factions and
+// the Lua that names things. read through gameDataFiles, so a mod that
+// changes or adds to them changes the hash
+static const char *SYSTEM_CACHE_DATA[] = { "systems", "factions", "libs/NameGen.lua" };
+static std::string s_systemCacheKey;
+
+struct SystemCacheHeader {
+	char magic[4];
+	Uint32 version;
+	// names and factions come from Lua and custom systems from data files,
+	// so a system is only good for the build that generated it
+	Uint64 buildHash;
+	// unexplored systems are generated without population, so a system
+	// generated before it was explored is no good afterwards
+	Uint32 explored;
+	double exploredTime;
+	Uint64 dataHash;
+	Uint32 dataSize;
+	// StarSystem::SaveGenerated data follows
+};
+
+// FNV-1a
+static Uint64 Hash(const char *data, size_t size)
+{
+	Uint64 hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= Uint8(data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static Uint64 BuildHash()
+{
+	static const std::string build = std::string(PIONEER_VERSION) + " " + PIONEER_EXTRAVERSION;
+	return Hash(build.c_str(), build.size());
+}
+
+static Uint64 DataHash()
+{
+	PROFILE_SCOPED()
+	std::vector<std::string> paths;
+	for (const char *path : SYSTEM_CACHE_DATA) {
+		const FileSystem::FileInfo info = FileSystem::gameDataFiles.Lookup(path);
+		if (info.IsFile())
+			paths.push_back(path);
+		else if (info.IsDir()) {
+			for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, path, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
+				paths.push_back(files.Current().GetPath());
+		}
+	}
+
+	// a combined hash of the build and each file's path and hash
+	std::string all = std::string(PIONEER_VERSION) + " " + PIONEER_EXTRAVERSION;
+	for (const std::string &path : paths) {
+		RefCountedPtr<FileSystem::FileData> data = FileSystem::gameDataFiles.ReadFile(path);
+		const Uint64 hash = data ? Hash(data->GetData(), data->GetSize()) : 0;
+		all += path;
+		all.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+	}
+	return Hash(all.data(), all.size());
+}
+
+// empties and removes every cache directory that isn't for the current data,
+// then removes the oldest systems from what's left if there are too many
+static void PruneSystemCache()
+{
+	PROFILE_SCOPED()
+	struct CacheFile {
+		std::string path;
+		Time::DateTime modTime;
+		bool operator<(const CacheFile &other) const { return modTime < other.modTime; }
+	};
+	std::vector<CacheFile> kept;
+
+	std::vector<FileSystem::FileInfo> dirs;
+	FileSystem::userFiles.ReadDirectory(SYSTEM_CACHE_DIR, dirs);
+	for (const FileSystem::FileInfo &dir : dirs) {
+		if (!dir.IsDir()) continue;
+		const bool current = ends_with(dir.GetName(), s_systemCacheKey);
+		std::vector<FileSystem::FileInfo> files;
+		FileSystem::userFiles.ReadDirectory(dir.GetPath(), files);
+		for (const FileSystem::FileInfo &file : files) {
+			if (!file.IsFile()) continue;
+			if (current) {
+				CacheFile entry = { file.GetPath(), file.GetModificationTime() };
+				kept.push_back(entry);
+			} else
+				FileSystem::userFiles.RemoveFile(file.GetPath());
+		}
+		if (!current && FileSystem::userFiles.RemoveFile(dir.GetPath()))
+			Output("removed stale system cache %s\n", dir.GetName().c_str());
+	}
+
+	if (kept.size() > SYSTEM_CACHE_MAX_FILES) {
+		std::sort(kept.begin(), kept.end());
+		for (size_t i = 0; i < kept.size() - SYSTEM_CACHE_MAX_FILES; i++)
+			FileSystem::userFiles.RemoveFile(kept[i].path);
+	}
+}
+
+// loads into a system that's just been made. false if there's nothing
+// usable, in which case the system has to be thrown away
+static bool ReadSystemCache(const std::string& cacheName, const Sector::System& secSys, RefCountedPtr<StarSystem::GeneratorAPI> system)
+{
+	PROFILE_SCOPED()
+	RefCountedPtr<FileSystem::FileData> data = FileSystem::userFiles.ReadFile(cacheName);
+	if (!data) return false;
+
+	SystemCacheHeader header;
+	if (data->GetSize() < sizeof(header)) return false;
+	memcpy(&header, data->GetData(), sizeof(header));
+	const char *payload = data->GetData() + sizeof(header);
+	if (memcmp(header.magic, SYSTEM_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+			header.version != SYSTEM_CACHE_VERSION ||
+			header.buildHash != BuildHash() ||
+			header.explored != Uint32(secSys.GetExplored()) ||
+			header.exploredTime != secSys.GetExploredTime() ||
+			header.dataSize != data->GetSize() - sizeof(header) ||
+			header.dataHash != Hash(payload, header.dataSize))
+		return false;
+
+	Serializer::Reader rd(ByteRange(payload, header.dataSize));
+	if (!system->LoadGenerated(rd) || !rd.AtEnd() || !system->GetRootBody())
+		return false;
+
+	// as StarSystemFromSectorGenerator
+	system->SetFaction(system->m_galaxy->GetFactions()->GetNearestFaction(&secSys));
+	system->SetExplored(secSys.GetExplored(), secSys.GetExploredTime());
+	return true;
+}
+
+// safe on a job thread. if two threads write the same system at once the
+// result fails the hash check and is replaced the next time round
+static void WriteSystemCache(const std::string& cacheName, const StarSystem::GeneratorAPI& system)
+{
+	PROFILE_SCOPED()
+	Serializer::Writer wr;
+	system.SaveGenerated(wr);
+	const std::string &payload = wr.GetData();
+
+	SystemCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SYSTEM_CACHE_MAGIC, sizeof(header.magic));
+	header.version = SYSTEM_CACHE_VERSION;
+	header.buildHash = BuildHash();
+	header.explored = system.GetExplored();
+	header.exploredTime = system.GetExploredTime();
+	header.dataHash = Hash(payload.data(), payload.size());
+	header.dataSize = payload.size();
+
+	FileSystem::userFiles.MakeDirectory(cacheName.substr(0, cacheName.rfind('/')));
+	FILE *f = FileSystem::userFiles.OpenWriteStream(cacheName);
+	if (!f) return;
+	const bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(payload.data(), payload.size(), 1, f) == 1;
+	fclose(f);
+	if (!ok)
+		Output("WARNING: couldn't write system cache file '%s'\n", cacheName.c_str());
+}
+
+//static
+void GalaxyGenerator::SetSystemCacheEnabled(bool enabled)
+{
+	s_systemCacheEnabled = enabled;
+	if (enabled) {
+		const Uint64 hash = DataHash();
+		char buf[32];
+		snprintf(buf, sizeof(buf), "-%08x%08x", Uint32(hash >> 32), Uint32(hash));
+		s_systemCacheKey = buf;
+		FileSystem::userFiles.MakeDirectory(SYSTEM_CACHE_DIR);
+		PruneSystemCache();
+	}
+}
 
 //static
 void GalaxyGenerator::Init(const std::string& name, Version version)
@@ -196,10 +384,26 @@ RefCountedPtr<StarSystem> GalaxyGenerator::GenerateStarSystem(RefCountedPtr<Gala
 	std::string name = sec->m_systems[path.systemIndex].GetName();
 	Uint32 _init[6] = { path.systemIndex, Uint32(path.sectorX), Uint32(path.sectorY), Uint32(path.sectorZ), UNIVERSE_SEED, Uint32(seed) };
 	Random rng(_init, 6);
+	std::string cacheName;
+	if (s_systemCacheEnabled) {
+		cacheName = GetSystemCacheName(path);
+		RefCountedPtr<StarSystem::GeneratorAPI> system(new StarSystem::GeneratorAPI(path, galaxy, cache, rng));
+		if (ReadSystemCache(cacheName, sec->m_systems[path.systemIndex], system))
+			return system;
+	}
 	StarSystemConfig config;
 	RefCountedPtr<StarSystem::GeneratorAPI> system(new StarSystem::GeneratorAPI(path, galaxy, cache, rng));
 	for (StarSystemGeneratorStage* sysgen : m_starSystemStage)
 		if (!sysgen->Apply(rng, galaxy, system, &config))
 			break;
+	if (!cacheName.empty())
+		WriteSystemCache(cacheName, *system);
 	return system;
 }
+
+std::string GalaxyGenerator::GetSystemCacheName(const SystemPath& path) const
+{
+	char buf[96];
+	snprintf(buf, sizeof(buf), "-%d%s/%d_%d_%d_%u.sys", m_version, s_systemCacheKey.c_str(), path.sectorX, path.sectorY, path.sectorZ, path.systemIndex);
+	return std::string(SYSTEM_CACHE_DIR) + "/" + FileSystem::SanitiseFileName(m_name) + buf;
+}
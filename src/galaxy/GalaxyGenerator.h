@@ -34,6 +34,13 @@ public:
 	static Version GetDefaultGeneratorVersion() { return s_defaultVersion; }
 	static Version GetLastVersion(const std::string& name);
 
+	// keep each star system in the user dir once it's generated, keyed by
+	// generator, version, the data it's generated from and path, so that a
+	// system that's been seen before (in any game) is loaded instead of
+	// generated again. enabling it clears out systems generated from other
+	// data and trims the rest. Pi enables it unless SystemCache=0
+	static void SetSystemCacheEnabled(bool enabled);
+
 	virtual ~GalaxyGenerator();
 
 	const std::string& GetName() const { return m_name; }
@@ -69,6 +76,8 @@ private:
 	virtual RefCountedPtr<Sector> GenerateSector(RefCountedPtr<Galaxy> galaxy, const SystemPath& path, SectorCache* cache);
 	virtual RefCountedPtr<StarSystem> GenerateStarSystem(RefCountedPtr<Galaxy> galaxy, const SystemPath& path, StarSystemCache* cache);
 
+	std::string GetSystemCacheName(const SystemPath& path) const;
+
 	const std::string m_name;
 	const Version m_version;
 
@@ -78,6 +87,7 @@ private:
 	static RefCountedPtr<Galaxy> s_galaxy;
 	static std::string s_defaultGenerator;
 	static Version s_defaultVersion;
+	static bool s_systemCacheEnabled;
 };
 
 template <>
@@ -0,0 +1,278 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "RoutePlanner.h"
+#include "Galaxy.h"
+#include "Sector.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+// how wide the first corridor is: whichever is more of this many sectors or
+// this many jumps either side of the line
+static const float CORRIDOR_MIN_SECTORS = 2.0f;
+static const float CORRIDOR_MIN_JUMPS = 2.0f;
+
+// for the fewest jumps, distance only breaks ties. small enough that it can't
+// add up to a jump over any route that could be planned
+static const float JUMP_TIEBREAK = 1e-4f;
+
+// give up on a search after this many systems, rather than hang the game
+// looking for a route that isn't there
+static const Uint32 MAX_SEARCH_NODES = 250000;
+
+// longer jumps are planned as if they were this long. the work for each
+// system goes up with the cube of the range, and few drives get near it
+static const float MAX_RANGE = 100.0f;
+
+// past this the graph is thrown away and built up again
+static const size_t MAX_GRAPH_NODES = 2000000;
+
+static const Uint32 NO_NODE = ~Uint32(0);
+
+RoutePlanner::RoutePlanner(Galaxy *galaxy) :
+	m_galaxy(galaxy),
+	m_range(0.0f),
+	m_searchStamp(0)
+{
+}
+
+void RoutePlanner::Clear()
+{
+	m_nodes.clear();
+	m_sectors.clear();
+	m_neighbours.clear();
+	m_hasNeighbours.clear();
+	m_stamp.clear();
+	m_g.clear();
+	m_parent.clear();
+	m_closed.clear();
+	m_searchStamp = 0;
+}
+
+Uint64 RoutePlanner::SectorKey(Sint32 sx, Sint32 sy, Sint32 sz)
+{
+	return (Uint64(Uint32(sx) & 0x1fffff) << 42) | (Uint64(Uint32(sy) & 0x1fffff) << 21) | Uint64(Uint32(sz) & 0x1fffff);
+}
+
+const RoutePlanner::SectorNodes &RoutePlanner::GetSectorNodes(Sint32 sx, Sint32 sy, Sint32 sz)
+{
+	const Uint64 key = SectorKey(sx, sy, sz);
+	auto it = m_sectors.find(key);
+	if (it != m_sectors.end())
+		return it->second;
+
+	RefCountedPtr<const Sector> sec = m_galaxy->GetSector(SystemPath(sx, sy, sz));
+
+	SectorNodes sn;
+	sn.first = m_nodes.size();
+	sn.count = sec->m_systems.size();
+	for (const Sector::System &sys : sec->m_systems) {
+		Node n;
+		n.pos = sys.GetFullPosition();
+		n.sx = sx; n.sy = sy; n.sz = sz;
+		n.idx = sys.idx;
+		m_nodes.push_back(n);
+	}
+
+	return m_sectors.insert(std::make_pair(key, sn)).first->second;
+}
+
+bool RoutePlanner::FindNode(const SystemPath &path, Uint32 &node)
+{
+	const SectorNodes &sn = GetSectorNodes(path.sectorX, path.sectorY, path.sectorZ);
+	if (path.systemIndex >= sn.count)
+		return false;
+	node = sn.first + path.systemIndex;
+	return true;
+}
+
+const std::vector<RoutePlanner::Edge> &RoutePlanner::GetNeighbours(Uint32 node)
+{
+	if (node < m_hasNeighbours.size() && m_hasNeighbours[node])
+		return m_neighbours[node];
+
+	// a copy, the node list grows as sectors are added
+	const Node from = m_nodes[node];
+	const Sint32 reach = Sint32(ceil(m_range / Sector::SIZE));
+	const float rangeSqr = m_range * m_range;
+
+	std::vector<Edge> edges;
+	for (Sint32 dx = -reach; dx <= reach; dx++) {
+		for (Sint32 dy = -reach; dy <= reach; dy++) {
+			for (Sint32 dz = -reach; dz <= reach; dz++) {
+				const Sint32 sx = from.sx + dx, sy = from.sy + dy, sz = from.sz + dz;
+
+				// skip sectors that are entirely out of range, so they don't
+				// have to be generated
+				const vector3f boxMin = Sector::SIZE * vector3f(float(sx), float(sy), float(sz));
+				const vector3f boxMax = boxMin + vector3f(Sector::SIZE);
+				const vector3f nearest(
+					Clamp(from.pos.x, boxMin.x, boxMax.x),
+					Clamp(from.pos.y, boxMin.y, boxMax.y),
+					Clamp(from.pos.z, boxMin.z, boxMax.z));
+				if ((nearest - from.pos).LengthSqr() > rangeSqr)
+					continue;
+
+				const SectorNodes sn = GetSectorNodes(sx, sy, sz);
+				for (Uint32 i = sn.first; i < sn.first + sn.count; i++) {
+					if (i == node) continue;
+					const float distSqr = (m_nodes[i].pos - from.pos).LengthSqr();
+					if (distSqr <= rangeSqr)
+						edges.push_back(Edge(i, sqrtf(distSqr)));
+				}
+			}
+		}
+	}
+
+	if (m_neighbours.size() < m_nodes.size()) {
+		m_neighbours.resize(m_nodes.size());
+		m_hasNeighbours.resize(m_nodes.size(), false);
+	}
+	m_neighbours[node].swap(edges);
+	m_hasNeighbours[node] = true;
+	return m_neighbours[node];
+}
+
+void RoutePlanner::TouchNode(Uint32 node)
+{
+	if (m_stamp.size() < m_nodes.size()) {
+		m_stamp.resize(m_nodes.size(), 0);
+		m_g.resize(m_nodes.size());
+		m_parent.resize(m_nodes.size());
+		m_closed.resize(m_nodes.size());
+	}
+	if (m_stamp[node] == m_searchStamp)
+		return;
+	m_stamp[node] = m_searchStamp;
+	m_g[node] = FLT_MAX;
+	m_parent[node] = NO_NODE;
+	m_closed[node] = false;
+}
+
+bool RoutePlanner::Search(Uint32 start, Uint32 goal, Metric metric, float corridor, std::vector<Uint32> &path)
+{
+	PROFILE_SCOPED()
+
+	m_searchStamp++;
+
+	const vector3f startPos = m_nodes[start].pos;
+	const vector3f goalPos = m_nodes[goal].pos;
+	const vector3f axis = goalPos - startPos;
+	const float axisLenSqr = axis.LengthSqr();
+	const float corridorSqr = corridor * corridor;
+	const float tiebreak = JUMP_TIEBREAK / m_range;
+
+	// straight line distance never overestimates the distance left, and a
+	// jump can cover at most the range
+	auto heuristic = [&](Uint32 n) -> float {
+		const float dist = (goalPos - m_nodes[n].pos).Length();
+		return metric == METRIC_JUMPS ? dist / m_range + dist * tiebreak : dist;
+	};
+	auto cost = [&](float dist) -> float {
+		return metric == METRIC_JUMPS ? 1.0f + dist * tiebreak : dist;
+	};
+	// by sector: the whole sector is in if its centre is close enough to the
+	// line from start to goal
+	auto inCorridor = [&](const Node &n) -> bool {
+		if (corridor <= 0.0f) return true;
+		const vector3f centre = Sector::SIZE * vector3f(n.sx + 0.5f, n.sy + 0.5f, n.sz + 0.5f);
+		const float t = Clamp((centre - startPos).Dot(axis) / axisLenSqr, 0.0f, 1.0f);
+		return (centre - (startPos + axis * t)).LengthSqr() <= corridorSqr;
+	};
+
+	typedef std::pair<float, Uint32> OpenEntry;
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > open;
+
+	TouchNode(start);
+	m_g[start] = 0.0f;
+	open.push(OpenEntry(heuristic(start), start));
+
+	Uint32 expanded = 0;
+	while (!open.empty()) {
+		const Uint32 n = open.top().second;
+		open.pop();
+
+		// the heuristic is consistent, so the first time a node comes off
+		// the queue is the best it'll get
+		if (m_closed[n]) continue;
+		m_closed[n] = true;
+
+		if (n == goal) {
+			path.clear();
+			for (Uint32 i = goal; i != NO_NODE; i = m_parent[i])
+				path.push_back(i);
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		if (++expanded > MAX_SEARCH_NODES)
+			return false;
+
+		const float g = m_g[n];
+		const std::vector<Edge> &edges = GetNeighbours(n);
+		for (const Edge &e : edges) {
+			if (!inCorridor(m_nodes[e.node])) continue;
+			TouchNode(e.node);
+			if (m_closed[e.node]) continue;
+
+			const float ng = g + cost(e.dist);
+			if (ng < m_g[e.node]) {
+				m_g[e.node] = ng;
+				m_parent[e.node] = n;
+				open.push(OpenEntry(ng + heuristic(e.node), e.node));
+			}
+		}
+	}
+
+	return false;
+}
+
+bool RoutePlanner::Plan(const SystemPath &from, const SystemPath &to, float range, Metric metric, std::vector<SystemPath> &route)
+{
+	PROFILE_SCOPED()
+
+	route.clear();
+	if (!from.HasValidSystem() || !to.HasValidSystem() || !std::isfinite(range) || range <= 0.0f)
+		return false;
+	range = std::min(range, MAX_RANGE);
+
+	if (m_nodes.size() > MAX_GRAPH_NODES)
+		Clear();
+
+	if (range != m_range) {
+		m_range = range;
+		m_neighbours.clear();
+		m_hasNeighbours.clear();
+	}
+
+	Uint32 start, goal;
+	if (!FindNode(from, start) || !FindNode(to, goal))
+		return false;
+
+	std::vector<Uint32> path;
+	if (start == goal)
+		path.push_back(start);
+	else {
+		// narrow first, then wider, then anywhere (corridor 0)
+		const float dist = (m_nodes[goal].pos - m_nodes[start].pos).Length();
+		float corridor = std::max(CORRIDOR_MIN_SECTORS * Sector::SIZE, CORRIDOR_MIN_JUMPS * range);
+		while (true) {
+			if (corridor >= dist) corridor = 0.0f;
+			if (Search(start, goal, metric, corridor, path))
+				break;
+			if (corridor == 0.0f)
+				return false;
+			corridor *= 2.0f;
+		}
+	}
+
+	route.reserve(path.size());
+	for (Uint32 i : path) {
+		const Node &n = m_nodes[i];
+		route.push_back(SystemPath(n.sx, n.sy, n.sz, n.idx));
+	}
+	return true;
+}
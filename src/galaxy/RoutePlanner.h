@@ -0,0 +1,93 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef _ROUTEPLANNER_H
+#define _ROUTEPLANNER_H
+
+#include "libs.h"
+#include "galaxy/SystemPath.h"
+#include <unordered_map>
+#include <vector>
+
+class Galaxy;
+
+// plans hyperspace routes between systems, as a series of jumps no longer
+// than the drive's range.
+//
+// the systems are the nodes of a jump graph that's built up as searches need
+// it, a sector at a time, from the sector cache. only positions are kept, and
+// each system's list of systems in range is worked out the first time it's
+// needed and kept until the range changes.
+//
+// the search is A*. for long routes it's first held to a corridor of sectors
+// along the straight line from start to end, widened if there's no route
+// inside it, so it doesn't spread out over every system within the distance
+// of the destination.
+//
+// sectors are generated on the main thread as they're reached, so the first
+// plot across unvisited space is slower than later ones
+
+class RoutePlanner {
+public:
+	enum Metric { // <enum scope='RoutePlanner' name=RouteMetric prefix=METRIC_ public>
+		METRIC_DISTANCE,  // shortest total distance, which is near enough least fuel
+		METRIC_JUMPS      // fewest jumps, shortest of those
+	};
+
+	RoutePlanner(Galaxy *galaxy);
+
+	// route from one system to another in jumps of no more than range
+	// lightyears, capped at 100. the route starts with from and ends with to.
+	// returns false if there's no route, none turned up within a reasonable
+	// search or range isn't a positive number
+	bool Plan(const SystemPath &from, const SystemPath &to, float range, Metric metric, std::vector<SystemPath> &route);
+
+	// forget the jump graph
+	void Clear();
+
+private:
+	struct Node {
+		vector3f pos;   // lightyears, from the galaxy origin
+		Sint32 sx, sy, sz;
+		Uint32 idx;
+	};
+
+	struct Edge {
+		Edge(Uint32 _node, float _dist) : node(_node), dist(_dist) {}
+		Uint32 node;
+		float dist;
+	};
+
+	struct SectorNodes {
+		Uint32 first;
+		Uint32 count;
+	};
+
+	static Uint64 SectorKey(Sint32 sx, Sint32 sy, Sint32 sz);
+	const SectorNodes &GetSectorNodes(Sint32 sx, Sint32 sy, Sint32 sz);
+	bool FindNode(const SystemPath &path, Uint32 &node);
+	const std::vector<Edge> &GetNeighbours(Uint32 node);
+	void TouchNode(Uint32 node);
+
+	bool Search(Uint32 start, Uint32 goal, Metric metric, float corridor, std::vector<Uint32> &path);
+
+	Galaxy *m_galaxy;
+
+	std::vector<Node> m_nodes;
+	std::unordered_map<Uint64, SectorNodes> m_sectors;
+
+	// systems in range of each node, for m_range. empty until asked for
+	float m_range;
+	std::vector<std::vector<Edge> > m_neighbours;
+	std::vector<bool> m_hasNeighbours;
+
+	// per-search state, indexed by node. a node's g and parent are only
+	// valid if its stamp is the current search's
+	Uint32 m_searchStamp;
+	std::vector<Uint32> m_stamp;
+	std::vector<float> m_g;
+	std::vector<Uint32> m_parent;
+	std::vector<bool> m_closed;
+};
+
+#endif
@@ -64,7 +64,7 @@ void Sector::System::SetExplored(StarSystem::ExplorationState e, double time)
 	}
 }
 
-void Sector::Dump(FILE* file, const char* indent) const
+void Sector::Dump(FILE* file, const char* indent, bool withSystems) const
 {
 	fprintf(file, "Sector(%d,%d,%d) {\n", sx, sy, sz);
 	fprintf(file, "\t" SIZET_FMT " systems\n", m_systems.size());
@@ -82,6 +82,10 @@ void Sector::Dump(FILE* file, const char* indent) const
 		for (unsigned i = 0; i < sys.GetNumStars(); ++i)
 			fprintf(file, "\t\t\t%s\n", EnumStrings::GetString("BodyType", sys.GetStarType(i)));
 		if (sys.GetNumStars() > 0) fprintf(file, "\t\t}\n");
+		if (!withSystems) {
+			fprintf(file, "\t}\n");
+			continue;
+		}
 		RefCountedPtr<const StarSystem> ssys = m_galaxy->GetStarSystem(SystemPath(sys.sx, sys.sy, sys.sz, sys.idx));
 		assert(ssys->GetPath().IsSameSystem(SystemPath(sys.sx, sys.sy, sys.sz, sys.idx)));
 		assert(ssys->GetNumStars() == sys.GetNumStars());
@@ -92,7 +92,7 @@ public:
 	std::vector<System> m_systems;
 	const int sx, sy, sz;
 
-	void Dump(FILE* file, const char* indent = "") const;
+	void Dump(FILE* file, const char* indent = "", bool withSystems = true) const;
 
 	sigc::signal<void, Sector::System*, StarSystem::ExplorationState, double> onSetExplorationState;
 
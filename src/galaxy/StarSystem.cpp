@@ -824,12 +824,208 @@ StarSystem::~StarSystem()
 {
 	PROFILE_SCOPED()
 	// clear parent and children pointers. someone (Lua) might still have a
-	// reference to things that are about to be deleted
-	m_rootBody->ClearParentAndChildPointers();
+	// reference to things that are about to be deleted. there's no root if
+	// loading it from the system cache failed
+	if (m_rootBody)
+		m_rootBody->ClearParentAndChildPointers();
 	if (m_cache)
 		m_cache->RemoveFromAttic(m_path);
 }
 
+static const Uint32 NO_BODY = ~Uint32(0);
+
+static void WriteFixed(Serializer::Writer &wr, const fixed &f) { wr.Int64(f.v); }
+static fixed ReadFixed(Serializer::Reader &rd) { return fixed(Sint64(rd.Int64())); }
+
+void StarSystem::SaveGenerated(Serializer::Writer &wr) const
+{
+	PROFILE_SCOPED()
+
+	wr.Int32(m_numStars);
+	wr.String(m_name);
+	wr.String(m_shortDesc);
+	wr.String(m_longDesc);
+	wr.Int32(m_polit.govType);
+	WriteFixed(wr, m_polit.lawlessness);
+	wr.Bool(m_isCustom);
+	wr.Bool(m_hasCustomBodies);
+	WriteFixed(wr, m_metallicity);
+	WriteFixed(wr, m_industrial);
+	wr.Int32(m_econType);
+	wr.Int32(m_seed);
+	for (int i = 0; i < GalacticEconomy::COMMODITY_COUNT; i++)
+		wr.Int32(m_tradeLevel[i]);
+	WriteFixed(wr, m_agricultural);
+	WriteFixed(wr, m_humanProx);
+	WriteFixed(wr, m_totalPop);
+	for (int i = 0; i < GalacticEconomy::COMMODITY_COUNT; i++)
+		wr.Bool(m_commodityLegal[i]);
+
+	wr.Int32(m_bodies.size());
+	for (const RefCountedPtr<SystemBody> &b : m_bodies) {
+		wr.Int32(b->m_parent ? b->m_parent->GetPath().bodyIndex : NO_BODY);
+		wr.Int32(b->m_children.size());
+		for (const SystemBody *kid : b->m_children)
+			wr.Int32(kid->GetPath().bodyIndex);
+		b->m_orbit.Save(wr);
+		wr.Int32(b->m_seed);
+		wr.String(b->m_name);
+		WriteFixed(wr, b->m_radius);
+		WriteFixed(wr, b->m_aspectRatio);
+		WriteFixed(wr, b->m_mass);
+		WriteFixed(wr, b->m_orbMin);
+		WriteFixed(wr, b->m_orbMax);
+		WriteFixed(wr, b->m_rotationPeriod);
+		WriteFixed(wr, b->m_rotationalPhaseAtStart);
+		WriteFixed(wr, b->m_humanActivity);
+		WriteFixed(wr, b->m_semiMajorAxis);
+		WriteFixed(wr, b->m_eccentricity);
+		WriteFixed(wr, b->m_orbitalOffset);
+		WriteFixed(wr, b->m_orbitalPhaseAtStart);
+		WriteFixed(wr, b->m_axialTilt);
+		WriteFixed(wr, b->m_inclination);
+		wr.Int32(b->m_averageTemp);
+		wr.Int32(b->m_type);
+		wr.Bool(b->m_isCustomBody);
+		WriteFixed(wr, b->m_metallicity);
+		WriteFixed(wr, b->m_volatileGas);
+		WriteFixed(wr, b->m_volatileLiquid);
+		WriteFixed(wr, b->m_volatileIces);
+		WriteFixed(wr, b->m_volcanicity);
+		WriteFixed(wr, b->m_atmosOxidizing);
+		WriteFixed(wr, b->m_life);
+		WriteFixed(wr, b->m_rings.minRadius);
+		WriteFixed(wr, b->m_rings.maxRadius);
+		wr.Color4UB(b->m_rings.baseColor);
+		WriteFixed(wr, b->m_population);
+		WriteFixed(wr, b->m_agricultural);
+		wr.String(b->m_heightMapFilename);
+		wr.Int32(b->m_heightMapFractal);
+		wr.Color4UB(b->m_atmosColor);
+		wr.Double(b->m_atmosDensity);
+	}
+
+	wr.Int32(m_rootBody ? m_rootBody->GetPath().bodyIndex : NO_BODY);
+	wr.Int32(m_spaceStations.size());
+	for (const SystemBody *b : m_spaceStations)
+		wr.Int32(b->GetPath().bodyIndex);
+	wr.Int32(m_stars.size());
+	for (const SystemBody *b : m_stars)
+		wr.Int32(b->GetPath().bodyIndex);
+}
+
+bool StarSystem::LoadGenerated(Serializer::Reader &rd)
+{
+	PROFILE_SCOPED()
+	assert(m_bodies.empty());
+
+	m_numStars = rd.Int32();
+	m_name = rd.String();
+	m_shortDesc = rd.String();
+	m_longDesc = rd.String();
+	const Uint32 govType = rd.Int32();
+	if (govType >= Polit::GOV_MAX) return false;
+	m_polit.govType = Polit::GovType(govType);
+	m_polit.lawlessness = ReadFixed(rd);
+	m_isCustom = rd.Bool();
+	m_hasCustomBodies = rd.Bool();
+	m_metallicity = ReadFixed(rd);
+	m_industrial = ReadFixed(rd);
+	m_econType = GalacticEconomy::EconType(rd.Int32());
+	m_seed = rd.Int32();
+	for (int i = 0; i < GalacticEconomy::COMMODITY_COUNT; i++)
+		m_tradeLevel[i] = Sint32(rd.Int32());
+	m_agricultural = ReadFixed(rd);
+	m_humanProx = ReadFixed(rd);
+	m_totalPop = ReadFixed(rd);
+	for (int i = 0; i < GalacticEconomy::COMMODITY_COUNT; i++)
+		m_commodityLegal[i] = rd.Bool();
+
+	// all the bodies first, so parents and children can be linked up as
+	// they're read
+	const Uint32 numBodies = rd.Int32();
+	for (Uint32 i = 0; i < numBodies; i++)
+		NewBody();
+
+	auto getBody = [&](Uint32 idx) -> SystemBody* {
+		return idx < numBodies ? m_bodies[idx].Get() : nullptr;
+	};
+
+	for (const RefCountedPtr<SystemBody> &b : m_bodies) {
+		const Uint32 parent = rd.Int32();
+		if (parent != NO_BODY && !(b->m_parent = getBody(parent))) return false;
+		const Uint32 numChildren = rd.Int32();
+		if (numChildren > numBodies) return false;
+		b->m_children.reserve(numChildren);
+		for (Uint32 i = 0; i < numChildren; i++) {
+			SystemBody *kid = getBody(rd.Int32());
+			if (!kid) return false;
+			b->m_children.push_back(kid);
+		}
+		b->m_orbit.Load(rd);
+		b->m_seed = rd.Int32();
+		b->m_name = rd.String();
+		b->m_radius = ReadFixed(rd);
+		b->m_aspectRatio = ReadFixed(rd);
+		b->m_mass = ReadFixed(rd);
+		b->m_orbMin = ReadFixed(rd);
+		b->m_orbMax = ReadFixed(rd);
+		b->m_rotationPeriod = ReadFixed(rd);
+		b->m_rotationalPhaseAtStart = ReadFixed(rd);
+		b->m_humanActivity = ReadFixed(rd);
+		b->m_semiMajorAxis = ReadFixed(rd);
+		b->m_eccentricity = ReadFixed(rd);
+		b->m_orbitalOffset = ReadFixed(rd);
+		b->m_orbitalPhaseAtStart = ReadFixed(rd);
+		b->m_axialTilt = ReadFixed(rd);
+		b->m_inclination = ReadFixed(rd);
+		b->m_averageTemp = Sint32(rd.Int32());
+		const Uint32 type = rd.Int32();
+		if (type > SystemBody::TYPE_MAX) return false;
+		b->m_type = SystemBody::BodyType(type);
+		b->m_isCustomBody = rd.Bool();
+		b->m_metallicity = ReadFixed(rd);
+		b->m_volatileGas = ReadFixed(rd);
+		b->m_volatileLiquid = ReadFixed(rd);
+		b->m_volatileIces = ReadFixed(rd);
+		b->m_volcanicity = ReadFixed(rd);
+		b->m_atmosOxidizing = ReadFixed(rd);
+		b->m_life = ReadFixed(rd);
+		b->m_rings.minRadius = ReadFixed(rd);
+		b->m_rings.maxRadius = ReadFixed(rd);
+		b->m_rings.baseColor = rd.Color4UB();
+		b->m_population = ReadFixed(rd);
+		b->m_agricultural = ReadFixed(rd);
+		b->m_heightMapFilename = rd.String();
+		b->m_heightMapFractal = rd.Int32();
+		b->m_atmosColor = rd.Color4UB();
+		b->m_atmosDensity = rd.Double();
+	}
+
+	const Uint32 root = rd.Int32();
+	if (root != NO_BODY) {
+		SystemBody *b = getBody(root);
+		if (!b) return false;
+		m_rootBody.Reset(b);
+	}
+	const Uint32 numStations = rd.Int32();
+	if (numStations > numBodies) return false;
+	for (Uint32 i = 0; i < numStations; i++) {
+		SystemBody *b = getBody(rd.Int32());
+		if (!b) return false;
+		m_spaceStations.push_back(b);
+	}
+	const Uint32 numStars = rd.Int32();
+	if (numStars > numBodies) return false;
+	for (Uint32 i = 0; i < numStars; i++) {
+		SystemBody *b = getBody(rd.Int32());
+		if (!b) return false;
+		m_stars.push_back(b);
+	}
+
+	return true;
+}
+
 void StarSystem::ToJson(Json::Value &jsonObj, StarSystem *s)
 {
 	if (s)
@@ -364,6 +364,13 @@ protected:
 	void MakeShortDescription();
 	void SetShortDesc(const std::string& desc) { m_shortDesc = desc; }
 
+	// everything the generator stages made, for the system cache. the faction
+	// isn't included, it has to be looked up again after loading. Load
+	// expects a system with no bodies yet, and returns false if the data
+	// doesn't make sense
+	void SaveGenerated(Serializer::Writer &wr) const;
+	bool LoadGenerated(Serializer::Reader &rd);
+
 private:
 	void SetCache(StarSystemCache* cache) { assert(!m_cache); m_cache = cache; }
 
@@ -438,6 +445,8 @@ public:
 	using StarSystem::NewBody;
 	using StarSystem::MakeShortDescription;
 	using StarSystem::SetShortDesc;
+	using StarSystem::SaveGenerated;
+	using StarSystem::LoadGenerated;
 };
 
 #endif /* _STARSYSTEM_H */
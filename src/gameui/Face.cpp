@@ -59,7 +59,7 @@ void Face::Layout()
 	Widget *innerWidget = GetInnerWidget();
 	if (!innerWidget) return;
 	SetWidgetDimensions(innerWidget, activeOffset, activeArea);
-	innerWidget->Layout();
+	LayoutWidget(innerWidget);
 }
 
 void Face::Draw()
@@ -96,7 +96,7 @@ Face *Face::SetHeightLines(Uint32 lines)
 	const Text::TextureFont *font = GetContext()->GetFont(GetFont()).Get();
 	const float height = font->GetHeight() * lines;
 	m_preferredSize = UI::Point(height * float(FaceParts::FACE_WIDTH) / float(FaceParts::FACE_HEIGHT), height);
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
@@ -35,11 +35,11 @@ GalaxyMap::GalaxyMap(Context *context):
 	m_labelOverlay = new GameUI::LabelOverlay(context);
 	AddLayer(m_labelOverlay);
 
-	GetContext()->RequestLayout();
+	RequestLayout();
 }
 
 UI::Point GalaxyMap::PreferredSize() {
-	return m_baseImage->PreferredSize();
+	return m_baseImage->GetPreferredSize();
 }
 
 void GalaxyMap::Update()
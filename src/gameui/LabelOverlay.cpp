@@ -118,14 +118,15 @@ void LabelOverlay::DrawLabelText(const Marker &m, const vector2f &screen_pos)
 	// Align to pixels (assumes that the rest of the transform stack doesn't
 	// apply any scaling or rotation or non-integer translations...)
 	r->Translate(std::floor(text_pos.x), std::floor(text_pos.y), 0.0f);
-	auto *vb = m_font->GetCachedVertexBuffer(m.text);
+	// the colour is baked into the vertices, so it's part of the cache key
+	auto *vb = m_font->GetCachedVertexBuffer(m.text, m.color);
 	if (vb) {
-		m_font->RenderBuffer(vb);
+		m_font->RenderBuffer(vb, m.color);
 	} else {
 		Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0);
-		m_font->PopulateString(va, m.text, 0.0f, 0.0f, Color::WHITE);
+		m_font->PopulateString(va, m.text, 0.0f, 0.0f, m.color);
 		if (va.GetNumVerts() > 0) {
-			vb = m_font->CreateVertexBuffer(va, m.text, true);
+			vb = m_font->CreateVertexBuffer(va, m.text, true, m.color);
 			m_font->RenderBuffer(vb, m.color);
 		}
 	}
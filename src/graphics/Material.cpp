@@ -18,8 +18,12 @@ Material::Material() :
 	specular(Color::BLACK),
 	emissive(Color::BLACK),
 	shininess(100), //somewhat sharp
+	smoothPatternColors(true),
 	specialParameter0(nullptr)
 {
+	patternColors[0] = Color::RED;
+	patternColors[1] = Color::GREEN;
+	patternColors[2] = Color::BLUE;
 }
 
 MaterialDescriptor::MaterialDescriptor()
@@ -98,6 +98,11 @@ public:
 	Color emissive;
 	int shininess; //specular power 0-128
 
+	//pattern colours (primary, secondary, trim) for materials that use patterns.
+	//set per model instance before drawing, so no per-instance texture is needed
+	Color patternColors[3];
+	bool smoothPatternColors; //blend between colours rather than picking the nearest
+
 	virtual void Apply() { }
 	virtual void Unapply() { }
 	virtual bool IsProgramLoaded() const = 0;
@@ -39,6 +39,12 @@ public:
 		// scenegraph entries
 		STAT_BILLBOARD,
 
+		// camera visibility pass
+		STAT_CULL_TESTED,
+		STAT_CULL_OFFSCREEN,
+		STAT_CULL_HIDDEN,	// too small to see
+		STAT_CULL_VISIBLE,
+
 		MAX_STAT
 	};
 	
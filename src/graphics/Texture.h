@@ -6,6 +6,8 @@
 
 #include "vector2.h"
 #include "RefCounted.h"
+#include <SDL_stdinc.h>
+#include <vector>
 
 namespace Graphics {
 
@@ -99,6 +101,10 @@ public:
 	virtual void SetSampleMode(TextureSampleMode) = 0;
 	virtual void BuildMipmaps() = 0;
 
+	// fetch the texture back as the renderer stores it, if that's compressed.
+	// data is every mip level in turn, the same layout Update takes
+	virtual bool GetCompressedImage(std::vector<Uint8> &data, TextureFormat &format, unsigned int &numMips) { return false; }
+
 	virtual ~Texture() {}
 
 protected:
@@ -7,11 +7,134 @@
 #include <SDL_image.h>
 #include <SDL_rwops.h>
 #include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
 
 // XXX SDL2 can all this be replaced with SDL_GL_BindTexture?
 
 namespace Graphics {
 
+// texture cache files live in <user dir>/texturecache/<source hash>/<options>,
+// so that everything built from one source can be found in one go.
+// bump the version whenever what goes into them changes
+static const Uint32 TEXTURE_CACHE_VERSION = 1;
+static const char TEXTURE_CACHE_DIR[] = "texturecache";
+// trimmed back to this at startup, oldest first
+static const Uint64 TEXTURE_CACHE_BUDGET = 512*1024*1024;
+
+static bool s_cacheEnabled = false;
+static bool s_cacheCompression = false;
+
+struct TextureCacheHeader {
+	char magic[4];
+	Uint32 format;
+	Uint32 width, height;
+	Uint32 virtualWidth, virtualHeight;
+	Uint32 numMips;
+	Uint32 dataSize;
+	// texture data follows, as Texture::Update takes it
+};
+
+static const char TEXTURE_CACHE_MAGIC[4] = { 'P', 'T', 'E', 'X' };
+
+static bool ReadCacheHeader(const FileSystem::FileData &data, TextureCacheHeader &header)
+{
+	if (data.GetSize() < sizeof(header))
+		return false;
+	memcpy(&header, data.GetData(), sizeof(header));
+	if (memcmp(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic)) != 0)
+		return false;
+	switch (header.format) {
+		case TEXTURE_RGB_888: case TEXTURE_RGBA_8888: case TEXTURE_DXT1: case TEXTURE_DXT5: break;
+		default: return false;
+	}
+	return header.width && header.height && header.dataSize == data.GetSize() - sizeof(header);
+}
+
+// FNV-1a
+static Uint64 HashSource(const FileSystem::FileData &data)
+{
+	Uint64 hash = 14695981039346656037ULL;
+	const Uint8 *p = reinterpret_cast<const Uint8*>(data.GetData());
+	for (size_t i = 0; i < data.GetSize(); i++) {
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static std::string GetCacheDir(Uint64 sourceHash)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%s/%08x%08x", TEXTURE_CACHE_DIR, Uint32(sourceHash >> 32), Uint32(sourceHash));
+	return buf;
+}
+
+static void PruneCache()
+{
+	PROFILE_SCOPED()
+	char prefix[16];
+	snprintf(prefix, sizeof(prefix), "v%u-", TEXTURE_CACHE_VERSION);
+
+	struct CacheFile {
+		std::string path;
+		Time::DateTime modTime;
+		Uint64 size;
+		bool operator<(const CacheFile &other) const { return modTime < other.modTime; }
+	};
+	std::vector<CacheFile> files;
+	Uint64 totalSize = 0;
+
+	std::vector<FileSystem::FileInfo> dirs;
+	FileSystem::userFiles.ReadDirectory(TEXTURE_CACHE_DIR, dirs);
+	for (const FileSystem::FileInfo &dir : dirs) {
+		if (!dir.IsDir()) continue;
+		std::vector<FileSystem::FileInfo> entries;
+		FileSystem::userFiles.ReadDirectory(dir.GetPath(), entries);
+		for (const FileSystem::FileInfo &info : entries) {
+			if (!info.IsFile()) continue;
+			// written by another version, so nothing will ever read it
+			if (!starts_with(info.GetName(), prefix)) {
+				FileSystem::userFiles.RemoveFile(info.GetPath());
+				continue;
+			}
+			FILE *f = FileSystem::userFiles.OpenReadStream(info.GetPath());
+			if (!f) continue;
+			fseek(f, 0, SEEK_END);
+			const long size = ftell(f);
+			fclose(f);
+			CacheFile file = { info.GetPath(), info.GetModificationTime(), Uint64(std::max(size, 0L)) };
+			files.push_back(file);
+			totalSize += file.size;
+		}
+	}
+
+	if (totalSize > TEXTURE_CACHE_BUDGET) {
+		std::sort(files.begin(), files.end());
+		for (const CacheFile &file : files) {
+			if (totalSize <= TEXTURE_CACHE_BUDGET) break;
+			if (FileSystem::userFiles.RemoveFile(file.path))
+				totalSize -= file.size;
+		}
+	}
+
+	// only succeeds for the ones that are now empty
+	for (const FileSystem::FileInfo &dir : dirs)
+		if (dir.IsDir()) FileSystem::userFiles.RemoveFile(dir.GetPath());
+}
+
+//static
+void TextureBuilder::SetCacheEnabled(bool enabled, bool useTextureCompression)
+{
+	s_cacheEnabled = enabled;
+	s_cacheCompression = useTextureCompression;
+	if (enabled) {
+		FileSystem::userFiles.MakeDirectory(TEXTURE_CACHE_DIR);
+		PruneCache();
+	}
+}
+
 TextureBuilder::TextureBuilder(const SDLSurfacePtr &surface, TextureSampleMode sampleMode, bool generateMipmaps, bool potExtend, bool forceRGBA, bool compressTextures, bool anisoFiltering) :
     m_surface(surface), m_sampleMode(sampleMode), m_generateMipmaps(generateMipmaps), m_potExtend(potExtend), m_forceRGBA(forceRGBA), m_compressTextures(compressTextures), m_anisotropicFiltering(anisoFiltering), m_textureType(TEXTURE_2D), m_prepared(false)
 {
@@ -98,6 +221,19 @@ void TextureBuilder::PrepareSurface()
 		}
 	}
 
+	if (m_cached) {
+		// built last time, so there's nothing left to do to it
+		TextureCacheHeader header;
+		ReadCacheHeader(*m_cached, header);
+		m_descriptor = TextureDescriptor(
+			TextureFormat(header.format),
+			vector2f(header.width, header.height),
+			vector2f(float(header.virtualWidth)/float(header.width), float(header.virtualHeight)/float(header.height)),
+			m_sampleMode, m_generateMipmaps, m_compressTextures, m_anisotropicFiltering, header.numMips, m_textureType);
+		m_prepared = true;
+		return;
+	}
+
 	TextureFormat targetTextureFormat;
 	unsigned int virtualWidth, actualWidth, virtualHeight, actualHeight, numberOfMipMaps = 0, numberOfImages = 1;
 	if( m_surface ) {
@@ -186,9 +322,100 @@ void TextureBuilder::PrepareSurface()
 	m_prepared = true;
 }
 
+// images decoded ahead of time by Preload, keyed by filename. DDS files are
+// kept as the raw file since DDSImage can't be handed around safely, and
+// reading the header out of it is cheap anyway
+struct PreloadedImage {
+	PreloadedImage() : sourceHash(0), hashed(false) {}
+
+	SDLSurfacePtr surface;
+	RefCountedPtr<FileSystem::FileData> dds;
+
+	// with the texture cache on, the hash of the source file and the names
+	// of everything in the cache that was built from it. usually there's
+	// only the one, in which case it's read here as well
+	Uint64 sourceHash;
+	bool hashed;
+	std::vector<std::string> cachedNames;
+	RefCountedPtr<FileSystem::FileData> cached;
+};
+static std::map<std::string, PreloadedImage> s_preloaded;
+static std::mutex s_preloadLock;
+
+static bool TakePreloaded(const std::string &filename, PreloadedImage &out)
+{
+	std::lock_guard<std::mutex> lock(s_preloadLock);
+	if (s_preloaded.empty()) return false;
+	auto it = s_preloaded.find(filename);
+	if (it == s_preloaded.end()) return false;
+	out = it->second;
+	s_preloaded.erase(it);
+	return true;
+}
+
+// doesn't touch anything but the filesystem, so it's safe on a job thread
+static void LookupCache(const FileSystem::FileData &source, PreloadedImage &img)
+{
+	img.sourceHash = HashSource(source);
+	img.hashed = true;
+
+	std::vector<FileSystem::FileInfo> entries;
+	FileSystem::userFiles.ReadDirectory(GetCacheDir(img.sourceHash), entries);
+	for (const FileSystem::FileInfo &info : entries)
+		if (info.IsFile()) img.cachedNames.push_back(info.GetName());
+	if (img.cachedNames.size() == 1)
+		img.cached = FileSystem::userFiles.ReadFile(GetCacheDir(img.sourceHash) + "/" + img.cachedNames.front());
+}
+
+//static
+void TextureBuilder::Preload(const std::string &filename)
+{
+	PreloadedImage img;
+	if (ends_with_ci(filename, ".dds")) {
+		img.dds = FileSystem::gameDataFiles.ReadFile(filename);
+		if (!img.dds) return;
+	} else if (s_cacheEnabled) {
+		RefCountedPtr<FileSystem::FileData> source = FileSystem::gameDataFiles.ReadFile(filename);
+		if (!source) return;
+		LookupCache(*source, img);
+		// no point decoding it if it's been built before. if it was built
+		// with different options we'll decode it when it's asked for
+		if (img.cachedNames.empty()) {
+			img.surface = LoadSurfaceFromData(filename, *source);
+			if (!img.surface) return;
+		}
+	} else {
+		img.surface = LoadSurfaceFromFile(filename);
+		if (!img.surface) return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_preloadLock);
+	s_preloaded[filename] = img;
+}
+
+//static
+void TextureBuilder::DropPreloaded(const std::vector<std::string> &filenames)
+{
+	std::lock_guard<std::mutex> lock(s_preloadLock);
+	for (const std::string &filename : filenames)
+		s_preloaded.erase(filename);
+}
+
+//static
+size_t TextureBuilder::GetNumPreloaded()
+{
+	std::lock_guard<std::mutex> lock(s_preloadLock);
+	return s_preloaded.size();
+}
+
 static size_t LoadDDSFromFile(const std::string &filename, PicoDDS::DDSImage& dds)
 {
-	RefCountedPtr<FileSystem::FileData> filedata = FileSystem::gameDataFiles.ReadFile(filename);
+	RefCountedPtr<FileSystem::FileData> filedata;
+	PreloadedImage img;
+	if (TakePreloaded(filename, img) && img.dds)
+		filedata = img.dds;
+	else
+		filedata = FileSystem::gameDataFiles.ReadFile(filename);
 	if (!filedata) {
 		Output("LoadDDSFromFile: %s: could not read file\n", filename.c_str());
 		return 0;
@@ -205,7 +432,36 @@ void TextureBuilder::LoadSurface()
 
 	SDLSurfacePtr s;
 	if(m_textureType == TEXTURE_2D) {
-		s = LoadSurfaceFromFile(m_filename);
+		PreloadedImage img;
+		TakePreloaded(m_filename, img);
+		std::string cacheName;
+		if (s_cacheEnabled) {
+			RefCountedPtr<FileSystem::FileData> source;
+			if (!img.hashed) {
+				source = FileSystem::gameDataFiles.ReadFile(m_filename);
+				if (source) LookupCache(*source, img);
+			}
+			if (img.hashed) {
+				const std::string options = GetCacheOptions();
+				cacheName = GetCacheDir(img.sourceHash) + "/" + options;
+				RefCountedPtr<FileSystem::FileData> data;
+				if (std::find(img.cachedNames.begin(), img.cachedNames.end(), options) != img.cachedNames.end())
+					data = img.cachedNames.size() == 1 ? img.cached : FileSystem::userFiles.ReadFile(cacheName);
+				TextureCacheHeader header;
+				if (data && ReadCacheHeader(*data, header)) {
+					m_cached = data;
+					return;
+				}
+			}
+			if (!img.surface && source)
+				img.surface = LoadSurfaceFromData(m_filename, *source);
+		}
+		s = img.surface;
+		if (! s)
+			s = LoadSurfaceFromFile(m_filename);
+		// don't cache the fallback under the name of the real thing
+		if (s)
+			m_cacheName = cacheName;
 		if (! s) { 
 			s = LoadSurfaceFromFile("textures/unknown.png"); 
 		}
@@ -229,8 +485,77 @@ void TextureBuilder::LoadDDS()
 	// XXX if we can't load the fallback texture, then what?
 }
 
+std::string TextureBuilder::GetCacheOptions() const
+{
+	// sampling and filtering don't change the data, so aren't part of it
+	char buf[64];
+	snprintf(buf, sizeof(buf), "v%u-%d%d%d%d.tex", TEXTURE_CACHE_VERSION,
+		int(m_generateMipmaps), int(m_potExtend), int(m_forceRGBA), int(m_compressTextures && s_cacheCompression));
+	return buf;
+}
+
+void TextureBuilder::WriteCache(Texture *texture)
+{
+	PROFILE_SCOPED()
+	assert(m_textureType == TEXTURE_2D);
+
+	// ideally we'd have what the renderer compressed the texture to. if it
+	// didn't, the converted image is still a lot quicker to load than the
+	// original
+	std::vector<Uint8> compressed;
+	TextureFormat format = m_descriptor.format;
+	unsigned int numMips = 0;
+	const void *data;
+	size_t dataSize;
+	if (texture->GetCompressedImage(compressed, format, numMips)) {
+		data = compressed.data();
+		dataSize = compressed.size();
+	} else if (m_surface && m_surface->pitch == m_surface->w * m_surface->format->BytesPerPixel) {
+		data = m_surface->pixels;
+		dataSize = m_surface->pitch * m_surface->h;
+	} else
+		return;
+
+	TextureCacheHeader header;
+	memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+	header.format = format;
+	header.width = m_descriptor.dataSize.x;
+	header.height = m_descriptor.dataSize.y;
+	header.virtualWidth = Uint32(m_descriptor.dataSize.x * m_descriptor.texSize.x + 0.5f);
+	header.virtualHeight = Uint32(m_descriptor.dataSize.y * m_descriptor.texSize.y + 0.5f);
+	header.numMips = numMips;
+	header.dataSize = dataSize;
+
+	FileSystem::userFiles.MakeDirectory(m_cacheName.substr(0, m_cacheName.rfind('/')));
+	FILE *f = FileSystem::userFiles.OpenWriteStream(m_cacheName);
+	if (!f) return;
+	const bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(data, dataSize, 1, f) == 1;
+	fclose(f);
+	// a truncated file fails the size check when it's read back, so it's
+	// harmless to leave it behind
+	if (!ok)
+		Output("WARNING: couldn't write texture cache file for '%s'\n", m_filename.c_str());
+}
+
+Texture *TextureBuilder::CreateTexture(Renderer *r)
+{
+	Texture *t = r->CreateTexture(GetDescriptor());
+	UpdateTexture(t);
+	if (!m_cached && !m_cacheName.empty())
+		WriteCache(t);
+	return t;
+}
+
 void TextureBuilder::UpdateTexture(Texture *texture)
 {
+	if (m_cached) {
+		assert(texture->GetDescriptor().type == TEXTURE_2D);
+		TextureCacheHeader header;
+		ReadCacheHeader(*m_cached, header);
+		texture->Update(m_cached->GetData() + sizeof(header), vector2f(header.width, header.height), TextureFormat(header.format), header.numMips);
+		return;
+	}
+
 	if( m_surface ) {
 		if(texture->GetDescriptor().type == TEXTURE_2D && m_textureType == TEXTURE_2D) {
 			texture->Update(m_surface->pixels, vector2f(m_surface->w,m_surface->h), m_descriptor.format, 0);
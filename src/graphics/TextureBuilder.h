@@ -6,9 +6,11 @@
 
 #include <SDL.h>
 #include <string>
+#include <vector>
 #include "Texture.h"
 #include "Renderer.h"
 #include "SDLWrappers.h"
+#include "FileSystem.h"
 
 #include "PicoDDS/PicoDDS.h"
 
@@ -60,6 +62,22 @@ public:
 	static Texture *GetWhiteTexture(Renderer *);
 	static Texture *GetTransparentTexture(Renderer *);
 
+	// read and decode an image file without touching the renderer, so that it
+	// can be done on a job thread. the next TextureBuilder for the same
+	// filename takes the decoded image instead of loading the file itself.
+	// images that nobody asked for must be dropped again by the preloader
+	static void Preload(const std::string &filename);
+	static void DropPreloaded(const std::vector<std::string> &filenames);
+	static size_t GetNumPreloaded();
+
+	// keep the result of building each texture (converted, mipmapped and
+	// compressed if the renderer does that) in the user dir, keyed by the
+	// source file contents and the builder options, so that next time it can
+	// be uploaded as it is. useTextureCompression is part of the key, since
+	// it changes what the renderer makes of a texture. enabling it also
+	// trims the cache down to size. Pi enables it unless TextureCache=0
+	static void SetCacheEnabled(bool enabled, bool useTextureCompression);
+
 private:
 	SDLSurfacePtr m_surface;
 	std::vector<SDLSurfacePtr> m_cubemap;
@@ -76,18 +94,21 @@ private:
 	TextureType m_textureType;
 
 	TextureDescriptor m_descriptor;
-	
-	Texture *CreateTexture(Renderer *r) {
-		Texture *t = r->CreateTexture(GetDescriptor());
-		UpdateTexture(t);
-		return t;
-	}
+
+	// name of this texture in the texture cache, if it's allowed in there,
+	// and what we found there under that name
+	std::string m_cacheName;
+	RefCountedPtr<FileSystem::FileData> m_cached;
+
+	Texture *CreateTexture(Renderer *r);
 	void UpdateTexture(Texture *texture); // XXX pass src/dest rectangles
 	void PrepareSurface();
 	bool m_prepared;
 
 	void LoadSurface();
 	void LoadDDS();
+	std::string GetCacheOptions() const;
+	void WriteCache(Texture *texture);
 };
 
 }
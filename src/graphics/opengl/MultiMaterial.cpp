@@ -91,6 +91,13 @@ void MultiMaterial::Apply()
 	p->texture5.Set(this->texture5, 5);
 	p->texture6.Set(this->texture6, 6);
 
+	if (m_descriptor.usePatterns) {
+		p->patternColors[0].Set(this->patternColors[0]);
+		p->patternColors[1].Set(this->patternColors[1]);
+		p->patternColors[2].Set(this->patternColors[2]);
+		p->smoothPatternColors.Set(this->smoothPatternColors ? 1 : 0);
+	}
+
 	p->heatGradient.Set(this->heatGradient, 7);
 	if(nullptr!=specialParameter0) {
 		HeatGradientParameters_t *pMGP = static_cast<HeatGradientParameters_t*>(specialParameter0);
@@ -310,6 +310,10 @@ void Program::InitUniforms()
 	heatingMatrix.Init("heatingMatrix", m_program);
 	heatingNormal.Init("heatingNormal", m_program);
 	heatingAmount.Init("heatingAmount", m_program);
+	patternColors[0].Init("patternColors[0]", m_program);
+	patternColors[1].Init("patternColors[1]", m_program);
+	patternColors[2].Init("patternColors[2]", m_program);
+	smoothPatternColors.Init("smoothPatternColors", m_program);
 	sceneAmbient.Init("scene.ambient", m_program);
 }
 
@@ -53,6 +53,8 @@ namespace Graphics {
 			Uniform heatingMatrix;
 			Uniform heatingNormal;
 			Uniform heatingAmount;
+			Uniform patternColors[3];
+			Uniform smoothPatternColors;
 
 			Uniform sceneAmbient;
 
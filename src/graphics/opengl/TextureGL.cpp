@@ -407,4 +407,59 @@ void TextureGL::BuildMipmaps()
 	}
 }
 
+bool TextureGL::GetCompressedImage(std::vector<Uint8> &data, TextureFormat &format, unsigned int &numMips)
+{
+	PROFILE_SCOPED()
+	if (m_target != GL_TEXTURE_2D)
+		return false;
+
+	glBindTexture(m_target, m_texture);
+
+	GLint compressed = GL_FALSE, internalFormat = 0;
+	glGetTexLevelParameteriv(m_target, 0, GL_TEXTURE_COMPRESSED, &compressed);
+	glGetTexLevelParameteriv(m_target, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+	if (compressed == GL_TRUE && internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+		format = TEXTURE_DXT5;
+	else if (compressed == GL_TRUE && internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+		format = TEXTURE_DXT1;
+	else {
+		glBindTexture(m_target, 0);
+		return false;
+	}
+
+	// walk the levels the same way Update does, so that what we hand back
+	// can be given straight to it
+	GLint maxLevel = 0;
+	glGetTexParameteriv(m_target, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+	size_t Width = GetDescriptor().dataSize.x;
+	size_t Height = GetDescriptor().dataSize.y;
+	size_t bufSize = ((Width + 3) / 4) * ((Height + 3) / 4) * GetMinSize(format);
+
+	data.clear();
+	numMips = 0;
+	for (GLint i = 0; i <= maxLevel; ++i) {
+		GLint levelSize = 0;
+		glGetTexLevelParameteriv(m_target, i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &levelSize);
+		if (size_t(levelSize) != bufSize) {
+			// the driver laid it out differently to how we would
+			glBindTexture(m_target, 0);
+			return false;
+		}
+		const size_t offset = data.size();
+		data.resize(offset + bufSize);
+		glGetCompressedTexImage(m_target, i, &data[offset]);
+		++numMips;
+
+		if (!GetDescriptor().generateMipmaps || Width<=MIN_COMPRESSED_TEXTURE_DIMENSION || Height<=MIN_COMPRESSED_TEXTURE_DIMENSION)
+			break;
+		bufSize /= 4;
+		Width /= 2;
+		Height /= 2;
+	}
+
+	glBindTexture(m_target, 0);
+	CHECKERRORS();
+	return numMips > 0;
+}
+
 }
@@ -21,6 +21,7 @@ public:
 
 	virtual void SetSampleMode(TextureSampleMode);
 	virtual void BuildMipmaps();
+	virtual bool GetCompressedImage(std::vector<Uint8> &data, TextureFormat &format, unsigned int &numMips);
 	GLuint GetTexture() const { return m_texture; }
 
 private:
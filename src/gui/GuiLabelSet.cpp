@@ -5,6 +5,18 @@
 
 namespace Gui {
 
+// no bigger than the distances labels are looked for in (clicks within 10
+// pixels, other labels within 5), so the cells around a point cover them
+static const float GRID_CELL_SIZE = 10.0f;
+
+static const Uint32 NO_ITEM = ~Uint32(0);
+
+// labels can be projected a long way off screen
+static int GridCell(float v)
+{
+	return int(floorf(Clamp(v, -1e6f, 1e6f) / GRID_CELL_SIZE));
+}
+
 LabelSet::LabelSet() : Widget()
 {
 	m_eventMask = EVENT_MOUSEDOWN;
@@ -14,25 +26,59 @@ LabelSet::LabelSet() : Widget()
 	m_font = Screen::GetFont();
 }
 
+Uint32 LabelSet::GridKey(int cx, int cy)
+{
+	return (Uint32(cx & 0xffff) << 16) | Uint32(cy & 0xffff);
+}
+
+void LabelSet::AddToGrid(Uint32 item)
+{
+	const LabelSetItem &i = m_items[item];
+	const Uint32 key = GridKey(GridCell(i.screenx), GridCell(i.screeny));
+	auto head = m_gridHead.insert(std::make_pair(key, NO_ITEM)).first;
+	m_gridNext.push_back(head->second);
+	head->second = item;
+}
+
 bool LabelSet::OnMouseDown(Gui::MouseButtonEvent *e)
 {
 	if ((e->button == SDL_BUTTON_LEFT) && (m_labelsClickable)) {
-		for (std::vector<LabelSetItem>::iterator i = m_items.begin(); i != m_items.end(); ++i) {
-			if ((fabs(e->x - (*i).screenx) < 10.0f) &&
-			    (fabs(e->y - (*i).screeny) < 10.0f)) {
-				(*i).onClick();
-				return false;
+		// the first one added, as if they were all checked in order
+		Uint32 found = NO_ITEM;
+		const int cx = GridCell(e->x), cy = GridCell(e->y);
+		for (int x = cx-1; x <= cx+1; x++) {
+			for (int y = cy-1; y <= cy+1; y++) {
+				auto head = m_gridHead.find(GridKey(x, y));
+				if (head == m_gridHead.end()) continue;
+				for (Uint32 item = head->second; item != NO_ITEM; item = m_gridNext[item]) {
+					const LabelSetItem &i = m_items[item];
+					if ((fabs(e->x - i.screenx) < 10.0f) &&
+					    (fabs(e->y - i.screeny) < 10.0f) && item < found)
+						found = item;
+				}
 			}
 		}
+		if (found != NO_ITEM) {
+			m_items[found].onClick();
+			return false;
+		}
 	}
 	return true;
 }
 
 bool LabelSet::CanPutItem(float x, float y)
 {
-	for (std::vector<LabelSetItem>::iterator i = m_items.begin(); i != m_items.end(); ++i) {
-		if ((fabs(x-(*i).screenx) < 5.0f) &&
-		    (fabs(y-(*i).screeny) < 5.0f)) return false;
+	const int cx = GridCell(x), cy = GridCell(y);
+	for (int gx = cx-1; gx <= cx+1; gx++) {
+		for (int gy = cy-1; gy <= cy+1; gy++) {
+			auto head = m_gridHead.find(GridKey(gx, gy));
+			if (head == m_gridHead.end()) continue;
+			for (Uint32 item = head->second; item != NO_ITEM; item = m_gridNext[item]) {
+				const LabelSetItem &i = m_items[item];
+				if ((fabs(x-i.screenx) < 5.0f) &&
+				    (fabs(y-i.screeny) < 5.0f)) return false;
+			}
+		}
 	}
 	return true;
 }
@@ -41,6 +87,7 @@ void LabelSet::Add(std::string text, sigc::slot<void> onClick, float screenx, fl
 {
 	if (CanPutItem(screenx, screeny)) {
 		m_items.push_back(LabelSetItem(text, onClick, screenx, screeny));
+		AddToGrid(m_items.size()-1);
 	}
 }
 
@@ -48,12 +95,15 @@ void LabelSet::Add(std::string text, sigc::slot<void> onClick, float screenx, fl
 {
 	if (CanPutItem(screenx, screeny)) {
 		m_items.push_back(LabelSetItem(text, onClick, screenx, screeny, col));
+		AddToGrid(m_items.size()-1);
 	}
 }
 
 void LabelSet::Clear()
 {
 	m_items.clear();
+	m_gridHead.clear();
+	m_gridNext.clear();
 }
 
 void LabelSet::Draw()
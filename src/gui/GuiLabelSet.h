@@ -6,10 +6,15 @@
 
 #include "GuiWidget.h"
 #include <vector>
+#include <unordered_map>
 
 /*
  * Collection of clickable labels. Used by the WorldView for clickable
  * bodies, and SystemView, SectorView etc.
+ *
+ * Labels are also kept in a screen-space grid, so checking for a label
+ * that's already too close and finding the one under the mouse only look
+ * at labels nearby rather than all of them.
  */
 namespace Gui {
 class LabelSet: public Widget {
@@ -52,8 +57,14 @@ public:
 	void SetLabelColor(const Color &c) { m_labelColor = c; }
 private:
 	bool CanPutItem(float x, float y);
+	void AddToGrid(Uint32 item);
+	static Uint32 GridKey(int cx, int cy);
 
 	std::vector<LabelSetItem> m_items;
+
+	// first item in each grid cell, then the next item in the same cell
+	std::unordered_map<Uint32, Uint32> m_gridHead;
+	std::vector<Uint32> m_gridNext;
 	bool m_labelsVisible;
 	bool m_labelsClickable;
 	Color m_labelColor;
@@ -308,7 +308,7 @@ void Screen::RenderStringBuffer(RefCountedPtr<Graphics::VertexBuffer> vb, const
 	r->Scale(Screen::fontScale[0], Screen::fontScale[1], 1);
 
 	// temporary, owned by the font
-	Graphics::VertexBuffer *pVB = font->GetCachedVertexBuffer(s);
+	Graphics::VertexBuffer *pVB = font->GetCachedVertexBuffer(s, color);
 	if (pVB) {
 		// found the buffer
 		font->RenderBuffer(pVB, color);
@@ -320,7 +320,7 @@ void Screen::RenderStringBuffer(RefCountedPtr<Graphics::VertexBuffer> vb, const
 
 		if (va.GetNumVerts() > 0) {
 			if (!vb.Valid() || vb->GetVertexCount() != va.GetNumVerts()) {
-				vb.Reset(font->CreateVertexBuffer(va, s, true));
+				vb.Reset(font->CreateVertexBuffer(va, s, true, color));
 			}
 
 			vb->Populate(va);
@@ -348,7 +348,7 @@ void Screen::RenderMarkupBuffer(RefCountedPtr<Graphics::VertexBuffer> vb, const
 	r->Scale(Screen::fontScale[0], Screen::fontScale[1], 1);
 
 	// temporary, owned by the font
-	Graphics::VertexBuffer *pVB = font->GetCachedVertexBuffer(s);
+	Graphics::VertexBuffer *pVB = font->GetCachedVertexBuffer(s, color, true);
 	if (pVB) {
 		// found the buffer
 		font->RenderBuffer(pVB, color);
@@ -360,7 +360,7 @@ void Screen::RenderMarkupBuffer(RefCountedPtr<Graphics::VertexBuffer> vb, const
 
 		if (va.GetNumVerts() > 0) {
 			if (!vb.Valid() || vb->GetVertexCount() != va.GetNumVerts()) {
-				vb.Reset(font->CreateVertexBuffer(va, s, true));
+				vb.Reset(font->CreateVertexBuffer(va, s, true, color, true));
 			}
 
 			vb->Populate(va);
@@ -4,10 +4,12 @@
 #include "libs.h"
 #include "Pi.h"
 #include "ModelViewer.h"
+#include "SimBench.h"
 #include "Game.h"
 #include "galaxy/GalaxyGenerator.h"
 #include "galaxy/Galaxy.h"
 #include "utils.h"
+#include <cctype>
 #include <cstdio>
 #include <cstdlib>
 
@@ -15,11 +17,30 @@ enum RunMode {
 	MODE_GAME,
 	MODE_MODELVIEWER,
 	MODE_GALAXYDUMP,
+	MODE_SIMBENCH,
 	MODE_VERSION,
 	MODE_USAGE,
 	MODE_USAGE_ERROR
 };
 
+// the key=value options that can follow any mode's own arguments
+static bool ParseOptions(int argc, char** argv, int pos, std::map<std::string,std::string> &options)
+{
+	static const std::string delim("=");
+	for (; pos < argc; pos++) {
+		const std::string arg(argv[pos]);
+		size_t mid = arg.find_first_of(delim, 0);
+		if (mid == std::string::npos || mid == 0 || mid == arg.length()-1) {
+			Output("malformed option: %s\n", arg.c_str());
+			return false;
+		}
+		const std::string key(arg.substr(0, mid));
+		const std::string val(arg.substr(mid+1, arg.length()));
+		options[key] = val;
+	}
+	return true;
+}
+
 int main(int argc, char** argv)
 {
 #ifdef PIONEER_PROFILER
@@ -52,6 +73,11 @@ int main(int argc, char** argv)
 			goto start;
 		}
 
+		if (modeopt == "simbench" || modeopt == "sb") {
+			mode = MODE_SIMBENCH;
+			goto start;
+		}
+
 		if (modeopt == "version" || modeopt == "v") {
 			mode = MODE_VERSION;
 			goto start;
@@ -70,6 +96,9 @@ start:
 	int pos = 2;
 	long int radius = 4;
 	long int sx = 0, sy = 0, sz = 0;
+	long int ticks = SimBench::DEFAULT_TICKS, ships = 0;
+	Galaxy::DumpFormat dumpFormat = Galaxy::DUMP_TEXT;
+	bool dumpSystems = true;
 	std::string filename;
 	switch (mode) {
 		case MODE_GALAXYDUMP: {
@@ -79,7 +108,7 @@ start:
 			}
 			filename = argv[pos];
 			++pos;
-			if (argc > pos) { // radius (optional)
+			if (argc > pos && isdigit(argv[pos][0])) { // radius (optional)
 				char* end = nullptr;
 				radius = std::strtol(argv[pos], &end, 0);
 				if (end == nullptr || *end != 0 || radius < 0 || radius > 10000) {
@@ -88,7 +117,7 @@ start:
 				}
 				++pos;
 			}
-			if (argc > pos) { // center of dump (three comma separated coordinates, optional)
+			if (argc > pos && strchr(argv[pos], ',')) { // center of dump (three comma separated coordinates, optional)
 				char* end = nullptr;
 				sx = std::strtol(argv[pos], &end, 0);
 				if (end == nullptr || *end != ',' || sx < -10000 || sx > 10000) {
@@ -107,25 +136,28 @@ start:
 				}
 				++pos;
 			}
+			for (; argc > pos && !strchr(argv[pos], '='); ++pos) { // format and what to include (optional)
+				const std::string arg(argv[pos]);
+				if (arg == "text")
+					dumpFormat = Galaxy::DUMP_TEXT;
+				else if (arg == "csv")
+					dumpFormat = Galaxy::DUMP_CSV;
+				else if (arg == "nosystems")
+					dumpSystems = false;
+				else {
+					Output("pioneer: invalid galaxy dump option: %s\n", argv[pos]);
+					break;
+				}
+			}
+			if (argc > pos && !strchr(argv[pos], '='))
+				break;
 			// fallthrough
 		}
 		case MODE_GAME: {
 			std::map<std::string,std::string> options;
-			if (argc > pos) {
-				static const std::string delim("=");
-				for (; pos < argc; pos++) {
-					const std::string arg(argv[pos]);
-					size_t mid = arg.find_first_of(delim, 0);
-					if (mid == std::string::npos || mid == 0 || mid == arg.length()-1) {
-						Output("malformed option: %s\n", arg.c_str());
-						return 1;
-					}
-					const std::string key(arg.substr(0, mid));
-					const std::string val(arg.substr(mid+1, arg.length()));
-					options[key] = val;
-				}
-			}
-			Pi::Init(options, mode == MODE_GALAXYDUMP);
+			if (!ParseOptions(argc, argv, pos, options))
+				return 1;
+			Pi::Init(options, mode != MODE_GAME);
 			if (mode == MODE_GAME)
 				for (;;) Pi::Start();
 			else if (mode == MODE_GALAXYDUMP) {
@@ -135,7 +167,7 @@ start:
 					break;
 				}
 				RefCountedPtr<Galaxy> galaxy = GalaxyGenerator::Create();
-				galaxy->Dump(file, sx, sy, sz, radius);
+				galaxy->Dump(file, sx, sy, sz, radius, dumpFormat, dumpSystems);
 				if (filename != "-" && fclose(file) != 0) {
 					Output("pioneer: writing to \"%s\" failed: %s\n", filename.c_str(), strerror(errno));
 				}
@@ -144,6 +176,41 @@ start:
 			break;
 		}
 
+		case MODE_SIMBENCH: {
+			if (argc < 3) {
+				Output("pioneer: simbench requires a scenario or saved game\n");
+				break;
+			}
+			filename = argv[pos];
+			++pos;
+			if (argc > pos && !strchr(argv[pos], '=')) { // ticks (optional)
+				char* end = nullptr;
+				ticks = std::strtol(argv[pos], &end, 0);
+				if (end == nullptr || *end != 0 || ticks <= 0) {
+					Output("pioneer: invalid tick count: %s\n", argv[pos]);
+					break;
+				}
+				++pos;
+			}
+			if (argc > pos && !strchr(argv[pos], '=')) { // ships (optional)
+				char* end = nullptr;
+				ships = std::strtol(argv[pos], &end, 0);
+				if (end == nullptr || *end != 0 || ships <= 0 || ships > 10000) {
+					Output("pioneer: invalid ship count: %s\n", argv[pos]);
+					break;
+				}
+				++pos;
+			}
+			std::map<std::string,std::string> options;
+			if (!ParseOptions(argc, argv, pos, options))
+				return 1;
+			Pi::Init(options, true, true);
+			if (!SimBench::Run(filename, ticks, ships))
+				Output("pioneer: simbench could not run \"%s\"\n", filename.c_str());
+			Pi::Quit();
+			break;
+		}
+
 		case MODE_MODELVIEWER: {
 			std::string modelName;
 			if (argc > 2)
@@ -169,7 +236,10 @@ start:
 				"available modes:\n"
 				"    -game        [-g]     game (default)\n"
 				"    -modelviewer [-mv]    model viewer\n"
-				"    -galaxydump  [-gd]    galaxy dumper\n"
+				"    -galaxydump  [-gd]    galaxy dumper:\n"
+				"                          <file> [radius] [cx,cy,cz] [text|csv] [nosystems]\n"
+				"    -simbench    [-sb]    headless simulation benchmark:\n"
+				"                          station|battle|transit|<savefile> [ticks] [ships]\n"
 				"    -version     [-v]     show version\n"
 				"    -help        [-h,-?]  this help\n"
 			);
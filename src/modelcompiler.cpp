@@ -24,12 +24,19 @@
 #include "OS.h"
 #include "StringF.h"
 #include "ModManager.h"
+#include "IniConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
 
 std::unique_ptr<GameConfig> s_config;
 std::unique_ptr<Graphics::Renderer> s_renderer;
 
 static const std::string s_dummyPath("");
+static const std::string s_manifestName("modelcompiler-manifest.ini");
 
 void SetupRenderer()
 {
@@ -63,46 +70,247 @@ void SetupRenderer()
 	s_renderer.reset(Graphics::Init(videoSettings));
 }
 
-void RunCompiler(const std::string &modelName, const std::string &filepath, const bool bInPlace)
+static std::string GetSavePath(const std::string &filepath)
+{
+	return FileSystem::NormalisePath(filepath.substr(0, filepath.size()-6));
+}
+
+// returns the size of the .sgm written, or 0 if it failed. the files the
+// model was built from are added to 'sources', if given
+size_t RunCompiler(Graphics::Renderer *renderer, const std::string &modelName, const std::string &filepath, const bool bInPlace, std::set<std::string> *sources = nullptr)
 {
 	PROFILE_SCOPED()
 	Profiler::Timer timer;
 	timer.Start();
-	Output("\n---\nStarting compiler for (%s)\n", modelName.c_str());
 
 	//load the current model in a pristine state (no navlights, shields...)
 	//and then save it into binary
 	std::unique_ptr<SceneGraph::Model> model;
 	try {
-		SceneGraph::Loader ld(s_renderer.get(), true, false);
+		SceneGraph::Loader ld(renderer, true, false);
 		model.reset(ld.LoadModel(modelName));
-		//dump warnings
+		if (sources)
+			sources->insert(ld.GetSourceFiles().begin(), ld.GetSourceFiles().end());
+		//dump warnings, in one go so they don't get mixed up with other models'
+		std::string log;
 		for (std::vector<std::string>::const_iterator it = ld.GetLogMessages().begin();
 			it != ld.GetLogMessages().end(); ++it)
 		{
-			Output("%s\n", (*it).c_str());
+			log += (*it) + "\n";
 		}
+		if (!log.empty())
+			Output("%s: %s", modelName.c_str(), log.c_str());
 	} catch (...) {
 		//minimal error handling, this is not expected to happen since we got this far.
-		return;
+		Output("%-32s could not be loaded\n", modelName.c_str());
+		return 0;
 	}
 
+	size_t size = 0;
 	try {
-		const std::string DataPath = FileSystem::NormalisePath(filepath.substr(0, filepath.size()-6));
-		SceneGraph::BinaryConverter bc(s_renderer.get());
-		bc.Save(modelName, DataPath, model.get(), bInPlace);
+		SceneGraph::BinaryConverter bc(renderer);
+		size = bc.Save(modelName, GetSavePath(filepath), model.get(), bInPlace);
 	} catch (const CouldNotOpenFileException&) {
 	} catch (const CouldNotWriteToFileException&) {
 	}
 
 	timer.Stop();
-	Output("Compiling \"%s\" took: %lf\n", modelName.c_str(), timer.millicycles());
+	if (size)
+		Output("%-32s %10u bytes %12.3lf ms\n", modelName.c_str(), Uint32(size), timer.millicycles());
+	else
+		Output("%-32s could not be saved\n", modelName.c_str());
+	return size;
+}
+
+// content hash of what a model is built from: every file in its directory
+// (meshes, textures, patterns), every file elsewhere that it was built from
+// last time, and the compiler version
+static std::string HashModelSources(const std::string &dir, const std::set<std::string> &sources)
+{
+	PROFILE_SCOPED()
+	// FNV-1a
+	Uint64 hash = 14695981039346656037ULL;
+	auto add = [&hash](const char *data, size_t size) {
+		for (size_t i = 0; i < size; i++)
+			hash = (hash ^ Uint8(data[i])) * 1099511628211ULL;
+	};
+
+	const std::string version = stringf("%0 %1 %2", PIONEER_VERSION, PIONEER_EXTRAVERSION, SceneGraph::BinaryConverter::GetVersion());
+	add(version.data(), version.size() + 1);
+
+	std::set<std::string> paths(sources);
+	for (FileSystem::FileEnumerator files(FileSystem::gameDataFiles, dir, FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next()) {
+		const FileSystem::FileInfo &info = files.Current();
+		// compiled models may be written back in here
+		if (info.IsFile() && !ends_with_ci(info.GetPath(), ".sgm"))
+			paths.insert(info.GetPath());
+	}
+
+	// a source that's gone hashes differently to one that's there
+	for (const std::string &path : paths) {
+		add(path.c_str(), path.size() + 1);
+		RefCountedPtr<FileSystem::FileData> data = FileSystem::gameDataFiles.ReadFile(path);
+		if (data)
+			add(data->GetData(), data->GetSize());
+		else
+			add("", 1);
+	}
+
+	char buf[17];
+	snprintf(buf, sizeof(buf), "%08x%08x", Uint32(hash >> 32), Uint32(hash));
+	return buf;
 }
 
+// compile a list of (name, path) models in parallel, skipping any whose
+// sources haven't changed since they were last compiled (unless forced)
+void RunBatchCompiler(const std::vector<std::pair<std::string, std::string>> &models, const bool bInPlace, const bool bForce)
+{
+	PROFILE_SCOPED()
+	Profiler::Timer timer;
+	timer.Start();
+
+	IniConfig manifest;
+	manifest.Read(FileSystem::userFiles, s_manifestName);
+	const std::string section = bInPlace ? "inplace" : "user";
+	// the files each model was built from, ';' separated
+	const std::string sourcesSection = section + "-sources";
+
+	// hashing is mostly file reading, so it's done up front on this thread
+	std::vector<std::pair<std::string, std::string>> toCompile;
+	for (auto &model : models) {
+		const std::string savePath = GetSavePath(model.second);
+		if (!bForce && SceneGraph::BinaryConverter::HasSavedFile(savePath, bInPlace)) {
+			std::set<std::string> sources;
+			std::istringstream list(manifest.String(sourcesSection, savePath, ""));
+			for (std::string source; std::getline(list, source, ';');)
+				if (!source.empty()) sources.insert(source);
+
+			const std::string dir = model.second.substr(0, model.second.rfind('/'));
+			const std::string hash = manifest.String(section, savePath, "");
+			if (!hash.empty() && hash == HashModelSources(dir, sources)) {
+				Output("%-32s up to date\n", model.first.c_str());
+				continue;
+			}
+		}
+		toCompile.push_back(model);
+	}
+
+	// each thread gets its own renderer, as the texture cache isn't thread safe
+	const size_t numThreads = std::min(size_t(std::max(OS::GetNumCores(), 1)), toCompile.size());
+	std::atomic<size_t> next(0);
+	std::atomic<size_t> totalSize(0);
+	std::mutex manifestLock;
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < numThreads; t++) {
+		threads.push_back(std::thread([&]() {
+			Graphics::RendererDummy renderer;
+			for (size_t i = next++; i < toCompile.size(); i = next++) {
+				const std::string &filepath = toCompile[i].second;
+				std::set<std::string> sources;
+				const size_t size = RunCompiler(&renderer, toCompile[i].first, filepath, bInPlace, &sources);
+				totalSize += size;
+
+				std::string hash, sourceList;
+				if (size) {
+					hash = HashModelSources(filepath.substr(0, filepath.rfind('/')), sources);
+					for (const std::string &source : sources)
+						sourceList += (sourceList.empty() ? "" : ";") + source;
+				}
+
+				std::lock_guard<std::mutex> lock(manifestLock);
+				manifest.SetString(section, GetSavePath(filepath), hash);
+				manifest.SetString(sourcesSection, GetSavePath(filepath), sourceList);
+			}
+		}));
+	}
+	for (std::thread &thread : threads)
+		thread.join();
+
+	manifest.Write(FileSystem::userFiles, s_manifestName);
+
+	timer.Stop();
+	Output("Compiled " SIZET_FMT " of " SIZET_FMT " models (" SIZET_FMT " bytes) on " SIZET_FMT " threads in %lf milliseconds\n",
+		toCompile.size(), models.size(), size_t(totalSize), numThreads, timer.millicycles());
+}
+
+// load every model from memory in both .sgm containers: the current raw one
+// that's read in place, and the old deflated one that has to be inflated first
+void RunBenchmark(const std::vector<std::pair<std::string, std::string>> &models, const int iterations)
+{
+	PROFILE_SCOPED()
+	size_t totalRaw = 0, totalDeflated = 0;
+	double totalRawMs = 0.0, totalDeflatedMs = 0.0;
+
+	// there's no v6 reader any more, so this can't time the old format's
+	// field by field loading. both columns load the current format; the
+	// second shows what deflating it (as v6 files were) would add
+	Output("v%u only: deflated shows inflate cost, not the old v6 loader\n", SceneGraph::BinaryConverter::GetVersion());
+	Output("%-32s %12s %12s %12s %12s\n", "model", "raw bytes", "raw ms", "zip bytes", "zip ms");
+	for (auto &entry : models) {
+		const std::string &modelName = entry.first;
+		const std::string dir = entry.second.substr(0, entry.second.rfind('/'));
+
+		std::unique_ptr<SceneGraph::Model> model;
+		try {
+			SceneGraph::Loader ld(s_renderer.get(), true, false);
+			model.reset(ld.LoadModel(modelName));
+		} catch (...) {
+			Output("%-32s could not be loaded\n", modelName.c_str());
+			continue;
+		}
+
+		SceneGraph::BinaryConverter bc(s_renderer.get());
+		std::string raw, deflated;
+		bc.SaveToMemory(model.get(), raw, false);
+		bc.SaveToMemory(model.get(), deflated, true);
+		model.reset();
+
+		const double msPerTick = 1000.0 / double(SDL_GetPerformanceFrequency());
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int i = 0; i < iterations; i++) {
+			delete bc.LoadFromMemory(modelName, dir, ByteRange(raw.data(), raw.size()));
+		}
+		const double rawMs = double(SDL_GetPerformanceCounter() - start) * msPerTick / iterations;
+
+		start = SDL_GetPerformanceCounter();
+		for (int i = 0; i < iterations; i++) {
+			delete bc.LoadFromMemory(modelName, dir, ByteRange(deflated.data(), deflated.size()));
+		}
+		const double deflatedMs = double(SDL_GetPerformanceCounter() - start) * msPerTick / iterations;
+
+		Output("%-32s %12u %12.3lf %12u %12.3lf\n",
+			modelName.c_str(), Uint32(raw.size()), rawMs, Uint32(deflated.size()), deflatedMs);
+		totalRaw += raw.size();
+		totalDeflated += deflated.size();
+		totalRawMs += rawMs;
+		totalDeflatedMs += deflatedMs;
+	}
+	Output("%-32s %12u %12.3lf %12u %12.3lf\n",
+		"total", Uint32(totalRaw), totalRawMs, Uint32(totalDeflated), totalDeflatedMs);
+}
+
+// every .model under models/, as (name, path)
+static void FindAllModels(std::vector<std::pair<std::string, std::string>> &list_model)
+{
+	FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
+	for (FileSystem::FileEnumerator files(fileSource, "models", FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
+	{
+		const FileSystem::FileInfo &info = files.Current();
+		const std::string &fpath = info.GetPath();
+
+		//check it's the expected type
+		if (info.IsFile()) {
+			if (ends_with_ci(fpath, ".model")) {	// store the path for ".model" files
+				list_model.push_back( std::make_pair(info.GetName().substr(0, info.GetName().size()-6), fpath) );
+			}
+		}
+	}
+}
 
 enum RunMode {
 	MODE_MODELCOMPILER=0,
 	MODE_MODELBATCHEXPORT,
+	MODE_BENCHMARK,
 	MODE_VERSION,
 	MODE_USAGE,
 	MODE_USAGE_ERROR
@@ -135,6 +343,11 @@ int main(int argc, char** argv)
 			goto start;
 		}
 
+		if (modeopt == "benchmark" || modeopt == "bench") {
+			mode = MODE_BENCHMARK;
+			goto start;
+		}
+
 		if (modeopt == "version" || modeopt == "v") {
 			mode = MODE_VERSION;
 			goto start;
@@ -191,39 +404,43 @@ start:
 					}
 				}
 				SetupRenderer();
-				RunCompiler(modelName, filePath, isInPlace);
+				RunCompiler(s_renderer.get(), modelName, filePath, isInPlace);
 			}
 			break;
 		}
 
 		case MODE_MODELBATCHEXPORT: {
-			// determine if we're meant to be writing these in the source directory
+			// determine if we're meant to be writing these in the source directory,
+			// and whether to rebuild models that are up to date
 			bool isInPlace = false;
-			if (argc > 2) {
-				std::string arg2 = argv[2];
-				isInPlace = (arg2 == "inplace" || arg2 == "true");
+			bool isForced = false;
+			for (int i = 2; i < argc; i++) {
+				const std::string arg = argv[i];
+				if (arg == "inplace" || arg == "true")
+					isInPlace = true;
+				else if (arg == "force")
+					isForced = true;
 			}
 
 			// find all of the models
 			std::vector<std::pair<std::string, std::string>> list_model;
-			FileSystem::FileSource &fileSource = FileSystem::gameDataFiles;
-			for (FileSystem::FileEnumerator files(fileSource, "models", FileSystem::FileEnumerator::Recurse); !files.Finished(); files.Next())
-			{
-				const FileSystem::FileInfo &info = files.Current();
-				const std::string &fpath = info.GetPath();
-
-				//check it's the expected type
-				if (info.IsFile()) {
-					if (ends_with_ci(fpath, ".model")) {	// store the path for ".model" files
-						list_model.push_back( std::make_pair(info.GetName().substr(0, info.GetName().size()-6), fpath) );
-					}
-				}
-			}
+			FindAllModels(list_model);
 
 			SetupRenderer();
-			for (auto &modelName : list_model) {
-				RunCompiler(modelName.first, modelName.second, isInPlace);
-			}
+			RunBatchCompiler(list_model, isInPlace, isForced);
+			break;
+		}
+
+		case MODE_BENCHMARK: {
+			int iterations = 10;
+			if (argc > 2)
+				iterations = std::max(1, atoi(argv[2]));
+
+			std::vector<std::pair<std::string, std::string>> list_model;
+			FindAllModels(list_model);
+
+			SetupRenderer();
+			RunBenchmark(list_model, iterations);
 			break;
 		}
 
@@ -246,6 +463,8 @@ start:
 				"    -compile inplace  [-c ... inplace]  model compiler\n"
 				"    -batch            [-b]              batch mode output into users home/Pioneer directory\n"
 				"    -batch inplace    [-b inplace]      batch mode output into the source folder\n"
+				"    -batch ... force  [-b ... force]    batch mode, also rebuilding models that are up to date\n"
+				"    -benchmark [n]    [-bench [n]]      time n loads of every model, plain and deflated\n"
 				"    -version          [-v]              show version\n"
 				"    -help             [-h,-?]           this help\n"
 			);
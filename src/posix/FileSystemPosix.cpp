@@ -9,7 +9,9 @@
 #include <cerrno>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 // on unix this is set from configure
@@ -129,15 +131,6 @@ namespace FileSystem {
 		}
 	}
 
-	static FileInfo::FileType stat_fd(int fd, Time::DateTime &mtime) {
-		struct stat info;
-		if (fstat(fd, &info) == 0) {
-			return interpret_stat(info, mtime);
-		} else {
-			return FileInfo::FT_NON_EXISTENT;
-		}
-	}
-
 	FileInfo FileSourceFS::Lookup(const std::string &path)
 	{
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
@@ -149,35 +142,59 @@ namespace FileSystem {
 	RefCountedPtr<FileData> FileSourceFS::ReadFile(const std::string &path)
 	{
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
-		FILE *fl = fopen(fullpath.c_str(), "rb");
-		if (!fl) {
+		int fd = open(fullpath.c_str(), O_RDONLY);
+		if (fd == -1) {
 			return RefCountedPtr<FileData>(0);
 		} else {
+			struct stat info;
 			Time::DateTime mtime;
-			FileInfo::FileType ty = stat_fd(fileno(fl), mtime);
+			FileInfo::FileType ty = FileInfo::FT_NON_EXISTENT;
+			if (fstat(fd, &info) == 0) {
+				ty = interpret_stat(info, mtime);
+			}
 			assert(ty == FileInfo::FT_FILE);
 
-			fseek(fl, 0, SEEK_END);
-			long sz = ftell(fl);
-			fseek(fl, 0, SEEK_SET);
+			const size_t sz = size_t(info.st_size);
+			if (sz >= FileDataMmap::MMAP_THRESHOLD) {
+				// private writable mapping, so callers poking at the buffer
+				// get their own copy of the page rather than a SIGSEGV
+				void *map = mmap(0, sz, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+				if (map != MAP_FAILED) {
+					close(fd);
+					return RefCountedPtr<FileData>(new FileDataMmap(MakeFileInfo(path, ty, mtime), sz, static_cast<char*>(map)));
+				}
+				// fall back to reading it
+			}
+
 			char *data = static_cast<char*>(std::malloc(sz));
 			if (!data) {
 				// XXX handling memory allocation failure gracefully is too hard right now
 				Output("failed when allocating buffer for '%s'\n", fullpath.c_str());
-				fclose(fl);
+				close(fd);
 				abort();
 			}
-			size_t read_size = fread(data, 1, sz, fl);
-			if (read_size != size_t(sz)) {
+			size_t read_size = 0;
+			while (read_size < sz) {
+				const ssize_t n = read(fd, data + read_size, sz - read_size);
+				if (n < 0 && errno == EINTR) continue;
+				if (n <= 0) break;
+				read_size += size_t(n);
+			}
+			if (read_size != sz) {
 				Output("file '%s' truncated!\n", fullpath.c_str());
 				memset(data + read_size, 0xee, sz - read_size);
 			}
-			fclose(fl);
+			close(fd);
 
 			return RefCountedPtr<FileData>(new FileDataMalloc(MakeFileInfo(path, ty, mtime), sz, data));
 		}
 	}
 
+	FileDataMmap::~FileDataMmap()
+	{
+		munmap(m_data, m_size);
+	}
+
 	bool FileSourceFS::ReadDirectory(const std::string &dirpath, std::vector<FileInfo> &output)
 	{
 		const std::string fulldirpath = JoinPathBelow(GetRoot(), dirpath);
@@ -247,6 +264,12 @@ namespace FileSystem {
 		return make_directory_raw(fullpath);
 	}
 
+	bool FileSourceFS::RemoveFile(const std::string &path)
+	{
+		const std::string fullpath = JoinPathBelow(GetRoot(), path);
+		return remove(fullpath.c_str()) == 0;
+	}
+
 	FILE* FileSourceFS::OpenReadStream(const std::string &path)
 	{
 		const std::string fullpath = JoinPathBelow(GetRoot(), path);
@@ -46,19 +46,19 @@ void Animation::Interpolate()
 	for(ChannelIterator chan = m_channels.begin(); chan != m_channels.end(); ++chan) {
 		matrix4x4f trans = chan->node->GetTransform();
 
-		if (!chan->rotationKeys.empty()) {
+		if (!chan->keys->rotationKeys.empty()) {
 			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
 			unsigned int frame = 0;
-			while (frame + 1 < chan->rotationKeys.size()) {
-				if (mtime < chan->rotationKeys[frame+1].time)
+			while (frame + 1 < chan->keys->rotationKeys.size()) {
+				if (mtime < chan->keys->rotationKeys[frame+1].time)
 					break;
 				frame++;
 			}
 
-			const RotationKey &a = chan->rotationKeys[frame];
+			const RotationKey &a = chan->keys->rotationKeys[frame];
 			vector3f saved_position = trans.GetTranslate();
-			if (frame + 1 < chan->rotationKeys.size()) {
-				const RotationKey &b = chan->rotationKeys[frame + 1];
+			if (frame + 1 < chan->keys->rotationKeys.size()) {
+				const RotationKey &b = chan->keys->rotationKeys[frame + 1];
 				double diffTime = b.time - a.time;
 				assert(diffTime > 0.0);
 				const float factor = Clamp(float((mtime - a.time) / diffTime), 0.f, 1.f);
@@ -72,19 +72,19 @@ void Animation::Interpolate()
 		//scaling will not work without rotation since it would
 		//continously scale the transform (would have to add originalTransform or
 		//something to MT)
-		if (!chan->scaleKeys.empty() && !chan->rotationKeys.empty()) {
+		if (!chan->keys->scaleKeys.empty() && !chan->keys->rotationKeys.empty()) {
 			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
 			unsigned int frame = 0;
-			while (frame + 1 < chan->scaleKeys.size()) {
-				if (mtime < chan->scaleKeys[frame+1].time)
+			while (frame + 1 < chan->keys->scaleKeys.size()) {
+				if (mtime < chan->keys->scaleKeys[frame+1].time)
 					break;
 				frame++;
 			}
 
-			const ScaleKey &a = chan->scaleKeys[frame];
+			const ScaleKey &a = chan->keys->scaleKeys[frame];
 			vector3f out;
-			if (frame + 1 < chan->scaleKeys.size()) {
-				const ScaleKey &b = chan->scaleKeys[frame + 1];
+			if (frame + 1 < chan->keys->scaleKeys.size()) {
+				const ScaleKey &b = chan->keys->scaleKeys[frame + 1];
 				double diffTime = b.time - a.time;
 				assert(diffTime > 0.0);
 				const float factor = Clamp(float((mtime - a.time) / diffTime), 0.f, 1.f);
@@ -95,19 +95,19 @@ void Animation::Interpolate()
 			trans.Scale(out.x, out.y, out.z);
 		}
 
-		if (!chan->positionKeys.empty()) {
+		if (!chan->keys->positionKeys.empty()) {
 			//find a frame. To optimize, should begin search from previous frame (when mTime > previous mTime)
 			unsigned int frame = 0;
-			while (frame + 1 < chan->positionKeys.size()) {
-				if (mtime < chan->positionKeys[frame+1].time)
+			while (frame + 1 < chan->keys->positionKeys.size()) {
+				if (mtime < chan->keys->positionKeys[frame+1].time)
 					break;
 				frame++;
 			}
 
-			const PositionKey &a = chan->positionKeys[frame];
+			const PositionKey &a = chan->keys->positionKeys[frame];
 			vector3f out;
-			if (frame + 1 < chan->positionKeys.size()) {
-				const PositionKey &b = chan->positionKeys[frame + 1];
+			if (frame + 1 < chan->keys->positionKeys.size()) {
+				const PositionKey &b = chan->keys->positionKeys[frame + 1];
 				double diffTime = b.time - a.time;
 				assert(diffTime > 0.0);
 				const float factor = Clamp(float((mtime - a.time) / diffTime), 0.f, 1.f);
@@ -10,12 +10,17 @@
 #include "AnimationKey.h"
 namespace SceneGraph {
 
-class AnimationChannel {
-public:
-	AnimationChannel(MatrixTransform *t) : node(t) { }
+//keyframes don't change once loaded, so model instances share them
+struct AnimationKeys : public RefCounted {
 	std::vector<PositionKey> positionKeys;
 	std::vector<RotationKey> rotationKeys;
 	std::vector<ScaleKey> scaleKeys;
+};
+
+class AnimationChannel {
+public:
+	AnimationChannel(MatrixTransform *t) : keys(new AnimationKeys), node(t) { }
+	RefCountedPtr<AnimationKeys> keys;
 	MatrixTransform *node;
 };
 
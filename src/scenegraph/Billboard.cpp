@@ -2,6 +2,7 @@
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
 #include "Billboard.h"
+#include "NodeCopyCache.h"
 #include "Model.h"
 #include "NodeVisitor.h"
 #include "graphics/Graphics.h"
@@ -30,7 +31,7 @@ Billboard::Billboard(const Billboard &billboard, NodeCopyCache *cache)
 
 Node* Billboard::Clone(NodeCopyCache *cache)
 {
-	return new Billboard(*this, cache);
+	return cache->Copy<Billboard>(this);
 }
 
 void Billboard::Accept(NodeVisitor &nv)
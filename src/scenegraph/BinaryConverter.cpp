@@ -19,7 +19,8 @@ using namespace SceneGraph;
 // 4: compressed SGM files and instancing support
 // 5: normal mapping
 // 6: 32-bit indicies
-const Uint32 SGM_VERSION = 6;
+// 7: uncompressed, with vertex, index and collision arrays stored as aligned raw blobs
+const Uint32 SGM_VERSION = 7;
 union SGM_STRING_VALUE{
 	char name[4];
 	Uint32 value;
@@ -79,7 +80,7 @@ void BinaryConverter::Save(const std::string& filename, Model* m)
 	Save(filename, s_EmptyString, m, false);
 }
 
-void BinaryConverter::Save(const std::string& filename, const std::string& savepath, Model* m, const bool bInPlace)
+size_t BinaryConverter::Save(const std::string& filename, const std::string& savepath, Model* m, const bool bInPlace)
 {
 	PROFILE_SCOPED()
 	printf("Saving file (%s)\n", filename.c_str());
@@ -108,6 +109,32 @@ void BinaryConverter::Save(const std::string& filename, const std::string& savep
 		if (!f) throw CouldNotOpenFileException();
 	}
 
+	std::string data;
+	SaveToMemory(m, data, false);
+	const size_t nwritten = fwrite(data.data(), data.size(), 1, f);
+	fclose(f);
+
+	if (nwritten != 1) throw CouldNotWriteToFileException();
+	return data.size();
+}
+
+//static
+bool BinaryConverter::HasSavedFile(const std::string& savepath, const bool bInPlace)
+{
+	if (bInPlace)
+		return FileSystem::FileSourceFS(FileSystem::GetDataDir()).Lookup(savepath + SGM_EXTENSION).IsFile();
+	return FileSystem::userFiles.Lookup(FileSystem::JoinPathBelow(SAVE_TARGET_DIR, savepath + SGM_EXTENSION)).IsFile();
+}
+
+//static
+Uint32 BinaryConverter::GetVersion()
+{
+	return SGM_VERSION;
+}
+
+void BinaryConverter::SaveToMemory(Model *m, std::string &out, bool compress)
+{
+	PROFILE_SCOPED()
 	Serializer::Writer wr;
 
 	wr.Int32(SGM_STRING_ID.value);
@@ -131,18 +158,18 @@ void BinaryConverter::Save(const std::string& filename, const std::string& savep
 	for (unsigned int i = 0; i < m->GetNumTags(); i++)
 		wr.String(m->GetTagByIndex(i)->GetName().c_str());
 
-	// compress in memory, write to open file 
-	size_t outSize = 0;
-	size_t nwritten = 0;
 	const std::string& data = wr.GetData();
-	void *pCompressedData = tdefl_compress_mem_to_heap(data.data(), data.length(), &outSize, 128);
-	if (pCompressedData) {
-		nwritten = fwrite(pCompressedData, outSize, 1, f);
-		mz_free(pCompressedData);
+	if (!compress) {
+		out = data;
+		return;
 	}
-	fclose(f);
 
-	if (nwritten != 1) throw CouldNotWriteToFileException();
+	// the old deflated container
+	size_t outSize = 0;
+	void *pCompressedData = tdefl_compress_mem_to_heap(data.data(), data.length(), &outSize, 128);
+	if (!pCompressedData) throw CouldNotWriteToFileException();
+	out.assign(static_cast<const char*>(pCompressedData), outSize);
+	mz_free(pCompressedData);
 }
 
 Model *BinaryConverter::Load(const std::string &filename)
@@ -174,20 +201,8 @@ Model *BinaryConverter::Load(const std::string &shortname, const std::string &ba
 					m_curPath = m_curPath.substr(0, m_curPath.length()-1);
 
 				RefCountedPtr<FileSystem::FileData> binfile = info.Read();
-				if (binfile.Valid()) {
-					Model* model(nullptr);
-					size_t outSize(0);
-					// decompress the loaded ByteRange in memory
-					const ByteRange bin = binfile->AsByteRange();
-					void *pDecompressedData = tinfl_decompress_mem_to_heap(&bin[0], bin.Size(), &outSize, 0);
-					if (pDecompressedData) {
-						// now parse in-memory representation as new ByteRange.
-						Serializer::Reader rd(ByteRange(static_cast<char*>(pDecompressedData), outSize));
-						model = CreateModel(name, rd);
-						mz_free(pDecompressedData);
-					}
-					return model;
-				}
+				if (binfile.Valid())
+					return LoadFromMemory(name, m_curPath, binfile->AsByteRange());
 			}
 		}
 	}
@@ -196,6 +211,51 @@ Model *BinaryConverter::Load(const std::string &shortname, const std::string &ba
 	return nullptr;
 }
 
+//static
+bool BinaryConverter::IsCompressed(const ByteRange &data)
+{
+	// current files start with the (uncompressed) signature and version;
+	// anything else is taken to be the old deflated container
+	return data.Size() < 4 || memcmp(data.begin, SGM_STRING_ID.name, 4) != 0;
+}
+
+//static
+std::unique_ptr<char, FreeDeleter> BinaryConverter::Decompress(const ByteRange &data, size_t &outSize)
+{
+	PROFILE_SCOPED()
+	outSize = 0;
+	// tinfl allocates with plain malloc, so FreeDeleter can release it
+	void *pDecompressedData = tinfl_decompress_mem_to_heap(data.begin, data.Size(), &outSize, 0);
+	return std::unique_ptr<char, FreeDeleter>(static_cast<char*>(pDecompressedData));
+}
+
+Model *BinaryConverter::LoadFromMemory(const std::string &filename, const std::string &path, const ByteRange &data)
+{
+	PROFILE_SCOPED()
+	if (!IsCompressed(data))
+		return LoadDecompressed(filename, path, data);
+
+	size_t outSize(0);
+	std::unique_ptr<char, FreeDeleter> decompressed = Decompress(data, outSize);
+	// not deflated either, so most likely another version. reading it as it
+	// is reports which
+	if (!decompressed)
+		return LoadDecompressed(filename, path, data);
+	return LoadDecompressed(filename, path, ByteRange(decompressed.get(), outSize));
+}
+
+Model *BinaryConverter::LoadDecompressed(const std::string &filename, const std::string &path, const ByteRange &data)
+{
+	PROFILE_SCOPED()
+	m_curPath = path;
+	Serializer::Reader rd(data);
+	try {
+		return CreateModel(filename, rd);
+	} catch (SavedGameCorruptException &) {
+		throw LoadingError("SGM file is corrupt");
+	}
+}
+
 Model *BinaryConverter::CreateModel(const std::string& filename, Serializer::Reader &rd)
 {
 	PROFILE_SCOPED()
@@ -304,18 +364,18 @@ void BinaryConverter::SaveAnimations(Serializer::Writer &wr, Model *m)
 		for (const auto &chan : anim->GetChannels()) {
 			wr.String(chan.node->GetName());
 			//write pos/rot/scale keys
-			wr.Int32(chan.positionKeys.size());
-			for (const auto &pkey : chan.positionKeys) {
+			wr.Int32(chan.keys->positionKeys.size());
+			for (const auto &pkey : chan.keys->positionKeys) {
 				wr.Double(pkey.time);
 				wr.Vector3f(pkey.position);
 			}
-			wr.Int32(chan.rotationKeys.size());
-			for (const auto &rkey : chan.rotationKeys) {
+			wr.Int32(chan.keys->rotationKeys.size());
+			for (const auto &rkey : chan.keys->rotationKeys) {
 				wr.Double(rkey.time);
 				wr.WrQuaternionf(rkey.rotation);
 			}
-			wr.Int32(chan.scaleKeys.size());
-			for (const auto &skey : chan.scaleKeys) {
+			wr.Int32(chan.keys->scaleKeys.size());
+			for (const auto &skey : chan.keys->scaleKeys) {
 				wr.Double(skey.time);
 				wr.Vector3f(skey.scale);
 			}
@@ -341,17 +401,17 @@ void BinaryConverter::LoadAnimations(Serializer::Reader &rd)
 			for (Uint32 numKeys = rd.Int32(); numKeys > 0; numKeys--) {
 				const double ktime = rd.Double();
 				const vector3f kpos = rd.Vector3f();
-				chan.positionKeys.push_back(PositionKey(ktime, kpos));
+				chan.keys->positionKeys.push_back(PositionKey(ktime, kpos));
 			}
 			for (Uint32 numKeys = rd.Int32(); numKeys > 0; numKeys--) {
 				const double ktime = rd.Double();
 				const Quaternionf krot = rd.RdQuaternionf();
-				chan.rotationKeys.push_back(RotationKey(ktime, krot));
+				chan.keys->rotationKeys.push_back(RotationKey(ktime, krot));
 			}
 			for (Uint32 numKeys = rd.Int32(); numKeys > 0; numKeys--) {
 				const double ktime = rd.Double();
 				const vector3f kscale = rd.Vector3f();
-				chan.scaleKeys.push_back(ScaleKey(ktime, kscale));
+				chan.keys->scaleKeys.push_back(ScaleKey(ktime, kscale));
 			}
 		}
 		m_model->m_animations.push_back(anim);
@@ -17,7 +17,10 @@
 #include "CollisionGeometry.h"
 #include "Thruster.h"
 #include "Billboard.h"
+#include "FileSystem.h"
+#include "SmartPtr.h"
 #include <functional>
+#include <memory>
 
 namespace SceneGraph
 {
@@ -26,10 +29,31 @@ class BinaryConverter : public BaseLoader
 public:
 	BinaryConverter(Graphics::Renderer*);
 	void Save(const std::string& filename, Model* m);
-	void Save(const std::string& filename, const std::string& savepath, Model* m, const bool bInPlace);
+	// returns the size of the file written
+	size_t Save(const std::string& filename, const std::string& savepath, Model* m, const bool bInPlace);
+
+	// whether there's a file where Save(..., savepath, ..., bInPlace) writes to
+	static bool HasSavedFile(const std::string& savepath, const bool bInPlace);
+	static Uint32 GetVersion();
 	Model *Load(const std::string &filename);
 	Model *Load(const std::string &filename, const std::string &path);
 
+	// serialise to an in-memory .sgm image. compress gives the old deflated
+	// container, which is smaller but has to be inflated before it's read
+	void SaveToMemory(Model *m, std::string &out, bool compress);
+
+	// build a model from an .sgm image in either container. the image is
+	// read in place, so a mapped file costs no extra copies. 'path' is the
+	// directory the model's textures and patterns are looked up in
+	Model *LoadFromMemory(const std::string &filename, const std::string &path, const ByteRange &data);
+
+	// for callers that want to read and inflate the file off the main
+	// thread: IsCompressed and Decompress are safe on any thread, and the
+	// (uncompressed) result then goes to LoadDecompressed
+	static bool IsCompressed(const ByteRange &data);
+	static std::unique_ptr<char, FreeDeleter> Decompress(const ByteRange &data, size_t &outSize);
+	Model *LoadDecompressed(const std::string &filename, const std::string &path, const ByteRange &data);
+
 	//if you implement any new node types, you must also register a loader function
 	//before calling Load.
 	void RegisterLoader(const std::string &typeName, std::function<Node*(NodeDatabase&)>);
@@ -2,6 +2,7 @@
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
 #include "Label3D.h"
+#include "NodeCopyCache.h"
 #include "NodeVisitor.h"
 #include "graphics/Renderer.h"
 #include "graphics/VertexArray.h"
@@ -40,7 +41,7 @@ Label3D::Label3D(const Label3D &label, NodeCopyCache *cache)
 
 Node* Label3D::Clone(NodeCopyCache *cache)
 {
-	return new Label3D(*this, cache);
+	return cache->Copy<Label3D>(this);
 }
 
 void Label3D::SetText(const std::string &text)
@@ -84,7 +84,7 @@ namespace {
 	class AssimpFileSystem : public Assimp::IOSystem
 	{
 	public:
-		AssimpFileSystem(FileSystem::FileSource& fs): m_fs(fs) {}
+		AssimpFileSystem(FileSystem::FileSource& fs, std::set<std::string> *opened): m_fs(fs), m_opened(opened) {}
 		virtual ~AssimpFileSystem() {}
 
 		virtual bool Exists(const char *path) const
@@ -100,6 +100,8 @@ namespace {
 			assert(mode[0] == 'r');
 			assert(!strchr(mode, '+'));
 			RefCountedPtr<FileSystem::FileData> data = m_fs.ReadFile(path);
+			if (data && m_opened)
+				m_opened->insert(data->GetInfo().GetPath());
 			return (data ? new AssimpFileReadStream(data) : 0);
 		}
 
@@ -110,6 +112,7 @@ namespace {
 
 	private:
 		FileSystem::FileSource &m_fs;
+		std::set<std::string> *m_opened;
 	};
 } // anonymous namespace
 
@@ -133,6 +136,7 @@ Model *Loader::LoadModel(const std::string &shortname, const std::string &basepa
 {
 	PROFILE_SCOPED()
 	m_logMessages.clear();
+	m_sourceFiles.clear();
 
 	std::vector<std::string> list_model;
 	std::vector<std::string> list_sgm;
@@ -189,6 +193,12 @@ Model *Loader::LoadModel(const std::string &shortname, const std::string &basepa
 
 				Parser p(fileSource, fpath, m_curPath);
 				p.Parse(&modelDefinition);
+
+				m_sourceFiles.insert(fpath);
+				for (const MaterialDefinition &mat : modelDefinition.matDefs) {
+					for (const std::string *tex : { &mat.tex_diff, &mat.tex_spec, &mat.tex_glow, &mat.tex_ambi, &mat.tex_norm })
+						if (!tex->empty()) m_sourceFiles.insert(*tex);
+				}
 			} catch (ParseError &err) {
 				Output("%s\n", err.what());
 				throw LoadingError(err.what());
@@ -324,7 +334,7 @@ RefCountedPtr<Node> Loader::LoadMesh(const std::string &filename, const AnimList
 	m_curMeshDef = filename.substr(slashpos+1, filename.length()-slashpos);
 
 	Assimp::Importer importer;
-	importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles));
+	importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles, &m_sourceFiles));
 
 	//Removing components is suggested to optimize loading. We do not care about vtx colors now.
 	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_COLORS);
@@ -644,7 +654,7 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 					const aiVector3D &aipos = aikey.mValue;
 					if (in_range(aikey.mTime, defStart, defEnd)) {
 						const double t = aikey.mTime * secondsPerTick;
-						chan.positionKeys.push_back(PositionKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
+						chan.keys->positionKeys.push_back(PositionKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
 						start = std::min(start, t);
 						end = std::max(end, t);
 					}
@@ -659,7 +669,7 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 					const aiQuaternion &airot = aikey.mValue;
 					if (in_range(aikey.mTime, defStart, defEnd)) {
 						const double t = aikey.mTime * secondsPerTick;
-						chan.rotationKeys.push_back(RotationKey(t, Quaternionf(airot.w, airot.x, airot.y, airot.z)));
+						chan.keys->rotationKeys.push_back(RotationKey(t, Quaternionf(airot.w, airot.x, airot.y, airot.z)));
 						start = std::min(start, t);
 						end = std::max(end, t);
 					}
@@ -670,7 +680,7 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 					const aiVector3D &aipos = aikey.mValue;
 					if (in_range(aikey.mTime, defStart, defEnd)) {
 						const double t = aikey.mTime * secondsPerTick;
-						chan.scaleKeys.push_back(ScaleKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
+						chan.keys->scaleKeys.push_back(ScaleKey(t, vector3f(aipos.x, aipos.y, aipos.z)));
 						start = std::min(start, t);
 						end = std::max(end, t);
 					}
@@ -681,17 +691,17 @@ void Loader::ConvertAnimations(const aiScene* scene, const AnimList &animDefs, N
 		// convert remove initial offset (so the first keyframe is at exactly t=0)
 		for (std::vector<AnimationChannel>::iterator chan = animation->m_channels.begin() + first_new_channel;
 				chan != animation->m_channels.end(); ++chan) {
-			for (unsigned int k = 0; k < chan->positionKeys.size(); ++k) {
-				chan->positionKeys[k].time -= start;
-				assert(chan->positionKeys[k].time >= 0.0);
+			for (unsigned int k = 0; k < chan->keys->positionKeys.size(); ++k) {
+				chan->keys->positionKeys[k].time -= start;
+				assert(chan->keys->positionKeys[k].time >= 0.0);
 			}
-			for (unsigned int k = 0; k < chan->rotationKeys.size(); ++k) {
-				chan->rotationKeys[k].time -= start;
-				assert(chan->rotationKeys[k].time >= 0.0);
+			for (unsigned int k = 0; k < chan->keys->rotationKeys.size(); ++k) {
+				chan->keys->rotationKeys[k].time -= start;
+				assert(chan->keys->rotationKeys[k].time >= 0.0);
 			}
-			for (unsigned int k = 0; k < chan->scaleKeys.size(); ++k) {
-				chan->scaleKeys[k].time -= start;
-				assert(chan->scaleKeys[k].time >= 0.0);
+			for (unsigned int k = 0; k < chan->keys->scaleKeys.size(); ++k) {
+				chan->keys->scaleKeys[k].time -= start;
+				assert(chan->keys->scaleKeys[k].time >= 0.0);
 			}
 		}
 
@@ -916,7 +926,7 @@ void Loader::LoadCollision(const std::string &filename)
 	assert(m_model);
 
 	Assimp::Importer importer;
-	importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles));
+	importer.SetIOHandler(new AssimpFileSystem(FileSystem::gameDataFiles, &m_sourceFiles));
 
 	//discard extra data
 	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS,
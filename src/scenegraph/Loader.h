@@ -10,6 +10,7 @@
 #include "CollisionGeometry.h"
 #include "graphics/Material.h"
 #include <assimp/types.h>
+#include <set>
 
 struct aiNode;
 struct aiMesh;
@@ -28,11 +29,16 @@ public:
 
 	const std::vector<std::string> &GetLogMessages() const { return m_logMessages; }
 
+	//every file the last model loaded was built from: the .model, the
+	//textures it names, and whatever its mesh files opened
+	const std::set<std::string> &GetSourceFiles() const { return m_sourceFiles; }
+
 protected:
 	bool m_doLog;
 	bool m_loadSGMs;
 	bool m_mostDetailedLod;
 	std::vector<std::string> m_logMessages;
+	std::set<std::string> m_sourceFiles;
 	std::string m_curMeshDef; //for logging
 
 	RefCountedPtr<Group> m_thrustersRoot;
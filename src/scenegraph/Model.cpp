@@ -2,16 +2,21 @@
 // Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
 
 #include "Model.h"
+#include "Billboard.h"
+#include "CollisionGeometry.h"
 #include "CollisionVisitor.h"
 #include "NodeCopyCache.h"
 #include "graphics/Renderer.h"
 #include "graphics/TextureBuilder.h"
 #include "graphics/VertexArray.h"
 #include "StringF.h"
+#include "utils.h"
 #include "json/JsonUtils.h"
 
 namespace SceneGraph {
 
+const char SHIELD_TRANSFORM_SUFFIX[] = "_accMtx4";
+
 static RefCountedPtr<Graphics::Texture> texHalos4x4;
 static RefCountedPtr<Graphics::Material> matHalos4x4;
 
@@ -24,18 +29,55 @@ public:
 	std::string label;
 };
 
+// find the nodes an instance needs its own copy of: anything with state that
+// can differ between instances, and every group on the way down to one.
+// navlights get billboards attached per ship, and shields (the whole subtree,
+// geometry included) get their node masks and render state set per ship.
+// returns true if 'node' is one of them
+static bool FindInstanceNodes(Node *node, const std::set<const Node*> &animated, std::set<const Node*> &out, bool wholeSubtree = false)
+{
+	const std::string &name = node->GetName();
+	wholeSubtree = wholeSubtree || ends_with(name, SHIELD_TRANSFORM_SUFFIX);
+
+	bool perInstance = wholeSubtree
+		|| (node->GetNodeFlags() & NODE_TAG) //things get attached to tags
+		|| starts_with(name, "navlight_")
+		|| animated.count(node)
+		|| dynamic_cast<Label3D*>(node)
+		|| dynamic_cast<Billboard*>(node);
+
+	if (CollisionGeometry *cg = dynamic_cast<CollisionGeometry*>(node))
+		perInstance = perInstance || cg->IsDynamic();
+
+	if (Group *group = dynamic_cast<Group*>(node)) {
+		for (unsigned int i = 0; i < group->GetNumChildren(); i++) {
+			if (FindInstanceNodes(group->GetChildAt(i), animated, out, wholeSubtree))
+				perInstance = true;
+		}
+	}
+
+	if (perInstance)
+		out.insert(node);
+	return perInstance;
+}
+
 Model::Model(Graphics::Renderer *r, const std::string &name)
 : m_boundingRadius(10.f)
 , m_renderer(r)
 , m_name(name)
 , m_curPatternIndex(0)
 , m_curPattern(0)
+, m_numInstanceNodes(0)
+, m_instanceNodeBytes(0)
 , m_debugFlags(0)
 , m_billboardTris(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_NORMAL)
 , m_billboardRS(nullptr)
 {
 	m_root.Reset(new Group(m_renderer));
 	m_root->SetName(name);
+	m_colors[0] = Color::RED;
+	m_colors[1] = Color::GREEN;
+	m_colors[2] = Color::BLUE;
 	ClearDecals();
 }
 
@@ -52,27 +94,34 @@ Model::Model(const Model &model)
 , m_billboardTris(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_NORMAL)
 , m_billboardRS(nullptr)
 {
-	//selective copying of node structure
-	NodeCopyCache cache;
+	//selective copying of node structure: only what can differ between
+	//instances is copied, the rest of the graph is shared
+	std::set<const Node*> animated;
+	for (const Animation *anim : model.m_animations)
+		for (const AnimationChannel &chan : anim->GetChannels())
+			animated.insert(chan.node);
+	std::set<const Node*> instanceNodes;
+	instanceNodes.insert(model.m_root.Get());
+	FindInstanceNodes(model.m_root.Get(), animated, instanceNodes);
+
+	NodeCopyCache cache(&instanceNodes);
 	m_root.Reset(dynamic_cast<Group*>(model.m_root->Clone(&cache)));
+	m_numInstanceNodes = cache.GetNumCopies();
+	m_instanceNodeBytes = cache.GetCopiedBytes();
 
 	//materials are shared by meshes
 	for (unsigned int i=0; i<MAX_DECAL_MATERIALS; i++)
 		m_decalMaterials[i] = model.m_decalMaterials[i];
 	ClearDecals();
 
-	//create unique color texture, if used
-	//patterns are shared
-	if (SupportsPatterns()) {
-		std::vector<Color> colors;
-		colors.push_back(Color::RED);
-		colors.push_back(Color::GREEN);
-		colors.push_back(Color::BLUE);
-		SetColors(colors);
+	//patterns are shared, colours are per-instance material parameters
+	m_colors[0] = Color::RED;
+	m_colors[1] = Color::GREEN;
+	m_colors[2] = Color::BLUE;
+	if (SupportsPatterns())
 		SetPattern(0);
-	}
 
-	//animations need to be copied and retargeted
+	//animations need to be copied and retargeted (keys are shared)
 	for (AnimationContainer::const_iterator it = model.m_animations.begin(); it != model.m_animations.end(); ++it) {
 		const Animation *anim = *it;
 		m_animations.push_back(new Animation(*anim));
@@ -101,20 +150,7 @@ Model *Model::MakeInstance() const
 void Model::Render(const matrix4x4f &trans, const RenderData *rd)
 {
 	PROFILE_SCOPED()
-	//update color parameters (materials are shared by model instances)
-	if (m_curPattern) {
-		for (MaterialContainer::const_iterator it = m_materials.begin(); it != m_materials.end(); ++it) {
-			if ((*it).second->GetDescriptor().usePatterns) {
-				(*it).second->texture5 = m_colorMap.GetTexture();
-				(*it).second->texture4 = m_curPattern;
-			}
-		}
-	}
-
-	//update decals (materials and geometries are shared)
-	for (unsigned int i=0; i < MAX_DECAL_MATERIALS; i++)
-		if (m_decalMaterials[i])
-			m_decalMaterials[i]->texture0 = m_curDecals[i];
+	ApplyInstanceState();
 
 	//Override renderdata if this model is called from ModelNode
 	RenderData params = (rd != 0) ? (*rd) : m_renderData;
@@ -171,20 +207,7 @@ void Model::Render(const std::vector<matrix4x4f> &trans, const RenderData *rd)
 {
 	PROFILE_SCOPED();
 
-	//update color parameters (materials are shared by model instances)
-	if (m_curPattern) {
-		for (MaterialContainer::const_iterator it = m_materials.begin(); it != m_materials.end(); ++it) {
-			if ((*it).second->GetDescriptor().usePatterns) {
-				(*it).second->texture5 = m_colorMap.GetTexture();
-				(*it).second->texture4 = m_curPattern;
-			}
-		}
-	}
-
-	//update decals (materials and geometries are shared)
-	for (unsigned int i = 0; i < MAX_DECAL_MATERIALS; i++)
-		if (m_decalMaterials[i])
-			m_decalMaterials[i]->texture0 = m_curDecals[i];
+	ApplyInstanceState();
 
 	//Override renderdata if this model is called from ModelNode
 	RenderData params = (rd != 0) ? (*rd) : m_renderData;
@@ -207,6 +230,29 @@ void Model::Render(const std::vector<matrix4x4f> &trans, const RenderData *rd)
 	}
 }
 
+//materials are shared by model instances, so this instance's pattern,
+//colours and decals are set on them before every draw
+void Model::ApplyInstanceState()
+{
+	if (m_curPattern) {
+		const bool smooth = m_patterns.at(m_curPatternIndex).smoothColor;
+		for (MaterialContainer::const_iterator it = m_materials.begin(); it != m_materials.end(); ++it) {
+			Graphics::Material *mat = (*it).second.Get();
+			if (mat->GetDescriptor().usePatterns) {
+				mat->texture4 = m_curPattern;
+				mat->patternColors[0] = m_colors[0];
+				mat->patternColors[1] = m_colors[1];
+				mat->patternColors[2] = m_colors[2];
+				mat->smoothPatternColors = smooth;
+			}
+		}
+	}
+
+	for (unsigned int i=0; i < MAX_DECAL_MATERIALS; i++)
+		if (m_decalMaterials[i])
+			m_decalMaterials[i]->texture0 = m_curDecals[i];
+}
+
 void Model::DrawBillboards()
 {
 	if(!m_billboardRS) {
@@ -439,7 +485,6 @@ void Model::SetPattern(unsigned int index)
 {
 	if (m_patterns.empty() || index > m_patterns.size() - 1) return;
 	const Pattern &pat = m_patterns.at(index);
-	m_colorMap.SetSmooth(pat.smoothColor);
 	m_curPatternIndex = index;
 	m_curPattern = pat.texture.Get();
 }
@@ -447,7 +492,9 @@ void Model::SetPattern(unsigned int index)
 void Model::SetColors(const std::vector<Color> &colors)
 {
 	assert(colors.size() == 3); //primary, seconday, trim
-	m_colorMap.Generate(GetRenderer(), colors.at(0), colors.at(1), colors.at(2));
+	m_colors[0] = colors.at(0);
+	m_colors[1] = colors.at(1);
+	m_colors[2] = colors.at(2);
 }
 
 void Model::SetDecalTexture(Graphics::Texture *t, unsigned int index)
@@ -601,6 +648,15 @@ void Model::LoadFromJson(const Json::Value &jsonObj)
 	SetPattern(modelObj["cur_pattern_index"].asUInt());
 }
 
+size_t Model::GetInstanceMemoryUsage() const
+{
+	size_t bytes = sizeof(Model) + m_instanceNodeBytes;
+	bytes += m_tags.capacity() * sizeof(MatrixTransform*);
+	for (const Animation *anim : m_animations)
+		bytes += sizeof(Animation) + anim->GetChannels().capacity() * sizeof(AnimationChannel);
+	return bytes;
+}
+
 std::string Model::GetNameForMaterial(Graphics::Material *mat) const
 {
 	for (auto it : m_materials) {
@@ -55,13 +55,18 @@
  *  - 3D labels (well, 2D) on models
  *  - spaceship thrusters
  *
+ * Instancing: MakeInstance copies only the nodes that can differ between instances
+ * (animated transforms, tags, labels, billboards and dynamic collision geometry,
+ * plus the groups leading to them). Everything else, along with materials, patterns,
+ * animation keys and the collision mesh, is shared with the model it was made from.
+ * Pattern colours are passed to the shared materials as parameters at draw time.
+ *
  * Things to optimize:
  *  - model cache
  *  - removing unnecessary nodes from the scene graph: pre-translate unanimated meshes etc.
  */
 #include "libs.h"
 #include "Animation.h"
-#include "ColorMap.h"
 #include "Group.h"
 #include "Label3D.h"
 #include "Pattern.h"
@@ -88,6 +93,10 @@ struct LoadingError : public std::runtime_error {
 	LoadingError(const std::string &str) : std::runtime_error(str.c_str()) { }
 };
 
+// Shields::ReparentShieldNodes moves shield geometry under transforms named
+// with this suffix. each instance gets its own copy of those subtrees
+extern const char SHIELD_TRANSFORM_SUFFIX[];
+
 typedef std::vector<std::pair<std::string, RefCountedPtr<Graphics::Material> > > MaterialContainer;
 typedef std::vector<Animation*> AnimationContainer;
 typedef std::vector<MatrixTransform *> TagContainer;
@@ -158,6 +167,12 @@ public:
 
 	Graphics::VertexArray& GetBillboardVA() { return m_billboardTris; }
 
+	//approximate memory used by this model's own state: the model object, the
+	//nodes MakeInstance copied for it and its animations. shared data (meshes,
+	//materials, textures, animation keys, collision mesh) isn't counted
+	size_t GetInstanceMemoryUsage() const;
+	unsigned int GetNumInstanceNodes() const { return m_numInstanceNodes; }
+
 	//serialization aid
 	std::string GetNameForMaterial(Graphics::Material*) const;
 
@@ -174,9 +189,9 @@ public:
 private:
 	Model(const Model&);
 	void DrawBillboards();
+	void ApplyInstanceState();
 
 	static const unsigned int MAX_DECAL_MATERIALS = 4;
-	ColorMap m_colorMap;
 	float m_boundingRadius;
 	MaterialContainer m_materials; //materials are shared throughout the model graph
 	PatternContainer m_patterns;
@@ -187,13 +202,18 @@ private:
 	std::string m_name;
 	std::vector<Animation *> m_animations;
 	TagContainer m_tags; //named attachment points
-	RenderData m_renderData;
 
 	//per-instance flavour data
+	RenderData m_renderData; //thruster levels
 	unsigned int m_curPatternIndex;
 	Graphics::Texture *m_curPattern;
+	Color m_colors[3];
 	Graphics::Texture *m_curDecals[MAX_DECAL_MATERIALS];
 
+	//nodes copied from the original by MakeInstance, and their size
+	unsigned int m_numInstanceNodes;
+	size_t m_instanceNodeBytes;
+
 	// debug support
 	void CreateAabbVB();
 	void DrawAabb();
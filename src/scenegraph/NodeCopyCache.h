@@ -6,6 +6,7 @@
 
 #include "RefCounted.h"
 #include <map>
+#include <set>
 
 namespace SceneGraph {
 
@@ -13,7 +14,14 @@ class Node;
 
 class NodeCopyCache {
 public:
+	//copy everything
+	NodeCopyCache() : m_copyOnly(nullptr), m_numCopies(0), m_copiedBytes(0) { }
+	//copy only the given nodes, and share the rest with the original
+	NodeCopyCache(const std::set<const Node*> *copyOnly) : m_copyOnly(copyOnly), m_numCopies(0), m_copiedBytes(0) { }
+
 	template <typename T> T *Copy(const T *origNode) {
+		if (m_copyOnly && !m_copyOnly->count(origNode))
+			return const_cast<T*>(origNode);
 		const bool doCache = origNode->GetRefCount() > 1;
 		if (doCache) {
 			std::map<const Node*,Node*>::const_iterator i = m_cache.find(origNode);
@@ -23,11 +31,27 @@ public:
 		T *newNode = new T(*origNode, this);
 		if (doCache)
 			m_cache.insert(std::make_pair(origNode, newNode));
+		m_numCopies++;
+		m_copiedBytes += sizeof(T);
 		return newNode;
 	}
 
+	//for nodes that are otherwise always shared: copied only when they're
+	//among the given nodes
+	template <typename T> T *CopyIfListed(const T *origNode) {
+		if (!m_copyOnly || !m_copyOnly->count(origNode))
+			return const_cast<T*>(origNode);
+		return Copy(origNode);
+	}
+
+	unsigned int GetNumCopies() const { return m_numCopies; }
+	size_t GetCopiedBytes() const { return m_copiedBytes; }
+
 private:
 	std::map<const Node*,Node*> m_cache;
+	const std::set<const Node*> *m_copyOnly;
+	unsigned int m_numCopies;
+	size_t m_copiedBytes;
 };
 
 }
@@ -3,6 +3,7 @@
 
 #include "StaticGeometry.h"
 #include "NodeVisitor.h"
+#include "NodeCopyCache.h"
 #include "Model.h"
 #include "BaseLoader.h"
 #include "graphics/Graphics.h"
@@ -33,7 +34,7 @@ StaticGeometry::StaticGeometry(const StaticGeometry &sg, NodeCopyCache *cache)
 
 Node* StaticGeometry::Clone(NodeCopyCache *cache)
 {
-	return this; //geometries are shared
+	return cache->CopyIfListed<StaticGeometry>(this); //geometries are shared, unless an instance needs its own
 }
 
 void StaticGeometry::Accept(NodeVisitor &nv)
@@ -103,12 +104,23 @@ void StaticGeometry::Render(const std::vector<matrix4x4f> &trans, const RenderDa
 		mat->emissive = it.material->emissive;
 		mat->shininess = it.material->shininess;
 		mat->specialParameter0 = it.material->specialParameter0;
+		// set per instance by Model::ApplyInstanceState
+		mat->patternColors[0] = it.material->patternColors[0];
+		mat->patternColors[1] = it.material->patternColors[1];
+		mat->patternColors[2] = it.material->patternColors[2];
+		mat->smoothPatternColors = it.material->smoothPatternColors;
 		// finally render using the instance material
 		r->DrawBufferIndexedInstanced(it.vertexBuffer.Get(), it.indexBuffer.Get(), m_renderState, mat.Get(), m_instBuffer.Get());
 	}
 }
 
 typedef std::vector<std::pair<std::string, RefCountedPtr<Graphics::Material> > > MaterialContainer;
+// position, normal, uv0 and optionally tangent, with no padding
+static inline Uint32 PackedVertexSize(bool hasTangents)
+{
+	return sizeof(vector3f) * 2 + sizeof(vector2f) + (hasTangents ? sizeof(vector3f) : 0);
+}
+
 void StaticGeometry::Save(NodeDatabase &db)
 {
     Node::Save(db);
@@ -133,41 +145,33 @@ void StaticGeometry::Save(NodeDatabase &db)
 
 		const bool hasTangents = (attribCombo & Graphics::ATTRIB_TANGENT);
 
-		//save positions, normals and uvs interleaved (only known format now)
+		//save positions, normals, uvs (and tangents) interleaved and tightly
+		//packed, which is exactly the layout Load asks the renderer for
 		const Uint32 posOffset = vbDesc.GetOffset(Graphics::ATTRIB_POSITION);
 		const Uint32 nrmOffset = vbDesc.GetOffset(Graphics::ATTRIB_NORMAL);
 		const Uint32 uv0Offset = vbDesc.GetOffset(Graphics::ATTRIB_UV0);
 		const Uint32 tanOffset = hasTangents ? vbDesc.GetOffset(Graphics::ATTRIB_TANGENT) : 0;
 		const Uint32 stride    = vbDesc.stride;
+		const Uint32 packedStride = PackedVertexSize(hasTangents);
 		db.wr->Int32(vbDesc.numVertices);
-		Uint8 *vtxPtr = mesh.vertexBuffer->Map<Uint8>(Graphics::BUFFER_MAP_READ);
-		if (hasTangents)
-		{
-			for (Uint32 i = 0; i < vbDesc.numVertices; i++) {
-				db.wr->Vector3f(*reinterpret_cast<vector3f*>(vtxPtr + i * stride + posOffset));
-				db.wr->Vector3f(*reinterpret_cast<vector3f*>(vtxPtr + i * stride + nrmOffset));
-				db.wr->Float(reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset)->x);
-				db.wr->Float(reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset)->y);
-				db.wr->Vector3f(*reinterpret_cast<vector3f*>(vtxPtr + i * stride + tanOffset));
-			}
-		}
-		else
-		{
-			for (Uint32 i = 0; i < vbDesc.numVertices; i++) {
-				db.wr->Vector3f(*reinterpret_cast<vector3f*>(vtxPtr + i * stride + posOffset));
-				db.wr->Vector3f(*reinterpret_cast<vector3f*>(vtxPtr + i * stride + nrmOffset));
-				db.wr->Float(reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset)->x);
-				db.wr->Float(reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset)->y);
-			}
+		std::vector<Uint8> packed(vbDesc.numVertices * packedStride);
+		const Uint8 *vtxPtr = mesh.vertexBuffer->Map<Uint8>(Graphics::BUFFER_MAP_READ);
+		for (Uint32 i = 0; i < vbDesc.numVertices; i++) {
+			Uint8 *out = &packed[i * packedStride];
+			memcpy(out,      vtxPtr + i * stride + posOffset, sizeof(vector3f));
+			memcpy(out + 12, vtxPtr + i * stride + nrmOffset, sizeof(vector3f));
+			memcpy(out + 24, vtxPtr + i * stride + uv0Offset, sizeof(vector2f));
+			if (hasTangents)
+				memcpy(out + 32, vtxPtr + i * stride + tanOffset, sizeof(vector3f));
 		}
 		mesh.vertexBuffer->Unmap();
+		db.wr->AlignedBlob(packed.empty() ? nullptr : &packed[0], packed.size());
 
 		//indices
 		const Uint32 *indexPtr = mesh.indexBuffer->Map(Graphics::BUFFER_MAP_READ);
 		const Uint32 numIndices = mesh.indexBuffer->GetSize();
 		db.wr->Int32(numIndices);
-		for (Uint32 i = 0; i < numIndices; i++)
-			db.wr->Int32(indexPtr[i]);
+		db.wr->AlignedBlob(indexPtr, numIndices * sizeof(Uint32));
 		mesh.indexBuffer->Unmap();
     }
 }
@@ -223,6 +227,11 @@ StaticGeometry *StaticGeometry::Load(NodeDatabase &db)
 		vbDesc.usage = Graphics::BUFFER_USAGE_STATIC;
 		vbDesc.numVertices = db.rd->Int32();
 
+		const Uint32 packedStride = PackedVertexSize(hasTangents);
+		const ByteRange vtxData = db.rd->AlignedBlob();
+		if (vtxData.Size() != size_t(vbDesc.numVertices) * packedStride)
+			throw LoadingError("Vertex data truncated");
+
 		RefCountedPtr<Graphics::VertexBuffer> vtxBuffer(db.loader->GetRenderer()->CreateVertexBuffer(vbDesc));
 		const Uint32 posOffset = vtxBuffer->GetDesc().GetOffset(Graphics::ATTRIB_POSITION);
 		const Uint32 nrmOffset = vtxBuffer->GetDesc().GetOffset(Graphics::ATTRIB_NORMAL);
@@ -230,35 +239,29 @@ StaticGeometry *StaticGeometry::Load(NodeDatabase &db)
 		const Uint32 tanOffset = hasTangents ? vtxBuffer->GetDesc().GetOffset(Graphics::ATTRIB_TANGENT) : 0;
 		const Uint32 stride = vtxBuffer->GetDesc().stride;
 		Uint8 *vtxPtr = vtxBuffer->Map<Uint8>(BUFFER_MAP_WRITE);
-		if (hasTangents)
-		{
-			for (Uint32 i = 0; i < vbDesc.numVertices; i++) {
-				*reinterpret_cast<vector3f*>(vtxPtr + i * stride + posOffset) = db.rd->Vector3f();
-				*reinterpret_cast<vector3f*>(vtxPtr + i * stride + nrmOffset) = db.rd->Vector3f();
-				const float uvx = db.rd->Float();
-				const float uvy = db.rd->Float();
-				*reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset) = vector2f(uvx, uvy);
-				*reinterpret_cast<vector3f*>(vtxPtr + i * stride + tanOffset) = db.rd->Vector3f();
-			}
-		}
-		else
-		{
+		if (stride == packedStride && posOffset == 0 && nrmOffset == 12 && uv0Offset == 24 && (!hasTangents || tanOffset == 32)) {
+			// same layout as the file, so one straight copy
+			memcpy(vtxPtr, vtxData.begin, vtxData.Size());
+		} else {
 			for (Uint32 i = 0; i < vbDesc.numVertices; i++) {
-				*reinterpret_cast<vector3f*>(vtxPtr + i * stride + posOffset) = db.rd->Vector3f();
-				*reinterpret_cast<vector3f*>(vtxPtr + i * stride + nrmOffset) = db.rd->Vector3f();
-				const float uvx = db.rd->Float();
-				const float uvy = db.rd->Float();
-				*reinterpret_cast<vector2f*>(vtxPtr + i * stride + uv0Offset) = vector2f(uvx, uvy);
+				const char *in = vtxData.begin + i * packedStride;
+				memcpy(vtxPtr + i * stride + posOffset, in,      sizeof(vector3f));
+				memcpy(vtxPtr + i * stride + nrmOffset, in + 12, sizeof(vector3f));
+				memcpy(vtxPtr + i * stride + uv0Offset, in + 24, sizeof(vector2f));
+				if (hasTangents)
+					memcpy(vtxPtr + i * stride + tanOffset, in + 32, sizeof(vector3f));
 			}
 		}
 		vtxBuffer->Unmap();
 
 		//index buffer
 		const Uint32 numIndices = db.rd->Int32();
+		const ByteRange idxData = db.rd->AlignedBlob();
+		if (idxData.Size() != size_t(numIndices) * sizeof(Uint32))
+			throw LoadingError("Index data truncated");
 		RefCountedPtr<Graphics::IndexBuffer> idxBuffer(db.loader->GetRenderer()->CreateIndexBuffer(numIndices, Graphics::BUFFER_USAGE_STATIC));
 		Uint32 *idxPtr = idxBuffer->Map(BUFFER_MAP_WRITE);
-		for (Uint32 i = 0; i < numIndices; i++)
-			idxPtr[i] = db.rd->Int32();
+		memcpy(idxPtr, idxData.begin, idxData.Size());
 		idxBuffer->Unmap();
 
 		sg->AddMesh(vtxBuffer, idxBuffer, material);
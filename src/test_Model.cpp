@@ -0,0 +1,103 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "NavLights.h"
+#include "Shields.h"
+#include "graphics/dummy/RendererDummy.h"
+#include "scenegraph/FindNodeVisitor.h"
+#include "scenegraph/SceneGraph.h"
+#include <iostream>
+
+using namespace std;
+using namespace SceneGraph;
+
+static void check(const char *what, bool ok)
+{
+	cout << what << ": " << (ok ? "pass" : "fail") << endl;
+}
+
+static MatrixTransform *FindTransform(Model *model, const std::string &name)
+{
+	FindNodeVisitor finder(FindNodeVisitor::MATCH_NAME_FULL, name);
+	model->GetRoot()->Accept(finder);
+	const std::vector<Node*> &results = finder.GetResults();
+	return results.empty() ? nullptr : dynamic_cast<MatrixTransform*>(results.front());
+}
+
+// instances share most of the graph with the model they came from, but each
+// ship attaches its own navlight billboards and sets its own shield state.
+// neither may leak into another instance, or outlive the one that made it
+void test_model_instances()
+{
+	cout << "----------------------------" << endl;
+	cout << "Running model instance tests" << endl;
+	cout << "----------------------------" << endl;
+
+	Graphics::RendererDummy renderer;
+	NavLights::Init(&renderer);
+	Shields::Init(&renderer);
+
+	Model *model = new Model(&renderer, "test");
+
+	MatrixTransform *light = new MatrixTransform(&renderer, matrix4x4f::Translation(5.0f, 0.0f, 0.0f));
+	light->SetName("navlight_red");
+	model->GetRoot()->AddChild(light);
+
+	// as Shields::ReparentShieldNodes leaves them
+	Group *shieldGroup = new Group(&renderer);
+	shieldGroup->SetName("Shields");
+	MatrixTransform *shieldTransform = new MatrixTransform(&renderer, matrix4x4f::Identity());
+	shieldTransform->SetName(std::string("0") + SHIELD_TRANSFORM_SUFFIX);
+	StaticGeometry *shieldMesh = new StaticGeometry(&renderer);
+	shieldMesh->SetName("test_shield");
+	shieldTransform->AddChild(shieldMesh);
+	shieldGroup->AddChild(shieldTransform);
+	model->GetRoot()->AddChild(shieldGroup);
+
+	Model *a = model->MakeInstance();
+	Model *b = model->MakeInstance();
+	NavLights *lightsA = new NavLights(a);
+	NavLights *lightsB = new NavLights(b);
+	Shields *shieldsA = new Shields(a);
+	Shields *shieldsB = new Shields(b);
+
+	MatrixTransform *lightA = FindTransform(a, "navlight_red");
+	MatrixTransform *lightB = FindTransform(b, "navlight_red");
+	check("navlight transforms are per instance", lightA && lightB && lightA != lightB && lightA != light);
+	check("one billboard per instance", lightB && lightB->GetNumChildren() == 1 && light->GetNumChildren() == 0);
+
+	check("shield geometry is per instance", shieldsA->GetFirstShieldMesh() != shieldsB->GetFirstShieldMesh()
+		&& shieldsB->GetFirstShieldMesh() != shieldMesh);
+
+	shieldsA->SetEnabled(false);
+	shieldsA->Update(0.0f, 1.0f);
+	shieldsB->SetEnabled(true);
+	shieldsB->Update(0.0f, 1.0f);
+	check("shield state is per instance", shieldsA->GetFirstShieldMesh()->GetNodeMask() == 0
+		&& shieldsB->GetFirstShieldMesh()->GetNodeMask() == NODE_TRANSPARENT);
+
+	delete shieldsA;
+	delete lightsA;
+	delete a;
+
+	// only b's own billboard is drawn, into b's billboard list
+	lightsB->SetEnabled(true);
+	lightsB->Update(0.0f);
+	RenderData rd;
+	rd.nodemask = NODE_TRANSPARENT | MASK_IGNORE;
+	b->Render(matrix4x4f::Translation(0.0f, 0.0f, -100.0f), &rd);
+	check("surviving instance renders its own billboard", b->GetBillboardVA().GetNumVerts() == 1);
+	b->GetBillboardVA().Clear();
+
+	delete shieldsB;
+	delete lightsB;
+	delete b;
+	delete model;
+
+	Shields::Uninit();
+	NavLights::Uninit();
+
+	cout << "----------------------------" << endl;
+	cout << "End of model instance tests." << endl;
+	cout << "----------------------------" << endl;
+}
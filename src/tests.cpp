@@ -5,6 +5,7 @@ void test_frames();
 void test_stringf();
 void test_random();
 void test_datetime();
+void test_model_instances();
 
 int main(int argc, char *argv[])
 {
@@ -12,5 +13,6 @@ int main(int argc, char *argv[])
 	test_stringf();
 	test_random();
 	test_datetime();
+	test_model_instances();
 	return 0;
 }
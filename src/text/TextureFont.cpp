@@ -22,6 +22,10 @@
 namespace {
 	static const int ATLAS_SIZE = 1024;
 	static double CACHE_EVICTION_TIME = 0.25;
+	// code points below this get a slot in the direct glyph table
+	static const Uint32 LATIN_GLYPHS = 0x250;
+	// evicted string buffers kept around for reuse
+	static const size_t MAX_FREE_BUFFERS = 64;
 };
 
 namespace Text {
@@ -84,7 +88,7 @@ void TextureFont::MeasureString(const std::string &str, float &w, float &h)
 				Uint32 chr2;
 				n = utf8_decode_char(&chr2, &str[i]);
 				assert(n);
-				line_width += GetKern(glyph, GetGlyph(chr2));
+				line_width += GetKern(chr, glyph, chr2, GetGlyph(chr2));
 			}
 		}
 	}
@@ -115,7 +119,7 @@ void TextureFont::MeasureCharacterPos(const std::string &str, int charIndex, flo
 			float advance = glyph.advX;
 
 			if (nextChar != '\n' && nextChar != '\0')
-				advance += GetKern(glyph, GetGlyph(nextChar));
+				advance += GetKern(chr, glyph, nextChar, GetGlyph(nextChar));
 
 			x += advance;
 		}
@@ -162,7 +166,7 @@ int TextureFont::PickCharacter(const std::string &str, float mouseX, float mouse
 			float advance = glyph.advX;
 
 			if (chr2 != '\n' && chr2 != '\0')
-				advance += GetKern(glyph, GetGlyph(chr2));
+				advance += GetKern(chr1, glyph, chr2, GetGlyph(chr2));
 
 			right = x + (advance / 2.0f);
 			x += advance;
@@ -225,7 +229,7 @@ void TextureFont::PopulateString(Graphics::VertexArray &va, const std::string &s
 				n = utf8_decode_char(&chr2, &str[i]);
 				assert(n);
 
-				px += GetKern(glyph, GetGlyph(chr2));
+				px += GetKern(chr, glyph, chr2, GetGlyph(chr2));
 			}
 
 			px += glyph.advX;
@@ -287,7 +291,7 @@ Color TextureFont::PopulateMarkup(Graphics::VertexArray &va, const std::string &
 				n = utf8_decode_char(&chr2, &str[i]);
 				assert(n);
 
-				px += GetKern(glyph, GetGlyph(chr2));
+				px += GetKern(chr, glyph, chr2, GetGlyph(chr2));
 			}
 
 			px += glyph.advX;
@@ -319,76 +323,102 @@ Graphics::VertexBuffer* TextureFont::CreateVertexBuffer(const Graphics::VertexAr
 	return nullptr;
 }
 
-Graphics::VertexBuffer* TextureFont::CreateVertexBuffer(const Graphics::VertexArray &va, const std::string &str, const bool bIsStatic)
+Graphics::VertexBuffer* TextureFont::CreateVertexBuffer(const Graphics::VertexArray &va, const std::string &str, const bool bIsStatic, const Color &color, const bool markup)
 {
 	if( va.GetNumVerts() > 0 )
 	{
-		Graphics::VertexBuffer *pVB = GetCachedVertexBuffer(str);
+		Graphics::VertexBuffer *pVB = GetCachedVertexBuffer(str, color, markup);
 		if (pVB)
 			return pVB;
 
-		//create buffer and upload data
-		Graphics::VertexBuffer *vbuffer = CreateVertexBuffer(va, bIsStatic);
-		AddCachedVertexBuffer(vbuffer, str);
+		++m_stats.runMisses;
+
+		// strings that change every frame (counters, timers) usually keep
+		// their length, so there's often an old buffer that will do
+		RefCountedPtr<Graphics::VertexBuffer> vbuffer;
+		auto free = m_vbFree.find(va.GetNumVerts());
+		if (free != m_vbFree.end()) {
+			vbuffer = free->second;
+			m_vbFree.erase(free);
+			vbuffer->Populate(va);
+			++m_stats.runsRecycled;
+		} else {
+			//create buffer and upload data
+			vbuffer.Reset(CreateVertexBuffer(va, bIsStatic));
+		}
 
-		return vbuffer;
+		// set the time that the buffer was added to the cache
+		RunKey key;
+		key.str = str;
+		key.color = color;
+		key.markup = markup;
+		m_vbTextCache[key] = std::make_pair(0.001 * double(SDL_GetTicks()), vbuffer);
+
+		return vbuffer.Get();
 	}
 	return nullptr;
 }
 
-Graphics::VertexBuffer* TextureFont::GetCachedVertexBuffer(const std::string &str)
+Graphics::VertexBuffer* TextureFont::GetCachedVertexBuffer(const std::string &str, const Color &color, const bool markup)
 {
-	VBHashMapIter found = m_vbTextCache.find(str);
+	// reuse the same key so a lookup doesn't allocate
+	m_lookupKey.str = str;
+	m_lookupKey.color = color;
+	m_lookupKey.markup = markup;
+	VBHashMapIter found = m_vbTextCache.find(m_lookupKey);
 	if (found == m_vbTextCache.end()) {
 		return nullptr;
 	}
+	++m_stats.runHits;
 
 	// update the last access time
 	const double lastAccessTime = 0.001 * double(SDL_GetTicks());
 	found->second.first = lastAccessTime;
 
+	// return the vertex buffer
+	Graphics::VertexBuffer *vb = found->second.second.Get();
+
 	if ((lastAccessTime - m_lfLastCacheCleanTime) > CACHE_EVICTION_TIME) {
 		CleanVertexBufferCache();
 		m_lfLastCacheCleanTime = lastAccessTime;
 	}
 
-	// return the vertex buffer
-	return found->second.second.Get();
-}
-
-void TextureFont::AddCachedVertexBuffer(Graphics::VertexBuffer *pVB, const std::string &str)
-{
-	Graphics::VertexBuffer *pLocalVB = GetCachedVertexBuffer(str);
-	if (pLocalVB)
-		return;
-
-	// set the time that the buffer was added to the cache
-	const double lastAccessTime = 0.001 * double(SDL_GetTicks());
-	m_vbTextCache[str] = std::make_pair(lastAccessTime, RefCountedPtr<Graphics::VertexBuffer>(pVB));
+	return vb;
 }
 
 Uint32 TextureFont::CleanVertexBufferCache()
 {
-	// update the last access time
 	Uint32 numDeleted = 0;
 	const double currentTime = 0.001 * double(SDL_GetTicks());
-	for (auto it : m_vbTextCache) {
-		if ((currentTime - it.second.first) > CACHE_EVICTION_TIME) {
-			it.second.second.Reset();
+	for (VBHashMapIter it = m_vbTextCache.begin(); it != m_vbTextCache.end(); ) {
+		if ((currentTime - it->second.first) > CACHE_EVICTION_TIME) {
+			// keep it for reuse, unless somebody else still has hold of it
+			const RefCountedPtr<Graphics::VertexBuffer> &vb = it->second.second;
+			if (vb->GetRefCount() == 1 && m_vbFree.size() < MAX_FREE_BUFFERS)
+				m_vbFree.insert(std::make_pair(vb->GetVertexCount(), vb));
+			it = m_vbTextCache.erase(it);
 			++numDeleted;
-		}
+		} else
+			++it;
 	}
 	return numDeleted;
 }
 
 const TextureFont::Glyph &TextureFont::GetGlyph(Uint32 chr)
 {
+	if (chr < LATIN_GLYPHS) {
+		if (!m_latinBaked[chr]) {
+			m_latinGlyphs[chr] = BakeGlyph(chr);
+			m_latinBaked[chr] = true;
+		}
+		return m_latinGlyphs[chr];
+	}
+
 	auto i = m_glyphs.find(chr);
 	if (i != m_glyphs.end())
 		return (*i).second;
 
-	m_glyphs[chr] = BakeGlyph(chr);
-	return m_glyphs[chr];
+	return m_glyphs.insert(std::make_pair(chr, BakeGlyph(chr))).first->second;
 }
 
 
@@ -581,6 +611,10 @@ TextureFont::TextureFont(const FontConfig &config, Graphics::Renderer *renderer,
 	, m_atlasVIncrement(0)
 	, m_lfLastCacheCleanTime(0.0)
 {
+	m_latinGlyphs.resize(LATIN_GLYPHS);
+	m_latinBaked.resize(LATIN_GLYPHS, false);
+	ClearCacheStats();
+
 	renderer->CheckRenderErrors(__FUNCTION__,__LINE__);
 
 	FT_Error err; // used to store freetype error return codes
@@ -671,14 +705,24 @@ FT_Face TextureFont::GetFTFace(const FontConfig::Face &face)
 	return ftFace;
 }
 
-float TextureFont::GetKern(const Glyph &a, const Glyph &b)
+float TextureFont::GetKern(Uint32 chrA, const Glyph &a, Uint32 chrB, const Glyph &b)
 {
-	if (a.ftFace != b.ftFace)
+	if (!a.ftFace || a.ftFace != b.ftFace || !FT_HAS_KERNING(a.ftFace))
 		return 0.0f;
 
+	const Uint64 pair = (Uint64(chrA) << 32) | chrB;
+	auto i = m_kerning.find(pair);
+	if (i != m_kerning.end()) {
+		++m_stats.kernHits;
+		return (*i).second;
+	}
+	++m_stats.kernMisses;
+
 	FT_Vector kern;
 	FT_Get_Kerning(a.ftFace, a.ftIndex, b.ftIndex, FT_KERNING_UNFITTED, &kern);
-	return float(kern.x) / 64.0f;
+	const float k = float(kern.x) / 64.0f;
+	m_kerning.insert(std::make_pair(pair, k));
+	return k;
 }
 
 }
@@ -40,8 +40,12 @@ public:
 	void PopulateString(Graphics::VertexArray &va, const std::string &str, const float x, const float y, const Color &color = Color::WHITE);
 	Color PopulateMarkup(Graphics::VertexArray &va, const std::string &str, const float x, const float y, const Color &color = Color::WHITE);
 	Graphics::VertexBuffer* CreateVertexBuffer(const Graphics::VertexArray &va, const bool bIsStatic) const;
-	Graphics::VertexBuffer* CreateVertexBuffer(const Graphics::VertexArray &va, const std::string &str, const bool bIsStatic);
-	Graphics::VertexBuffer* GetCachedVertexBuffer(const std::string &str);
+	// cached string geometry, keyed on the string, the colour it was
+	// populated with and whether it was populated as markup. buffers are
+	// owned by the font and are dropped (or recycled for another string of
+	// the same length) once they haven't been asked for in a little while
+	Graphics::VertexBuffer* CreateVertexBuffer(const Graphics::VertexArray &va, const std::string &str, const bool bIsStatic, const Color &color = Color::WHITE, const bool markup = false);
+	Graphics::VertexBuffer* GetCachedVertexBuffer(const std::string &str, const Color &color = Color::WHITE, const bool markup = false);
 
 	// general baseline-to-baseline height
 	float GetHeight() const { return m_height; }
@@ -63,14 +67,33 @@ public:
 	static int GetGlyphCount() { return s_glyphCount; }
 	static void ClearGlyphCount() { s_glyphCount = 0; }
 
+	struct CacheStats {
+		Uint32 runHits, runMisses, runsRecycled;
+		Uint32 kernHits, kernMisses;
+	};
+	const CacheStats &GetCacheStats() const { return m_stats; }
+	void ClearCacheStats() { memset(&m_stats, 0, sizeof(m_stats)); }
+
 	RefCountedPtr<Graphics::Texture> GetTexture() const  { return m_texture; }
 	Graphics::Material* GetMaterial() const { return m_mat.get(); }
+	Graphics::RenderState* GetRenderState() const { return m_renderState; }
 
 private:
 	TextureFont(const TextureFont &);
 	TextureFont &operator=(const TextureFont &);
 
-	void AddCachedVertexBuffer(Graphics::VertexBuffer *pVB, const std::string &str);
+	struct RunKey {
+		std::string str;
+		Color color;
+		bool markup;
+		bool operator==(const RunKey &o) const { return markup == o.markup && color == o.color && str == o.str; }
+	};
+	struct RunKeyHash {
+		size_t operator()(const RunKey &k) const {
+			return std::hash<std::string>()(k.str) ^ (size_t(k.color.r | (k.color.g << 8) | (k.color.b << 16) | (Uint32(k.color.a) << 24)) * 31) ^ size_t(k.markup);
+		}
+	};
+
 	Uint32 CleanVertexBufferCache();
 
 	FontConfig m_config;
@@ -85,7 +108,9 @@ private:
 
 	Glyph BakeGlyph(Uint32 chr);
 
-	float GetKern(const Glyph &a, const Glyph &b);
+	// kerning between two code points, cached by pair
+	float GetKern(Uint32 chrA, const Glyph &a, Uint32 chrB, const Glyph &b);
+	std::unordered_map<Uint64,float> m_kerning;
 
 	void AddGlyphGeometry(Graphics::VertexArray &va, const Glyph &glyph, const float x, const float y, const Color &color);
 	float m_height;
@@ -95,7 +120,11 @@ private:
 
 	static int s_glyphCount;
 
-	std::map<Uint32,Glyph> m_glyphs;
+	// the Latin blocks cover nearly everything we draw, so they're indexed
+	// directly. everything else is hashed
+	std::vector<Glyph> m_latinGlyphs;
+	std::vector<bool> m_latinBaked;
+	std::unordered_map<Uint32,Glyph> m_glyphs;
 
 	// UV offsets for glyphs
 	unsigned int m_atlasU;
@@ -109,11 +138,16 @@ private:
 	int m_bufWidth, m_bufHeight;
 	int m_bpp;
 
-	typedef std::unordered_map<std::string, std::pair<double,RefCountedPtr<Graphics::VertexBuffer>>> VBHashMap;
+	typedef std::unordered_map<RunKey, std::pair<double,RefCountedPtr<Graphics::VertexBuffer>>, RunKeyHash> VBHashMap;
 	typedef VBHashMap::iterator VBHashMapIter;
 	typedef VBHashMap::const_iterator VBHashMapConstIter;
 	VBHashMap m_vbTextCache;
 	double m_lfLastCacheCleanTime;
+	// evicted buffers nobody else holds, by vertex count
+	std::unordered_multimap<Uint32, RefCountedPtr<Graphics::VertexBuffer>> m_vbFree;
+	RunKey m_lookupKey;
+
+	CacheStats m_stats;
 };
 
 }
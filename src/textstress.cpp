@@ -7,14 +7,45 @@
 #include "OS.h"
 #include "graphics/Graphics.h"
 #include "graphics/Renderer.h"
-#include "text/FontDescriptor.h"
+#include "graphics/VertexArray.h"
+#include "graphics/VertexBuffer.h"
+#include "text/FontConfig.h"
 #include "text/TextureFont.h"
 
+// text throughput benchmark. draws a screen full of labels for a number of
+// frames, the way a busy HUD would: mostly the same strings every frame, some
+// numbers that change each frame, all measured before they're drawn.
+//
+//   textstress [frames] [font]
+
 static const int WIDTH  = 1024;
 static const int HEIGHT = 768;
 
+static const int NUM_LABELS = 400;
+static const int DEFAULT_FRAMES = 600;
+
+static const char *WORDS[] = {
+	"Hydrogen", "Liquid Oxygen", "Medicines", "Fruit and Vegetables", "Rubbish",
+	"Sol", "Barnard's Star", "Epsilon Eridani", "Ross 154", "Lave",
+	"Sinonatrix", "Kanara Assault Drone", "Natrix", "Deneb Lux", "Malabar",
+	"Café", "Zürich", "Ñandú", "Ærøskøbing", "Œuvre",
+};
+
+// wall clock time, summed over every Start/Stop pair
+struct StressTimer {
+	StressTimer() : m_start(0), m_total(0) {}
+	void Start() { m_start = SDL_GetPerformanceCounter(); }
+	void Stop() { m_total += SDL_GetPerformanceCounter() - m_start; }
+	double Milliseconds() const { return double(m_total) * 1000.0 / double(SDL_GetPerformanceFrequency()); }
+private:
+	Uint64 m_start, m_total;
+};
+
 int main(int argc, char **argv)
 {
+	const int numFrames = argc > 1 ? std::max(1, atoi(argv[1])) : DEFAULT_FRAMES;
+	const std::string fontName = argc > 2 ? argv[2] : "UIFont";
+
 	FileSystem::Init();
 
 	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -31,6 +62,7 @@ int main(int argc, char **argv)
 	videoSettings.requestedSamples = 0;
 	videoSettings.vsync = false;
 	videoSettings.useTextureCompression = false;
+	videoSettings.useAnisotropicFiltering = false;
 	videoSettings.enableDebugMessages = false;
 	videoSettings.iconFile = OS::GetIconFilename();
 	videoSettings.title = "textstress";
@@ -40,32 +72,86 @@ int main(int argc, char **argv)
 	r->SetOrthographicProjection(0, WIDTH, HEIGHT, 0, -1, 1);
 	r->SetTransform(matrix4x4f::Identity());
 	r->SetClearColor(Color::BLACK);
-	r->SetBlendMode(Graphics::BLEND_ALPHA);
-	r->SetDepthTest(false);
 
-	const Text::FontDescriptor fontDesc(Text::FontDescriptor::Load(FileSystem::gameDataFiles, "fonts/UIFont.ini", "en"));
-	Text::TextureFont *font = new Text::TextureFont(fontDesc, r);
+	const Text::FontConfig config(fontName);
+	RefCountedPtr<Text::TextureFont> font(new Text::TextureFont(config, r));
+
+	std::vector<std::string> labels(NUM_LABELS);
+	std::vector<Color> colors(NUM_LABELS);
+	for (int i = 0; i < NUM_LABELS; i++) {
+		labels[i] = WORDS[i % COUNTOF(WORDS)];
+		colors[i] = Color(128 + (i * 37) % 128, 128 + (i * 59) % 128, 128 + (i * 83) % 128);
+	}
 
-	std::string str;
-	for (int i = 33; i < 127; i++)
-		str.push_back(i);
+	StressTimer measureTimer, populateTimer, drawTimer, frameTimer;
+	Uint64 glyphs = 0;
+	char buf[64];
 
-	while (1) {
+	frameTimer.Start();
+	int frame;
+	for (frame = 0; frame < numFrames; frame++) {
 		bool done = false;
 
 		SDL_Event event;
 		while (SDL_PollEvent(&event)) {
-			if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)
+			if ((event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) || event.type == SDL_QUIT)
 				done = true;
 		}
 		if (done)
 			break;
 
-		font->RenderString(str.c_str(), rand()%(WIDTH*2)-WIDTH, rand()%HEIGHT, Color::WHITE);
+		// a quarter of the labels are readouts that change every frame
+		for (int i = 0; i < NUM_LABELS; i += 4) {
+			snprintf(buf, sizeof(buf), "%s %d.%02d km/s", WORDS[i % COUNTOF(WORDS)], (frame + i) % 1000, (frame * 7 + i) % 100);
+			labels[i] = buf;
+		}
+
+		r->BeginFrame();
+		r->ClearScreen();
+
+		measureTimer.Start();
+		float w, h, x = 0.0f, y = 0.0f;
+		for (const std::string &s : labels)
+			font->MeasureString(s, w, h);
+		measureTimer.Stop();
+
+		drawTimer.Start();
+		for (int i = 0; i < NUM_LABELS; i++) {
+			font->MeasureString(labels[i], w, h);
+			if (x + w > WIDTH) { x = 0.0f; y += h; }
+			if (y > HEIGHT) y = 0.0f;
+
+			r->SetTransform(matrix4x4f::Translation(x, y, 0.0f));
+			Graphics::VertexBuffer *vb = font->GetCachedVertexBuffer(labels[i], colors[i]);
+			if (!vb) {
+				populateTimer.Start();
+				Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0);
+				font->PopulateString(va, labels[i], 0.0f, 0.0f, colors[i]);
+				populateTimer.Stop();
+				vb = font->CreateVertexBuffer(va, labels[i], true, colors[i]);
+			}
+			font->RenderBuffer(vb, colors[i]);
+			glyphs += labels[i].size();
+			x += w + 8.0f;
+		}
+		drawTimer.Stop();
+
+		r->EndFrame();
 		r->SwapBuffers();
 	}
+	frameTimer.Stop();
+
+	const Text::TextureFont::CacheStats &stats = font->GetCacheStats();
+	Output("textstress: %d frames, %d labels, font %s\n", frame, NUM_LABELS, fontName.c_str());
+	Output("  total    %12.3lf ms (%.3lf ms/frame)\n", frameTimer.Milliseconds(), frameTimer.Milliseconds() / std::max(frame, 1));
+	Output("  measure  %12.3lf ms\n", measureTimer.Milliseconds());
+	Output("  populate %12.3lf ms\n", populateTimer.Milliseconds());
+	Output("  draw     %12.3lf ms\n", drawTimer.Milliseconds());
+	Output("  %.0lf glyphs/s\n", double(glyphs) / (frameTimer.Milliseconds() * 0.001));
+	Output("  runs: %u hits, %u misses, %u buffers recycled\n", stats.runHits, stats.runMisses, stats.runsRecycled);
+	Output("  kerning: %u hits, %u misses\n", stats.kernHits, stats.kernMisses);
 
-	delete font;
+	font.Reset();
 	delete r;
 
 	SDL_Quit();
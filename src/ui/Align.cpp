@@ -8,7 +8,7 @@ namespace UI {
 Point Align::PreferredSize()
 {
 	if (!GetInnerWidget()) return Point();
-	return GetInnerWidget()->PreferredSize();
+	return GetInnerWidget()->GetPreferredSize();
 }
 
 void Align::Layout()
@@ -61,7 +61,7 @@ void Align::Layout()
 	}
 
 	SetWidgetDimensions(GetInnerWidget(), pos, Point(std::min(size.x, preferred.x), std::min(size.y, preferred.y)));
-	GetInnerWidget()->Layout();
+	LayoutWidget(GetInnerWidget());
 }
 
 }
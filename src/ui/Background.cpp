@@ -12,7 +12,7 @@ Point Background::PreferredSize()
 	const Skin::BorderedRectElement &elem(GetContext()->GetSkin().BackgroundNormal());
 	const Point borderSize(elem.borderWidth*2, elem.borderHeight*2);
 	if (!GetInnerWidget()) return borderSize;
-	Point preferredSize = SizeAdd(GetInnerWidget()->PreferredSize(), Point(elem.paddingX*2, elem.paddingY*2));
+	Point preferredSize = SizeAdd(GetInnerWidget()->GetPreferredSize(), Point(elem.paddingX*2, elem.paddingY*2));
 	preferredSize.x = std::max(preferredSize.x, borderSize.x);
 	preferredSize.y = std::max(preferredSize.y, borderSize.y);
 	return preferredSize;
@@ -23,7 +23,7 @@ void Background::Layout()
 	if (!GetInnerWidget()) return;
 	const Skin::BorderedRectElement &elem(GetContext()->GetSkin().BackgroundNormal());
 	SetWidgetDimensions(GetInnerWidget(), Point(elem.paddingX, elem.paddingY), GetSize()-Point(elem.paddingX*2, elem.paddingY*2));
-	return GetInnerWidget()->Layout();
+	LayoutWidget(GetInnerWidget());
 }
 
 void Background::Draw()
@@ -45,7 +45,7 @@ void Button::Layout()
 
 	const Point innerSize = GetSize() - Point(elem.paddingX*2, elem.paddingY*2);
 	SetWidgetDimensions(innerWidget, Point(elem.paddingX, elem.paddingY), innerWidget->CalcSize(innerSize));
-	innerWidget->Layout();
+	LayoutWidget(innerWidget);
 
 	Point innerActiveArea(innerWidget->GetActiveArea());
 	growToMinimum(innerActiveArea, GetContext()->GetSkin().ButtonMinInnerSize());
@@ -39,6 +39,7 @@ void CheckBox::Draw()
 void CheckBox::Toggle()
 {
 	m_checked = !m_checked;
+	MarkDrawDirty();
 	onValueChanged.emit(m_checked);
 }
 
@@ -14,7 +14,7 @@ class ColorBackground : public Single {
 public:
 	virtual void Draw();
 
-	void SetColor(const Color &color) { m_color = color; }
+	void SetColor(const Color &color) { m_color = color; MarkDrawDirty(); }
 
 protected:
 	friend class Context;
@@ -35,7 +35,21 @@ void Container::Draw()
 void Container::LayoutChildren()
 {
 	for (auto end = m_widgets.end(), it = m_widgets.begin(); it != end; ++it)
-		(*it)->Layout();
+		LayoutWidget((*it).Get());
+}
+
+void Container::LayoutWidget(Widget *widget)
+{
+	assert(widget->GetContainer() == this);
+
+	if (!widget->m_layoutDirty && widget->m_layoutSize == widget->GetSize())
+		return;
+
+	// cleared first, so a widget that asks for layout again while it's being
+	// laid out gets another go
+	widget->m_layoutDirty = false;
+	widget->m_layoutSize = widget->GetSize();
+	widget->Layout();
 }
 
 void Container::AddWidget(Widget *widget)
@@ -51,7 +65,9 @@ void Container::AddWidget(Widget *widget)
 	widget->Attach(this);
 	m_widgets.push_back(RefCountedPtr<Widget>(widget));
 
-	GetContext()->RequestLayout();
+	if (IsVisible())
+		GetContext()->ShortcutsChanged();
+	RequestLayout();
 }
 
 void Container::RemoveWidget(Widget *widget)
@@ -67,7 +83,9 @@ void Container::RemoveWidget(Widget *widget)
 	widget->Detach();
 	m_widgets.erase(i);
 
-	GetContext()->RequestLayout();
+	if (IsVisible())
+		GetContext()->ShortcutsChanged();
+	RequestLayout();
 }
 
 void Container::RemoveAllWidgets()
@@ -75,7 +93,10 @@ void Container::RemoveAllWidgets()
 	for (auto end = m_widgets.end(), it = m_widgets.begin(); it != end; ++it)
 		(*it)->Detach();
 	m_widgets.clear();
-	GetContext()->RequestLayout();
+
+	if (IsVisible())
+		GetContext()->ShortcutsChanged();
+	RequestLayout();
 }
 
 void Container::Disable()
@@ -102,6 +123,13 @@ void Container::NotifyVisible(bool visible)
 	}
 }
 
+void Container::InvalidateLayoutTree()
+{
+	Widget::InvalidateLayoutTree();
+	for (std::vector< RefCountedPtr<Widget> >::iterator i = m_widgets.begin(); i != m_widgets.end(); ++i)
+		(*i)->InvalidateLayoutTree();
+}
+
 void Container::DisableChildren()
 {
 	for (std::vector< RefCountedPtr<Widget> >::iterator i = m_widgets.begin(); i != m_widgets.end(); ++i) {
@@ -10,10 +10,12 @@
 
 // Container is the base class for all UI containers. Containers must
 // provide a Layout() method that implements its layout strategy. Layout()
-// will typically call PreferredSize() on its children to request their
-// desired sizings then call SetSize() on its children to set their sizes
-// appropriately. Containers should then call LayoutChildren() to make its
-// children do their layout.
+// will typically call GetPreferredSize() on its children to request their
+// desired sizings then call SetWidgetDimensions() on its children to set
+// their sizes appropriately. Containers should then call LayoutChildren() (or
+// LayoutWidget() for each child) to make its children do their layout.
+// Children that haven't changed size and haven't asked for layout are
+// skipped.
 //
 // Containers don't have provide Update() or Draw(). If they do they should
 // make sure that they call the baseclass methods so that child widgets will
@@ -55,6 +57,12 @@ protected:
 
 	void SetWidgetDimensions(Widget *widget, const Point &position, const Point &size);
 
+	// lay out a child, if it has asked for layout or its size has changed
+	// since it was last laid out
+	void LayoutWidget(Widget *widget);
+
+	virtual void InvalidateLayoutTree();
+
 private:
 
 	// EventDispatcher will call here on layout change to get the shortcuts
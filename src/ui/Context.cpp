@@ -47,8 +47,11 @@ Context::Context(LuaManager *lua, Graphics::Renderer *renderer, int width, int h
 	m_mousePointer(nullptr),
 	m_mousePointerEnabled(true),
 	m_eventDispatcher(this),
-	m_skin("ui/Skin.ini", renderer, scale),
-	m_lua(lua)
+	m_drawList(renderer),
+	m_skin("ui/Skin.ini", renderer, &m_drawList, scale),
+	m_lua(lua),
+	m_drawing(false),
+	m_rendererStateValid(false)
 {
 	lua_State *l = m_lua->GetLuaState();
 	lua_newtable(l);
@@ -127,17 +130,94 @@ Widget *Context::GetWidgetAt(const Point &pos)
 
 void Context::Layout()
 {
+	PROFILE_SCOPED()
+
 	// some widgets (eg MultiLineText) can require two layout passes because we
 	// don't know their preferred size until after their first layout run. so
 	// then we have to do layout again to make sure everyone else gets it right
 	m_needsLayout = false;
 
+	// this covers anything that was asked for already
+	for (auto it = m_layoutRequests.begin(); it != m_layoutRequests.end(); ++it)
+		(*it)->m_layoutQueued = false;
+	m_layoutRequests.clear();
+
+	m_eventDispatcher.ShortcutsChanged();
+
+	InvalidateLayoutTree();
 	LayoutChildren();
-	if (m_needsLayout)
+	if (m_needsLayout) {
+		InvalidateLayoutTree();
 		LayoutChildren();
+	}
 
 	m_needsLayout = false;
 
+	// anything that asked during the full layout (the second pass above, for
+	// widgets that use RequestLayout() on themselves) gets done now
+	UpdateLayout();
+}
+
+// finds the widget that has to be laid out again to satisfy a request from
+// the given widget. that's the widget itself if its preferred size hasn't
+// changed, otherwise its container has to make room for it, and so on up.
+// marks everything on the way as needing layout. returns 0 if the widget
+// isn't attached
+Widget *Context::FindLayoutRoot(Widget *widget)
+{
+	Widget *w = widget;
+	while (true) {
+		Container *container = w->GetContainer();
+		if (!container)
+			return 0;
+
+		const Point oldSize(w->m_preferredSize);
+		w->InvalidateLayout();
+
+		// layers are always the size of the screen
+		if (container == this)
+			return w;
+
+		if (w->GetPreferredSize() == oldSize && !w->IsLayoutShared())
+			return w;
+
+		w = container;
+	}
+}
+
+void Context::UpdateLayout()
+{
+	PROFILE_SCOPED()
+
+	// same as a full layout, a widget that asks again during the first pass
+	// gets a second. anything still asking after that waits for next time
+	for (int pass = 0; pass < 2 && !m_layoutRequests.empty(); pass++) {
+		std::vector< RefCountedPtr<Widget> > requests;
+		requests.swap(m_layoutRequests);
+
+		std::vector<Widget*> roots;
+		roots.reserve(requests.size());
+		for (auto it = requests.begin(); it != requests.end(); ++it) {
+			Widget *w = (*it).Get();
+			w->m_layoutQueued = false;
+			if (!w->IsVisible())
+				continue;
+			if (Widget *root = FindLayoutRoot(w))
+				roots.push_back(root);
+		}
+
+		// a root inside another root's subtree will already have been done
+		// along with it
+		for (auto it = roots.begin(); it != roots.end(); ++it) {
+			Widget *root = *it;
+			if (!root->m_layoutDirty)
+				continue;
+			root->m_layoutDirty = false;
+			root->m_layoutSize = root->GetSize();
+			root->Layout();
+		}
+	}
+
 	m_eventDispatcher.LayoutUpdated();
 }
 
@@ -147,29 +227,38 @@ void Context::Update()
 
 	if (m_needsLayout)
 		Layout();
+	else if (!m_layoutRequests.empty())
+		UpdateLayout();
 
 	if (m_mousePointer && m_mousePointerEnabled)
-		SetWidgetDimensions(m_mousePointer, m_eventDispatcher.GetMousePos()-m_mousePointer->GetHotspot(), m_mousePointer->PreferredSize());
+		SetWidgetDimensions(m_mousePointer, m_eventDispatcher.GetMousePos()-m_mousePointer->GetHotspot(), m_mousePointer->GetPreferredSize());
 
 	Container::Update();
 }
 
 void Context::Draw()
 {
-	Graphics::Renderer *r = GetRenderer();
+	PROFILE_SCOPED()
+
+	Graphics::Renderer *r = m_renderer;
 	r->ClearDepthBuffer();
 
 	// Ticket for the viewport mostly
 	Graphics::Renderer::StateTicket ticket(r);
 	r->SetViewport(0, 0, m_width, m_height);
 
+	m_drawList.ClearStats();
+	m_drawing = true;
+
 	// reset renderer for each layer
 	for (std::vector<Layer*>::iterator i = m_layers.begin(); i != m_layers.end(); ++i) {
 		r->SetOrthographicProjection(0, m_width, m_height, 0, -1, 1);
 		r->SetTransform(matrix4x4f::Identity());
 		r->SetClearColor(Color::BLACK);
+		m_rendererStateValid = false;
 
 		DrawWidget(*i);
+		m_drawList.Flush();
 
 		r->SetScissor(false);
 	}
@@ -178,9 +267,13 @@ void Context::Draw()
 		r->SetOrthographicProjection(0, m_width, m_height, 0, -1, 1);
 		r->SetTransform(matrix4x4f::Identity());
 		r->SetClearColor(Color::BLACK);
+		m_rendererStateValid = false;
 		DrawWidget(m_mousePointer);
+		m_drawList.Flush();
 		r->SetScissor(false);
 	}
+
+	m_drawing = false;
 }
 
 Widget *Context::CallTemplate(const char *name, const LuaTable &args)
@@ -237,23 +330,70 @@ void Context::DrawWidget(Widget *w)
 
 	m_scissorStack.push(std::make_pair(newScissorPos, newScissorSize));
 
-	m_renderer->SetScissor(true, vector2f(newScissorPos.x, m_height - newScissorPos.y - newScissorSize.y), vector2f(newScissorSize.x, newScissorSize.y));
-
 	m_drawWidgetPosition += drawOffset;
 
-	m_renderer->SetTransform(matrix4x4f::Translation(m_drawWidgetPosition.x, m_drawWidgetPosition.y, 0));
+	m_drawList.SetOrigin(m_drawWidgetPosition);
+	m_drawList.SetClip(newScissorPos, newScissorSize);
+	m_rendererStateValid = false;
 
 	float oldOpacity = m_opacityStack.empty() ? 1.0f : m_opacityStack.top();
 	float opacity = oldOpacity * w->GetAnimatedOpacity();
 	m_opacityStack.push(opacity);
 	m_skin.SetOpacity(opacity);
 
-	w->Draw();
+	DrawList::Segment &cache = w->m_drawCache;
+	if (!w->m_drawDirty && m_drawList.IsBatching() && cache.Matches(m_drawWidgetPosition, newScissorPos, newScissorSize, opacity))
+		m_drawList.Replay(cache);
+	else {
+		const DrawList::Mark mark = m_drawList.GetMark();
+
+		w->Draw();
+
+		if (m_drawList.Capture(mark, cache)) {
+			cache.valid = true;
+			cache.origin = m_drawWidgetPosition;
+			cache.clipPos = newScissorPos;
+			cache.clipSize = newScissorSize;
+			cache.opacity = opacity;
+		}
+		else
+			cache.Invalidate();
+
+		w->m_drawDirty = false;
+	}
 
 	m_opacityStack.pop();
 	m_scissorStack.pop();
 
 	m_drawWidgetPosition -= finalPos + drawOffset;
+
+	// back to the parent, which may not be finished yet
+	const std::pair<Point,Point> &parentScissor(m_scissorStack.top());
+	m_drawList.SetOrigin(m_drawWidgetPosition);
+	m_drawList.SetClip(parentScissor.first, parentScissor.second);
+	m_skin.SetOpacity(oldOpacity);
+	m_rendererStateValid = false;
+}
+
+Graphics::Renderer *Context::GetRenderer()
+{
+	if (m_drawing) {
+		if (!m_drawList.IsEmpty())
+			m_rendererStateValid = false;
+		m_drawList.Flush();
+
+		if (!m_rendererStateValid)
+			SetDrawState();
+	}
+	return m_renderer;
+}
+
+void Context::SetDrawState()
+{
+	const std::pair<Point,Point> &scissor(m_scissorStack.top());
+	m_renderer->SetScissor(true, vector2f(scissor.first.x, m_height - scissor.first.y - scissor.second.y), vector2f(scissor.second.x, scissor.second.y));
+	m_renderer->SetTransform(matrix4x4f::Translation(m_drawWidgetPosition.x, m_drawWidgetPosition.y, 0));
+	m_rendererStateValid = true;
 }
 
 void Context::SetMousePointer(const std::string &filename, const Point &hotspot)
@@ -268,7 +408,7 @@ void Context::SetMousePointer(const std::string &filename, const Point &hotspot)
 	m_mousePointer = new MousePointer(this, filename, hotspot);
 
 	AddWidget(m_mousePointer);
-	SetWidgetDimensions(m_mousePointer, pos - m_mousePointer->GetHotspot(), m_mousePointer->PreferredSize());
+	SetWidgetDimensions(m_mousePointer, pos - m_mousePointer->GetHotspot(), m_mousePointer->GetPreferredSize());
 }
 
 }
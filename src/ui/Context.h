@@ -10,6 +10,7 @@
 #include "EventDispatcher.h"
 #include "Animation.h"
 #include "Skin.h"
+#include "DrawList.h"
 
 #include "Widget.h"
 #include "Layer.h"
@@ -68,6 +69,11 @@ namespace UI {
 // GetContext() method.
 //
 // It also holds an event dispatcher for distributing events to its widgets.
+//
+// Drawing goes into a draw list that's submitted in batches once each layer
+// has been drawn. Each widget keeps the quads its subtree recorded last
+// frame, and if it hasn't been marked dirty since (and hasn't moved, been
+// clipped differently or faded) they're replayed without drawing it again.
 
 class Context : public Container {
 public:
@@ -135,12 +141,17 @@ public:
 	bool Dispatch(const Event &event) { return m_eventDispatcher.Dispatch(event); }
 	bool DispatchSDLEvent(const SDL_Event &event) { return m_eventDispatcher.DispatchSDLEvent(event); }
 
+	// lay out the whole tree on the next update
 	void RequestLayout() { m_needsLayout = true; }
+	// lay out one widget (and any parents it affects) on the next update.
+	// widgets call this through Widget::RequestLayout()
+	void RequestLayout(Widget *widget) { m_layoutRequests.push_back(RefCountedPtr<Widget>(widget)); }
 
 	void SelectWidget(Widget *target) { m_eventDispatcher.SelectWidget(target); }
 	void DeselectWidget(Widget *target) { m_eventDispatcher.DeselectWidget(target); }
 
 	void DisableWidget(Widget *target) { m_eventDispatcher.DisableWidget(target); }
+	void ShortcutsChanged() { m_eventDispatcher.ShortcutsChanged(); }
 	void EnableWidget(Widget *target) { m_eventDispatcher.EnableWidget(target); }
 
 	virtual void Layout();
@@ -153,8 +164,13 @@ public:
 	Widget *CallTemplate(const char *name, const LuaTable &args);
 	Widget *CallTemplate(const char *name);
 
-	Graphics::Renderer *GetRenderer() const { return m_renderer; }
+	// while drawing, this flushes the draw list and sets the renderer up for
+	// the widget being drawn (transform and scissor), so anything that needs
+	// the renderer directly should get it here right before using it. the
+	// widget's subtree won't be cached
+	Graphics::Renderer *GetRenderer();
 	const Skin &GetSkin() const { return m_skin; }
+	DrawList &GetDrawList() { return m_drawList; }
 
 	const float &GetScale() const { return m_scale; }
 
@@ -167,6 +183,9 @@ public:
 private:
 	virtual Point PreferredSize() { return Point(); }
 
+	void UpdateLayout();
+	Widget *FindLayoutRoot(Widget *widget);
+
 	Graphics::Renderer *m_renderer;
 	int m_width;
 	int m_height;
@@ -174,6 +193,7 @@ private:
 	float m_scale;
 
 	bool m_needsLayout;
+	std::vector< RefCountedPtr<Widget> > m_layoutRequests;
 
 	std::vector<Layer*> m_layers;
 
@@ -182,6 +202,7 @@ private:
 
 	EventDispatcher m_eventDispatcher;
 	AnimationController m_animationController;
+	DrawList m_drawList;
 	Skin m_skin;
 
 	LuaManager *m_lua;
@@ -199,6 +220,12 @@ private:
 	Point m_drawWidgetPosition;
 	std::stack< std::pair<Point,Point> > m_scissorStack;
 	std::stack<float> m_opacityStack;
+
+	void SetDrawState();
+	bool m_drawing;
+	// the renderer transform and scissor are only set when something asks
+	// for the renderer
+	bool m_rendererStateValid;
 };
 
 }
@@ -0,0 +1,264 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#include "DrawList.h"
+#include "graphics/Renderer.h"
+#include "graphics/Material.h"
+#include "graphics/RenderState.h"
+#include "utils.h"
+
+namespace UI {
+
+// how many batches back a quad will look for one it can join. past this it
+// almost always overlaps something anyway
+static const int BATCH_LOOKBACK = 16;
+
+// smallest vertex buffer a batch gets, so small batches don't keep
+// reallocating as they grow and shrink from frame to frame
+static const Uint32 MIN_BATCH_VERTICES = 256;
+
+static inline Color LerpColor(const Color &a, const Color &b, float t)
+{
+	return Color(
+		Uint8(a.r + (b.r - a.r) * t),
+		Uint8(a.g + (b.g - a.g) * t),
+		Uint8(a.b + (b.b - a.b) * t),
+		Uint8(a.a + (b.a - a.a) * t));
+}
+
+DrawList::DrawList(Graphics::Renderer *renderer) :
+	m_renderer(renderer),
+	m_origin(0.0f),
+	m_clipMin(0.0f),
+	m_clipMax(0.0f),
+	m_numBatches(0),
+	m_flushCount(0),
+	m_batching(true)
+{
+}
+
+void DrawList::SetClip(const Point &pos, const Point &size)
+{
+	m_clipMin = vector2f(pos.x, pos.y);
+	m_clipMax = vector2f(pos.x + size.x, pos.y + size.y);
+}
+
+void DrawList::AddQuad(Graphics::Material *material, Graphics::RenderState *renderState, const vector2f &pos, const vector2f &size, const vector2f &uvPos, const vector2f &uvSize, const Color &color)
+{
+	const Color colors[4] = { color, color, color, color };
+	AddQuad(material, renderState, pos, size, uvPos, uvSize, colors);
+}
+
+void DrawList::AddQuad(Graphics::Material *material, Graphics::RenderState *renderState, const vector2f &pos, const vector2f &size, const vector2f &uvPos, const vector2f &uvSize, const Color color[4])
+{
+	Quad q;
+	q.material = material;
+	q.renderState = renderState;
+	q.pos[0] = m_origin + pos;
+	q.pos[1] = m_origin + pos + size;
+	q.uv[0] = uvPos;
+	q.uv[1] = uvPos + uvSize;
+	for (int i = 0; i < 4; i++)
+		q.color[i] = color[i];
+	AddClipped(q);
+}
+
+void DrawList::AddGlyphs(Graphics::Material *material, Graphics::RenderState *renderState, const Graphics::VertexArray &va)
+{
+	// each glyph is two triangles, top-left first and bottom-right last
+	// (see TextureFont::AddGlyphGeometry). colour is per glyph
+	const Uint32 numVerts = va.GetNumVerts();
+	Quad q;
+	q.material = material;
+	q.renderState = renderState;
+	for (Uint32 i = 0; i + 5 < numVerts; i += 6) {
+		q.pos[0] = m_origin + vector2f(va.position[i].x, va.position[i].y);
+		q.pos[1] = m_origin + vector2f(va.position[i+5].x, va.position[i+5].y);
+		q.uv[0] = va.uv0[i];
+		q.uv[1] = va.uv0[i+5];
+		q.color[0] = q.color[1] = q.color[2] = q.color[3] = va.diffuse[i];
+		AddClipped(q);
+	}
+}
+
+void DrawList::AddClipped(Quad &q)
+{
+	const vector2f p0(std::max(q.pos[0].x, m_clipMin.x), std::max(q.pos[0].y, m_clipMin.y));
+	const vector2f p1(std::min(q.pos[1].x, m_clipMax.x), std::min(q.pos[1].y, m_clipMax.y));
+
+	// entirely outside the clip rect (or empty to begin with)
+	if (p0.x >= p1.x || p0.y >= p1.y)
+		return;
+
+	if (p0.x != q.pos[0].x || p0.y != q.pos[0].y || p1.x != q.pos[1].x || p1.y != q.pos[1].y) {
+		// partly clipped. pull the texture coordinates and colours in to
+		// match, so it looks the same as the scissor would have
+		const vector2f size(q.pos[1] - q.pos[0]);
+		const float fx0 = (p0.x - q.pos[0].x) / size.x, fy0 = (p0.y - q.pos[0].y) / size.y;
+		const float fx1 = (p1.x - q.pos[0].x) / size.x, fy1 = (p1.y - q.pos[0].y) / size.y;
+
+		const vector2f uvSize(q.uv[1] - q.uv[0]);
+		q.uv[1] = vector2f(q.uv[0].x + uvSize.x * fx1, q.uv[0].y + uvSize.y * fy1);
+		q.uv[0] = vector2f(q.uv[0].x + uvSize.x * fx0, q.uv[0].y + uvSize.y * fy0);
+
+		const Color *c = q.color;
+		if (!(c[0] == c[1] && c[0] == c[2] && c[0] == c[3])) {
+			const Color top0(LerpColor(c[0], c[2], fx0)), bottom0(LerpColor(c[1], c[3], fx0));
+			const Color top1(LerpColor(c[0], c[2], fx1)), bottom1(LerpColor(c[1], c[3], fx1));
+			q.color[0] = LerpColor(top0, bottom0, fy0);
+			q.color[1] = LerpColor(top0, bottom0, fy1);
+			q.color[2] = LerpColor(top1, bottom1, fy0);
+			q.color[3] = LerpColor(top1, bottom1, fy1);
+		}
+
+		q.pos[0] = p0;
+		q.pos[1] = p1;
+	}
+
+	m_quads.push_back(q);
+	m_stats.quads++;
+}
+
+DrawList::Mark DrawList::GetMark() const
+{
+	Mark mark;
+	mark.quad = m_quads.size();
+	mark.flush = m_flushCount;
+	return mark;
+}
+
+bool DrawList::Capture(const Mark &mark, Segment &segment) const
+{
+	if (!m_batching || mark.flush != m_flushCount)
+		return false;
+	segment.quads.assign(m_quads.begin() + mark.quad, m_quads.end());
+	return true;
+}
+
+void DrawList::Replay(const Segment &segment)
+{
+	m_quads.insert(m_quads.end(), segment.quads.begin(), segment.quads.end());
+	m_stats.quads += segment.quads.size();
+	m_stats.replayedQuads += segment.quads.size();
+}
+
+void DrawList::AddVertices(Graphics::VertexArray &va, const Quad &q)
+{
+	const vector3f tl(q.pos[0].x, q.pos[0].y, 0.0f), br(q.pos[1].x, q.pos[1].y, 0.0f);
+	const vector3f bl(tl.x, br.y, 0.0f), tr(br.x, tl.y, 0.0f);
+	const vector2f uvtl(q.uv[0]), uvbr(q.uv[1]);
+	const vector2f uvbl(uvtl.x, uvbr.y), uvtr(uvbr.x, uvtl.y);
+
+	va.Add(tl, q.color[0], uvtl);
+	va.Add(bl, q.color[1], uvbl);
+	va.Add(tr, q.color[2], uvtr);
+
+	va.Add(tr, q.color[2], uvtr);
+	va.Add(bl, q.color[1], uvbl);
+	va.Add(br, q.color[3], uvbr);
+}
+
+void DrawList::BuildBatches()
+{
+	PROFILE_SCOPED()
+
+	m_numBatches = 0;
+
+	for (const Quad &q : m_quads) {
+		int target = -1;
+
+		if (m_batching) {
+			// find the most recent batch with the same state. we can only
+			// move the quad back into it if it doesn't overlap anything
+			// that's drawn after it
+			const int stop = std::max(0, int(m_numBatches) - BATCH_LOOKBACK);
+			for (int i = int(m_numBatches) - 1; i >= stop; i--) {
+				const Batch &b = m_batches[i];
+				if (b.material == q.material && b.renderState == q.renderState) {
+					target = i;
+					break;
+				}
+				if (b.boundsMax.x > q.pos[0].x && b.boundsMin.x < q.pos[1].x && b.boundsMax.y > q.pos[0].y && b.boundsMin.y < q.pos[1].y)
+					break;
+			}
+		}
+
+		if (target < 0) {
+			if (m_numBatches == m_batches.size())
+				m_batches.push_back(Batch());
+			Batch &b = m_batches[m_numBatches];
+			b.material = q.material;
+			b.renderState = q.renderState;
+			b.boundsMin = q.pos[0];
+			b.boundsMax = q.pos[1];
+			b.va.Clear();
+			target = m_numBatches++;
+		}
+		else {
+			Batch &b = m_batches[target];
+			b.boundsMin = vector2f(std::min(b.boundsMin.x, q.pos[0].x), std::min(b.boundsMin.y, q.pos[0].y));
+			b.boundsMax = vector2f(std::max(b.boundsMax.x, q.pos[1].x), std::max(b.boundsMax.y, q.pos[1].y));
+		}
+
+		AddVertices(m_batches[target].va, q);
+	}
+}
+
+void DrawList::DrawBatch(Uint32 index, Batch &batch)
+{
+	if (!m_batching) {
+		// the way it used to be done, through the renderer's scratch buffers
+		m_renderer->DrawTriangles(&batch.va, batch.renderState, batch.material);
+		return;
+	}
+
+	const Uint32 numVerts = batch.va.GetNumVerts();
+
+	if (index >= m_buffers.size())
+		m_buffers.resize(index + 1);
+	RefCountedPtr<Graphics::VertexBuffer> &vb = m_buffers[index];
+
+	if (!vb.Valid() || vb->GetDesc().numVertices < numVerts) {
+		Graphics::VertexBufferDesc vbd;
+		vbd.attrib[0].semantic = Graphics::ATTRIB_POSITION;
+		vbd.attrib[0].format = Graphics::ATTRIB_FORMAT_FLOAT3;
+		vbd.attrib[1].semantic = Graphics::ATTRIB_DIFFUSE;
+		vbd.attrib[1].format = Graphics::ATTRIB_FORMAT_UBYTE4;
+		vbd.attrib[2].semantic = Graphics::ATTRIB_UV0;
+		vbd.attrib[2].format = Graphics::ATTRIB_FORMAT_FLOAT2;
+		vbd.numVertices = std::max(MIN_BATCH_VERTICES, ceil_pow2(numVerts));
+		vbd.usage = Graphics::BUFFER_USAGE_DYNAMIC;
+		vb.Reset(m_renderer->CreateVertexBuffer(vbd));
+	}
+
+	vb->SetVertexCount(numVerts);
+	vb->Populate(batch.va);
+	m_renderer->DrawBuffer(vb.Get(), batch.renderState, batch.material);
+}
+
+void DrawList::Flush()
+{
+	// whatever the caller draws next isn't in the list, so nothing recorded
+	// before this can be captured and replayed without it
+	m_flushCount++;
+
+	if (m_quads.empty())
+		return;
+
+	PROFILE_SCOPED()
+
+	BuildBatches();
+
+	m_renderer->SetTransform(matrix4x4f::Identity());
+	m_renderer->SetScissor(false);
+
+	for (Uint32 i = 0; i < m_numBatches; i++)
+		DrawBatch(i, m_batches[i]);
+
+	m_stats.batches += m_numBatches;
+	m_stats.flushes++;
+
+	m_quads.clear();
+}
+
+}
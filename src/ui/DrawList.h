@@ -0,0 +1,147 @@
+// Copyright © 2008-2016 Pioneer Developers. See AUTHORS.txt for details
+// Licensed under the terms of the GPL v3. See licenses/GPL-3.txt
+
+#ifndef UI_DRAWLIST_H
+#define UI_DRAWLIST_H
+
+#include "libs.h"
+#include "Point.h"
+#include "Color.h"
+#include "vector2.h"
+#include "SmartPtr.h"
+#include "graphics/VertexArray.h"
+#include "graphics/VertexBuffer.h"
+#include <vector>
+
+namespace Graphics { class Renderer; class Material; class RenderState; }
+
+// DrawList collects the quads (skin elements, text, images) that the widgets
+// draw during a frame so they can be submitted in a handful of draw calls
+// instead of one each.
+//
+// Widgets record quads in their own coordinates, exactly as they would have
+// drawn them with the renderer. The list moves them to the current draw
+// origin and clips them against the current scissor rect on the CPU, so
+// quads from different widgets can share a batch.
+//
+// Flush() sorts the quads into batches by material and render state. Draw
+// order still matters (the gauge mask and fill, text over backgrounds), so a
+// quad only joins an earlier batch if it doesn't overlap anything drawn in a
+// batch since; otherwise it starts a new one. The result is the same as
+// drawing each quad on its own, in order.
+//
+// Anything that has to use the renderer directly must flush the list first
+// (Context::GetRenderer() does this).
+
+namespace UI {
+
+class DrawList {
+public:
+	DrawList(Graphics::Renderer *renderer);
+
+	struct Quad {
+		Graphics::Material *material;
+		Graphics::RenderState *renderState;
+		vector2f pos[2];     // top-left, bottom-right, screen space
+		vector2f uv[2];
+		Color color[4];      // top-left, bottom-left, top-right, bottom-right
+	};
+
+	// the quads a widget and its children recorded the last time they were
+	// drawn, and where they were drawn. if nothing has changed the context
+	// replays them instead of drawing the widget again
+	struct Segment {
+		Segment() : valid(false), opacity(0.0f) {}
+
+		bool Matches(const Point &_origin, const Point &_clipPos, const Point &_clipSize, float _opacity) const {
+			return valid && origin == _origin && clipPos == _clipPos && clipSize == _clipSize && opacity == _opacity;
+		}
+		void Invalidate() { valid = false; quads.clear(); }
+
+		bool valid;
+		Point origin;
+		Point clipPos;
+		Point clipSize;
+		float opacity;
+		std::vector<Quad> quads;
+	};
+
+	// position of the next quad, for capturing a segment
+	struct Mark {
+		size_t quad;
+		Uint32 flush;
+	};
+
+	struct Stats {
+		Stats() : quads(0), replayedQuads(0), batches(0), flushes(0) {}
+		Uint32 quads;          // quads drawn, including replayed ones
+		Uint32 replayedQuads;  // quads that came from a segment
+		Uint32 batches;        // draw calls
+		Uint32 flushes;
+	};
+
+	// where widget coordinates are, and the rect everything gets clipped to
+	void SetOrigin(const Point &origin) { m_origin = vector2f(origin.x, origin.y); }
+	void SetClip(const Point &pos, const Point &size);
+
+	void AddQuad(Graphics::Material *material, Graphics::RenderState *renderState, const vector2f &pos, const vector2f &size, const vector2f &uvPos, const vector2f &uvSize, const Color &color);
+	// colors are top-left, bottom-left, top-right, bottom-right
+	void AddQuad(Graphics::Material *material, Graphics::RenderState *renderState, const vector2f &pos, const vector2f &size, const vector2f &uvPos, const vector2f &uvSize, const Color color[4]);
+	// text, as built by TextureFont::PopulateString (two triangles per glyph)
+	void AddGlyphs(Graphics::Material *material, Graphics::RenderState *renderState, const Graphics::VertexArray &va);
+
+	Mark GetMark() const;
+	// copies everything added since the mark into the segment. fails if the
+	// list was flushed in the meantime
+	bool Capture(const Mark &mark, Segment &segment) const;
+	void Replay(const Segment &segment);
+
+	bool IsEmpty() const { return m_quads.empty(); }
+
+	// draw everything recorded so far. leaves the renderer with an identity
+	// transform and no scissor
+	void Flush();
+
+	// with batching off every quad is drawn on its own and segments can't be
+	// captured, which is how the UI used to draw. for comparison
+	void SetBatching(bool enabled) { m_batching = enabled; }
+	bool IsBatching() const { return m_batching; }
+
+	const Stats &GetStats() const { return m_stats; }
+	void ClearStats() { m_stats = Stats(); }
+
+private:
+	struct Batch {
+		Batch() : material(nullptr), renderState(nullptr), va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0) {}
+		Graphics::Material *material;
+		Graphics::RenderState *renderState;
+		vector2f boundsMin, boundsMax;
+		Graphics::VertexArray va;
+	};
+
+	void AddClipped(Quad &q);
+	void BuildBatches();
+	void DrawBatch(Uint32 index, Batch &batch);
+	static void AddVertices(Graphics::VertexArray &va, const Quad &q);
+
+	Graphics::Renderer *m_renderer;
+
+	vector2f m_origin;
+	vector2f m_clipMin, m_clipMax;
+
+	std::vector<Quad> m_quads;
+
+	// reused from flush to flush
+	std::vector<Batch> m_batches;
+	Uint32 m_numBatches;
+	std::vector< RefCountedPtr<Graphics::VertexBuffer> > m_buffers;
+
+	Uint32 m_flushCount;
+	bool m_batching;
+
+	Stats m_stats;
+};
+
+}
+
+#endif
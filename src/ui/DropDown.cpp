@@ -36,13 +36,13 @@ DropDown::DropDown(Context *context) : Container(context), m_popupWantToggle(fal
 
 Point DropDown::PreferredSize()
 {
-	return m_container->PreferredSize();
+	return m_container->GetPreferredSize();
 }
 
 void DropDown::Layout()
 {
 	SetWidgetDimensions(m_container, Point(), GetSize());
-	m_container->Layout();
+	LayoutWidget(m_container);
 }
 
 void DropDown::Update()
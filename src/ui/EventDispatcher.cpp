@@ -337,8 +337,12 @@ void EventDispatcher::LayoutUpdated()
 	if (m_selected && !m_selected->IsVisible())
 		m_selected.Reset();
 
-	m_shortcuts.clear();
-	m_baseContainer->CollectShortcuts(m_shortcuts);
+	// this walks the whole tree, so only when it could have changed
+	if (!m_shortcutsValid) {
+		m_shortcuts.clear();
+		m_baseContainer->CollectShortcuts(m_shortcuts);
+		m_shortcutsValid = true;
+	}
 
 	RefCountedPtr<Widget> target(m_baseContainer->GetWidgetAt(m_lastMousePosition));
 	DispatchMouseOverOut(target.Get(), m_lastMousePosition);
@@ -17,7 +17,8 @@ public:
 	EventDispatcher(Container *baseContainer) :
 		m_baseContainer(baseContainer),
 		m_mouseActiveReceiver(0),
-		m_lastMouseOverTarget(0)
+		m_lastMouseOverTarget(0),
+		m_shortcutsValid(false)
 		{}
 
 	bool Dispatch(const Event &event);
@@ -25,6 +26,10 @@ public:
 
 	void LayoutUpdated();
 
+	// widgets have been added or removed, or their shortcuts changed, so
+	// the shortcuts need collecting again after the next layout
+	void ShortcutsChanged() { m_shortcutsValid = false; }
+
 	Widget *GetSelected() const { return m_selected.Get(); }
 	Widget *GetMouseActive() const { return m_mouseActiveReceiver.Get(); }
 
@@ -51,6 +56,7 @@ private:
 	RefCountedPtr<Widget> m_selected;
 
 	std::map<KeySym,Widget*> m_shortcuts;
+	bool m_shortcutsValid;
 };
 
 }
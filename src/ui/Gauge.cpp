@@ -60,12 +60,17 @@ Gauge *Gauge::SetLevelAscending(bool ascending)
 
 void Gauge::SetValue(float v)
 {
-	m_value = Clamp(v*m_mult, 0.0f, 1.0f);
+	const float value = Clamp(v*m_mult, 0.0f, 1.0f);
+	if (is_equal_exact(value, m_value))
+		return;
+	m_value = value;
 	UpdateStyle();
 }
 
 void Gauge::UpdateStyle()
 {
+	MarkDrawDirty();
+
 	if (m_levelAscending)
 		m_style =
 			m_value > m_criticalLevel && m_criticalLevel <= 1.0f ? CRITICAL :
@@ -4,7 +4,6 @@
 #include "Gradient.h"
 #include "Context.h"
 #include "graphics/Renderer.h"
-#include "graphics/VertexArray.h"
 #include "graphics/Material.h"
 
 namespace UI {
@@ -19,26 +18,23 @@ Gradient::Gradient(Context *context, const Color &beginColor, const Color &endCo
 
 void Gradient::Draw()
 {
-	Graphics::Renderer *r = GetContext()->GetRenderer();
-	if (!m_quad) {
-		const Point &offset = GetActiveOffset();
-		const Point &area = GetActiveArea();
-
-		const float x = offset.x;
-		const float y = offset.y;
-		const float sx = area.x;
-		const float sy = area.y;
-
-		Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE);
-		va.Add(vector3f(x, y, 0.0f), m_beginColor);
-		va.Add(vector3f(x, y + sy, 0.0f), m_direction == HORIZONTAL ? m_beginColor : m_endColor);
-		va.Add(vector3f(x + sx, y, 0.0f), m_direction == HORIZONTAL ? m_endColor : m_beginColor);
-		va.Add(vector3f(x + sx, y + sy, 0.0f), m_endColor);
-
-		auto renderState = GetContext()->GetSkin().GetAlphaBlendState();
-		m_quad.reset(new Graphics::Drawables::TexturedQuad(r, m_material, va, renderState));
-	}
-	m_quad->Draw(r, Color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, GetContext()->GetOpacity()*Color::WHITE.a));
+	const Point &offset = GetActiveOffset();
+	const Point &area = GetActiveArea();
+
+	const float opacity = GetContext()->GetOpacity();
+	const Color begin(m_beginColor.r, m_beginColor.g, m_beginColor.b, opacity*m_beginColor.a);
+	const Color end(m_endColor.r, m_endColor.g, m_endColor.b, opacity*m_endColor.a);
+
+	// top-left, bottom-left, top-right, bottom-right
+	const Color colors[4] = {
+		begin,
+		m_direction == HORIZONTAL ? begin : end,
+		m_direction == HORIZONTAL ? end : begin,
+		end
+	};
+
+	GetContext()->GetDrawList().AddQuad(m_material.Get(), GetContext()->GetSkin().GetAlphaBlendState(),
+		vector2f(offset.x, offset.y), vector2f(area.x, area.y), vector2f(0.0f), vector2f(0.0f), colors);
 
 	Container::Draw();
 }
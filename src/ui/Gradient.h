@@ -6,7 +6,6 @@
 
 #include "Single.h"
 #include "Color.h"
-#include "graphics/Drawables.h"
 #include "graphics/Material.h"
 
 namespace UI {
@@ -31,7 +30,6 @@ private:
 	Direction m_direction;
 
 	RefCountedPtr<Graphics::Material> m_material;
-	std::unique_ptr<Graphics::Drawables::TexturedQuad> m_quad;
 };
 
 }
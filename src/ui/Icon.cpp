@@ -52,6 +52,7 @@ Icon::Icon(Context *context, const std::string &iconName): Widget(context),
 
 		Graphics::MaterialDescriptor matDesc;
 		matDesc.textures = 1;
+		matDesc.vertexColors = true;
 		s_material.Reset(GetContext()->GetRenderer()->CreateMaterial(matDesc));
 		s_material->texture0 = s_texture.Get();
 	}
@@ -74,26 +75,13 @@ Point Icon::PreferredSize()
 
 void Icon::Draw()
 {
-	Graphics::Renderer *r = GetContext()->GetRenderer();
-	if (!m_quad) {
-		const Point &offset = GetActiveOffset();
-		const Point &area = GetActiveArea();
-
-		const float x = offset.x;
-		const float y = offset.y;
-		const float sx = area.x;
-		const float sy = area.y;
-
-		Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_UV0);
-		va.Add(vector3f(x,    y,    0.0f), vector2f(s_texScale.x*(m_texPos.x),    s_texScale.y*(m_texPos.y)));
-		va.Add(vector3f(x,    y+sy, 0.0f), vector2f(s_texScale.x*(m_texPos.x),    s_texScale.y*(m_texPos.y+48)));
-		va.Add(vector3f(x+sx, y,    0.0f), vector2f(s_texScale.x*(m_texPos.x+48), s_texScale.y*(m_texPos.y)));
-		va.Add(vector3f(x+sx, y+sy, 0.0f), vector2f(s_texScale.x*(m_texPos.x+48), s_texScale.y*(m_texPos.y+48)));
-
-		auto renderState = GetContext()->GetSkin().GetAlphaBlendState();
-		m_quad.reset(new Graphics::Drawables::TexturedQuad(r, s_material, va, renderState));
-	}
-	m_quad->Draw(r, Color(m_color.r, m_color.g, m_color.b, GetContext()->GetOpacity()*m_color.a));
+	const Point &offset = GetActiveOffset();
+	const Point &area = GetActiveArea();
+
+	GetContext()->GetDrawList().AddQuad(s_material.Get(), GetContext()->GetSkin().GetAlphaBlendState(),
+		vector2f(offset.x, offset.y), vector2f(area.x, area.y),
+		vector2f(s_texScale.x*m_texPos.x, s_texScale.y*m_texPos.y), vector2f(s_texScale.x*48, s_texScale.y*48),
+		Color(m_color.r, m_color.g, m_color.b, GetContext()->GetOpacity()*m_color.a));
 }
 
 }
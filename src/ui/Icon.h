@@ -8,7 +8,6 @@
 #include "IniConfig.h"
 #include "SmartPtr.h"
 #include "vector2.h"
-#include "graphics/Drawables.h"
 #include "graphics/Material.h"
 #include "graphics/Texture.h"
 
@@ -19,7 +18,7 @@ public:
 	virtual Point PreferredSize();
 	virtual void Draw();
 
-	Icon *SetColor(const Color &c) { m_color = c; return this; }
+	Icon *SetColor(const Color &c) { m_color = c; MarkDrawDirty(); return this; }
 
 protected:
 	friend class Context;
@@ -35,7 +34,6 @@ private:
 
 	Point m_texPos;
 	Color m_color;
-	std::unique_ptr<Graphics::Drawables::TexturedQuad> m_quad;
 };
 
 }
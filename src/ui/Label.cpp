@@ -4,8 +4,6 @@
 #include "Label.h"
 #include "Context.h"
 #include "text/TextureFont.h"
-#include "graphics/VertexArray.h"
-#include "graphics/VertexBuffer.h"
 
 namespace UI {
 
@@ -18,6 +16,7 @@ Label::Label(Context *context, const std::string &text) : Widget(context)
 , m_text(text)
 , m_color(Color::WHITE)
 , m_font(GetContext()->GetFont(GetFont()))
+, m_glyphs(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0)
 {
 	RegisterBindPoint("text", sigc::mem_fun(this, &Label::BindText));
 }
@@ -56,22 +55,26 @@ void Label::Draw()
 	if (m_bNeedsUpdating || m_font != GetContext()->GetFont(GetFont()) || !is_equal_exact(m_prevOpacity, opacity) || m_bPrevDisabled != IsDisabled())
 	{
 		m_font = GetContext()->GetFont(GetFont());
-		Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0);
-		m_font->PopulateString(va, m_text, 0.0f, 0.0f, finalColor);
-		m_vbuffer.Reset( m_font->CreateVertexBuffer(va, true) );
+		m_glyphs.Clear();
+		m_font->PopulateString(m_glyphs, m_text, 0.0f, 0.0f, finalColor);
 		m_bNeedsUpdating = false;
 		m_bPrevDisabled = IsDisabled();
 		m_prevOpacity = opacity;
 	}
 
-	m_font->RenderBuffer( m_vbuffer.Get() );
+	GetContext()->GetDrawList().AddGlyphs(m_font->GetMaterial(), m_font->GetRenderState(), m_glyphs);
 }
 
 Label *Label::SetText(const std::string &text)
 {
+	// readouts get set every frame whether they've changed or not
+	if (text == m_text)
+		return this;
+
 	m_text = text;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	m_bNeedsUpdating = true;
+	MarkDrawDirty();
 	return this;
 }
 
@@ -7,7 +7,7 @@
 #include "Widget.h"
 #include "SmartPtr.h"
 #include "text/TextureFont.h"
-#include "graphics/VertexBuffer.h"
+#include "graphics/VertexArray.h"
 
 // single line of text
 
@@ -22,7 +22,7 @@ public:
 	Label *SetText(const std::string &text);
 	const std::string &GetText() const { return m_text; }
 
-	Label *SetColor(const Color &c) { m_color = c; return this; }
+	Label *SetColor(const Color &c) { m_color = c; m_bNeedsUpdating = true; MarkDrawDirty(); return this; }
 
 protected:
 	friend class Context;
@@ -38,7 +38,7 @@ private:
 	Color m_color;
 	Point m_preferredSize;
 	RefCountedPtr<Text::TextureFont> m_font;
-	RefCountedPtr<Graphics::VertexBuffer> m_vbuffer;
+	Graphics::VertexArray m_glyphs;
 };
 
 }
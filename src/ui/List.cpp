@@ -16,12 +16,12 @@ List::List(Context *context) : Container(context), m_selected(-1)
 }
 
 Point List::PreferredSize() {
-	return m_container->PreferredSize();
+	return m_container->GetPreferredSize();
 }
 
 void List::Layout() {
 	SetWidgetDimensions(m_container, Point(), GetSize());
-	m_container->Layout();
+	LayoutWidget(m_container);
 }
 
 List *List::AddOption(const std::string &text)
@@ -43,7 +43,7 @@ List *List::AddOption(const std::string &text)
 
 	m_optionBackgrounds.push_back(background);
 
-	GetContext()->RequestLayout();
+	RequestLayout();
 
 	return this;
 }
@@ -104,7 +104,7 @@ void List::Clear()
 	static_cast<VBox*>(m_container->GetInnerWidget())->Clear();
 	m_selected = -1;
 
-	GetContext()->RequestLayout();
+	RequestLayout();
 }
 
 bool List::HandleOptionMouseOver(int index)
@@ -83,7 +83,7 @@ void Margin::Layout()
 
 	SetWidgetDimensions(GetInnerWidget(), innerPos, GetInnerWidget()->CalcSize(innerSize));
 
-	GetInnerWidget()->Layout();
+	LayoutWidget(GetInnerWidget());
 }
 
 }
@@ -16,7 +16,7 @@ void OverlayStack::Layout()
 	Point sz = GetSize();
 	for (auto it : Container::GetWidgets()) {
 		SetWidgetDimensions(it.Get(), Point(), it->CalcSize(sz));
-		it->Layout();
+		LayoutWidget(it.Get());
 	}
 }
 
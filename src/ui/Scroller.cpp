@@ -17,11 +17,11 @@ Scroller::Scroller(Context *context) : Container(context),
 
 Point Scroller::PreferredSize()
 {
-	const Point sliderSize = m_slider->GetContainer() ? m_slider->PreferredSize() : Point(0);
+	const Point sliderSize = m_slider->GetContainer() ? m_slider->GetPreferredSize() : Point(0);
 	if (!m_innerWidget)
 		return sliderSize;
 
-	const Point innerWidgetSize = m_innerWidget->PreferredSize();
+	const Point innerWidgetSize = m_innerWidget->GetPreferredSize();
 
 	return Point(SizeAdd(innerWidgetSize.x, sliderSize.x), innerWidgetSize.y);
 }
@@ -32,7 +32,7 @@ void Scroller::Layout()
 
 	const Point size(GetSize());
 
-	const Point childPreferredSize = m_innerWidget->PreferredSize();
+	const Point childPreferredSize = m_innerWidget->GetPreferredSize();
 
 	// if the child can fit then we don't need the slider
 	if (childPreferredSize.y <= size.y) {
@@ -40,20 +40,20 @@ void Scroller::Layout()
 			Container::RemoveWidget(m_slider.Get());
 
 		SetWidgetDimensions(m_innerWidget, Point(), size);
-		m_innerWidget->Layout();
+		LayoutWidget(m_innerWidget);
 	}
 
 	else {
 		if (!m_slider->GetContainer())
 			AddWidget(m_slider.Get());
 
-		const Point sliderSize = m_slider->PreferredSize();
+		const Point sliderSize = m_slider->GetPreferredSize();
 
 		SetWidgetDimensions(m_slider.Get(), Point(size.x-sliderSize.x, 0), Point(sliderSize.x, size.y));
-		m_slider->Layout();
+		LayoutWidget(m_slider.Get());
 
-		SetWidgetDimensions(m_innerWidget, Point(), Point(size.x-sliderSize.x, std::max(size.y, m_innerWidget->PreferredSize().y)));
-		m_innerWidget->Layout();
+		SetWidgetDimensions(m_innerWidget, Point(), Point(size.x-sliderSize.x, std::max(size.y, m_innerWidget->GetPreferredSize().y)));
+		LayoutWidget(m_innerWidget);
 
 		const float step = float(sliderSize.y) * 0.5f / float(childPreferredSize.y);
 		m_slider->SetStep(step);
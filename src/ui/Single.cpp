@@ -16,7 +16,7 @@ void Single::Layout()
 {
 	if (!m_innerWidget) return;
 	SetWidgetDimensions(m_innerWidget, Point(), m_innerWidget->CalcSize(GetSize()));
-	m_innerWidget->Layout();
+	LayoutWidget(m_innerWidget);
 }
 
 Single *Single::SetInnerWidget(Widget *widget)
@@ -31,7 +31,7 @@ Single *Single::SetInnerWidget(Widget *widget)
 	AddWidget(widget);
 	m_innerWidget = widget;
 
-	GetContext()->RequestLayout();
+	RequestLayout();
 
 	return this;
 }
@@ -41,7 +41,7 @@ void Single::RemoveInnerWidget()
 	if (m_innerWidget) {
 		Container::RemoveWidget(m_innerWidget);
 		m_innerWidget = 0;
-		GetContext()->RequestLayout();
+		RequestLayout();
 	}
 }
 
@@ -4,7 +4,6 @@
 #include "Skin.h"
 #include "IniConfig.h"
 #include "graphics/TextureBuilder.h"
-#include "graphics/VertexArray.h"
 #include "FileSystem.h"
 #include "utils.h"
 
@@ -12,8 +11,9 @@ namespace UI {
 
 static const float SKIN_SIZE = 512.0f;
 
-Skin::Skin(const std::string &filename, Graphics::Renderer *renderer, float scale) :
+Skin::Skin(const std::string &filename, Graphics::Renderer *renderer, DrawList *drawList, float scale) :
 	m_renderer(renderer),
+	m_drawList(drawList),
 	m_scale(scale),
 	m_opacity(1.0f)
 {
@@ -28,7 +28,10 @@ Skin::Skin(const std::string &filename, Graphics::Renderer *renderer, float scal
 
 	m_texture.Reset(Graphics::TextureBuilder::UI(cfg.String("TextureFile")).GetOrCreateTexture(m_renderer, "ui"));
 
+	// opacity (and for rects, the colour) goes in the vertices so that
+	// elements can be batched together
 	Graphics::MaterialDescriptor desc;
+	desc.vertexColors = true;
 	desc.textures = 1;
 	m_textureMaterial.Reset(m_renderer->CreateMaterial(desc));
 	m_textureMaterial->texture0 = m_texture.Get();
@@ -113,15 +116,10 @@ static inline vector2f scaled(const vector2f &v)
 
 void Skin::DrawRectElement(const RectElement &element, const Point &pos, const Point &size, Graphics::BlendMode blendMode) const
 {
-	Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_UV0);
-
-	va.Add(vector3f(pos.x,        pos.y,        0.0f), scaled(vector2f(element.pos.x,                element.pos.y)));
-	va.Add(vector3f(pos.x,        pos.y+size.y, 0.0f), scaled(vector2f(element.pos.x,                element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x+size.x, pos.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x, element.pos.y)));
-	va.Add(vector3f(pos.x+size.x, pos.y+size.y, 0.0f), scaled(vector2f(element.pos.x+element.size.x, element.pos.y+element.size.y)));
-
-	m_textureMaterial->diffuse = Color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
-	m_renderer->DrawTriangles(&va, GetRenderState(blendMode), m_textureMaterial.Get(), Graphics::TRIANGLE_STRIP);
+	const Color color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
+	m_drawList->AddQuad(m_textureMaterial.Get(), GetRenderState(blendMode),
+		vector2f(pos.x, pos.y), vector2f(size.x, size.y),
+		scaled(vector2f(element.pos.x, element.pos.y)), scaled(vector2f(element.size.x, element.size.y)), color);
 }
 
 void Skin::DrawBorderedRectElement(const BorderedRectElement &element, const Point &pos, const Point &size, Graphics::BlendMode blendMode) const
@@ -129,96 +127,61 @@ void Skin::DrawBorderedRectElement(const BorderedRectElement &element, const Poi
 	const float width = element.borderWidth;
 	const float height = element.borderHeight;
 
-	Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_UV0);
-
-	va.Add(vector3f(pos.x,              pos.y,        0.0f), scaled(vector2f(element.pos.x,                             element.pos.y)));
-	va.Add(vector3f(pos.x,              pos.y+height, 0.0f), scaled(vector2f(element.pos.x,                             element.pos.y+height)));
-	va.Add(vector3f(pos.x+width,        pos.y,        0.0f), scaled(vector2f(element.pos.x+width,                       element.pos.y)));
-	va.Add(vector3f(pos.x+width,        pos.y+height, 0.0f), scaled(vector2f(element.pos.x+width,                       element.pos.y+height)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x-width,        element.pos.y)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y+height, 0.0f), scaled(vector2f(element.pos.x+element.size.x-width,        element.pos.y+height)));
-	va.Add(vector3f(pos.x+size.x,       pos.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x,              element.pos.y)));
-	va.Add(vector3f(pos.x+size.x,       pos.y+height, 0.0f), scaled(vector2f(element.pos.x+element.size.x,              element.pos.y+height)));
-
-	// degenerate triangles to join rows
-	va.Add(vector3f(pos.x+size.x,       pos.y+height, 0.0f), scaled(vector2f(element.pos.x+element.size.x,              element.pos.y+height)));
-	va.Add(vector3f(pos.x,              pos.y+height, 0.0f), scaled(vector2f(element.pos.x,                             element.pos.y+height)));
-
-	va.Add(vector3f(pos.x,              pos.y+height,        0.0f), scaled(vector2f(element.pos.x,                      element.pos.y+height)));
-	va.Add(vector3f(pos.x,              pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x,                      element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x+width,        pos.y+height,        0.0f), scaled(vector2f(element.pos.x+width,                element.pos.y+height)));
-	va.Add(vector3f(pos.x+width,        pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+width,                element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y+height,        0.0f), scaled(vector2f(element.pos.x+element.size.x-width, element.pos.y+height)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+element.size.x-width, element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x+size.x,       pos.y+height,        0.0f), scaled(vector2f(element.pos.x+element.size.x,       element.pos.y+height)));
-	va.Add(vector3f(pos.x+size.x,       pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+element.size.x,       element.pos.y+element.size.y-height)));
-
-	// degenerate triangles to join rows
-	va.Add(vector3f(pos.x+size.x,       pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+element.size.x,       element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x,              pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x,                      element.pos.y+element.size.y-height)));
-
-	va.Add(vector3f(pos.x,              pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x,                      element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x,              pos.y+size.y,        0.0f), scaled(vector2f(element.pos.x,                      element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x+width,        pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+width,                element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x+width,        pos.y+size.y,        0.0f), scaled(vector2f(element.pos.x+width,                element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+element.size.x-width, element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y+size.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x-width, element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x+size.x,       pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+element.size.x,       element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x+size.x,       pos.y+size.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x,       element.pos.y+element.size.y)));
-
-	m_textureMaterial->diffuse = Color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
-	m_renderer->DrawTriangles(&va, GetRenderState(blendMode), m_textureMaterial.Get(), Graphics::TRIANGLE_STRIP);
+	// corners, edges and centre
+	const float x[4] = { float(pos.x), pos.x+width,  pos.x+size.x-width,  float(pos.x+size.x) };
+	const float y[4] = { float(pos.y), pos.y+height, pos.y+size.y-height, float(pos.y+size.y) };
+	const float u[4] = { float(element.pos.x), element.pos.x+width,  element.pos.x+element.size.x-width,  float(element.pos.x+element.size.x) };
+	const float v[4] = { float(element.pos.y), element.pos.y+height, element.pos.y+element.size.y-height, float(element.pos.y+element.size.y) };
+
+	const Color color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
+	Graphics::RenderState *state = GetRenderState(blendMode);
+
+	for (int row = 0; row < 3; row++)
+		for (int col = 0; col < 3; col++)
+			m_drawList->AddQuad(m_textureMaterial.Get(), state,
+				vector2f(x[col], y[row]), vector2f(x[col+1]-x[col], y[row+1]-y[row]),
+				scaled(vector2f(u[col], v[row])), scaled(vector2f(u[col+1]-u[col], v[row+1]-v[row])), color);
 }
 
 void Skin::DrawVerticalEdgedRectElement(const EdgedRectElement &element, const Point &pos, const Point &size, Graphics::BlendMode blendMode) const
 {
 	const float height = element.edgeWidth;
 
-	Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_UV0);
+	// top edge, middle, bottom edge
+	const float y[4] = { float(pos.y), pos.y+height, pos.y+size.y-height, float(pos.y+size.y) };
+	const float v[4] = { float(element.pos.y), element.pos.y+height, element.pos.y+element.size.y-height, float(element.pos.y+element.size.y) };
 
-	va.Add(vector3f(pos.x+size.x, pos.y,               0.0f), scaled(vector2f(element.pos.x+element.size.x, element.pos.y)));
-	va.Add(vector3f(pos.x,        pos.y,               0.0f), scaled(vector2f(element.pos.x,                element.pos.y)));
-	va.Add(vector3f(pos.x+size.x, pos.y+height,        0.0f), scaled(vector2f(element.pos.x+element.size.x, element.pos.y+height)));
-	va.Add(vector3f(pos.x,        pos.y+height,        0.0f), scaled(vector2f(element.pos.x,                element.pos.y+height)));
-	va.Add(vector3f(pos.x+size.x, pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x+element.size.x, element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x,        pos.y+size.y-height, 0.0f), scaled(vector2f(element.pos.x,                element.pos.y+element.size.y-height)));
-	va.Add(vector3f(pos.x+size.x, pos.y+size.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x, element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x,        pos.y+size.y,        0.0f), scaled(vector2f(element.pos.x,                element.pos.y+element.size.y)));
+	const Color color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
+	Graphics::RenderState *state = GetRenderState(blendMode);
 
-	m_textureMaterial->diffuse = Color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
-	m_renderer->DrawTriangles(&va, GetRenderState(blendMode), m_textureMaterial.Get(), Graphics::TRIANGLE_STRIP);
+	for (int row = 0; row < 3; row++)
+		m_drawList->AddQuad(m_textureMaterial.Get(), state,
+			vector2f(pos.x, y[row]), vector2f(size.x, y[row+1]-y[row]),
+			scaled(vector2f(element.pos.x, v[row])), scaled(vector2f(element.size.x, v[row+1]-v[row])), color);
 }
 
 void Skin::DrawHorizontalEdgedRectElement(const EdgedRectElement &element, const Point &pos, const Point &size, Graphics::BlendMode blendMode) const
 {
 	const float width = element.edgeWidth;
 
-	Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_UV0);
+	// left edge, middle, right edge
+	const float x[4] = { float(pos.x), pos.x+width, pos.x+size.x-width, float(pos.x+size.x) };
+	const float u[4] = { float(element.pos.x), element.pos.x+width, element.pos.x+element.size.x-width, float(element.pos.x+element.size.x) };
 
-	va.Add(vector3f(pos.x,              pos.y,        0.0f), scaled(vector2f(element.pos.x,                      element.pos.y)));
-	va.Add(vector3f(pos.x,              pos.y+size.y, 0.0f), scaled(vector2f(element.pos.x,                      element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x+width,        pos.y,        0.0f), scaled(vector2f(element.pos.x+width,                element.pos.y)));
-	va.Add(vector3f(pos.x+width,        pos.y+size.y, 0.0f), scaled(vector2f(element.pos.x+width,                element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x-width, element.pos.y)));
-	va.Add(vector3f(pos.x+size.x-width, pos.y+size.y, 0.0f), scaled(vector2f(element.pos.x+element.size.x-width, element.pos.y+element.size.y)));
-	va.Add(vector3f(pos.x+size.x,       pos.y,        0.0f), scaled(vector2f(element.pos.x+element.size.x,       element.pos.y)));
-	va.Add(vector3f(pos.x+size.x,       pos.y+size.y, 0.0f), scaled(vector2f(element.pos.x+element.size.x,       element.pos.y+element.size.y)));
+	const Color color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
+	Graphics::RenderState *state = GetRenderState(blendMode);
 
-	m_textureMaterial->diffuse = Color(Color::WHITE.r, Color::WHITE.g, Color::WHITE.b, m_opacity*Color::WHITE.a);
-	m_renderer->DrawTriangles(&va, GetRenderState(blendMode), m_textureMaterial.Get(), Graphics::TRIANGLE_STRIP);
+	for (int col = 0; col < 3; col++)
+		m_drawList->AddQuad(m_textureMaterial.Get(), state,
+			vector2f(x[col], pos.y), vector2f(x[col+1]-x[col], size.y),
+			scaled(vector2f(u[col], element.pos.y)), scaled(vector2f(u[col+1]-u[col], element.size.y)), color);
 }
 
 void Skin::DrawRectColor(const Color &col, const Point &pos, const Point &size) const
 {
-	Graphics::VertexArray va(Graphics::ATTRIB_POSITION);
-
-	va.Add(vector3f(pos.x,        pos.y,        0.0f));
-	va.Add(vector3f(pos.x,        pos.y+size.y, 0.0f));
-	va.Add(vector3f(pos.x+size.x, pos.y,        0.0f));
-	va.Add(vector3f(pos.x+size.x, pos.y+size.y, 0.0f));
-
-	m_colorMaterial->diffuse = Color(col.r, col.g, col.b, m_opacity*col.a);
-	m_renderer->DrawTriangles(&va, GetAlphaBlendState(), m_colorMaterial.Get(), Graphics::TRIANGLE_STRIP);
+	m_drawList->AddQuad(m_colorMaterial.Get(), GetAlphaBlendState(),
+		vector2f(pos.x, pos.y), vector2f(size.x, size.y), vector2f(0.0f), vector2f(0.0f),
+		Color(col.r, col.g, col.b, m_opacity*col.a));
 }
 
 Skin::RectElement Skin::LoadRectElement(const std::string &spec)
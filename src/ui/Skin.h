@@ -10,14 +10,17 @@
 #include "graphics/Material.h"
 #include "graphics/RenderState.h"
 #include "Point.h"
+#include "DrawList.h"
 
 #include <SDL_stdinc.h>
 
 namespace UI {
 
+// Skin elements aren't drawn immediately; they're recorded into the context's
+// draw list and submitted with everything else at the end of the frame
 class Skin {
 public:
-	Skin(const std::string &filename, Graphics::Renderer *renderer, float scale);
+	Skin(const std::string &filename, Graphics::Renderer *renderer, DrawList *drawList, float scale);
 
 	void SetOpacity(float o) { m_opacity = o; }
 
@@ -219,6 +222,7 @@ public:
 
 private:
 	Graphics::Renderer *m_renderer;
+	DrawList *m_drawList;
 
 	float m_scale;
 
@@ -64,6 +64,7 @@ void Slider::UpdateButton()
 	}
 
 	m_mouseOverButton = IsMouseOver() && PointInsideButton(m_lastMousePosition);
+	MarkDrawDirty();
 }
 
 void Slider::Draw()
@@ -119,6 +120,7 @@ Slider *Slider::SetRange(float min, float max)
 void Slider::HandleMouseDown(const MouseButtonEvent &event)
 {
 	m_buttonDown = PointInsideButton(event.pos);
+	MarkDrawDirty();
 
     if (!m_buttonDown) {
 		float change = 0.0f;
@@ -145,6 +147,7 @@ void Slider::HandleMouseDown(const MouseButtonEvent &event)
 void Slider::HandleMouseUp(const MouseButtonEvent &event)
 {
 	m_buttonDown = false;
+	MarkDrawDirty();
 	Widget::HandleMouseUp(event);
 }
 
@@ -181,7 +184,11 @@ void Slider::HandleMouseMove(const MouseMotionEvent &event)
 
 	else {
 		m_lastMousePosition = event.pos;
-		m_mouseOverButton = PointInsideButton(event.pos);
+		const bool mouseOverButton = PointInsideButton(event.pos);
+		if (mouseOverButton != m_mouseOverButton) {
+			m_mouseOverButton = mouseOverButton;
+			MarkDrawDirty();
+		}
 	}
 
 	Widget::HandleMouseMove(event);
@@ -190,6 +197,7 @@ void Slider::HandleMouseMove(const MouseMotionEvent &event)
 void Slider::HandleMouseOut()
 {
 	m_mouseOverButton = false;
+	MarkDrawDirty();
 	Widget::HandleMouseOut();
 }
 
@@ -102,7 +102,8 @@ Table::Inner::Inner(Context *context, LayoutAccumulator &layout) : Container(con
 	m_rowSpacing(0),
 	m_rowAlignment(ROW_TOP),
 	m_dirty(false),
-	m_mouseEnabled(false)
+	m_mouseEnabled(false),
+	m_hoverRow(-1)
 {
 }
 
@@ -156,7 +157,7 @@ void Table::Inner::Layout()
 			Widget *w = row[j];
 			if (!w) continue;
 
-			const Point preferredSize(w->PreferredSize());
+			const Point preferredSize(w->GetPreferredSize());
 			int height = std::min(preferredSize.y, m_rowHeight[i]);
 
 			int off = 0;
@@ -221,6 +222,12 @@ void Table::Inner::Clear()
 	m_dirty = false;
 }
 
+void Table::Inner::InvalidateLayout()
+{
+	Container::InvalidateLayout();
+	m_dirty = true;
+}
+
 void Table::Inner::AccumulateLayout()
 {
 	for (std::vector< std::vector<Widget*> >::const_iterator i = m_rows.begin(); i != m_rows.end(); ++i)
@@ -252,6 +259,20 @@ void Table::Inner::HandleClick()
 	Container::HandleClick();
 }
 
+void Table::Inner::HandleMouseMove(const MouseMotionEvent &event)
+{
+	// the highlight only needs drawing again when it moves to another row
+	if (m_mouseEnabled) {
+		const int row = RowUnderPoint(GetMousePos());
+		if (row != m_hoverRow) {
+			m_hoverRow = row;
+			MarkDrawDirty();
+		}
+	}
+
+	Container::HandleMouseMove(event);
+}
+
 int Table::Inner::RowUnderPoint(const Point &pt, int *out_row_top, int *out_row_bottom) const
 {
 	int start = 0, end = m_rows.size()-1, mid = 0;
@@ -346,7 +367,7 @@ void Table::Layout()
 		const Point sliderSize(m_slider->PreferredSize().x, size.y);
 		const Point sliderPos(size.x-sliderSize.x, top);
 		SetWidgetDimensions(m_slider.Get(), sliderPos, sliderSize);
-		m_slider->Layout();
+		LayoutWidget(m_slider.Get());
 
 		size.x = sliderPos.x;
 
@@ -358,9 +379,19 @@ void Table::Layout()
 
 	SetWidgetDimensions(m_body.Get(), Point(0, top), size);
 
+	// column widths may have moved even if the sizes haven't
+	m_header->InvalidateLayout();
+	m_body->InvalidateLayout();
+
 	LayoutChildren();
 }
 
+void Table::InvalidateLayout()
+{
+	Container::InvalidateLayout();
+	m_dirty = true;
+}
+
 void Table::HandleInvisible()
 {
 	m_slider->SetValue(0);
@@ -371,7 +402,7 @@ Table *Table::SetHeadingRow(const WidgetSet &set)
 	m_header->Clear();
 	m_header->AddRow(set.widgets);
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
@@ -379,7 +410,7 @@ Table *Table::AddRow(const WidgetSet &set)
 {
 	m_body->AddRow(set.widgets);
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
@@ -387,14 +418,14 @@ void Table::ClearRows()
 {
 	m_body->Clear();
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 }
 
 Table *Table::SetRowSpacing(int spacing)
 {
 	m_body->SetRowSpacing(GetContext()->GetScale() * spacing);
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
@@ -402,7 +433,7 @@ Table *Table::SetColumnSpacing(int spacing)
 {
 	m_layout.SetColumnSpacing(GetContext()->GetScale() * spacing);
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
@@ -410,7 +441,7 @@ Table *Table::SetRowAlignment(RowAlignDirection dir)
 {
 	m_body->SetRowAlignment(dir);
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
@@ -418,7 +449,7 @@ Table *Table::SetColumnAlignment(ColumnAlignDirection mode)
 {
 	m_layout.SetColumnAlignment(mode);
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
@@ -426,7 +457,7 @@ Table *Table::SetHeadingFont(Font font)
 {
 	m_header->SetFont(font);
 	m_dirty = true;
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
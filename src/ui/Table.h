@@ -52,6 +52,7 @@ public:
 
 protected:
 	virtual void HandleInvisible();
+	virtual void InvalidateLayout();
 
 private:
 
@@ -101,12 +102,18 @@ private:
 
 		void SetRowAlignment(RowAlignDirection dir);
 
-		void SetMouseEnabled(bool enabled) { m_mouseEnabled = enabled; }
+		void SetMouseEnabled(bool enabled) { m_mouseEnabled = enabled; MarkDrawDirty(); }
+
+		// rows share column widths with the other half of the table, so
+		// the table has to lay them out together
+		virtual void InvalidateLayout();
+		virtual bool IsLayoutShared() const { return true; }
 
 		sigc::signal<void,unsigned int> onRowClicked;
 
 	protected:
 		virtual void HandleClick();
+		virtual void HandleMouseMove(const MouseMotionEvent &event);
 
 	private:
 		int RowUnderPoint(const Point &pt, int *out_row_top = 0, int *out_row_bottom = 0) const;
@@ -120,6 +127,8 @@ private:
 		bool m_dirty;
 
 		bool m_mouseEnabled;
+		// row being highlighted
+		int m_hoverRow;
 	};
 
 	LayoutAccumulator m_layout;
@@ -9,7 +9,8 @@
 namespace UI {
 
 TextEntry::TextEntry(Context *context, const std::string &text) : Container(context),
-	m_cursor(0)
+	m_cursor(0),
+	m_cursorHeight(0)
 {
 	m_label = GetContext()->Label(text);
 	AddWidget(m_label);
@@ -19,7 +20,7 @@ Point TextEntry::PreferredSize()
 {
 	const Skin::BorderedRectElement &elem(GetContext()->GetSkin().BackgroundNormal());
 	const Point borderSize(elem.borderWidth*2, elem.borderHeight*2);
-	Point preferredSize = SizeAdd(m_label->PreferredSize(), Point(elem.paddingX*2, elem.paddingY*2));
+	Point preferredSize = SizeAdd(m_label->GetPreferredSize(), Point(elem.paddingX*2, elem.paddingY*2));
 	preferredSize.x = std::max(preferredSize.x, borderSize.x);
 	preferredSize.y = std::max(preferredSize.y, borderSize.y);
 	return preferredSize;
@@ -36,22 +37,20 @@ void TextEntry::Layout()
 
 	SetWidgetDimensions(m_label, innerPos, innerSize);
 
-	// XXX see ::Draw. after Container::Draw we're still translated to the
-	// label origin so we calculate the cursor from there
-	const float cursorBottom = m_label->GetSize().y;
-	const float cursorTop    = cursorBottom - GetContext()->GetFont(GetFont())->GetHeight();
+	m_cursorHeight = GetContext()->GetFont(GetFont())->GetHeight();
+	m_cursorPos.y = m_label->GetSize().y - m_cursorHeight;
 
-	m_cursorVertices[0] = vector3f(0.0f, cursorTop,    0.0f);
-	m_cursorVertices[1] = vector3f(0.0f, cursorBottom, 0.0f);
-
-	m_label->Layout();
+	LayoutWidget(m_label);
 }
 
 void TextEntry::Update()
 {
 	float cursorLeft, cursorBaseline;
 	GetContext()->GetFont(GetFont())->MeasureCharacterPos(GetText().c_str(), m_cursor, cursorLeft, cursorBaseline);
-	m_cursorVertices[0].x = m_cursorVertices[1].x = cursorLeft + 0.5f;
+	if (m_cursorPos.x != int(cursorLeft)) {
+		m_cursorPos.x = cursorLeft;
+		MarkDrawDirty();
+	}
 
 	// offset such that the cursor is always visible
 	const Point offset(m_label->GetDrawOffset());
@@ -78,8 +77,8 @@ void TextEntry::Draw()
 	Container::Draw();
 
 	if (IsSelected()) {
-		m_lines.SetData(2, &m_cursorVertices[0], Color::WHITE);
-		m_lines.Draw(GetContext()->GetRenderer(), GetContext()->GetSkin().GetAlphaBlendState());
+		const Point labelPos(m_label->GetPosition() + m_label->GetDrawOffset());
+		GetContext()->GetSkin().DrawRectColor(Color::WHITE, labelPos + m_cursorPos, Point(1, m_cursorHeight));
 	}
 }
 
@@ -88,7 +87,7 @@ TextEntry *TextEntry::SetText(const std::string &text)
 	bool atEnd = m_label->GetText().size() == m_cursor;
 	m_label->SetText(text);
 	m_cursor = atEnd ? Uint32(text.size()) : Clamp(m_cursor, Uint32(0), Uint32(text.size()));
-	GetContext()->RequestLayout();
+	RequestLayout();
 	return this;
 }
 
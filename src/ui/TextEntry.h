@@ -6,7 +6,6 @@
 
 #include "Container.h"
 #include "Label.h"
-#include "graphics/Drawables.h"
 
 namespace UI {
 
@@ -36,8 +35,9 @@ private:
 	Label *m_label;
 
 	Uint32 m_cursor;
-	vector3f m_cursorVertices[2];
-	Graphics::Drawables::Lines m_lines;
+	// in label coordinates
+	Point m_cursorPos;
+	int m_cursorHeight;
 };
 
 }
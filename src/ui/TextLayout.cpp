@@ -3,16 +3,15 @@
 
 #include "TextLayout.h"
 #include "Widget.h"
+#include "DrawList.h"
 #include "RefCounted.h"
 #include "text/TextureFont.h"
 #include "Color.h"
-#include "graphics/VertexArray.h"
-#include "graphics/VertexBuffer.h"
 
 namespace UI {
 
 TextLayout::TextLayout(const RefCountedPtr<Text::TextureFont> &font, const std::string &text)
-	: m_font(font),	m_lastDrawPos(Point(INT_MIN, INT_MIN)), m_lastDrawSize(Point(INT_MIN, INT_MIN)), m_prevColor(Color::WHITE)
+	: m_font(font), m_glyphs(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0), m_lastDrawPos(Point(INT_MIN, INT_MIN)), m_lastDrawSize(Point(INT_MIN, INT_MIN)), m_prevColor(Color::WHITE)
 {
 	if (!text.size())
 		return;
@@ -107,7 +106,7 @@ Point TextLayout::ComputeSize(const Point &layoutSize)
 	return bounds;
 }
 
-void TextLayout::Draw(const Point &layoutSize, const Point &drawPos, const Point &drawSize, const Color &color)
+void TextLayout::Draw(DrawList &drawList, const Point &layoutSize, const Point &drawPos, const Point &drawSize, const Color &color)
 {
 	// Has anything changed between passes
 	const bool bAnyNew = (layoutSize != m_lastRequested) || (m_lastDrawPos != drawPos) || (m_lastDrawSize != drawSize) || (m_prevColor != color);
@@ -117,23 +116,15 @@ void TextLayout::Draw(const Point &layoutSize, const Point &drawPos, const Point
 		const int top = -drawPos.y - m_font->GetHeight();
 		const int bottom = -drawPos.y + drawSize.y;
 
-		Graphics::VertexArray va(Graphics::ATTRIB_POSITION | Graphics::ATTRIB_DIFFUSE | Graphics::ATTRIB_UV0);
-
+		m_glyphs.Clear();
 		for (std::vector<Word>::iterator i = m_words.begin(); i != m_words.end(); ++i) {
 			if ((*i).pos.y >= top && (*i).pos.y < bottom) {
-				m_font->PopulateString(va, (*i).text, (*i).pos.x, (*i).pos.y, color);
+				m_font->PopulateString(m_glyphs, (*i).text, (*i).pos.x, (*i).pos.y, color);
 			}
 		}
-
-		if (!m_vbuffer.Valid() || (m_vbuffer->GetVertexCount() != va.GetNumVerts())) {
-			m_vbuffer.Reset(m_font->CreateVertexBuffer(va, true));
-		}
-		else {
-			m_vbuffer->Populate(va);
-		}
 	}
 
-	m_font->RenderBuffer( m_vbuffer.Get() );
+	drawList.AddGlyphs(m_font->GetMaterial(), m_font->GetRenderState(), m_glyphs);
 
 	// store current params
 	m_lastRequested = layoutSize;
@@ -7,21 +7,22 @@
 #include "Point.h"
 #include "RefCounted.h"
 #include "Color.h"
+#include "graphics/VertexArray.h"
 #include <string>
 #include <vector>
 
 namespace Text { class TextureFont; }
-namespace Graphics { class Renderer; class VertexBuffer; }
-
 namespace UI {
 
+class DrawList;
+
 class TextLayout {
 public:
 	TextLayout(const RefCountedPtr<Text::TextureFont> &font, const std::string &text);
 
 	Point ComputeSize(const Point &layoutSize);
 
-	void Draw(const Point &layoutSize, const Point &drawPos, const Point &drawSize, const Color &color = Color::WHITE);
+	void Draw(DrawList &drawList, const Point &layoutSize, const Point &drawPos, const Point &drawSize, const Color &color = Color::WHITE);
 
 private:
 	struct Word {
@@ -35,7 +36,7 @@ private:
 	Point m_lastSize;        // and the resulting size
 
 	RefCountedPtr<Text::TextureFont> m_font;
-	RefCountedPtr<Graphics::VertexBuffer> m_vbuffer;
+	Graphics::VertexArray m_glyphs;
 
 	Point m_lastDrawPos;
 	Point m_lastDrawSize;
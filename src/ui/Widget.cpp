@@ -23,7 +23,13 @@ Widget::Widget(Context *context) :
 	m_visible(false),
 	m_animatedOpacity(1.0f),
 	m_animatedPositionX(1.0f),
-	m_animatedPositionY(1.0f)
+	m_animatedPositionY(1.0f),
+	m_layoutDirty(true),
+	m_layoutQueued(false),
+	m_preferredSizeValid(false),
+	m_preferredSize(0),
+	m_layoutSize(0),
+	m_drawDirty(true)
 {
 	assert(m_context);
 }
@@ -55,6 +61,11 @@ void Widget::Attach(Container *container)
 	assert(container);
 	assert(m_context == container->GetContext());
 	m_container = container;
+	container->MarkDrawDirty();
+
+	// nothing here was laid out in this container, and layout requests made
+	// while we were detached went nowhere
+	InvalidateLayoutTree();
 
 	// we should never be visible while we're detached, and we should
 	// always be detached before being attached to something else
@@ -65,6 +76,7 @@ void Widget::Attach(Container *container)
 void Widget::Detach()
 {
 	NotifyVisible(false);
+	m_container->MarkDrawDirty();
 	m_container = 0;
 	m_position = Point();
 	m_size = Point();
@@ -72,6 +84,8 @@ void Widget::Detach()
 
 void Widget::SetDimensions(const Point &position, const Point &size)
 {
+	if (position != m_position || size != m_size)
+		MarkDrawDirty();
 	m_position = position;
 	SetSize(size);
 	SetActiveArea(size);
@@ -88,20 +102,49 @@ void Widget::NotifyVisible(bool visible)
 
 void Widget::SetActiveArea(const Point &activeArea, const Point &activeOffset)
 {
-	m_activeArea = Point(Clamp(activeArea.x, 0, GetSize().x), Clamp(activeArea.y, 0, GetSize().y));
+	const Point newActiveArea(Clamp(activeArea.x, 0, GetSize().x), Clamp(activeArea.y, 0, GetSize().y));
+	if (newActiveArea != m_activeArea || activeOffset != m_activeOffset)
+		MarkDrawDirty();
+	m_activeArea = newActiveArea;
 	m_activeOffset = activeOffset;
 }
 
+void Widget::AddShortcut(const KeySym &keysym)
+{
+	m_shortcuts.insert(keysym);
+	if (m_visible)
+		GetContext()->ShortcutsChanged();
+}
+
+void Widget::RemoveShortcut(const KeySym &keysym)
+{
+	m_shortcuts.erase(keysym);
+	if (m_visible)
+		GetContext()->ShortcutsChanged();
+}
+
 Widget *Widget::SetFont(Font font)
 {
 	m_font = font;
-	GetContext()->RequestLayout();
+	// everything inside that inherits the font changes size too
+	InvalidateLayoutTree();
+	RequestLayout();
+	MarkDrawDirty();
 	return this;
 }
 
+Point Widget::GetPreferredSize()
+{
+	if (!m_preferredSizeValid) {
+		m_preferredSize = PreferredSize();
+		m_preferredSizeValid = true;
+	}
+	return m_preferredSize;
+}
+
 Point Widget::CalcLayoutContribution()
 {
-	Point preferredSize = PreferredSize();
+	Point preferredSize = GetPreferredSize();
 	const Uint32 flags = GetSizeControlFlags();
 
 	if (flags & NO_WIDTH)
@@ -122,7 +165,7 @@ Point Widget::CalcSize(const Point &avail)
 	if (!(GetSizeControlFlags() & PRESERVE_ASPECT))
 		return avail;
 
-	const Point preferredSize = PreferredSize();
+	const Point preferredSize = GetPreferredSize();
 
 	const float wantRatio = float(preferredSize.x) / float(preferredSize.y);
 	const float haveRatio = float(avail.x) / float(avail.y);
@@ -145,6 +188,31 @@ Widget::Font Widget::GetFont() const
 	return m_font;
 }
 
+void Widget::MarkDrawDirty()
+{
+	// the first parent that's already dirty will have marked its own
+	// parents when it was dirtied
+	for (Widget *w = this; w && !w->m_drawDirty; w = w->m_container)
+		w->m_drawDirty = true;
+}
+
+void Widget::RequestLayout()
+{
+	InvalidateLayout();
+
+	// a detached widget has everything redone when it's attached
+	if (m_visible && !m_layoutQueued) {
+		m_layoutQueued = true;
+		m_context->RequestLayout(this);
+	}
+}
+
+void Widget::InvalidateLayout()
+{
+	m_layoutDirty = true;
+	m_preferredSizeValid = false;
+}
+
 bool Widget::IsMouseActive() const
 {
 	return (GetContext()->GetMouseActive() == this);
@@ -291,6 +359,7 @@ bool Widget::TriggerMouseOver(const Point &pos, bool handled, Widget *stop)
 	// only send external events on state change
 	if (!m_mouseOver) {
 		m_mouseOver = true;
+		MarkDrawDirty();
 		HandleMouseOver();
 		if (!handled) handled = onMouseOver.emit();
 	}
@@ -306,6 +375,7 @@ bool Widget::TriggerMouseOut(const Point &pos, bool handled, Widget *stop)
 		HandleMouseOut();
 		if (!handled) handled = onMouseOut.emit();
 		m_mouseOver = false;
+		MarkDrawDirty();
 	}
 	if (stop == this) return handled;
 	if (GetContainer()) handled = GetContainer()->TriggerMouseOut(pos+GetPosition(), handled, stop);
@@ -322,21 +392,25 @@ bool Widget::TriggerClick(bool handled)
 
 void Widget::TriggerMouseActivate()
 {
+	MarkDrawDirty();
 	HandleMouseActivate();
 }
 
 void Widget::TriggerMouseDeactivate()
 {
+	MarkDrawDirty();
 	HandleMouseDeactivate();
 }
 
 void Widget::TriggerSelect()
 {
+	MarkDrawDirty();
 	HandleSelect();
 }
 
 void Widget::TriggerDeselect()
 {
+	MarkDrawDirty();
 	HandleDeselect();
 }
 
@@ -10,6 +10,7 @@
 #include "RefCounted.h"
 #include "WidgetSet.h"
 #include "PropertiedObject.h"
+#include "DrawList.h"
 #include <climits>
 #include <set>
 
@@ -19,10 +20,12 @@
 //
 // At minimum, a widget must implement Draw().
 //
-// - Draw() actually draws the widget, using regular renderer calls. The
-//   renderer state will be set such that the widget's top-left corner is at
-//   [0,0] with a scissor region to prevent drawing outside of the widget's
-//   allocated space.
+// - Draw() actually draws the widget, through the skin, the context's draw
+//   list or (if it must) the renderer from Context::GetRenderer(). The
+//   widget's top-left corner is at [0,0] and anything outside the widget's
+//   allocated space is clipped. What it draws is kept and reused on later
+//   frames until MarkDrawDirty() is called, so any widget with state that
+//   changes how it looks must call that when the state changes.
 //
 // Widgets can implement PreferredSize(), Layout() and Draw() to do more
 // advanced things.
@@ -68,8 +71,10 @@
 //
 // Event handlers from user input are called before Layout(), which gives a
 // widget an opportunity to modify the layout based on input. If a widget
-// wants to change its size it must call GetContext()->RequestLayout() to
-// force a layout change to occur.
+// wants to change its size it must call RequestLayout() to force a layout
+// change to occur. Only that widget is laid out again, along with those of its
+// parents whose preferred size changes as a result; the rest of the tree keeps
+// its layout. GetContext()->RequestLayout() lays out everything.
 //
 // Event handlers are called against the "leaf" widgets first. Handlers return
 // a bool to indicate if the event was "handled" or not. If a widget has no
@@ -99,6 +104,10 @@ public:
 	virtual void Update() {}
 	virtual void Draw() = 0;
 
+	// PreferredSize(), remembered until the widget requests layout again.
+	// containers should use this to size their children
+	Point GetPreferredSize();
+
 	// gui context
 	Context *GetContext() const { return m_context; }
 
@@ -126,7 +135,7 @@ public:
 	};
 
 	// draw offset. used to move a widget "under" its visible area (scissor)
-	void SetDrawOffset(const Point &drawOffset) { m_drawOffset = drawOffset; }
+	void SetDrawOffset(const Point &drawOffset) { if (drawOffset != m_drawOffset) { m_drawOffset = drawOffset; MarkDrawDirty(); } }
 	const Point &GetDrawOffset() const { return m_drawOffset; }
 
 	// active area of the widget. the widget may only want to use part of its
@@ -169,8 +178,8 @@ public:
 
 	// register a key that, when pressed and not handled by any other widget,
 	// will cause a click event to be sent to this widget
-	void AddShortcut(const KeySym &keysym) { m_shortcuts.insert(keysym); }
-	void RemoveShortcut(const KeySym &keysym) { m_shortcuts.erase(keysym); }
+	void AddShortcut(const KeySym &keysym);
+	void RemoveShortcut(const KeySym &keysym);
 
 	// font size. obviously used for text size but also sometimes used for
 	// general widget size (eg space size). might do nothing, depends on the
@@ -288,8 +297,27 @@ protected:
 	// (ie, its chain of parents links to a Context)
 	bool IsVisible() const { return m_visible; }
 
-	void SetDisabled(bool disabled) { m_disabled = disabled; }
-	void SetHidden(bool hidden) { m_hidden = hidden; }
+	void SetDisabled(bool disabled) { m_disabled = disabled; MarkDrawDirty(); }
+	void SetHidden(bool hidden) { m_hidden = hidden; MarkDrawDirty(); }
+
+	// something that affects how the widget looks has changed, so it (and
+	// its parents, which include it in what they draw) must be drawn again
+	void MarkDrawDirty();
+
+	// something that affects the widget's preferred size or the layout of
+	// its children has changed. it will be laid out again before the next
+	// draw, along with any parents that have to make room for it
+	void RequestLayout();
+
+	// forget the cached preferred size and mark the widget for layout.
+	// widgets that keep layout state of their own can override this to
+	// reset it too (they must call the base)
+	virtual void InvalidateLayout();
+
+	// a widget whose layout is worked out together with its siblings (eg
+	// table rows, which share column widths) returns true so that a layout
+	// request from inside it always goes on to its container
+	virtual bool IsLayoutShared() const { return false; }
 
 	// internal event handlers. override to handle events. unlike the external
 	// on* signals, every widget in the stack is guaranteed to receive a call
@@ -393,6 +421,9 @@ private:
 	void SetDimensions(const Point &position, const Point &size);
 	virtual void NotifyVisible(bool visible);
 
+	// invalidate the layout of this widget and everything in it
+	virtual void InvalidateLayoutTree() { InvalidateLayout(); }
+
 	// called by Container::CollectShortcuts
 	const std::set<KeySym> &GetShortcuts() const { return m_shortcuts; }
 
@@ -406,9 +437,9 @@ private:
 	// Animation needs to change our animation attributes
 	friend class Animation;
 
-	void SetAnimatedOpacity(float opacity) { m_animatedOpacity = opacity; }
-	void SetAnimatedPositionX(float pos) { m_animatedPositionX = pos; }
-	void SetAnimatedPositionY(float pos) { m_animatedPositionY = pos; }
+	void SetAnimatedOpacity(float opacity) { m_animatedOpacity = opacity; MarkDrawDirty(); }
+	void SetAnimatedPositionX(float pos) { m_animatedPositionX = pos; MarkDrawDirty(); }
+	void SetAnimatedPositionY(float pos) { m_animatedPositionY = pos; MarkDrawDirty(); }
 
 
 	Context *m_context;
@@ -440,6 +471,17 @@ private:
 	float m_animatedOpacity;
 	float m_animatedPositionX;
 	float m_animatedPositionY;
+
+	// layout state (see Context::UpdateLayout and Container::LayoutWidget)
+	bool m_layoutDirty;
+	bool m_layoutQueued;
+	bool m_preferredSizeValid;
+	Point m_preferredSize;
+	Point m_layoutSize;
+
+	// what this widget and its children drew last time (see Context::DrawWidget)
+	bool m_drawDirty;
+	DrawList::Segment m_drawCache;
 };
 
 }
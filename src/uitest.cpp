@@ -11,6 +11,7 @@
 #include "Lua.h"
 #include "PropertiedObject.h"
 #include "OS.h"
+#include "profiler/Profiler.h"
 #include <typeinfo>
 
 static const int WIDTH  = 1024;
@@ -111,6 +112,130 @@ static void animation_callback(int n)
 	printf("%d animation completed\n", n);
 }
 
+// ui draw benchmark. builds something like the station market screen (a long
+// table of rows with labels, icons, gauges and buttons) and draws it for a
+// number of frames, once through the batched draw list and once drawing each
+// quad on its own, the way the ui used to. a few readouts change every frame
+// so not everything can be replayed from the cache.
+//
+//   uitest bench [frames]
+
+static const int BENCH_ROWS = 60;
+static const int BENCH_DEFAULT_FRAMES = 500;
+
+static const char *BENCH_GOODS[] = {
+	"Hydrogen", "Liquid Oxygen", "Water", "Carbon Ore", "Metal Ore",
+	"Fruit and Vegetables", "Animal Meat", "Medicines", "Robots", "Computers",
+	"Industrial Machinery", "Farm Machinery", "Air Processors", "Hand Weapons", "Rubbish",
+};
+
+static UI::Widget *bench_screen(UI::Context *c, std::vector<UI::Label*> &prices, std::vector<UI::Gauge*> &stock)
+{
+	UI::Table *t = c->Table();
+	t->SetRowSpacing(2)->SetColumnSpacing(8);
+	t->SetHeadingRow(UI::WidgetSet(c->Label(""), c->Label("Name"), c->Label("Price"), c->Label("In stock"), c->Label("Cargo"), c->Label("")));
+
+	for (int i = 0; i < BENCH_ROWS; i++) {
+		UI::Label *price = c->Label("0.00");
+		UI::Gauge *gauge = c->Gauge();
+		gauge->SetValue(float(i % 10) * 0.1f);
+		prices.push_back(price);
+		stock.push_back(gauge);
+
+		t->AddRow(UI::WidgetSet(
+			c->Icon(i & 1 ? "Bag" : "Agenda"),
+			c->Label(BENCH_GOODS[i % COUNTOF(BENCH_GOODS)]),
+			price,
+			gauge,
+			c->Label("0t"),
+			c->HBox(4)->PackEnd(UI::WidgetSet(
+				c->Button()->SetInnerWidget(c->Label("Buy")),
+				c->Button()->SetInnerWidget(c->Label("Sell"))
+			))
+		));
+	}
+
+	return c->Margin(10)->SetInnerWidget(
+		c->Background()->SetInnerWidget(
+			c->VBox(10)->PackEnd(UI::WidgetSet(
+				c->ColorBackground(Color(0, 0, 64, 255))->SetInnerWidget(c->Label("Commodity market")),
+				c->Scroller()->SetInnerWidget(t)
+			))
+		)
+	);
+}
+
+static bool bench_frames(UI::Context *c, Graphics::Renderer *r, int numFrames, std::vector<UI::Label*> &prices, std::vector<UI::Gauge*> &stock)
+{
+	Profiler::Timer updateTimer, drawTimer, frameTimer;
+	UI::DrawList::Stats total;
+	char buf[32];
+
+	frameTimer.Start();
+	int frame;
+	for (frame = 0; frame < numFrames; frame++) {
+		SDL_Event event;
+		while (SDL_PollEvent(&event)) {
+			if ((event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) || event.type == SDL_QUIT)
+				return false;
+		}
+
+		// one price in ten and one gauge in twenty change each frame, like a
+		// market with some trading going on
+		for (size_t i = frame % 10; i < prices.size(); i += 10) {
+			snprintf(buf, sizeof(buf), "%d.%02d", (frame * 13 + int(i)) % 1000, (frame + int(i)) % 100);
+			prices[i]->SetText(buf);
+		}
+		for (size_t i = frame % 20; i < stock.size(); i += 20)
+			stock[i]->SetValue(float((frame + i) % 100) * 0.01f);
+
+		updateTimer.Start();
+		c->Update();
+		updateTimer.Stop();
+
+		r->BeginFrame();
+		r->ClearScreen();
+
+		drawTimer.Start();
+		c->Draw();
+		drawTimer.Stop();
+
+		r->EndFrame();
+		r->SwapBuffers();
+
+		const UI::DrawList::Stats &stats = c->GetDrawList().GetStats();
+		total.quads += stats.quads;
+		total.replayedQuads += stats.replayedQuads;
+		total.batches += stats.batches;
+		total.flushes += stats.flushes;
+	}
+	frameTimer.Stop();
+
+	const int frames = std::max(frame, 1);
+	Output("uitest bench: %d frames, %s\n", frame, c->GetDrawList().IsBatching() ? "batched" : "unbatched");
+	Output("  total  %12.3lf ms (%.3lf ms/frame)\n", frameTimer.millicycles(), frameTimer.millicycles() / frames);
+	Output("  update %12.3lf ms (%.3lf ms/frame)\n", updateTimer.millicycles(), updateTimer.millicycles() / frames);
+	Output("  draw   %12.3lf ms (%.3lf ms/frame)\n", drawTimer.millicycles(), drawTimer.millicycles() / frames);
+	Output("  %u quads/frame, %u replayed, %u draw calls, %u flushes\n", total.quads / frames, total.replayedQuads / frames, total.batches / frames, total.flushes / frames);
+
+	return true;
+}
+
+static void bench(UI::Context *c, Graphics::Renderer *r, int numFrames)
+{
+	std::vector<UI::Label*> prices;
+	std::vector<UI::Gauge*> stock;
+	c->GetTopLayer()->SetInnerWidget(bench_screen(c, prices, stock));
+	c->Layout();
+
+	c->GetDrawList().SetBatching(true);
+	if (!bench_frames(c, r, numFrames, prices, stock))
+		return;
+
+	c->GetDrawList().SetBatching(false);
+	bench_frames(c, r, numFrames, prices, stock);
+}
+
 int main(int argc, char **argv)
 {
 	FileSystem::Init();
@@ -141,6 +266,18 @@ int main(int argc, char **argv)
 
 	RefCountedPtr<UI::Context> c(new UI::Context(Lua::manager, r, WIDTH, HEIGHT));
 
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		bench(c.Get(), r, argc > 2 ? std::max(1, atoi(argv[2])) : BENCH_DEFAULT_FRAMES);
+
+		c.Reset();
+		Lua::Uninit();
+		delete r;
+
+		SDL_Quit();
+
+		exit(0);
+	}
+
 	UI::Grid *g = c->Grid(3,3);
 	UI::Image *img[9];
 	for (int y = 0; y < 3; y++)
@@ -159,6 +159,18 @@ namespace FileSystem {
 			}
 			size_t size = size_t(large_size.QuadPart);
 
+			if (size >= FileDataMmap::MMAP_THRESHOLD && size <= 0x7FFFFFFFull) {
+				// the view keeps the mapping (and the file) alive by itself
+				HANDLE mapping = CreateFileMappingW(filehandle, 0, PAGE_WRITECOPY, 0, 0, 0);
+				void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : 0;
+				if (mapping) CloseHandle(mapping);
+				if (view) {
+					CloseHandle(filehandle);
+					return RefCountedPtr<FileData>(new FileDataMmap(MakeFileInfo(path, FileInfo::FT_FILE, modtime), size, static_cast<char*>(view)));
+				}
+				// fall back to reading it
+			}
+
 			char *data = static_cast<char*>(std::malloc(size));
 			if (!data) {
 				// XXX handling memory allocation failure gracefully is too hard right now
@@ -191,6 +203,11 @@ namespace FileSystem {
 		}
 	}
 
+	FileDataMmap::~FileDataMmap()
+	{
+		UnmapViewOfFile(m_data);
+	}
+
 	bool FileSourceFS::ReadDirectory(const std::string &dirpath, std::vector<FileInfo> &output)
 	{
 		size_t output_head_size = output.size();
@@ -260,6 +277,18 @@ namespace FileSystem {
 		return make_directory_raw(wfullpath);
 	}
 
+	bool FileSourceFS::RemoveFile(const std::string &path)
+	{
+		const std::string fullpath = JoinPathBelow(GetRoot(), path);
+		const std::wstring wfullpath = transcode_utf8_to_utf16(fullpath);
+		const DWORD attrs = GetFileAttributesW(wfullpath.c_str());
+		if (attrs == INVALID_FILE_ATTRIBUTES)
+			return false;
+		if (attrs & FILE_ATTRIBUTE_DIRECTORY)
+			return RemoveDirectoryW(wfullpath.c_str()) != 0;
+		return DeleteFileW(wfullpath.c_str()) != 0;
+	}
+
 	static FILE* open_file_raw(const std::string &fullpath, const wchar_t *mode)
 	{
 		const std::wstring wfullpath = transcode_utf8_to_utf16(fullpath);